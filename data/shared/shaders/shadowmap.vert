@@ -2,7 +2,8 @@
  * @brief Shader to fill the bound shadowmap with the depth values
  */
 
-$in ivec3 a_pos;
+// relative to the mesh offset - which is part of u_model
+$in uvec3 a_pos;
 #ifdef INSTANCED
 // instanced rendering
 $in vec3 a_offset;
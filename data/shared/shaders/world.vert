@@ -1,5 +1,6 @@
 // attributes from the VAOs
-$in ivec3 a_pos;
+// relative to the mesh offset - which is part of u_model
+$in uvec3 a_pos;
 $in uvec3 a_info;
 
 #ifdef INSTANCED
@@ -165,6 +165,17 @@ function luatest2:execute(ai, deltaMillis)
 	return RUNNING
 end
 
+--[[
+LuaTestId returns a tree node state that depends on the ai
+--]]
+local luatestid = REGISTRY.createNode("LuaTestId")
+function luatestid:execute(ai, deltaMillis)
+	if ai:id() % 2 == 0 then
+		return FINISHED
+	end
+	return RUNNING
+end
+
 --[[
 ensure we have a name clash here with a node
 --]]
@@ -175,7 +186,7 @@ function luaconditiontest:evaluate(ai)
 end
 
 --[[
-A condition that always returns true
+A condition that returns true for the ai ids up to 9000
 --]]
 local luaconditiontesttrue = REGISTRY.createCondition("LuaTestTrue")
 function luaconditiontesttrue:evaluate(ai)
@@ -183,7 +194,7 @@ function luaconditiontesttrue:evaluate(ai)
 end
 
 --[[
-A condition that always returns false
+A condition that returns false for the ai ids up to 9000
 --]]
 local luaconditiontestfalse = REGISTRY.createCondition("LuaTestFalse")
 function luaconditiontestfalse:evaluate(ai)
@@ -197,7 +208,7 @@ local luafiltertest = REGISTRY.createFilter("LuaFilterTest")
 function luafiltertest:filter(ai)
 	ai:addFilteredEntity(42)
 	ai:addFilteredEntity(1337)
-	ai:addFilteredEntity(101)
+	ai:addFilteredEntity(ai:id())
 	local ents = ai:filteredEntities()
 	ai:setFilteredEntities(ents)
 end
@@ -25,6 +25,7 @@
 #include "network/EntityRemoveHandler.h"
 #include "network/EntitySpawnHandler.h"
 #include "network/EntityUpdateHandler.h"
+#include "network/EntityUpdatesHandler.h"
 #include "network/UserSpawnHandler.h"
 #include "voxel/MaterialColor.h"
 
@@ -85,7 +86,8 @@ void Client::onEvent(const network::DisconnectEvent& event) {
 }
 
 void Client::onEvent(const network::NewConnectionEvent& event) {
-	flatbuffers::FlatBufferBuilder fbb;
+	network::ScopedBuilder builder;
+	flatbuffers::FlatBufferBuilder& fbb = builder;
 	const std::string& email = core::Var::getSafe(cfg::ClientEmail)->strVal();
 	const std::string& password = core::Var::getSafe(cfg::ClientPassword)->strVal();
 	Log::info("Trying to log into the server with %s", email.c_str());
@@ -126,13 +128,14 @@ core::AppState Client::onInit() {
 	eventBus()->subscribe<voxel::WorldCreatedEvent>(*this);
 
 	const network::ProtocolHandlerRegistryPtr& r = _network->registry();
-	r->registerHandler(network::EnumNameServerMsgType(network::ServerMsgType::AttribUpdate), std::make_shared<AttribUpdateHandler>());
-	r->registerHandler(network::EnumNameServerMsgType(network::ServerMsgType::EntitySpawn), std::make_shared<EntitySpawnHandler>());
-	r->registerHandler(network::EnumNameServerMsgType(network::ServerMsgType::EntityRemove), std::make_shared<EntityRemoveHandler>());
-	r->registerHandler(network::EnumNameServerMsgType(network::ServerMsgType::EntityUpdate), std::make_shared<EntityUpdateHandler>());
-	r->registerHandler(network::EnumNameServerMsgType(network::ServerMsgType::UserSpawn), std::make_shared<UserSpawnHandler>());
-	r->registerHandler(network::EnumNameServerMsgType(network::ServerMsgType::AuthFailed), std::make_shared<AuthFailedHandler>());
-	r->registerHandler(network::EnumNameServerMsgType(network::ServerMsgType::Seed), std::make_shared<SeedHandler>(_world));
+	r->registerHandler<AttribUpdateHandler>();
+	r->registerHandler<EntitySpawnHandler>();
+	r->registerHandler<EntityRemoveHandler>();
+	r->registerHandler<EntityUpdateHandler>();
+	r->registerHandler<EntityUpdatesHandler>();
+	r->registerHandler<UserSpawnHandler>();
+	r->registerHandler<AuthFailedHandler>();
+	r->registerHandler(network::ServerMsgType::Seed, std::make_shared<SeedHandler>(_world));
 
 	core::AppState state = Super::onInit();
 	if (state != core::AppState::Running) {
@@ -329,7 +332,8 @@ void Client::authFailed() {
 }
 
 void Client::disconnect() {
-	flatbuffers::FlatBufferBuilder fbb;
+	network::ScopedBuilder builder;
+	flatbuffers::FlatBufferBuilder& fbb = builder;
 	_messageSender->sendClientMessage(_peer, fbb, network::ClientMsgType::UserDisconnect, network::CreateUserDisconnect(fbb).Union());
 }
 
@@ -363,7 +367,8 @@ void Client::spawn(frontend::ClientEntityId id, const char *name, const glm::vec
 	_worldRenderer.addEntity(_player);
 	_worldRenderer.onSpawn(pos);
 
-	flatbuffers::FlatBufferBuilder fbb;
+	network::ScopedBuilder builder;
+	flatbuffers::FlatBufferBuilder& fbb = builder;
 	_messageSender->sendClientMessage(_peer, fbb, network::ClientMsgType::UserConnected,
 			network::CreateUserConnected(fbb).Union());
 }
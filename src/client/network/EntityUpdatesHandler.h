@@ -0,0 +1,38 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "IClientProtocolHandler.h"
+#include "network/EntityState.h"
+
+/**
+ * Applies the aggregated removes, spawns and state updates of all entities that are visible for
+ * the user. The quantized states are converted back into world coordinates relative to the origin
+ * of the message.
+ */
+CLIENTPROTOHANDLERIMPL(EntityUpdates) {
+	if (const auto* removes = message->removes()) {
+		for (const int64_t id : *removes) {
+			client->entityRemove(id);
+		}
+	}
+	if (const auto* spawns = message->spawns()) {
+		for (const network::EntitySpawn* spawn : *spawns) {
+			const network::Vec3 *pos = spawn->pos();
+			client->entitySpawn(spawn->id(), spawn->type(), spawn->rotation(), glm::vec3(pos->x(), pos->y(), pos->z()));
+		}
+	}
+	const auto* states = message->states();
+	if (states == nullptr) {
+		return;
+	}
+	const network::Vec3 *_origin = message->origin();
+	const glm::vec3 origin = _origin == nullptr ? glm::vec3(0.0f) : glm::vec3(_origin->x(), _origin->y(), _origin->z());
+	const float scale = message->scale();
+	for (const network::EntityState* state : *states) {
+		const glm::vec3& pos = network::entityStatePosition(*state, origin, scale);
+		client->entityUpdate(state->id(), pos, network::dequantizeRotation(state->rotation()));
+	}
+}
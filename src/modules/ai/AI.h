@@ -4,6 +4,7 @@
 #pragma once
 
 #include <unordered_map>
+#include <vector>
 #include <memory>
 
 #include "group/GroupId.h"
@@ -46,15 +47,32 @@ class AI : public NonCopyable, public std::enable_shared_from_this<AI> {
 	friend class Server;
 protected:
 	/**
-	 * This map is only filled if we are in debugging mode for this entity
+	 * @brief The state of one @ai{TreeNode} for this entity.
+	 *
+	 * The last status and the last execution time are only updated if we are in debugging mode for this entity.
+	 * Often @ai{Selector} states must be stored to continue in the next step at a particular
+	 * position in the behaviour tree. The limit state is the amount of executions for the @ai{Limit} node.
+	 */
+	struct NodeState {
+		TreeNodeStatus lastStatus = UNKNOWN;
+		int64_t lastExecMillis = -1L;
+		int selectorState = AI_NOTHING_SELECTED;
+		int limitState = 0;
+	};
+	/**
+	 * The node states - indexed by @ai{TreeNode::getIndex()}
 	 */
-	typedef std::unordered_map<int, TreeNodeStatus> NodeStates;
-	NodeStates _lastStatus;
+	std::vector<NodeState> _nodeStates;
 	/**
-	 * This map is only filled if we are in debugging mode for this entity
+	 * The states of the nodes that weren't indexed yet - the key is the node id
+	 * @sa @ai{TreeNode::assignIndices()}
 	 */
-	typedef std::unordered_map<int, uint64_t> LastExecMap;
-	LastExecMap _lastExecMillis;
+	typedef std::unordered_map<int, NodeState> UnindexedNodeStates;
+	UnindexedNodeStates _unindexedNodeStates;
+
+	NodeState& getNodeState(const TreeNode& node);
+	const NodeState* findNodeState(const TreeNode& node) const;
+	void resetNodeStates();
 
 	/**
 	 * @note The filtered entities are kept even over several ticks. The caller should decide
@@ -67,19 +85,6 @@ protected:
 
 	void addFilteredEntity(CharacterId id);
 
-	/**
-	 * Often @ai{Selector} states must be stored to continue in the next step at a particular
-	 * position in the behaviour tree. This map is doing exactly this.
-	 */
-	typedef std::unordered_map<int, int> SelectorStates;
-	SelectorStates _selectorStates;
-
-	/**
-	 * This map stores the amount of execution for the @ai{Limit} node. The key is the node id
-	 */
-	typedef std::unordered_map<int, int> LimitStates;
-	LimitStates _limitStates;
-
 	TreeNodePtr _behaviour;
 	AggroMgr _aggroMgr;
 
@@ -96,9 +101,13 @@ protected:
 public:
 	/**
 	 * @param behaviour The behaviour tree node that is applied to this ai entity
+	 * @note The tree is shared between the ai entities - the node indices must already be assigned
+	 * (see @ai{TreeNode::assignIndices()}), this is done by the tree loader once the tree is complete.
 	 */
 	explicit AI(const TreeNodePtr& behaviour) :
 			_behaviour(behaviour), _pause(false), _debuggingActive(false), _time(0L), _zone(nullptr), _reset(false) {
+		ai_assert(!_behaviour || _behaviour->getIndex() >= 0, "The node indices of the behaviour tree are not assigned");
+		resetNodeStates();
 	}
 	virtual ~AI() {
 	}
@@ -147,6 +156,7 @@ public:
 	TreeNodePtr getBehaviour() const;
 	/**
 	 * @brief Set a new behaviour
+	 * @note The node indices of the tree must already be assigned - see @ai{TreeNode::assignIndices()}
 	 * @return the old one if there was any
 	 */
 	TreeNodePtr setBehaviour(const TreeNodePtr& newBehaviour);
@@ -201,8 +211,45 @@ inline TreeNodePtr AI::getBehaviour() const {
 	return _behaviour;
 }
 
+inline AI::NodeState& AI::getNodeState(const TreeNode& node) {
+	const int index = node.getIndex();
+	if (index < 0) {
+		return _unindexedNodeStates[node.getId()];
+	}
+	if (index >= (int)_nodeStates.size()) {
+		// the tree was extended after the behaviour was set
+		_nodeStates.resize(index + 1);
+	}
+	return _nodeStates[index];
+}
+
+inline const AI::NodeState* AI::findNodeState(const TreeNode& node) const {
+	const int index = node.getIndex();
+	if (index < 0) {
+		UnindexedNodeStates::const_iterator i = _unindexedNodeStates.find(node.getId());
+		if (i == _unindexedNodeStates.end()) {
+			return nullptr;
+		}
+		return &i->second;
+	}
+	if (index >= (int)_nodeStates.size()) {
+		return nullptr;
+	}
+	return &_nodeStates[index];
+}
+
+inline void AI::resetNodeStates() {
+	_unindexedNodeStates.clear();
+	if (!_behaviour) {
+		_nodeStates.clear();
+		return;
+	}
+	_nodeStates.assign(_behaviour->getIndexCount(), NodeState());
+}
+
 inline TreeNodePtr AI::setBehaviour(const TreeNodePtr& newBehaviour) {
 	TreeNodePtr current = _behaviour;
+	ai_assert(!newBehaviour || newBehaviour->getIndex() >= 0, "The node indices of the behaviour tree are not assigned");
 	_behaviour = newBehaviour;
 	_reset = true;
 	return current;
@@ -284,10 +331,8 @@ inline void AI::update(int64_t dt, bool debuggingActive) {
 	if (_reset) {
 		// safe to do it like this, because update is not called from multiple threads
 		_reset = false;
-		_lastStatus.clear();
-		_lastExecMillis.clear();
+		resetNodeStates();
 		_filteredEntities.clear();
-		_selectorStates.clear();
 	}
 
 	_debuggingActive = debuggingActive;
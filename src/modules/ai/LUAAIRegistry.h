@@ -6,6 +6,7 @@
 
 #include "AIRegistry.h"
 #include "LUAFunctions.h"
+#include "LUAStatePool.h"
 #include "tree/LUATreeNode.h"
 #include "conditions/LUACondition.h"
 #include "filter/LUAFilter.h"
@@ -65,10 +66,26 @@ namespace ai {
  * @par AI metatable
  * There is a metatable that you can modify by calling @ai{LUAAIRegistry::pushAIMetatable()}.
  * This metatable is applied to all @ai{AI} pointers that are forwarded to the lua functions.
+ *
+ * @par Multiple lua states
+ * A lua state can only be used by one thread at a time. To run the lua nodes of a @ai{Zone} in parallel,
+ * the registry can maintain several identically initialized states - one per zone worker thread is a good
+ * choice. Every script that is given to evaluate() is executed in each of the states. The nodes, conditions,
+ * filters and steerings are only registered by the first state, the other states just attach their own
+ * lua functions to the same factories. Each call picks any free state.
+ *
+ * This means that lua globals are per state: a script must not keep any state in lua globals or upvalues
+ * that has to be the same for all calls or for all entities - every call might run in a different state.
+ * Put such data into the @ai{AI} or the @ai{ICharacter} (e.g. via @c setAttribute) instead. Calls into lua
+ * must not trigger other lua nodes, conditions, filters or steerings, as the state is locked for the
+ * duration of the call.
  */
 class LUAAIRegistry : public AIRegistry {
 protected:
+	// the first lua state - the lua nodes are registered while the scripts are evaluated in this state
 	lua_State* _s = nullptr;
+	LUAStatePool _states;
+	const int _stateCount;
 
 	using LuaNodeFactory = LUATreeNode::LUATreeNodeFactory;
 	typedef std::shared_ptr<LuaNodeFactory> LUATreeNodeFactoryPtr;
@@ -92,6 +109,19 @@ protected:
 	FilterFactoryMap _filterFactories;
 	SteeringFactoryMap _steeringFactories;
 
+	/**
+	 * @brief Returns the factory that was already registered while evaluating the scripts in the first state
+	 */
+	template<class FactoryMap>
+	typename FactoryMap::mapped_type getFactory(const FactoryMap& factories, const std::string& type) const {
+		ScopedReadLock scopedLock(_lock);
+		auto i = factories.find(type);
+		if (i == factories.end()) {
+			return typename FactoryMap::mapped_type();
+		}
+		return i->second;
+	}
+
 	/***
 	 * Gives you access the the light userdata for the LUAAIRegistry.
 	 * @return the registry userdata
@@ -164,10 +194,18 @@ protected:
 	static int luaAI_createnode(lua_State* s) {
 		LUAAIRegistry* r = luaAI_toregistry(s);
 		const std::string type = luaL_checkstring(s, -1);
-		const LUATreeNodeFactoryPtr& factory = std::make_shared<LuaNodeFactory>(s, type);
-		const bool inserted = r->registerNodeFactory(type, *factory);
-		if (!inserted) {
-			return luaL_error(s, "tree node %s is already registered", type.c_str());
+		LUATreeNodeFactoryPtr factory;
+		if (s == r->_s) {
+			factory = std::make_shared<LuaNodeFactory>(&r->_states, type);
+			const bool inserted = r->registerNodeFactory(type, *factory);
+			if (!inserted) {
+				return luaL_error(s, "tree node %s is already registered", type.c_str());
+			}
+		} else {
+			factory = r->getFactory(r->_treeNodeFactories, type);
+			if (!factory) {
+				return luaL_error(s, "tree node %s is not registered in the first lua state", type.c_str());
+			}
 		}
 
 		luaAI_newuserdata<LuaNodeFactory*>(s, factory.get());
@@ -206,10 +244,18 @@ protected:
 	static int luaAI_createcondition(lua_State* s) {
 		LUAAIRegistry* r = luaAI_toregistry(s);
 		const std::string type = luaL_checkstring(s, -1);
-		const LUAConditionFactoryPtr& factory = std::make_shared<LuaConditionFactory>(s, type);
-		const bool inserted = r->registerConditionFactory(type, *factory);
-		if (!inserted) {
-			return luaL_error(s, "condition %s is already registered", type.c_str());
+		LUAConditionFactoryPtr factory;
+		if (s == r->_s) {
+			factory = std::make_shared<LuaConditionFactory>(&r->_states, type);
+			const bool inserted = r->registerConditionFactory(type, *factory);
+			if (!inserted) {
+				return luaL_error(s, "condition %s is already registered", type.c_str());
+			}
+		} else {
+			factory = r->getFactory(r->_conditionFactories, type);
+			if (!factory) {
+				return luaL_error(s, "condition %s is not registered in the first lua state", type.c_str());
+			}
 		}
 
 		luaAI_newuserdata<LuaConditionFactory*>(s, factory.get());
@@ -244,10 +290,18 @@ protected:
 	static int luaAI_createfilter(lua_State* s) {
 		LUAAIRegistry* r = luaAI_toregistry(s);
 		const std::string type = luaL_checkstring(s, -1);
-		const LUAFilterFactoryPtr& factory = std::make_shared<LuaFilterFactory>(s, type);
-		const bool inserted = r->registerFilterFactory(type, *factory);
-		if (!inserted) {
-			return luaL_error(s, "filter %s is already registered", type.c_str());
+		LUAFilterFactoryPtr factory;
+		if (s == r->_s) {
+			factory = std::make_shared<LuaFilterFactory>(&r->_states, type);
+			const bool inserted = r->registerFilterFactory(type, *factory);
+			if (!inserted) {
+				return luaL_error(s, "filter %s is already registered", type.c_str());
+			}
+		} else {
+			factory = r->getFactory(r->_filterFactories, type);
+			if (!factory) {
+				return luaL_error(s, "filter %s is not registered in the first lua state", type.c_str());
+			}
 		}
 
 		luaAI_newuserdata<LuaFilterFactory*>(s, factory.get());
@@ -278,10 +332,18 @@ protected:
 	static int luaAI_createsteering(lua_State* s) {
 		LUAAIRegistry* r = luaAI_toregistry(s);
 		const std::string type = luaL_checkstring(s, -1);
-		const LUASteeringFactoryPtr& factory = std::make_shared<LuaSteeringFactory>(s, type);
-		const bool inserted = r->registerSteeringFactory(type, *factory);
-		if (!inserted) {
-			return luaL_error(s, "steering %s is already registered", type.c_str());
+		LUASteeringFactoryPtr factory;
+		if (s == r->_s) {
+			factory = std::make_shared<LuaSteeringFactory>(&r->_states, type);
+			const bool inserted = r->registerSteeringFactory(type, *factory);
+			if (!inserted) {
+				return luaL_error(s, "steering %s is already registered", type.c_str());
+			}
+		} else {
+			factory = r->getFactory(r->_steeringFactories, type);
+			if (!factory) {
+				return luaL_error(s, "steering %s is not registered in the first lua state", type.c_str());
+			}
 		}
 
 		luaAI_newuserdata<LuaSteeringFactory*>(s, factory.get());
@@ -299,7 +361,12 @@ protected:
 	}
 
 public:
-	LUAAIRegistry() {
+	/**
+	 * @param[in] states The amount of lua states - use the amount of threads that tick your @ai{Zone}s
+	 * to run the lua nodes in parallel.
+	 */
+	explicit LUAAIRegistry(int states = 1) :
+			_stateCount(std::max(1, states)) {
 		init();
 	}
 
@@ -411,11 +478,22 @@ public:
 	}
 
 	/**
-	 * @brief Access to the lua state.
+	 * @brief Access to the lua state with the given index.
+	 * @note The state is not locked - only modify it before the lua nodes are executed
 	 * @see pushAIMetatable()
 	 */
-	lua_State* getLuaState() {
-		return _s;
+	lua_State* getLuaState(int index = 0) {
+		if (_states.empty()) {
+			return nullptr;
+		}
+		return _states.get(index);
+	}
+
+	/**
+	 * @return The amount of lua states
+	 */
+	int getLuaStateCount() const {
+		return (int)_states.size();
 	}
 
 	/**
@@ -424,57 +502,73 @@ public:
 	 * lua functions.
 	 * @note lua_ctxai() can be used in your lua c callbacks to get access to the
 	 * @ai{AI} pointer: @code const AI* ai = lua_ctxai(s, 1); @endcode
+	 * @note If there are several lua states, this must be done for each of them.
 	 */
-	int pushAIMetatable() {
-		ai_assert(_s != nullptr, "LUA state is not yet initialized");
-		return luaL_getmetatable(_s, luaAI_metaai());
+	int pushAIMetatable(int index = 0) {
+		ai_assert(!_states.empty(), "LUA state is not yet initialized");
+		return luaL_getmetatable(_states.get(index), luaAI_metaai());
 	}
 
 	/**
 	 * @brief Pushes the character metatable onto the stack. This allows anyone to modify it
 	 * to provide own functions and data that is applied to the @c ai:character() value
+	 * @note If there are several lua states, this must be done for each of them.
 	 */
-	int pushCharacterMetatable() {
-		ai_assert(_s != nullptr, "LUA state is not yet initialized");
-		return luaL_getmetatable(_s, luaAI_metacharacter());
+	int pushCharacterMetatable(int index = 0) {
+		ai_assert(!_states.empty(), "LUA state is not yet initialized");
+		return luaL_getmetatable(_states.get(index), luaAI_metacharacter());
 	}
 
 	/**
 	 * @see shutdown()
 	 */
 	bool init() {
-		if (_s != nullptr) {
+		if (!_states.empty()) {
 			return true;
 		}
-		_s = luaL_newstate();
+		std::vector<lua_State*> states;
+		states.reserve(_stateCount);
+		for (int i = 0; i < _stateCount; ++i) {
+			states.push_back(luaL_newstate());
+		}
+		_states.init(states);
+		_s = states.front();
+		for (lua_State* s : states) {
+			if (!initState(s)) {
+				return false;
+			}
+		}
+		return true;
+	}
 
-		lua_atpanic(_s, [] (lua_State* L) {
+	bool initState(lua_State* s) {
+		lua_atpanic(s, [] (lua_State* L) {
 			ai_log_error("Lua panic. Error message: %s", (lua_isnil(L, -1) ? "" : lua_tostring(L, -1)));
 			return 0;
 		});
-		lua_gc(_s, LUA_GCSTOP, 0);
-		luaL_openlibs(_s);
+		lua_gc(s, LUA_GCSTOP, 0);
+		luaL_openlibs(s);
 
-		luaAI_registerfuncs(_s, &registryFuncs.front(), "META_REGISTRY");
-		lua_setglobal(_s, "REGISTRY");
+		luaAI_registerfuncs(s, &registryFuncs.front(), "META_REGISTRY");
+		lua_setglobal(s, "REGISTRY");
 
 		// TODO: random
 
-		luaAI_globalpointer(_s, this, luaAI_metaregistry());
+		luaAI_globalpointer(s, this, luaAI_metaregistry());
 
-		luaAI_registerfuncs(_s, &aiFuncs.front(), luaAI_metaai());
-		luaAI_registerfuncs(_s, &vecFuncs.front(), luaAI_metavec());
-		luaAI_registerfuncs(_s, &zoneFuncs.front(), luaAI_metazone());
-		luaAI_registerfuncs(_s, &characterFuncs.front(), luaAI_metacharacter());
-		luaAI_registerfuncs(_s, &aggroMgrFuncs.front(), luaAI_metaaggromgr());
-		luaAI_registerfuncs(_s, &groupMgrFuncs.front(), luaAI_metagroupmgr());
+		luaAI_registerfuncs(s, &aiFuncs.front(), luaAI_metaai());
+		luaAI_registerfuncs(s, &vecFuncs.front(), luaAI_metavec());
+		luaAI_registerfuncs(s, &zoneFuncs.front(), luaAI_metazone());
+		luaAI_registerfuncs(s, &characterFuncs.front(), luaAI_metacharacter());
+		luaAI_registerfuncs(s, &aggroMgrFuncs.front(), luaAI_metaaggromgr());
+		luaAI_registerfuncs(s, &groupMgrFuncs.front(), luaAI_metagroupmgr());
 
 		const char* script = ""
 			"UNKNOWN, CANNOTEXECUTE, RUNNING, FINISHED, FAILED, EXCEPTION = 0, 1, 2, 3, 4, 5\n";
 
-		if (luaL_loadbufferx(_s, script, strlen(script), "", nullptr) || lua_pcall(_s, 0, 0, 0)) {
-			ai_log_error("%s", lua_tostring(_s, -1));
-			lua_pop(_s, 1);
+		if (luaL_loadbufferx(s, script, strlen(script), "", nullptr) || lua_pcall(s, 0, 0, 0)) {
+			ai_log_error("%s", lua_tostring(s, -1));
+			lua_pop(s, 1);
 			return false;
 		}
 		return true;
@@ -491,10 +585,8 @@ public:
 			_filterFactories.clear();
 			_steeringFactories.clear();
 		}
-		if (_s != nullptr) {
-			lua_close(_s);
-			_s = nullptr;
-		}
+		_states.shutdown();
+		_s = nullptr;
 	}
 
 	~LUAAIRegistry() {
@@ -506,20 +598,25 @@ public:
 	}
 
 	/**
-	 * @brief Load your lua scripts into the lua state of the registry.
+	 * @brief Load your lua scripts into the lua states of the registry.
 	 * This can be called multiple times to e.g. load multiple files.
 	 * @return @c true if the lua script was loaded, @c false otherwise
 	 * @note you have to call init() before
+	 * @note The script is executed once in each lua state
 	 */
 	bool evaluate(const char* luaBuffer, size_t size) {
-		if (_s == nullptr) {
+		if (_states.empty()) {
 			ai_log_debug("LUA state is not yet initialized");
 			return false;
 		}
-		if (luaL_loadbufferx(_s, luaBuffer, size, "", nullptr) || lua_pcall(_s, 0, 0, 0)) {
-			ai_log_error("%s", lua_tostring(_s, -1));
-			lua_pop(_s, 1);
-			return false;
+		for (size_t i = 0; i < _states.size(); ++i) {
+			const LUAStatePool::ScopedState scopedState(_states, i);
+			lua_State* s = scopedState.state();
+			if (luaL_loadbufferx(s, luaBuffer, size, "", nullptr) || lua_pcall(s, 0, 0, 0)) {
+				ai_log_error("%s", lua_tostring(s, -1));
+				lua_pop(s, 1);
+				return false;
+			}
 		}
 		return true;
 	}
@@ -0,0 +1,147 @@
+/***
+ * @file LUAStatePool.h
+ * @ingroup LUA
+ */
+#pragma once
+
+#include "commonlua/LUA.h"
+#include "common/Types.h"
+#include "common/NonCopyable.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace ai {
+
+/**
+ * @brief A set of identically initialized lua states. A lua state can only be used by one thread
+ * at a time - so every call into lua must acquire a state via @c LUAStatePool::ScopedState.
+ *
+ * Each thread starts looking for a free state at a different position. With as many states as there
+ * are threads that tick the @ai{Zone}, the threads usually don't wait for each other.
+ *
+ * @see @ai{LUAAIRegistry}
+ */
+class LUAStatePool : public NonCopyable {
+private:
+	std::vector<lua_State*> _states;
+	std::unique_ptr<std::atomic<bool>[]> _used;
+
+	inline bool tryAcquire(size_t index) const {
+		bool expected = false;
+		return _used[index].compare_exchange_strong(expected, true, std::memory_order_acquire);
+	}
+
+	inline void release(size_t index) const {
+		_used[index].store(false, std::memory_order_release);
+	}
+
+	size_t acquire() const;
+	void acquire(size_t index) const;
+
+public:
+	/**
+	 * @brief Locks one of the lua states for the lifetime of this object
+	 */
+	class ScopedState : public NonCopyable {
+	private:
+		const LUAStatePool& _pool;
+		const size_t _index;
+	public:
+		/**
+		 * @brief Locks any free state - this is what the lua nodes use
+		 */
+		explicit ScopedState(const LUAStatePool& pool) :
+				_pool(pool), _index(pool.acquire()) {
+		}
+
+		/**
+		 * @brief Locks the state with the given index - e.g. to load a script into each of the states
+		 */
+		ScopedState(const LUAStatePool& pool, size_t index) :
+				_pool(pool), _index(index) {
+			pool.acquire(index);
+		}
+
+		~ScopedState() {
+			_pool.release(_index);
+		}
+
+		inline lua_State* state() const {
+			return _pool._states[_index];
+		}
+
+		inline size_t index() const {
+			return _index;
+		}
+	};
+
+	~LUAStatePool() {
+		ai_assert(_states.empty(), "LUA states were not closed");
+	}
+
+	/**
+	 * @brief Adds the given states to the pool. The pool takes the ownership.
+	 * @note Must not be called while any of the states are in use
+	 */
+	void init(const std::vector<lua_State*>& states) {
+		_states = states;
+		_used.reset(new std::atomic<bool>[states.size()]);
+		for (size_t i = 0; i < states.size(); ++i) {
+			_used[i] = false;
+		}
+	}
+
+	/**
+	 * @brief Closes all lua states
+	 * @note Must not be called while any of the states are in use
+	 */
+	void shutdown() {
+		for (lua_State* s : _states) {
+			lua_close(s);
+		}
+		_states.clear();
+		_used.reset();
+	}
+
+	inline size_t size() const {
+		return _states.size();
+	}
+
+	inline bool empty() const {
+		return _states.empty();
+	}
+
+	/**
+	 * @return The lua state with the given index - without locking it.
+	 */
+	inline lua_State* get(size_t index) const {
+		return _states[index];
+	}
+};
+
+inline size_t LUAStatePool::acquire() const {
+	ai_assert(!_states.empty(), "LUA states are not yet initialized");
+	const size_t n = _states.size();
+	const size_t start = std::hash<std::thread::id>()(std::this_thread::get_id()) % n;
+	for (;;) {
+		for (size_t i = 0; i < n; ++i) {
+			const size_t index = (start + i) % n;
+			if (tryAcquire(index)) {
+				return index;
+			}
+		}
+		std::this_thread::yield();
+	}
+}
+
+inline void LUAStatePool::acquire(size_t index) const {
+	ai_assert(index < _states.size(), "Invalid LUA state index given");
+	while (!tryAcquire(index)) {
+		std::this_thread::yield();
+	}
+}
+
+}
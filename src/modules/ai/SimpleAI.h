@@ -69,7 +69,7 @@
  *   * @ai{SelectGroupLeader}
  *   * @ai{SelectGroupMembers} - select all the group members of a specified group
  *   * @ai{SelectHighestAggro} - put the highest @ref Aggro @ai{CharacterId} into the selection
- *   * @ai{SelectZone} - select all known entities in the zone
+ *   * @ai{SelectZone} - select all known entities in the zone - or only those in the given radius
  *   * @ai{Union} - merges several other filter results
  * * Steering
  *   * @movement{GroupFlee}
@@ -298,6 +298,9 @@
 #include "server/AIAddNodeMessage.h"
 #include "server/AIDeleteNodeMessage.h"
 #include "server/AIUpdateNodeMessage.h"
+#include "server/AIStreamModeMessage.h"
+#include "server/AIStateDeltaMessage.h"
+#include "server/AIStateBaseline.h"
 
 #include "zone/Zone.h"
 
@@ -0,0 +1,89 @@
+/**
+ * @file
+ */
+
+#include "ai/tests/TestShared.h"
+#include "core/tests/Benchmark.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+// counts the heap allocations of this benchmark binary
+std::atomic<uint64_t> allocations(0);
+}
+
+void* operator new(std::size_t size) {
+	++allocations;
+	if (void* p = std::malloc(size)) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+class AIBenchmark: public TestSuite {
+protected:
+	ai::TreeNodePtr leaf() const {
+		return std::make_shared<ai::TreeNode>("leaf", "", ai::True::get());
+	}
+
+	ai::TreeNodePtr createTree() const {
+		const ai::ConditionPtr& t = ai::True::get();
+		ai::TreeNodePtr root = std::make_shared<ai::PrioritySelector>("root", "", t);
+		ai::TreeNodePtr fallback = std::make_shared<ai::PrioritySelector>("fallback", "", t);
+		for (int i = 0; i < 4; ++i) {
+			ai::TreeNodePtr limit = std::make_shared<ai::Limit>("limit", "1000000", t);
+			ai::TreeNodePtr sequence = std::make_shared<ai::Sequence>("sequence", "", t);
+			for (int j = 0; j < 4; ++j) {
+				sequence->addChild(leaf());
+			}
+			ai::TreeNodePtr parallel = std::make_shared<ai::Parallel>("parallel", "", t);
+			ai::TreeNodePtr succeed = std::make_shared<ai::Succeed>("succeed", "", t);
+			succeed->addChild(leaf());
+			parallel->addChild(succeed);
+			ai::TreeNodePtr fail = std::make_shared<ai::Fail>("fail", "", t);
+			fail->addChild(leaf());
+			parallel->addChild(fail);
+			sequence->addChild(parallel);
+			limit->addChild(sequence);
+			fallback->addChild(limit);
+		}
+		root->addChild(fallback);
+		root->addChild(leaf());
+		root->assignIndices();
+		return root;
+	}
+};
+
+TEST_F(AIBenchmark, benchmarkTick) {
+	const ai::TreeNodePtr& root = createTree();
+	std::vector<ai::AIPtr> ais;
+	const int n = 1000;
+	for (int i = 0; i < n; ++i) {
+		ai::AIPtr ai = std::make_shared<ai::AI>(root);
+		ai->setCharacter(std::make_shared<TestEntity>(i));
+		ais.push_back(ai);
+	}
+	auto tick = [&] () {
+		for (const ai::AIPtr& ai : ais) {
+			// debugging is active to also record the node states for the debug server
+			ai->update(1, true);
+			ai->getBehaviour()->execute(ai, 1);
+		}
+	};
+	const uint64_t before = allocations;
+	tick();
+	const int firstTickAllocations = (int)(allocations - before);
+	std::printf("[ BENCHMARK] aiTick1000 allocations in the first tick: %i\n", firstTickAllocations);
+	::testing::Test::RecordProperty("aiTick1000FirstTickAllocations", firstTickAllocations);
+	core::measure("aiTick1000", 100, tick);
+	EXPECT_NE(ai::UNKNOWN, root->getLastStatus(ais.front()));
+}
@@ -0,0 +1,75 @@
+/**
+ * @file
+ */
+
+#include "ai/tests/TestShared.h"
+#include "core/tests/Benchmark.h"
+#include <string>
+#include <cmath>
+
+class ZoneBenchmark: public TestSuite {
+protected:
+	void tick(int n) {
+		ai::Zone zone("benchmark");
+		ai::TreeNodePtr root = std::make_shared<ai::PrioritySelector>("test", "", ai::True::get());
+		root->assignIndices();
+		for (int i = 0; i < n; ++i) {
+			ai::ICharacterPtr character = std::make_shared<TestEntity>(i);
+			ai::AIPtr ai = std::make_shared<ai::AI>(root);
+			ai->setCharacter(character);
+			ASSERT_TRUE(zone.addAI(ai));
+		}
+		zone.update(0l);
+		ASSERT_EQ(n, (int)zone.size());
+		const std::string name = "zoneUpdate" + std::to_string(n);
+		core::measure(name.c_str(), 10, [&] () {
+			zone.update(1l);
+		});
+	}
+
+	/**
+	 * Every entity of a crowd looks for its neighbours - this is O(n^2) without the spatial index
+	 */
+	void neighbours(int n, float cellSize) {
+		ai::Zone zone("benchmark");
+		zone.setSpatialIndex(cellSize);
+		ai::TreeNodePtr root = std::make_shared<ai::PrioritySelector>("test", "", ai::True::get());
+		root->assignIndices();
+		const int side = (int)std::sqrt((float)n);
+		for (int i = 0; i < n; ++i) {
+			ai::ICharacterPtr character = std::make_shared<TestEntity>(i);
+			character->setPosition(glm::vec3((float)(i % side) * 2.0f, 0.0f, (float)(i / side) * 2.0f));
+			ai::AIPtr ai = std::make_shared<ai::AI>(root);
+			ai->setCharacter(character);
+			ASSERT_TRUE(zone.addAI(ai));
+		}
+		zone.update(0l);
+		const std::string name = "zoneNeighbours" + std::to_string(n) + (cellSize > 0.0f ? "Grid" : "");
+		core::measure(name.c_str(), 3, [&] () {
+			zone.executeParallel([&] (const ai::AIPtr& ai) {
+				ai::Zone::CharacterIdList ids;
+				zone.getAIsInRadius(ai->getCharacter()->getPosition(), 8.0f, ids);
+			});
+		});
+	}
+};
+
+TEST_F(ZoneBenchmark, benchmarkUpdate10000) {
+	tick(10000);
+}
+
+TEST_F(ZoneBenchmark, benchmarkUpdate50000) {
+	tick(50000);
+}
+
+TEST_F(ZoneBenchmark, benchmarkUpdate100000) {
+	tick(100000);
+}
+
+TEST_F(ZoneBenchmark, benchmarkNeighbours10000) {
+	neighbours(10000, 0.0f);
+}
+
+TEST_F(ZoneBenchmark, benchmarkNeighbours10000Grid) {
+	neighbours(10000, 8.0f);
+}
@@ -0,0 +1,60 @@
+/**
+ * @file
+ */
+#pragma once
+
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <vector>
+
+namespace ai {
+
+/**
+ * @brief Calls @c func(begin, end) for batches of the range [0, n) on the workers of the given
+ * pool and the calling thread.
+ *
+ * The range is split into a few batches per worker. The workers take the next free batch as soon
+ * as they are done with their current one - so a batch with expensive elements doesn't stall the others.
+ * Because the calling thread takes part in the work, this also finishes if all pool workers are busy.
+ *
+ * @note Blocks until all batches are executed.
+ */
+template<class Func>
+void parallelFor(ThreadPool& pool, size_t n, const Func& func, size_t minBatchSize = 64u) {
+	if (n == 0u) {
+		return;
+	}
+	const size_t workers = pool.size() + 1u;
+	const size_t batchSize = std::max(minBatchSize, n / (workers * 4u));
+	const size_t batches = (n + batchSize - 1u) / batchSize;
+	if (batches <= 1u) {
+		func(0u, n);
+		return;
+	}
+
+	std::atomic<size_t> nextBatch(0u);
+	auto worker = [&] () {
+		for (;;) {
+			const size_t batch = nextBatch.fetch_add(1u);
+			if (batch >= batches) {
+				return;
+			}
+			const size_t begin = batch * batchSize;
+			func(begin, std::min(n, begin + batchSize));
+		}
+	};
+	const size_t tasks = std::min(workers, batches) - 1u;
+	std::vector<std::future<void> > results;
+	results.reserve(tasks);
+	for (size_t i = 0u; i < tasks; ++i) {
+		results.emplace_back(pool.enqueue(worker));
+	}
+	worker();
+	for (auto& result : results) {
+		result.wait();
+	}
+}
+
+}
@@ -0,0 +1,185 @@
+/**
+ * @file
+ */
+#pragma once
+
+#include "Math.h"
+#include "Types.h"
+#include <unordered_map>
+#include <vector>
+#include <cmath>
+#include <stdint.h>
+
+namespace ai {
+
+/**
+ * @brief Uniform grid on the x/z plane that buckets @ai{CharacterId}s by their position.
+ *
+ * The positions are stored in the cells, too - so radius queries don't have to touch the
+ * @ai{AI} or @ai{ICharacter} instances. Moving an entry only modifies the cells if it left
+ * its current cell.
+ *
+ * @note This class is not thread safe
+ */
+class SpatialGrid {
+public:
+	struct Entry {
+		CharacterId id;
+		glm::vec3 position;
+	};
+	typedef std::vector<Entry> Cell;
+
+private:
+	typedef uint64_t CellKey;
+	struct Slot {
+		CellKey cell;
+		size_t index;
+	};
+	float _cellSize;
+	std::unordered_map<CellKey, Cell> _cells;
+	// character id => location in the cells
+	std::unordered_map<CharacterId, Slot> _slots;
+
+	inline int32_t cellCoord(float v) const {
+		return (int32_t)std::floor(v / _cellSize);
+	}
+
+	static inline CellKey key(int32_t x, int32_t z) {
+		return ((CellKey)(uint32_t)x << 32) | (CellKey)(uint32_t)z;
+	}
+
+	inline CellKey key(const glm::vec3& position) const {
+		return key(cellCoord(position.x), cellCoord(position.z));
+	}
+
+	void removeFromCell(const Slot& slot);
+	void addToCell(CellKey cellKey, CharacterId id, const glm::vec3& position);
+
+public:
+	/**
+	 * @param cellSize The edge length of a cell. Radius queries should be in the range of a few cells.
+	 */
+	explicit SpatialGrid(float cellSize) :
+			_cellSize(cellSize) {
+		ai_assert(cellSize > 0.0f, "Invalid cell size given");
+	}
+
+	/**
+	 * @brief Adds the given character id or moves it to the given position if it's already known
+	 */
+	void update(CharacterId id, const glm::vec3& position);
+	bool remove(CharacterId id);
+	void clear();
+
+	inline size_t size() const {
+		return _slots.size();
+	}
+
+	inline float cellSize() const {
+		return _cellSize;
+	}
+
+	/**
+	 * @brief Calls @c func(const Entry&) for every entry that is within the given radius on the x/z plane
+	 * @return The amount of entries that were visited
+	 */
+	template<typename Func>
+	size_t visit(const glm::vec3& center, float radius, Func&& func) const {
+		if (_slots.empty() || radius < 0.0f) {
+			return 0u;
+		}
+		const float radiusSquared = radius * radius;
+		size_t visited = 0u;
+		// huge radius - walking the cells is cheaper than probing every cell coordinate
+		const float cellsPerAxis = 2.0f * radius / _cellSize + 2.0f;
+		if (cellsPerAxis * cellsPerAxis > (float)_cells.size()) {
+			for (const auto& e : _cells) {
+				for (const Entry& entry : e.second) {
+					const float dx = entry.position.x - center.x;
+					const float dz = entry.position.z - center.z;
+					if (dx * dx + dz * dz <= radiusSquared) {
+						func(entry);
+						++visited;
+					}
+				}
+			}
+			return visited;
+		}
+		const int32_t minX = cellCoord(center.x - radius);
+		const int32_t maxX = cellCoord(center.x + radius);
+		const int32_t minZ = cellCoord(center.z - radius);
+		const int32_t maxZ = cellCoord(center.z + radius);
+		for (int32_t x = minX; x <= maxX; ++x) {
+			for (int32_t z = minZ; z <= maxZ; ++z) {
+				auto i = _cells.find(key(x, z));
+				if (i == _cells.end()) {
+					continue;
+				}
+				for (const Entry& entry : i->second) {
+					const float dx = entry.position.x - center.x;
+					const float dz = entry.position.z - center.z;
+					if (dx * dx + dz * dz <= radiusSquared) {
+						func(entry);
+						++visited;
+					}
+				}
+			}
+		}
+		return visited;
+	}
+};
+
+inline void SpatialGrid::removeFromCell(const Slot& slot) {
+	auto i = _cells.find(slot.cell);
+	ai_assert(i != _cells.end(), "Cell for slot not found");
+	Cell& cell = i->second;
+	const size_t last = cell.size() - 1;
+	if (slot.index != last) {
+		cell[slot.index] = cell[last];
+		_slots[cell[slot.index].id].index = slot.index;
+	}
+	cell.pop_back();
+	if (cell.empty()) {
+		_cells.erase(i);
+	}
+}
+
+inline void SpatialGrid::addToCell(CellKey cellKey, CharacterId id, const glm::vec3& position) {
+	Cell& cell = _cells[cellKey];
+	_slots[id] = Slot{cellKey, cell.size()};
+	cell.push_back(Entry{id, position});
+}
+
+inline void SpatialGrid::update(CharacterId id, const glm::vec3& position) {
+	const CellKey cellKey = key(position);
+	auto i = _slots.find(id);
+	if (i == _slots.end()) {
+		addToCell(cellKey, id, position);
+		return;
+	}
+	const Slot slot = i->second;
+	if (slot.cell == cellKey) {
+		_cells[cellKey][slot.index].position = position;
+		return;
+	}
+	removeFromCell(slot);
+	addToCell(cellKey, id, position);
+}
+
+inline bool SpatialGrid::remove(CharacterId id) {
+	auto i = _slots.find(id);
+	if (i == _slots.end()) {
+		return false;
+	}
+	const Slot slot = i->second;
+	_slots.erase(i);
+	removeFromCell(slot);
+	return true;
+}
+
+inline void SpatialGrid::clear() {
+	_cells.clear();
+	_slots.clear();
+}
+
+}
@@ -45,6 +45,13 @@ public:
 	template<class F, class ... Args>
 	auto enqueue(F&& f, Args&&... args) -> std::future<typename std::result_of<F(Args...)>::type>;
 
+	/**
+	 * @return The amount of worker threads
+	 */
+	size_t size() const {
+		return _workers.size();
+	}
+
 	~ThreadPool();
 private:
 	// need to keep track of threads so we can join them
@@ -11,17 +11,32 @@ namespace ai {
 
 /**
  * @brief This filter will pick the entities from the zone of the given entity
+ *
+ * If a radius is given as parameter, only the entities within this radius around the given
+ * entity are picked. This uses the spatial index of the zone if it is enabled.
+ * @see Zone::setSpatialIndex()
  */
 class SelectZone: public IFilter {
+protected:
+	float _radius;
 public:
 	FILTER_FACTORY(SelectZone)
 
 	explicit SelectZone(const std::string& parameters = "") :
 		IFilter("SelectZone", parameters) {
+		if (_parameters.empty()) {
+			_radius = -1.0f;
+		} else {
+			_radius = std::stof(_parameters);
+		}
 	}
 
 	void filter (const AIPtr& entity) override {
 		FilteredEntities& entities = getFilteredEntities(entity);
+		if (_radius >= 0.0f) {
+			entity->getZone()->getAIsInRadius(entity->getCharacter()->getPosition(), _radius, entities);
+			return;
+		}
 		auto func = [&] (const AIPtr& ai) {
 			entities.push_back(ai->getId());
 			return true;
@@ -22,7 +22,7 @@ public:
 	virtual MoveVector execute (const AIPtr& ai, float speed) const override {
 		const glm::vec3& target = getSelectionTarget(ai, 0);
 		if (isInfinite(target)) {
-			const MoveVector d(target, 0.0);
+			return MoveVector(target, 0.0f);
 		}
 		const glm::vec3& v = glm::normalize(ai->getCharacter()->getPosition() - target);
 		const float orientation = angle(v);
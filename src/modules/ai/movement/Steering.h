@@ -58,6 +58,9 @@ public:
 
 /**
  * @brief @c IFilter steering interface
+ *
+ * The target is one entity of the filtered selection - a lookup by id. Proximity belongs into the filter
+ * that builds the selection (e.g. @c SelectZone with a radius uses the spatial grid of the @c Zone).
  */
 class SelectionSteering : public ISteering {
 protected:
@@ -67,8 +70,15 @@ protected:
 			return VEC3_INFINITE;
 		}
 		const Zone* zone = entity->getZone();
+		if (zone == nullptr) {
+			return VEC3_INFINITE;
+		}
 		const CharacterId characterId = selection[index];
 		const AIPtr& ai = zone->getAI(characterId);
+		// the selected entity might have left the zone since the filter was executed
+		if (!ai) {
+			return VEC3_INFINITE;
+		}
 		const ICharacterPtr character = ai->getCharacter();
 		return character->getPosition();
 	}
@@ -0,0 +1,134 @@
+/**
+ * @file
+ */
+#pragma once
+
+#include "AIStateDeltaMessage.h"
+#include "AIStreamModeMessage.h"
+#include <unordered_map>
+#include <vector>
+
+namespace ai {
+
+/**
+ * @brief The world state a particular client already received
+ *
+ * The server keeps one baseline per client that enabled the delta streaming and fills the
+ * @ai{AIStateDeltaMessage}s by comparing the current world state against it.
+ */
+class AIStateBaseline {
+private:
+	struct Entry {
+		AIStateWorld state;
+		// the update the character was seen in the last time
+		uint32_t generation;
+	};
+	std::unordered_map<CharacterId, Entry> _entries;
+	uint32_t _generation = 0u;
+
+	void diff(const AIStateWorld& state, Entry& entry, AIStateDeltaMessage& msg) const;
+
+public:
+	/**
+	 * @brief Fills the given message with the changes since the last update and makes the given
+	 * states the new baseline.
+	 *
+	 * @param[in] states The current state of all characters
+	 * @param[in] mode Characters outside of the view rectangle are treated as removed
+	 * @param[out] msg The message to fill
+	 * @return @c false if nothing changed and thus nothing has to be sent
+	 */
+	bool update(const std::vector<AIStateWorld>& states, const AIStreamMode& mode, AIStateDeltaMessage& msg);
+
+	/**
+	 * @brief Forget everything that was sent - the next update will contain all characters again
+	 */
+	inline void clear() {
+		_entries.clear();
+	}
+
+	inline size_t size() const {
+		return _entries.size();
+	}
+};
+
+inline void AIStateBaseline::diff(const AIStateWorld& state, Entry& entry, AIStateDeltaMessage& msg) const {
+	AIStateWorld& known = entry.state;
+	uint8_t flags = 0u;
+	if (known.getPosition() != state.getPosition()) {
+		flags |= AIStateDelta::DELTA_POSITION;
+	}
+	if (known.getOrientation() != state.getOrientation()) {
+		flags |= AIStateDelta::DELTA_ORIENTATION;
+	}
+	const CharacterAttributes& attributes = state.getAttributes();
+	const CharacterAttributes& knownAttributes = known.getAttributes();
+	bool attributesChanged = attributes.size() != knownAttributes.size();
+	if (!attributesChanged) {
+		for (const auto& e : attributes) {
+			auto i = knownAttributes.find(e.first);
+			if (i == knownAttributes.end() || i->second != e.second) {
+				attributesChanged = true;
+				break;
+			}
+		}
+	}
+	if (attributesChanged) {
+		flags |= AIStateDelta::DELTA_ATTRIBUTES;
+	}
+	if (flags == 0u) {
+		return;
+	}
+
+	AIStateDelta& delta = msg.addDelta(state.getId(), flags);
+	delta.position = state.getPosition();
+	delta.orientation = state.getOrientation();
+	if (attributesChanged) {
+		for (const auto& e : attributes) {
+			auto i = knownAttributes.find(e.first);
+			if (i == knownAttributes.end() || i->second != e.second) {
+				delta.attributes.insert(e);
+			}
+		}
+		for (const auto& e : knownAttributes) {
+			if (attributes.find(e.first) == attributes.end()) {
+				delta.removedAttributes.push_back(e.first);
+			}
+		}
+		known.getAttributes() = attributes;
+	}
+	known.setPosition(state.getPosition());
+	known.setOrientation(state.getOrientation());
+}
+
+inline bool AIStateBaseline::update(const std::vector<AIStateWorld>& states, const AIStreamMode& mode, AIStateDeltaMessage& msg) {
+	msg.clear();
+	++_generation;
+	for (const AIStateWorld& state : states) {
+		if (!mode.isInView(state.getPosition())) {
+			continue;
+		}
+		auto i = _entries.find(state.getId());
+		if (i == _entries.end()) {
+			_entries.emplace(state.getId(), Entry{state, _generation});
+			AIStateDelta& delta = msg.addDelta(state.getId(), AIStateDelta::DELTA_FULL);
+			delta.position = state.getPosition();
+			delta.orientation = state.getOrientation();
+			delta.attributes = state.getAttributes();
+			continue;
+		}
+		i->second.generation = _generation;
+		diff(state, i->second, msg);
+	}
+	for (auto i = _entries.begin(); i != _entries.end();) {
+		if (i->second.generation == _generation) {
+			++i;
+			continue;
+		}
+		msg.addRemoved(i->first);
+		i = _entries.erase(i);
+	}
+	return !msg.empty();
+}
+
+}
@@ -0,0 +1,195 @@
+/**
+ * @file
+ */
+#pragma once
+
+#include "IProtocolMessage.h"
+#include "AIStubTypes.h"
+#include <vector>
+#include <string>
+
+namespace ai {
+
+/**
+ * @brief The changes of a single character since the last state the client received
+ *
+ * Only the parts that are flagged are valid. A new character has all flags set.
+ */
+struct AIStateDelta {
+	enum : uint8_t {
+		DELTA_POSITION    = 1 << 0,
+		DELTA_ORIENTATION = 1 << 1,
+		DELTA_ATTRIBUTES  = 1 << 2,
+		// the character was not known to the client - the attributes are complete
+		DELTA_NEW         = 1 << 3,
+		DELTA_FULL        = DELTA_POSITION | DELTA_ORIENTATION | DELTA_ATTRIBUTES | DELTA_NEW
+	};
+
+	CharacterId id = -1;
+	uint8_t flags = 0u;
+	glm::vec3 position;
+	float orientation = 0.0f;
+	// the added or changed attributes - or all attributes for new characters
+	CharacterAttributes attributes;
+	std::vector<std::string> removedAttributes;
+
+	/**
+	 * @brief Applies the delta to the given state
+	 */
+	void apply(AIStateWorld& state) const {
+		if (flags & DELTA_NEW) {
+			state = AIStateWorld(id, position, orientation, attributes);
+			return;
+		}
+		if (flags & DELTA_POSITION) {
+			state.setPosition(position);
+		}
+		if (flags & DELTA_ORIENTATION) {
+			state.setOrientation(orientation);
+		}
+		if (flags & DELTA_ATTRIBUTES) {
+			CharacterAttributes& stateAttributes = state.getAttributes();
+			for (const std::string& key : removedAttributes) {
+				stateAttributes.erase(key);
+			}
+			for (const auto& e : attributes) {
+				stateAttributes[e.first] = e.second;
+			}
+		}
+	}
+};
+
+/**
+ * @brief Message for the remote debugging interface
+ *
+ * The changes of the world state since the last @ai{AIStateDeltaMessage} that was sent to the client.
+ * Only clients that enabled the delta streaming via @ai{AIStreamModeMessage} receive this message
+ * instead of the @ai{AIStateMessage}.
+ *
+ * Characters that are no longer known to the server or that left the view rectangle of the
+ * client are listed in the removed ids.
+ */
+class AIStateDeltaMessage: public IProtocolMessage {
+private:
+	typedef std::vector<AIStateDelta> Deltas;
+	Deltas _deltas;
+	std::vector<CharacterId> _removed;
+
+	void readDelta(streamContainer& in) {
+		AIStateDelta delta;
+		delta.id = readInt(in);
+		delta.flags = readByte(in);
+		if (delta.flags & AIStateDelta::DELTA_POSITION) {
+			delta.position.x = readFloat(in);
+			delta.position.y = readFloat(in);
+			delta.position.z = readFloat(in);
+		}
+		if (delta.flags & AIStateDelta::DELTA_ORIENTATION) {
+			delta.orientation = readFloat(in);
+		}
+		if (delta.flags & AIStateDelta::DELTA_ATTRIBUTES) {
+			const int size = readShort(in);
+			delta.attributes.reserve(size);
+			for (int i = 0; i < size; ++i) {
+				const std::string& key = readString(in);
+				const std::string& value = readString(in);
+				delta.attributes.insert(std::make_pair(key, value));
+			}
+			const int removedSize = readShort(in);
+			delta.removedAttributes.reserve(removedSize);
+			for (int i = 0; i < removedSize; ++i) {
+				delta.removedAttributes.push_back(readString(in));
+			}
+		}
+		_deltas.push_back(std::move(delta));
+	}
+
+	void writeDelta(streamContainer& out, const AIStateDelta& delta) const {
+		addInt(out, delta.id);
+		addByte(out, delta.flags);
+		if (delta.flags & AIStateDelta::DELTA_POSITION) {
+			addFloat(out, delta.position.x);
+			addFloat(out, delta.position.y);
+			addFloat(out, delta.position.z);
+		}
+		if (delta.flags & AIStateDelta::DELTA_ORIENTATION) {
+			addFloat(out, delta.orientation);
+		}
+		if (delta.flags & AIStateDelta::DELTA_ATTRIBUTES) {
+			addShort(out, static_cast<int16_t>(delta.attributes.size()));
+			for (const auto& e : delta.attributes) {
+				addString(out, e.first);
+				addString(out, e.second);
+			}
+			addShort(out, static_cast<int16_t>(delta.removedAttributes.size()));
+			for (const std::string& key : delta.removedAttributes) {
+				addString(out, key);
+			}
+		}
+	}
+
+public:
+	AIStateDeltaMessage() :
+			IProtocolMessage(PROTO_STATEDELTA) {
+	}
+
+	explicit AIStateDeltaMessage(streamContainer& in) :
+			IProtocolMessage(PROTO_STATEDELTA) {
+		const int deltaSize = readInt(in);
+		_deltas.reserve(deltaSize);
+		for (int i = 0; i < deltaSize; ++i) {
+			readDelta(in);
+		}
+		const int removedSize = readInt(in);
+		_removed.reserve(removedSize);
+		for (int i = 0; i < removedSize; ++i) {
+			_removed.push_back(readInt(in));
+		}
+	}
+
+	/**
+	 * @return The delta to fill. The reference is only valid until the next delta is added.
+	 */
+	AIStateDelta& addDelta(CharacterId id, uint8_t flags) {
+		_deltas.emplace_back();
+		AIStateDelta& delta = _deltas.back();
+		delta.id = id;
+		delta.flags = flags;
+		return delta;
+	}
+
+	void addRemoved(CharacterId id) {
+		_removed.push_back(id);
+	}
+
+	inline bool empty() const {
+		return _deltas.empty() && _removed.empty();
+	}
+
+	void clear() {
+		_deltas.clear();
+		_removed.clear();
+	}
+
+	void serialize(streamContainer& out) const override {
+		addByte(out, _id);
+		addInt(out, static_cast<int>(_deltas.size()));
+		for (const AIStateDelta& delta : _deltas) {
+			writeDelta(out, delta);
+		}
+		addInt(out, static_cast<int>(_removed.size()));
+		for (CharacterId id : _removed) {
+			addInt(out, id);
+		}
+	}
+
+	inline const std::vector<AIStateDelta>& getDeltas() const {
+		return _deltas;
+	}
+
+	inline const std::vector<CharacterId>& getRemoved() const {
+		return _removed;
+	}
+};
+
+}
@@ -82,6 +82,10 @@ public:
 		_states.push_back(std::move(tree));
 	}
 
+	void clear() {
+		_states.clear();
+	}
+
 	void serialize(streamContainer& out) const override {
 		addByte(out, _id);
 		addInt(out, static_cast<int>(_states.size()));
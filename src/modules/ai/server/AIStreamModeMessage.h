@@ -0,0 +1,100 @@
+/**
+ * @file
+ */
+#pragma once
+
+#include "IProtocolMessage.h"
+#include "common/Math.h"
+
+namespace ai {
+
+/**
+ * @brief The way the server streams the world state to a particular client
+ */
+struct AIStreamMode {
+	/**
+	 * @brief If @c true the client receives @ai{AIStateDeltaMessage}s instead of the full @ai{AIStateMessage}
+	 */
+	bool delta = false;
+	/**
+	 * @brief The minimum time between two state updates for this client. @c 0 means every server update.
+	 */
+	int32_t updateMillis = 0;
+	/**
+	 * @brief The view rectangle on the x/z plane. Only entities inside of it are sent.
+	 * The rectangle is empty (and thus disabled) if the min values are bigger than the max values.
+	 */
+	float minX = 1.0f;
+	float minZ = 1.0f;
+	float maxX = -1.0f;
+	float maxZ = -1.0f;
+
+	AIStreamMode() {
+	}
+
+	AIStreamMode(bool _delta, int32_t _updateMillis) :
+			delta(_delta), updateMillis(_updateMillis) {
+	}
+
+	AIStreamMode(bool _delta, int32_t _updateMillis, float _minX, float _minZ, float _maxX, float _maxZ) :
+			delta(_delta), updateMillis(_updateMillis), minX(_minX), minZ(_minZ), maxX(_maxX), maxZ(_maxZ) {
+	}
+
+	inline bool hasViewRect() const {
+		return minX <= maxX && minZ <= maxZ;
+	}
+
+	inline bool isInView(const glm::vec3& position) const {
+		if (!hasViewRect()) {
+			return true;
+		}
+		return position.x >= minX && position.x <= maxX && position.z >= minZ && position.z <= maxZ;
+	}
+};
+
+/**
+ * @brief Message for the remote debugging interface
+ *
+ * Sent by a client to negotiate the way the world state is streamed to it. Clients that never send
+ * this message get the full @ai{AIStateMessage} on every server update. The server sends the message
+ * back to the client to acknowledge the new mode - the messages that follow the acknowledge are
+ * using the new mode.
+ *
+ * If delta streaming gets enabled, the server starts with an empty baseline for the client. The client
+ * should drop the world state it already knows once it receives the acknowledge.
+ */
+class AIStreamModeMessage: public IProtocolMessage {
+private:
+	AIStreamMode _mode;
+
+public:
+	explicit AIStreamModeMessage(const AIStreamMode& mode) :
+			IProtocolMessage(PROTO_STREAMMODE), _mode(mode) {
+	}
+
+	explicit AIStreamModeMessage(streamContainer& in) :
+			IProtocolMessage(PROTO_STREAMMODE) {
+		_mode.delta = readBool(in);
+		_mode.updateMillis = readInt(in);
+		_mode.minX = readFloat(in);
+		_mode.minZ = readFloat(in);
+		_mode.maxX = readFloat(in);
+		_mode.maxZ = readFloat(in);
+	}
+
+	void serialize(streamContainer& out) const override {
+		addByte(out, _id);
+		addBool(out, _mode.delta);
+		addInt(out, _mode.updateMillis);
+		addFloat(out, _mode.minX);
+		addFloat(out, _mode.minZ);
+		addFloat(out, _mode.maxX);
+		addFloat(out, _mode.maxZ);
+	}
+
+	inline const AIStreamMode& getMode() const {
+		return _mode;
+	}
+};
+
+}
@@ -216,6 +216,10 @@ public:
 		return _orientation;
 	}
 
+	inline void setOrientation(float orientation) {
+		_orientation = orientation;
+	}
+
 	/**
 	 * @return The position in the world
 	 */
@@ -223,6 +227,10 @@ public:
 		return _position;
 	}
 
+	inline void setPosition(const glm::vec3& position) {
+		_position = position;
+	}
+
 	/**
 	 * @return Attributes for the entity
 	 */
@@ -9,7 +9,7 @@
 
 namespace ai {
 
-typedef uint8_t ClientId;
+typedef uint32_t ClientId;
 
 /**
  * @brief Interface for the execution of assigned IProtocolMessage
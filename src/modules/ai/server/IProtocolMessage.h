@@ -7,7 +7,7 @@
 #include <stddef.h>
 #include <limits.h>
 #include <string>
-#include <deque>
+#include "StreamBuffer.h"
 #define AI_LIL_ENDIAN  1234
 #define AI_BIG_ENDIAN  4321
 #ifdef __linux__
@@ -36,7 +36,7 @@
 namespace ai {
 
 typedef uint8_t ProtocolId;
-typedef std::deque<uint8_t> streamContainer;
+typedef StreamBuffer streamContainer;
 
 const ProtocolId PROTO_PING = 0;
 const ProtocolId PROTO_STATE = 1;
@@ -51,6 +51,8 @@ const ProtocolId PROTO_STEP = 9;
 const ProtocolId PROTO_UPDATENODE = 10;
 const ProtocolId PROTO_DELETENODE = 11;
 const ProtocolId PROTO_ADDNODE = 12;
+const ProtocolId PROTO_STREAMMODE = 13;
+const ProtocolId PROTO_STATEDELTA = 14;
 
 /**
  * @brief A protocol message is used for the serialization of the ai states for remote debugging
@@ -172,8 +174,8 @@ inline bool IProtocolMessage::readBool(streamContainer& in) {
 }
 
 inline uint8_t IProtocolMessage::readByte(streamContainer& in) {
-	const uint8_t b = in.front();
-	in.pop_front();
+	uint8_t b;
+	in.read(&b, sizeof(b));
 	return b;
 }
 
@@ -196,101 +198,59 @@ inline float IProtocolMessage::readFloat(streamContainer& in) {
 }
 
 inline std::string IProtocolMessage::readString(streamContainer& in) {
-	std::string strbuff;
-	strbuff.reserve(64);
-	for (;;) {
-		const char chr = static_cast<char>(in.front());
-		in.pop_front();
-		if (chr == '\0')
-			break;
-		strbuff += chr;
-	}
+	const char* begin = reinterpret_cast<const char*>(in.data());
+	const size_t length = strnlen(begin, in.size());
+	std::string strbuff(begin, length);
+	// skip the string and the terminating \0
+	in.skip(length < in.size() ? length + 1 : length);
 	return strbuff;
 }
 
 inline void IProtocolMessage::addString(streamContainer& out, const std::string& string) {
-	const std::size_t length = string.length();
-	for (std::size_t i = 0; i < length; ++i) {
-		out.push_back(uint8_t(string[i]));
-	}
-	out.push_back(uint8_t('\0'));
+	// including the terminating \0
+	out.append(reinterpret_cast<const uint8_t*>(string.c_str()), string.length() + 1);
 }
 
 inline void IProtocolMessage::addShort(streamContainer& out, int16_t word) {
 	const int16_t swappedWord = AI_SwapLE16(word);
-	out.push_back(uint8_t(swappedWord));
-	out.push_back(uint8_t(swappedWord >> CHAR_BIT));
+	out.append(reinterpret_cast<const uint8_t*>(&swappedWord), sizeof(swappedWord));
 }
 
 inline void IProtocolMessage::addInt(streamContainer& out, int32_t dword) {
-	int32_t swappedDWord = AI_SwapLE32(dword);
-	out.push_back(uint8_t(swappedDWord));
-	out.push_back(uint8_t(swappedDWord >>= CHAR_BIT));
-	out.push_back(uint8_t(swappedDWord >>= CHAR_BIT));
-	out.push_back(uint8_t(swappedDWord >> CHAR_BIT));
+	const int32_t swappedDWord = AI_SwapLE32(dword);
+	out.append(reinterpret_cast<const uint8_t*>(&swappedDWord), sizeof(swappedDWord));
 }
 
 inline void IProtocolMessage::addLong(streamContainer& out, int64_t dword) {
-	int64_t swappedDWord = AI_SwapLE64(dword);
-	out.push_back(uint8_t(swappedDWord));
-	out.push_back(uint8_t(swappedDWord >>= CHAR_BIT));
-	out.push_back(uint8_t(swappedDWord >>= CHAR_BIT));
-	out.push_back(uint8_t(swappedDWord >>= CHAR_BIT));
-	out.push_back(uint8_t(swappedDWord >>= CHAR_BIT));
-	out.push_back(uint8_t(swappedDWord >>= CHAR_BIT));
-	out.push_back(uint8_t(swappedDWord >>= CHAR_BIT));
-	out.push_back(uint8_t(swappedDWord >> CHAR_BIT));
+	const int64_t swappedDWord = AI_SwapLE64(dword);
+	out.append(reinterpret_cast<const uint8_t*>(&swappedDWord), sizeof(swappedDWord));
 }
 
 inline int16_t IProtocolMessage::readShort(streamContainer& in) {
-	uint8_t buf[2];
-	const int l = sizeof(buf);
-	for (int i = 0; i < l; ++i) {
-		buf[i] = in.front();
-		in.pop_front();
-	}
-	const int16_t *word = (const int16_t*) (void*) &buf;
-	const int16_t val = AI_SwapLE16(*word);
-	return val;
+	int16_t word;
+	in.read(reinterpret_cast<uint8_t*>(&word), sizeof(word));
+	return AI_SwapLE16(word);
 }
 
 inline int32_t IProtocolMessage::readInt(streamContainer& in) {
-	uint8_t buf[4];
-	const int l = sizeof(buf);
-	for (int i = 0; i < l; ++i) {
-		buf[i] = in.front();
-		in.pop_front();
-	}
-	const int32_t *word = (const int32_t*) (void*) &buf;
-	const int32_t val = AI_SwapLE32(*word);
-	return val;
+	int32_t word;
+	in.read(reinterpret_cast<uint8_t*>(&word), sizeof(word));
+	return AI_SwapLE32(word);
 }
 
 inline int32_t IProtocolMessage::peekInt(const streamContainer& in) {
-	uint8_t buf[4];
-	const int l = sizeof(buf);
-	streamContainer::const_iterator it = in.begin();
-	for (int i = 0; i < l; ++i) {
-		if (it == in.end())
-			return -1;
-		buf[i] = *it;
-		++it;
+	int32_t word;
+	if (in.size() < sizeof(word)) {
+		return -1;
 	}
-	const int32_t *word = (const int32_t*) (void*) &buf;
-	const int32_t val = AI_SwapLE32(*word);
-	return val;
+	memcpy(&word, in.data(), sizeof(word));
+	return AI_SwapLE32(word);
 }
 
 inline int64_t IProtocolMessage::readLong(streamContainer& in) {
-	uint8_t buf[8];
-	const int l = sizeof(buf);
-	for (int i = 0; i < l; ++i) {
-		buf[i] = in.front();
-		in.pop_front();
-	}
-	const int64_t *word = (const int64_t*) (void*) &buf;
-	const int64_t val = AI_SwapLE64(*word);
-	return val;
+	int64_t word;
+	in.read(reinterpret_cast<uint8_t*>(&word), sizeof(word));
+	return AI_SwapLE64(word);
 }
 
 #define PROTO_MSG(name, id) class name : public IProtocolMessage { public: name() : IProtocolMessage(id) {} }
@@ -23,10 +23,12 @@ namespace ai {
 class IProtocolMessage;
 
 struct Client {
-	explicit Client(SOCKET _socket) :
-			socket(_socket), finished(false), in(), out() {
+	Client(SOCKET _socket, ClientId _id) :
+			socket(_socket), id(_id), finished(false), in(), out() {
 	}
 	SOCKET socket;
+	// stable over the lifetime of the connection - this is given to the protocol handlers
+	ClientId id;
 	bool finished;
 	streamContainer in;
 	streamContainer out;
@@ -49,6 +51,9 @@ protected:
 	fd_set _readFDSet;
 	fd_set _writeFDSet;
 	int64_t _time;
+	ClientId _nextClientId;
+	// reused for serializing the messages
+	streamContainer _messageBuffer;
 
 	typedef std::list<Client> ClientSockets;
 	typedef ClientSockets::iterator ClientSocketsIter;
@@ -59,6 +64,7 @@ protected:
 	Listeners _listeners;
 
 	bool sendMessage(Client& client);
+	void addMessage(Client& client, const streamContainer& message);
 public:
 	Network(uint16_t port = 10001, const std::string& hostname = "0.0.0.0");
 	virtual ~Network();
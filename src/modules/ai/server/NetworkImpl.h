@@ -41,7 +41,7 @@
 namespace ai {
 
 inline Network::Network(uint16_t port, const std::string& hostname) :
-		_port(port), _hostname(hostname), _socketFD(INVALID_SOCKET), _time(0L) {
+		_port(port), _hostname(hostname), _socketFD(INVALID_SOCKET), _time(0L), _nextClientId(0) {
 	FD_ZERO(&_readFDSet);
 	FD_ZERO(&_writeFDSet);
 }
@@ -135,12 +135,9 @@ inline bool Network::sendMessage(Client& client) {
 		return true;
 	}
 
-	std::array<uint8_t, 16384> buf;
 	while (!client.out.empty()) {
-		const size_t len = std::min(buf.size(), client.out.size());
-		std::copy_n(client.out.begin(), len, buf.begin());
 		const SOCKET clientSocket = client.socket;
-		const network_return sent = send(clientSocket, (const char*)&buf[0], len, 0);
+		const network_return sent = send(clientSocket, (const char*)client.out.data(), client.out.size(), 0);
 		if (sent < 0) {
 			return false;
 		}
@@ -148,11 +145,17 @@ inline bool Network::sendMessage(Client& client) {
 			// better luck next time - but don't block others
 			return true;
 		}
-		client.out.erase(client.out.begin(), std::next(client.out.begin(), sent));
+		client.out.skip(sent);
 	}
 	return true;
 }
 
+inline void Network::addMessage(Client& client, const streamContainer& message) {
+	IProtocolMessage::addInt(client.out, static_cast<int32_t>(message.size()));
+	client.out.append(message);
+	FD_SET(client.socket, &_writeFDSet);
+}
+
 inline void Network::update(int64_t deltaTime) {
 	_time += deltaTime;
 	if (_time > 5000L) {
@@ -177,7 +180,7 @@ inline void Network::update(int64_t deltaTime) {
 		const SOCKET clientSocket = accept(_socketFD, nullptr, nullptr);
 		if (clientSocket != INVALID_SOCKET) {
 			FD_SET(clientSocket, &_readFDSet);
-			const Client c(clientSocket);
+			const Client c(clientSocket, _nextClientId++);
 			_clientSockets.push_back(c);
 			for (INetworkListener* listener : _listeners) {
 				listener->onConnect(&_clientSockets.back());
@@ -185,8 +188,7 @@ inline void Network::update(int64_t deltaTime) {
 		}
 	}
 
-	ClientId clientId = 0;
-	for (ClientSocketsIter i = _clientSockets.begin(); i != _clientSockets.end(); ++clientId) {
+	for (ClientSocketsIter i = _clientSockets.begin(); i != _clientSockets.end();) {
 		Client& client = *i;
 		const SOCKET clientSocket = client.socket;
 		if (clientSocket == INVALID_SOCKET) {
@@ -208,7 +210,7 @@ inline void Network::update(int64_t deltaTime) {
 				i = closeClient(i);
 				continue;
 			}
-			std::copy_n(buf.begin(), len, std::back_inserter(client.in));
+			client.in.append(&buf[0], len);
 		}
 
 		ProtocolMessageFactory& factory = ProtocolMessageFactory::get();
@@ -220,7 +222,7 @@ inline void Network::update(int64_t deltaTime) {
 			}
 			IProtocolHandler* handler = ProtocolHandlerRegistry::get().getHandler(*msg);
 			if (handler) {
-				handler->execute(clientId, *msg);
+				handler->execute(client.id, *msg);
 			}
 		}
 		++i;
@@ -232,8 +234,8 @@ inline bool Network::broadcast(const IProtocolMessage& msg) {
 		return false;
 	}
 	_time = 0L;
-	streamContainer out;
-	msg.serialize(out);
+	_messageBuffer.clear();
+	msg.serialize(_messageBuffer);
 	for (ClientSocketsIter i = _clientSockets.begin(); i != _clientSockets.end(); ++i) {
 		Client& client = *i;
 		if (client.socket == INVALID_SOCKET) {
@@ -241,9 +243,7 @@ inline bool Network::broadcast(const IProtocolMessage& msg) {
 			continue;
 		}
 
-		IProtocolMessage::addInt(client.out, static_cast<int32_t>(out.size()));
-		std::copy(out.begin(), out.end(), std::back_inserter(client.out));
-		FD_SET(client.socket, &_writeFDSet);
+		addMessage(client, _messageBuffer);
 	}
 
 	return true;
@@ -255,12 +255,9 @@ inline bool Network::sendToClient(Client* client, const IProtocolMessage& msg) {
 		return false;
 	}
 
-	streamContainer out;
-	msg.serialize(out);
-
-	IProtocolMessage::addInt(client->out, static_cast<int32_t>(out.size()));
-	std::copy(out.begin(), out.end(), std::back_inserter(client->out));
-	FD_SET(client->socket, &_writeFDSet);
+	_messageBuffer.clear();
+	msg.serialize(_messageBuffer);
+	addMessage(*client, _messageBuffer);
 	return true;
 }
 
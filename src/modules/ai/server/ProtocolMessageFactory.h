@@ -16,6 +16,8 @@
 #include "AIUpdateNodeMessage.h"
 #include "AIAddNodeMessage.h"
 #include "AIDeleteNodeMessage.h"
+#include "AIStreamModeMessage.h"
+#include "AIStateDeltaMessage.h"
 
 namespace ai {
 
@@ -34,6 +36,8 @@ private:
 	uint8_t *_aiUpdateNode;
 	uint8_t *_aiAddNode;
 	uint8_t *_aiDeleteNode;
+	uint8_t *_aiStreamMode;
+	uint8_t *_aiStateDelta;
 
 	ProtocolMessageFactory() :
 		_aiState(new uint8_t[sizeof(AIStateMessage)]),
@@ -48,7 +52,9 @@ private:
 		_aiCharacterStatic(new uint8_t[sizeof(AICharacterStaticMessage)]),
 		_aiUpdateNode(new uint8_t[sizeof(AIUpdateNodeMessage)]),
 		_aiAddNode(new uint8_t[sizeof(AIAddNodeMessage)]),
-		_aiDeleteNode(new uint8_t[sizeof(AIDeleteNodeMessage)]) {
+		_aiDeleteNode(new uint8_t[sizeof(AIDeleteNodeMessage)]),
+		_aiStreamMode(new uint8_t[sizeof(AIStreamModeMessage)]),
+		_aiStateDelta(new uint8_t[sizeof(AIStateDeltaMessage)]) {
 	}
 public:
 	~ProtocolMessageFactory() {
@@ -65,6 +71,8 @@ public:
 		delete[] _aiUpdateNode;
 		delete[] _aiAddNode;
 		delete[] _aiDeleteNode;
+		delete[] _aiStreamMode;
+		delete[] _aiStateDelta;
 	}
 
 	static ProtocolMessageFactory& get() {
@@ -125,6 +133,10 @@ public:
 			return new (_aiAddNode) AIAddNodeMessage(in);
 		} else if (type == PROTO_DELETENODE) {
 			return new (_aiDeleteNode) AIDeleteNodeMessage(in);
+		} else if (type == PROTO_STREAMMODE) {
+			return new (_aiStreamMode) AIStreamModeMessage(in);
+		} else if (type == PROTO_STATEDELTA) {
+			return new (_aiStateDelta) AIStateDeltaMessage(in);
 		}
 
 		return nullptr;
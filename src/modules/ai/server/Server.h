@@ -6,10 +6,14 @@
 #include "common/Thread.h"
 #include "tree/TreeNode.h"
 #include <unordered_set>
+#include <unordered_map>
 #include "Network.h"
 #include "zone/Zone.h"
 #include "AIRegistry.h"
 #include "AIStateMessage.h"
+#include "AIStateDeltaMessage.h"
+#include "AIStateBaseline.h"
+#include "AIStreamModeMessage.h"
 #include "AINamesMessage.h"
 #include "AIStubTypes.h"
 #include "AICharacterDetailsMessage.h"
@@ -32,6 +36,7 @@ class ChangeHandler;
 class AddNodeHandler;
 class DeleteNodeHandler;
 class UpdateNodeHandler;
+class StreamModeHandler;
 class NopHandler;
 
 /**
@@ -46,6 +51,11 @@ class NopHandler;
  * will also broadcast an @ai{AICharacterDetailsMessage} to all connected clients.
  *
  * You can only debug one @ai{Zone} at the same time. The debugging session is shared between all connected clients.
+ *
+ * Clients can negotiate the way the world state is streamed to them by sending an @ai{AIStreamModeMessage}. They
+ * can limit the update rate, limit the state to a view rectangle and only receive the changes since the last update
+ * via @ai{AIStateDeltaMessage}. Clients that don't send this message receive the full @ai{AIStateMessage} with the
+ * rate that is configured via @c setStateUpdateInterval().
  */
 class Server: public INetworkListener {
 protected:
@@ -65,6 +75,7 @@ protected:
 	AddNodeHandler *_addNodeHandler;
 	DeleteNodeHandler *_deleteNodeHandler;
 	UpdateNodeHandler *_updateNodeHandler;
+	StreamModeHandler *_streamModeHandler;
 	NopHandler _nopHandler;
 	std::atomic_bool _pause;
 	// the current active debugging zone
@@ -72,6 +83,25 @@ protected:
 	ReadWriteLock _lock = {"server"};
 	std::vector<std::string> _names;
 	uint32_t _broadcastMask = 0u;
+	int64_t _stateUpdateMillis = 0L;
+
+	/**
+	 * @brief The streaming state of a connected client
+	 */
+	struct DebugClient {
+		Client* client = nullptr;
+		// false for clients that never sent an AIStreamModeMessage
+		bool streamMode = false;
+		AIStreamMode mode;
+		AIStateBaseline baseline;
+		// -1 if the next state update should be sent regardless of the update interval
+		int64_t lastStateMillis = -1L;
+	};
+	// only touched from the thread that calls Server::update
+	std::unordered_map<ClientId, DebugClient> _clients;
+	// the world state of the current update - shared between all clients
+	AIStateMessage _stateMessage;
+	AIStateDeltaMessage _deltaMessage;
 
 	enum EventType {
 		EV_SELECTION,
@@ -83,6 +113,7 @@ protected:
 		EV_PAUSE,
 		EV_RESET,
 		EV_SETDEBUG,
+		EV_STREAMMODE,
 
 		EV_MAX
 	};
@@ -92,10 +123,11 @@ protected:
 			CharacterId characterId;
 			int64_t stepMillis;
 			Zone* zone;
-			Client* newClient;
+			ClientId clientId;
 			bool pauseState;
 		} data;
 		std::string strData = "";
+		AIStreamMode streamMode;
 		EventType type;
 	};
 	std::vector<Event> _events;
@@ -106,7 +138,13 @@ protected:
 	void addChildren(const TreeNodePtr& node, AIStateNode& parent, const AIPtr& ai) const;
 
 	// only call these from the Server::update method
-	void broadcastState(const Zone* zone);
+	/**
+	 * @param force If @c false, the state is only sent to the clients whose update interval elapsed
+	 */
+	void broadcastState(const Zone* zone, bool force = true);
+	void collectState(const Zone* zone);
+	// sends the last collected state in the stream mode of the given client
+	void sendState(DebugClient& client);
 	void broadcastCharacterDetails(const Zone* zone);
 	void broadcastStaticCharacterDetails(const Zone* zone);
 
@@ -136,6 +174,8 @@ public:
 	 *
 	 * @see @c TreeNodeParser
 	 * @see @c ConditionParser
+	 * @note The tree is modified in the next @ai{Zone::update} before the @ai{AI} instances are ticked - see
+	 * @ai{Zone::scheduleBetweenTicks()}. The return value only tells whether the change was scheduled.
 	 */
 	bool updateNode(const CharacterId& characterId, int32_t nodeId, const std::string& name, const std::string& type, const std::string& condition);
 
@@ -151,6 +191,7 @@ public:
 	 *
 	 * @see @ai{TreeNodeParser}
 	 * @see @ai{ConditionParser}
+	 * @note See updateNode()
 	 */
 	bool addNode(const CharacterId& characterId, int32_t parentNodeId, const std::string& name, const std::string& type, const std::string& condition);
 
@@ -160,6 +201,7 @@ public:
 	 *
 	 * @param[in] characterId The id of the @ai{ICharacter} where we want to delete the specified node
 	 * @param[in] nodeId The id of the @ai{TreeNode} to delete
+	 * @note See updateNode()
 	 */
 	bool deleteNode(const CharacterId& characterId, int32_t nodeId);
 
@@ -209,6 +251,20 @@ public:
 	 */
 	void step(int64_t stepMillis = 1L);
 
+	/**
+	 * @brief Changes the way the world state is streamed to the given client
+	 * @see @ai{AIStreamModeMessage}
+	 */
+	void setStreamMode(const ClientId& clientId, const AIStreamMode& mode);
+
+	/**
+	 * @brief The minimum time between two world state updates for the clients that didn't negotiate their
+	 * own stream mode. @c 0 (the default) sends the state on every server update.
+	 *
+	 * @note Only call this from the thread that updates the server
+	 */
+	void setStateUpdateInterval(int64_t millis);
+
 	/**
 	 * @brief call this to update the server - should get called somewhere from your game tick
 	 */
@@ -12,6 +12,7 @@
 #include "AddNodeHandler.h"
 #include "DeleteNodeHandler.h"
 #include "UpdateNodeHandler.h"
+#include "StreamModeHandler.h"
 
 namespace ai {
 
@@ -24,7 +25,8 @@ inline Server::Server(AIRegistry& aiRegistry, short port, const std::string& hos
 		_aiRegistry(aiRegistry), _network(port, hostname), _selectedCharacterId(AI_NOTHING_SELECTED), _time(0L),
 		_selectHandler(new SelectHandler(*this)), _pauseHandler(new PauseHandler(*this)), _resetHandler(new ResetHandler(*this)),
 		_stepHandler(new StepHandler(*this)), _changeHandler(new ChangeHandler(*this)), _addNodeHandler(new AddNodeHandler(*this)),
-		_deleteNodeHandler(new DeleteNodeHandler(*this)), _updateNodeHandler(new UpdateNodeHandler(*this)), _pause(false), _zone(nullptr) {
+		_deleteNodeHandler(new DeleteNodeHandler(*this)), _updateNodeHandler(new UpdateNodeHandler(*this)),
+		_streamModeHandler(new StreamModeHandler(*this)), _pause(false), _zone(nullptr) {
 	_network.addListener(this);
 	ProtocolHandlerRegistry& r = ai::ProtocolHandlerRegistry::get();
 	r.registerHandler(ai::PROTO_SELECT, _selectHandler);
@@ -36,6 +38,7 @@ inline Server::Server(AIRegistry& aiRegistry, short port, const std::string& hos
 	r.registerHandler(ai::PROTO_ADDNODE, _addNodeHandler);
 	r.registerHandler(ai::PROTO_DELETENODE, _deleteNodeHandler);
 	r.registerHandler(ai::PROTO_UPDATENODE, _updateNodeHandler);
+	r.registerHandler(ai::PROTO_STREAMMODE, _streamModeHandler);
 }
 
 inline Server::~Server() {
@@ -47,6 +50,7 @@ inline Server::~Server() {
 	delete _addNodeHandler;
 	delete _deleteNodeHandler;
 	delete _updateNodeHandler;
+	delete _streamModeHandler;
 	_network.removeListener(this);
 }
 
@@ -56,13 +60,15 @@ inline void Server::enqueueEvent(const Event& event) {
 }
 
 inline void Server::onConnect(Client* client) {
+	_clients[client->id].client = client;
 	Event event;
 	event.type = EV_NEWCONNECTION;
-	event.data.newClient = client;
+	event.data.clientId = client->id;
 	enqueueEvent(event);
 }
 
-inline void Server::onDisconnect(Client* /*client*/) {
+inline void Server::onDisconnect(Client* client) {
+	_clients.erase(client->id);
 	ai_log("remote debugger disconnect (%i)", _network.getConnectedClients());
 	Zone* zone = _zone;
 	if (zone == nullptr) {
@@ -118,16 +124,52 @@ inline void Server::addChildren(const TreeNodePtr& node, AIStateNode& parent, co
 	}
 }
 
-inline void Server::broadcastState(const Zone* zone) {
+inline void Server::broadcastState(const Zone* zone, bool force) {
 	_broadcastMask |= SV_BROADCAST_STATE;
-	AIStateMessage msg;
+	bool collected = false;
+	for (auto& e : _clients) {
+		DebugClient& c = e.second;
+		const int64_t interval = c.streamMode ? c.mode.updateMillis : _stateUpdateMillis;
+		if (!force && c.lastStateMillis >= 0L && _time - c.lastStateMillis < interval) {
+			continue;
+		}
+		if (!collected) {
+			// the state is only collected once for all clients
+			collected = true;
+			collectState(zone);
+		}
+		sendState(c);
+	}
+}
+
+inline void Server::collectState(const Zone* zone) {
+	_stateMessage.clear();
 	auto func = [&] (const AIPtr& ai) {
 		const ICharacterPtr& chr = ai->getCharacter();
-		const AIStateWorld b(chr->getId(), chr->getPosition(), chr->getOrientation(), chr->getAttributes());
-		msg.addState(b);
+		_stateMessage.addState(AIStateWorld(chr->getId(), chr->getPosition(), chr->getOrientation(), chr->getAttributes()));
 	};
 	zone->execute(func);
-	_network.broadcast(msg);
+}
+
+inline void Server::sendState(DebugClient& c) {
+	c.lastStateMillis = _time;
+	if (c.mode.delta) {
+		if (c.baseline.update(_stateMessage.getStates(), c.mode, _deltaMessage)) {
+			_network.sendToClient(c.client, _deltaMessage);
+		}
+		return;
+	}
+	if (!c.mode.hasViewRect()) {
+		_network.sendToClient(c.client, _stateMessage);
+		return;
+	}
+	AIStateMessage msg;
+	for (const AIStateWorld& state : _stateMessage.getStates()) {
+		if (c.mode.isInView(state.getPosition())) {
+			msg.addState(state);
+		}
+	}
+	_network.sendToClient(c.client, msg);
 }
 
 inline void Server::broadcastStaticCharacterDetails(const Zone* zone) {
@@ -255,11 +297,40 @@ inline void Server::handleEvents(Zone* zone, bool pauseState) {
 			break;
 		}
 		case EV_NEWCONNECTION: {
-			_network.sendToClient(event.data.newClient, AIPauseMessage(pauseState));
-			_network.sendToClient(event.data.newClient, AINamesMessage(_names));
+			auto i = _clients.find(event.data.clientId);
+			if (i == _clients.end()) {
+				// already disconnected again
+				break;
+			}
+			Client* client = i->second.client;
+			_network.sendToClient(client, AIPauseMessage(pauseState));
+			_network.sendToClient(client, AINamesMessage(_names));
 			ai_log("new remote debugger connection (%i)", _network.getConnectedClients());
 			break;
 		}
+		case EV_STREAMMODE: {
+			auto i = _clients.find(event.data.clientId);
+			if (i == _clients.end()) {
+				break;
+			}
+			DebugClient& c = i->second;
+			AIStreamMode mode = event.streamMode;
+			mode.updateMillis = std::max(0, mode.updateMillis);
+			// the client drops its known state if delta streaming gets enabled - so start from scratch, too
+			if (mode.delta != c.mode.delta) {
+				c.baseline.clear();
+			}
+			c.streamMode = true;
+			c.mode = mode;
+			c.lastStateMillis = -1L;
+			_network.sendToClient(c.client, AIStreamModeMessage(mode));
+			// there are no state updates while the execution is paused
+			if (zone != nullptr && pauseState) {
+				collectState(zone);
+				sendState(c);
+			}
+			break;
+		}
 		case EV_ZONEADD: {
 			if (!_zones.insert(event.data.zone).second) {
 				return;
@@ -319,11 +390,6 @@ inline bool Server::updateNode(const CharacterId& characterId, int32_t nodeId, c
 	if (zone == nullptr) {
 		return false;
 	}
-	const AIPtr& ai = zone->getAI(characterId);
-	const TreeNodePtr& node = ai->getBehaviour()->getId() == nodeId ? ai->getBehaviour() : ai->getBehaviour()->getChild(nodeId);
-	if (!node) {
-		return false;
-	}
 	ConditionParser conditionParser(_aiRegistry, condition);
 	const ConditionPtr& conditionPtr = conditionParser.getCondition();
 	if (!conditionPtr) {
@@ -337,27 +403,42 @@ inline bool Server::updateNode(const CharacterId& characterId, int32_t nodeId, c
 		return false;
 	}
 	newNode->setCondition(conditionPtr);
-	for (auto& child : node->getChildren()) {
-		newNode->addChild(child);
-	}
 
-	const TreeNodePtr& root = ai->getBehaviour();
-	if (node == root) {
-		ai->setBehaviour(newNode);
-	} else {
-		const TreeNodePtr& parent = root->getParent(root, nodeId);
-		if (!parent) {
-			ai_log_error("No parent for non-root node '%i'", nodeId);
-			return false;
+	// the behaviour tree is shared by all the ai instances that are using it - it must not be modified
+	// while they are ticked
+	return zone->scheduleBetweenTicks([this, zone, characterId, nodeId, newNode] () {
+		const AIPtr& ai = zone->getAI(characterId);
+		if (!ai) {
+			return;
+		}
+		const TreeNodePtr& root = ai->getBehaviour();
+		const TreeNodePtr& node = root->getId() == nodeId ? root : root->getChild(nodeId);
+		if (!node) {
+			ai_log_error("Failed to update the node '%i' - it doesn't exist", nodeId);
+			return;
+		}
+		for (auto& child : node->getChildren()) {
+			newNode->addChild(child);
 		}
-		parent->replaceChild(nodeId, newNode);
-	}
 
-	Event event;
-	event.type = EV_UPDATESTATICCHRDETAILS;
-	event.data.zone = zone;
-	enqueueEvent(event);
-	return true;
+		if (node == root) {
+			newNode->assignIndices();
+			ai->setBehaviour(newNode);
+		} else {
+			const TreeNodePtr& parent = root->getParent(root, nodeId);
+			if (!parent) {
+				ai_log_error("No parent for non-root node '%i'", nodeId);
+				return;
+			}
+			parent->replaceChild(nodeId, newNode);
+			root->assignIndices();
+		}
+
+		Event event;
+		event.type = EV_UPDATESTATICCHRDETAILS;
+		event.data.zone = zone;
+		enqueueEvent(event);
+	});
 }
 
 inline bool Server::addNode(const CharacterId& characterId, int32_t parentNodeId, const std::string& name, const std::string& type, const std::string& condition) {
@@ -365,14 +446,6 @@ inline bool Server::addNode(const CharacterId& characterId, int32_t parentNodeId
 	if (zone == nullptr) {
 		return false;
 	}
-	const AIPtr& ai = zone->getAI(characterId);
-	TreeNodePtr node = ai->getBehaviour();
-	if (node->getId() != parentNodeId) {
-		node = node->getChild(parentNodeId);
-	}
-	if (!node) {
-		return false;
-	}
 	ConditionParser conditionParser(_aiRegistry, condition);
 	const ConditionPtr& conditionPtr = conditionParser.getCondition();
 	if (!conditionPtr) {
@@ -386,15 +459,28 @@ inline bool Server::addNode(const CharacterId& characterId, int32_t parentNodeId
 		return false;
 	}
 	newNode->setCondition(conditionPtr);
-	if (!node->addChild(newNode)) {
-		return false;
-	}
 
-	Event event;
-	event.type = EV_UPDATESTATICCHRDETAILS;
-	event.data.zone = zone;
-	enqueueEvent(event);
-	return true;
+	// see updateNode()
+	return zone->scheduleBetweenTicks([this, zone, characterId, parentNodeId, newNode] () {
+		const AIPtr& ai = zone->getAI(characterId);
+		if (!ai) {
+			return;
+		}
+		TreeNodePtr node = ai->getBehaviour();
+		if (node->getId() != parentNodeId) {
+			node = node->getChild(parentNodeId);
+		}
+		if (!node || !node->addChild(newNode)) {
+			ai_log_error("Failed to add the node to the parent '%i'", parentNodeId);
+			return;
+		}
+		ai->getBehaviour()->assignIndices();
+
+		Event event;
+		event.type = EV_UPDATESTATICCHRDETAILS;
+		event.data.zone = zone;
+		enqueueEvent(event);
+	});
 }
 
 inline bool Server::deleteNode(const CharacterId& characterId, int32_t nodeId) {
@@ -402,24 +488,30 @@ inline bool Server::deleteNode(const CharacterId& characterId, int32_t nodeId) {
 	if (zone == nullptr) {
 		return false;
 	}
-	const AIPtr& ai = zone->getAI(characterId);
-	// don't delete the root
-	const TreeNodePtr& root = ai->getBehaviour();
-	if (root->getId() == nodeId) {
-		return false;
-	}
+	// see updateNode()
+	return zone->scheduleBetweenTicks([this, zone, characterId, nodeId] () {
+		const AIPtr& ai = zone->getAI(characterId);
+		if (!ai) {
+			return;
+		}
+		// don't delete the root
+		const TreeNodePtr& root = ai->getBehaviour();
+		if (root->getId() == nodeId) {
+			ai_log_error("The root node can't be deleted");
+			return;
+		}
 
-	const TreeNodePtr& parent = root->getParent(root, nodeId);
-	if (!parent) {
-		ai_log_error("No parent for non-root node '%i'", nodeId);
-		return false;
-	}
-	parent->replaceChild(nodeId, TreeNodePtr());
-	Event event;
-	event.type = EV_UPDATESTATICCHRDETAILS;
-	event.data.zone = zone;
-	enqueueEvent(event);
-	return true;
+		const TreeNodePtr& parent = root->getParent(root, nodeId);
+		if (!parent) {
+			ai_log_error("No parent for non-root node '%i'", nodeId);
+			return;
+		}
+		parent->replaceChild(nodeId, TreeNodePtr());
+		Event event;
+		event.type = EV_UPDATESTATICCHRDETAILS;
+		event.data.zone = zone;
+		enqueueEvent(event);
+	});
 }
 
 inline void Server::addZone(Zone* zone) {
@@ -475,6 +567,18 @@ inline void Server::step(int64_t stepMillis) {
 	enqueueEvent(event);
 }
 
+inline void Server::setStreamMode(const ClientId& clientId, const AIStreamMode& mode) {
+	Event event;
+	event.type = EV_STREAMMODE;
+	event.data.clientId = clientId;
+	event.streamMode = mode;
+	enqueueEvent(event);
+}
+
+inline void Server::setStateUpdateInterval(int64_t millis) {
+	_stateUpdateMillis = millis < 0L ? 0L : millis;
+}
+
 inline void Server::update(int64_t deltaTime) {
 	_time += deltaTime;
 	const int clients = _network.getConnectedClients();
@@ -487,7 +591,7 @@ inline void Server::update(int64_t deltaTime) {
 	if (clients > 0 && zone != nullptr) {
 		if (!pauseState) {
 			if ((_broadcastMask & SV_BROADCAST_STATE) == 0) {
-				broadcastState(zone);
+				broadcastState(zone, false);
 			}
 			if ((_broadcastMask & SV_BROADCAST_CHRDETAILS) == 0) {
 				broadcastCharacterDetails(zone);
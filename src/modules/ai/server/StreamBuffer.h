@@ -0,0 +1,135 @@
+/**
+ * @file
+ */
+#pragma once
+
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <cassert>
+
+namespace ai {
+
+/**
+ * @brief Contiguous byte buffer for the protocol messages.
+ *
+ * Bytes are appended at the end and consumed from the front. Consuming only moves a read offset - the
+ * consumed bytes are dropped once everything was read or if they make up the bigger part of the buffer.
+ * Because the unread bytes are contiguous, they can be handed to @c send() directly.
+ *
+ * The interface is a subset of @c std::deque - so @c std::back_inserter and friends work, too.
+ */
+class StreamBuffer {
+private:
+	std::vector<uint8_t> _data;
+	size_t _readPos = 0u;
+
+	inline void compact() {
+		if (_readPos == _data.size()) {
+			_data.clear();
+			_readPos = 0u;
+		} else if (_readPos > 4096u && _readPos * 2u > _data.size()) {
+			_data.erase(_data.begin(), _data.begin() + _readPos);
+			_readPos = 0u;
+		}
+	}
+
+public:
+	typedef uint8_t value_type;
+	typedef uint8_t& reference;
+	typedef const uint8_t& const_reference;
+	typedef uint8_t* iterator;
+	typedef const uint8_t* const_iterator;
+	typedef size_t size_type;
+	typedef ptrdiff_t difference_type;
+
+	inline size_t size() const {
+		return _data.size() - _readPos;
+	}
+
+	inline bool empty() const {
+		return size() == 0u;
+	}
+
+	inline void reserve(size_t size) {
+		_data.reserve(_readPos + size);
+	}
+
+	inline void clear() {
+		_data.clear();
+		_readPos = 0u;
+	}
+
+	inline const uint8_t* data() const {
+		return _data.data() + _readPos;
+	}
+
+	inline iterator begin() {
+		return _data.data() + _readPos;
+	}
+
+	inline iterator end() {
+		return _data.data() + _data.size();
+	}
+
+	inline const_iterator begin() const {
+		return _data.data() + _readPos;
+	}
+
+	inline const_iterator end() const {
+		return _data.data() + _data.size();
+	}
+
+	inline uint8_t front() const {
+		assert(!empty());
+		return _data[_readPos];
+	}
+
+	inline void push_back(uint8_t byte) {
+		_data.push_back(byte);
+	}
+
+	inline void append(const uint8_t* bytes, size_t size) {
+		_data.insert(_data.end(), bytes, bytes + size);
+	}
+
+	inline void append(const StreamBuffer& other) {
+		append(other.data(), other.size());
+	}
+
+	/**
+	 * @brief Consumes the given amount of bytes from the front
+	 */
+	inline void skip(size_t size) {
+		assert(size <= this->size());
+		_readPos += size;
+		compact();
+	}
+
+	/**
+	 * @brief Copies the given amount of bytes from the front into @c out and consumes them
+	 * @note Reading from a truncated stream fills the missing bytes with zeros
+	 */
+	inline void read(uint8_t* out, size_t size) {
+		const size_t available = size < this->size() ? size : this->size();
+		memcpy(out, data(), available);
+		memset(out + available, 0, size - available);
+		skip(available);
+	}
+
+	inline void pop_front() {
+		skip(1u);
+	}
+
+	/**
+	 * @note Only erasing from the front is supported
+	 */
+	inline iterator erase(const_iterator first, const_iterator last) {
+		assert(first == begin());
+		skip(static_cast<size_t>(last - first));
+		return begin();
+	}
+};
+
+}
@@ -0,0 +1,27 @@
+/**
+ * @file
+ */
+#pragma once
+
+#include "IProtocolHandler.h"
+#include "AIStreamModeMessage.h"
+#include "Server.h"
+
+namespace ai {
+
+class Server;
+
+class StreamModeHandler: public ai::IProtocolHandler {
+private:
+	Server& _server;
+public:
+	explicit StreamModeHandler(Server& server) : _server(server) {
+	}
+
+	void execute(const ClientId& clientId, const IProtocolMessage& message) override {
+		const AIStreamModeMessage& msg = static_cast<const AIStreamModeMessage&>(message);
+		_server.setStreamMode(clientId, msg.getMode());
+	}
+};
+
+}
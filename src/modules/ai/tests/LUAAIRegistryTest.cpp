@@ -81,6 +81,7 @@ protected:
 		ai::Zone zone("TestNode");
 		const ai::TreeNodePtr& node = _registry.createNode(nodeName, ctx);
 		ASSERT_TRUE((bool)node) << "Could not create lua provided node '" << nodeName << "'";
+		node->assignIndices();
 		const ai::AIPtr& ai = std::make_shared<ai::AI>(node);
 		ai->setCharacter(_chr);
 		ASSERT_TRUE(zone.addAI(ai));
@@ -100,6 +101,50 @@ protected:
 		lua_gc(_registry.getLuaState(), LUA_GCCOLLECT, 0);
 		ASSERT_EQ(1, ai.use_count()) << "Someone is still referencing the AI instance";
 	}
+
+	/**
+	 * Ticks lua nodes, conditions and filters for a lot of entities on several threads. The results
+	 * of the lua scripts depend on the ai, so mixing up the states of the entities changes them.
+	 * @return The tree node status, the amount of filtered entities and the filtered entities for each entity
+	 */
+	std::vector<int> tickZone(ai::LUAAIRegistry& registry) {
+		std::vector<int> results;
+		ai::Zone zone("LuaZone", 4);
+		// the last status of a node is only recorded for debugged entities
+		zone.setDebug(true);
+		const ai::ConditionPtr& condition = registry.createCondition("LuaTestTrue", ctxCondition);
+		const ai::TreeNodeFactoryContext ctx = ai::TreeNodeFactoryContext("TreeNodeName", "", condition);
+		const ai::TreeNodePtr& node = registry.createNode("LuaTestId", ctx);
+		const ai::FilterPtr& filter = registry.createFilter("LuaFilterTest", ctxFilter);
+		if (!node || !filter) {
+			return results;
+		}
+		node->assignIndices();
+		std::vector<ai::AIPtr> ais;
+		for (ai::CharacterId id = 8500; id < 9500; ++id) {
+			const ai::AIPtr& ai = std::make_shared<ai::AI>(node);
+			ai->setCharacter(std::make_shared<TestEntity>(id));
+			zone.addAI(ai);
+			ais.push_back(ai);
+		}
+		zone.update(1l);
+		zone.update(1l);
+		zone.executeParallel([&] (const ai::AIPtr& ai) {
+			filter->filter(ai);
+		});
+		for (const ai::AIPtr& ai : ais) {
+			results.push_back((int)node->getLastStatus(ai));
+			const ai::FilteredEntities& filtered = ai->getFilteredEntities();
+			results.push_back((int)filtered.size());
+			results.insert(results.end(), filtered.begin(), filtered.end());
+		}
+		zone.removeAIs(ais);
+		zone.update(1l);
+		for (int i = 0; i < registry.getLuaStateCount(); ++i) {
+			lua_gc(registry.getLuaState(i), LUA_GCCOLLECT, 0);
+		}
+		return results;
+	}
 };
 
 std::string LUAAIRegistryTest::_luaCode;
@@ -145,3 +190,19 @@ TEST_F(LUAAIRegistryTest, testFilter_100) {
 TEST_F(LUAAIRegistryTest, testSteeringEmpty) {
 	testSteering("LuaSteeringTest");
 }
+
+TEST_F(LUAAIRegistryTest, testMultipleStates) {
+	ai::LUAAIRegistry registry(4);
+	ASSERT_EQ(4, registry.getLuaStateCount());
+	ASSERT_TRUE(registry.evaluate(_luaCode)) << "Failed to load lua script into all states";
+	const std::vector<int>& expected = tickZone(_registry);
+	// status, amount of filtered entities and the three filtered entities for the ids 8500 to 9499
+	ASSERT_EQ(5u * 1000u, expected.size());
+	EXPECT_EQ(ai::TreeNodeStatus::FINISHED, expected[0]) << "Unexpected status for 8500";
+	EXPECT_EQ(8500, expected[4]) << "Unexpected filtered entity for 8500";
+	EXPECT_EQ(ai::TreeNodeStatus::RUNNING, expected[5]) << "Unexpected status for 8501";
+	EXPECT_EQ(8501, expected[9]) << "Unexpected filtered entity for 8501";
+	EXPECT_EQ(ai::TreeNodeStatus::CANNOTEXECUTE, expected[5 * 999]) << "Unexpected status for 9499";
+	EXPECT_EQ(expected, tickZone(registry)) << "Different results with one and with several lua states";
+	registry.shutdown();
+}
@@ -112,3 +112,86 @@ TEST_F(MessageTest, testIProtocolMessageReset) {
 	ai::IProtocolMessage* d = serializeDeserialize(m);
 	ASSERT_EQ(m.getId(), d->getId());
 }
+
+TEST_F(MessageTest, testAIStreamModeMessage) {
+	const ai::AIStreamMode mode(true, 100, -10.0f, -20.0f, 10.0f, 20.0f);
+	ai::AIStreamModeMessage m(mode);
+	ai::AIStreamModeMessage* d = serializeDeserialize(m);
+	ASSERT_EQ(m.getId(), d->getId());
+	ASSERT_TRUE(d->getMode().delta);
+	ASSERT_EQ(100, d->getMode().updateMillis);
+	ASSERT_TRUE(d->getMode().hasViewRect());
+	ASSERT_TRUE(d->getMode().isInView(glm::vec3(5.0f, 100.0f, -15.0f)));
+	ASSERT_FALSE(d->getMode().isInView(glm::vec3(11.0f, 0.0f, 0.0f)));
+	ASSERT_FALSE(ai::AIStreamMode().hasViewRect());
+}
+
+TEST_F(MessageTest, testAIStateDeltaMessage) {
+	ai::AIStateDeltaMessage m;
+	ai::AIStateDelta& full = m.addDelta(1, ai::AIStateDelta::DELTA_FULL);
+	full.position = glm::vec3(1.0f, 2.0f, 3.0f);
+	full.orientation = 0.5f;
+	full.attributes["Name"] = "Test";
+	ai::AIStateDelta& changed = m.addDelta(2, ai::AIStateDelta::DELTA_ATTRIBUTES);
+	changed.attributes["Health"] = "10";
+	changed.removedAttributes.push_back("Name");
+	m.addRemoved(3);
+
+	ai::AIStateDeltaMessage* d = serializeDeserialize(m);
+	ASSERT_EQ(m.getId(), d->getId());
+	ASSERT_EQ(2u, d->getDeltas().size());
+	ASSERT_EQ(1u, d->getRemoved().size());
+	ASSERT_EQ(3, d->getRemoved()[0]);
+
+	ai::AIStateWorld state1;
+	d->getDeltas()[0].apply(state1);
+	ASSERT_EQ(1, state1.getId());
+	ASSERT_EQ(glm::vec3(1.0f, 2.0f, 3.0f), state1.getPosition());
+	ASSERT_FLOAT_EQ(0.5f, state1.getOrientation());
+	ASSERT_EQ("Test", state1.getAttributes().find("Name")->second);
+
+	ai::CharacterAttributes attributes;
+	attributes["Name"] = "Other";
+	ai::AIStateWorld state2(2, glm::vec3(4.0f), 1.0f, attributes);
+	d->getDeltas()[1].apply(state2);
+	ASSERT_EQ(glm::vec3(4.0f), state2.getPosition()) << "Position was not flagged as changed";
+	ASSERT_FLOAT_EQ(1.0f, state2.getOrientation());
+	ASSERT_EQ(1u, state2.getAttributes().size());
+	ASSERT_EQ("10", state2.getAttributes().find("Health")->second);
+}
+
+TEST_F(MessageTest, testAIStateBaseline) {
+	ai::CharacterAttributes attributes;
+	attributes["Name"] = "Test";
+	std::vector<ai::AIStateWorld> states;
+	states.emplace_back(1, glm::vec3(0.0f), 0.0f, attributes);
+	states.emplace_back(2, glm::vec3(100.0f, 0.0f, 100.0f), 0.0f, attributes);
+
+	ai::AIStateBaseline baseline;
+	ai::AIStateDeltaMessage msg;
+	const ai::AIStreamMode mode(true, 0);
+	ASSERT_TRUE(baseline.update(states, mode, msg));
+	ASSERT_EQ(2u, msg.getDeltas().size());
+	ASSERT_EQ(ai::AIStateDelta::DELTA_FULL, msg.getDeltas()[0].flags);
+
+	ASSERT_FALSE(baseline.update(states, mode, msg)) << "Nothing changed, nothing should be sent";
+
+	states[0].setPosition(glm::vec3(1.0f, 0.0f, 0.0f));
+	states[1].getAttributes()["Health"] = "10";
+	ASSERT_TRUE(baseline.update(states, mode, msg));
+	ASSERT_EQ(2u, msg.getDeltas().size());
+	ASSERT_EQ(ai::AIStateDelta::DELTA_POSITION, msg.getDeltas()[0].flags);
+	ASSERT_EQ(ai::AIStateDelta::DELTA_ATTRIBUTES, msg.getDeltas()[1].flags);
+	ASSERT_EQ(1u, msg.getDeltas()[1].attributes.size()) << "Only the changed attribute should be sent";
+
+	states.pop_back();
+	ASSERT_TRUE(baseline.update(states, mode, msg));
+	ASSERT_TRUE(msg.getDeltas().empty());
+	ASSERT_EQ(1u, msg.getRemoved().size());
+	ASSERT_EQ(2, msg.getRemoved()[0]);
+
+	const ai::AIStreamMode viewMode(true, 0, 10.0f, 10.0f, 20.0f, 20.0f);
+	ASSERT_TRUE(baseline.update(states, viewMode, msg));
+	ASSERT_EQ(1u, msg.getRemoved().size()) << "Characters that left the view should be removed";
+	ASSERT_EQ(0u, baseline.size());
+}
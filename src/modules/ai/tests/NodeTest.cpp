@@ -17,6 +17,7 @@ TEST_F(NodeTest, testSequence) {
 	node->addChild(idle1);
 	node->addChild(idle2);
 
+	node->assignIndices();
 	ai::AIPtr ai(new ai::AI(node));
 	ai::ICharacterPtr chr(new ai::ICharacter(1));
 	ai->setCharacter(chr);
@@ -50,6 +51,7 @@ TEST_F(NodeTest, testIdle) {
 	ai::Idle::Factory f;
 	ai::TreeNodeFactoryContext ctx("testidle", "1000", ai::True::get());
 	ai::TreeNodePtr node = f.create(&ctx);
+	node->assignIndices();
 	ai::AIPtr entity(new ai::AI(node));
 	ai::ICharacterPtr chr(new ai::ICharacter(1));
 	entity->setCharacter(chr);
@@ -71,6 +73,7 @@ TEST_F(NodeTest, testParallel) {
 	node->addChild(idle1);
 	node->addChild(idle2);
 
+	node->assignIndices();
 	ai::AIPtr e(new ai::AI(node));
 	ai::ICharacterPtr chr(new ai::ICharacter(1));
 	e->setCharacter(chr);
@@ -102,6 +105,7 @@ TEST_F(NodeTest, testPrioritySelector) {
 	node->addChild(idle1);
 	node->addChild(idle2);
 
+	node->assignIndices();
 	ai::AIPtr e(new ai::AI(node));
 	ai::ICharacterPtr chr(new ai::ICharacter(1));
 	e->setCharacter(chr);
@@ -133,6 +137,7 @@ TEST_F(NodeTest, testPrioritySelectorWithCondition) {
 	node->addChild(idle1);
 	node->addChild(idle2);
 
+	node->assignIndices();
 	ai::AIPtr e(new ai::AI(node));
 	ai::ICharacterPtr chr(new ai::ICharacter(1));
 	e->setCharacter(chr);
@@ -149,3 +154,35 @@ TEST_F(NodeTest, testPrioritySelectorWithCondition) {
 	ASSERT_EQ(ai::CANNOTEXECUTE, idle1->getLastStatus(e));
 	ASSERT_EQ(ai::FINISHED, idle2->getLastStatus(e));
 }
+
+TEST_F(NodeTest, testAssignIndices) {
+	ai::TreeNodePtr root = std::make_shared<ai::Sequence>("root", "", ai::True::get());
+	ai::TreeNodePtr child1 = std::make_shared<ai::TreeNode>("child1", "", ai::True::get());
+	ai::TreeNodePtr child2 = std::make_shared<ai::TreeNode>("child2", "", ai::True::get());
+	root->addChild(child1);
+	ASSERT_EQ(-1, root->getIndex());
+	root->assignIndices();
+	EXPECT_EQ(0, root->getIndex());
+	EXPECT_EQ(1, child1->getIndex());
+	EXPECT_EQ(2, root->getIndexCount());
+
+	ai::AIPtr ai = std::make_shared<ai::AI>(root);
+	ai->setCharacter(std::make_shared<ai::ICharacter>(1));
+	ai->update(1, true);
+	root->execute(ai, 1);
+	ASSERT_EQ(ai::FINISHED, child1->getLastStatus(ai));
+
+	// extend the tree after the ai was created - the states of the unindexed node must still work
+	root->addChild(child2);
+	ai->update(1, true);
+	root->execute(ai, 1);
+	ASSERT_EQ(ai::FINISHED, child2->getLastStatus(ai));
+
+	root->assignIndices();
+	EXPECT_EQ(1, child1->getIndex()) << "Already assigned indices must not change";
+	EXPECT_EQ(2, child2->getIndex());
+	EXPECT_EQ(3, root->getIndexCount());
+	ai->update(1, true);
+	root->execute(ai, 1);
+	ASSERT_EQ(ai::FINISHED, child2->getLastStatus(ai));
+}
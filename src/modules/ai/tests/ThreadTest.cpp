@@ -23,3 +23,20 @@ TEST_F(ThreadTest, testThreadScheduler_schedule) {
 	std::this_thread::sleep_for(std::chrono::milliseconds(100));
 	ASSERT_EQ(1, countExecutionOnce);
 }
+
+TEST_F(ThreadTest, testParallelFor) {
+	ai::ThreadPool pool(4);
+	const size_t n = 10000;
+	std::vector<std::atomic_int> visited(n);
+	for (std::atomic_int& v : visited) {
+		v = 0;
+	}
+	ai::parallelFor(pool, n, [&] (size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			++visited[i];
+		}
+	}, 16u);
+	for (size_t i = 0; i < n; ++i) {
+		ASSERT_EQ(1, visited[i].load()) << "Element " << i << " was not visited exactly once";
+	}
+}
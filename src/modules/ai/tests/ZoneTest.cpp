@@ -6,6 +6,7 @@ class ZoneTest: public TestSuite {
 TEST_F(ZoneTest, testChanges) {
 	ai::Zone zone("test1");
 	ai::TreeNodePtr root = std::make_shared<ai::PrioritySelector>("test", "", ai::True::get());
+	root->assignIndices();
 	ai::ICharacterPtr character = std::make_shared<TestEntity>(1);
 	ai::AIPtr ai = std::make_shared<ai::AI>(root);
 	ai->setCharacter(character);
@@ -32,6 +33,7 @@ TEST_F(ZoneTest, testChanges) {
 TEST_F(ZoneTest, testMassAdd1000000) {
 	ai::Zone zone("test1");
 	ai::TreeNodePtr root = std::make_shared<ai::PrioritySelector>("test", "", ai::True::get());
+	root->assignIndices();
 	const int n = 1000000;
 	for (int i = 0; i < n; ++i) {
 		ai::ICharacterPtr character = std::make_shared<TestEntity>(i);
@@ -42,3 +44,154 @@ TEST_F(ZoneTest, testMassAdd1000000) {
 	zone.update(0l);
 	ASSERT_EQ(n, (int)zone.size());
 }
+
+TEST_F(ZoneTest, testRemoveKeepsOthers) {
+	ai::Zone zone("test1");
+	ai::TreeNodePtr root = std::make_shared<ai::PrioritySelector>("test", "", ai::True::get());
+	root->assignIndices();
+	std::vector<ai::AIPtr> ais;
+	for (int i = 0; i < 5; ++i) {
+		ai::ICharacterPtr character = std::make_shared<TestEntity>(i);
+		ai::AIPtr ai = std::make_shared<ai::AI>(root);
+		ai->setCharacter(character);
+		ASSERT_TRUE(zone.addAI(ai)) << "Could not add ai to the zone";
+		ais.push_back(ai);
+	}
+	zone.update(0l);
+	ASSERT_EQ(5u, zone.size());
+	ASSERT_TRUE(zone.removeAI(ais[1]));
+	ASSERT_TRUE(zone.destroyAI(0));
+	zone.update(0l);
+	ASSERT_EQ(3u, zone.size());
+	EXPECT_FALSE(zone.getAI(0));
+	EXPECT_FALSE(zone.getAI(1));
+	EXPECT_EQ(nullptr, ais[1]->getZone());
+	for (int i = 2; i < 5; ++i) {
+		EXPECT_EQ(ais[i], zone.getAI(i)) << "Lookup for " << i << " failed after removal";
+	}
+	int visited = 0;
+	zone.execute([&] (const ai::AIPtr& ai) {
+		++visited;
+	});
+	EXPECT_EQ(3, visited);
+}
+
+TEST_F(ZoneTest, testExecuteParallel) {
+	ai::Zone zone("test1", 4);
+	ai::TreeNodePtr root = std::make_shared<ai::PrioritySelector>("test", "", ai::True::get());
+	root->assignIndices();
+	const int n = 10000;
+	for (int i = 0; i < n; ++i) {
+		ai::ICharacterPtr character = std::make_shared<TestEntity>(i);
+		ai::AIPtr ai = std::make_shared<ai::AI>(root);
+		ai->setCharacter(character);
+		ASSERT_TRUE(zone.addAI(ai)) << "Could not add ai to the zone";
+	}
+	zone.update(0l);
+	std::atomic_int visited(0);
+	zone.executeParallel([&] (const ai::AIPtr& ai) {
+		++visited;
+	});
+	EXPECT_EQ(n, visited.load());
+}
+
+TEST_F(ZoneTest, testScheduleBetweenTicks) {
+	ai::Zone zone("test1", 4);
+	ai::TreeNodePtr root = std::make_shared<ai::PrioritySelector>("test", "", ai::True::get());
+	root->assignIndices();
+	ai::ICharacterPtr character = std::make_shared<TestEntity>(1);
+	ai::AIPtr ai = std::make_shared<ai::AI>(root);
+	ai->setCharacter(character);
+	ASSERT_TRUE(zone.addAI(ai)) << "Could not add ai to the zone";
+	int executed = 0;
+	ai::TreeNodeStatus status = ai::TreeNodeStatus::FINISHED;
+	ASSERT_TRUE(zone.scheduleBetweenTicks([&] () {
+		++executed;
+		// the scheduled add is already done - but the ai wasn't ticked yet
+		EXPECT_EQ(1u, zone.size());
+		status = root->getLastStatus(ai);
+	}));
+	EXPECT_EQ(0, executed) << "The function must only be executed in the zone update";
+	zone.update(1l);
+	EXPECT_EQ(1, executed);
+	EXPECT_EQ(ai::TreeNodeStatus::UNKNOWN, status) << "The function was executed after the tick";
+	zone.update(1l);
+	EXPECT_EQ(1, executed) << "The function must only be executed once";
+}
+
+TEST_F(ZoneTest, testSpatialIndex) {
+	ai::Zone zone("test1");
+	zone.setSpatialIndex(4.0f);
+	ASSERT_TRUE(zone.hasSpatialIndex());
+	ai::TreeNodePtr root = std::make_shared<ai::PrioritySelector>("test", "", ai::True::get());
+	root->assignIndices();
+	std::vector<ai::AIPtr> ais;
+	for (int i = 0; i < 10; ++i) {
+		ai::ICharacterPtr character = std::make_shared<TestEntity>(i);
+		character->setPosition(glm::vec3(i * 1.5f, 0.0f, -2.0f));
+		ai::AIPtr ai = std::make_shared<ai::AI>(root);
+		ai->setCharacter(character);
+		ASSERT_TRUE(zone.addAI(ai)) << "Could not add ai to the zone";
+		ais.push_back(ai);
+	}
+	zone.update(0l);
+
+	ai::Zone::CharacterIdList ids;
+	EXPECT_EQ(3u, zone.getAIsInRadius(glm::vec3(0.0f, 100.0f, -2.0f), 3.0f, ids)) << "The y axis should not be taken into account";
+	std::sort(ids.begin(), ids.end());
+	EXPECT_EQ(ai::Zone::CharacterIdList({0, 1, 2}), ids);
+
+	ids.clear();
+	EXPECT_EQ(2u, zone.getNearestAIs(glm::vec3(9.1f, 0.0f, -2.0f), 2u, ids));
+	EXPECT_EQ(ai::Zone::CharacterIdList({6, 7}), ids);
+
+	ids.clear();
+	EXPECT_EQ(10u, zone.getNearestAIs(glm::vec3(1000.0f, 0.0f, 1000.0f), 20u, ids));
+	EXPECT_EQ(9, ids.front());
+	EXPECT_EQ(0, ids.back());
+
+	// move across several cells and remove an entry
+	ais[0]->getCharacter()->setPosition(glm::vec3(100.0f, 0.0f, 100.0f));
+	ASSERT_TRUE(zone.removeAI(ais[1]));
+	zone.update(0l);
+	ids.clear();
+	EXPECT_EQ(1u, zone.getAIsInRadius(glm::vec3(0.0f, 0.0f, -2.0f), 3.0f, ids));
+	EXPECT_EQ(ai::Zone::CharacterIdList({2}), ids);
+	ids.clear();
+	EXPECT_EQ(1u, zone.getNearestAIs(glm::vec3(100.0f, 0.0f, 100.0f), 5u, ids, 10.0f));
+	EXPECT_EQ(ai::Zone::CharacterIdList({0}), ids);
+
+	// the brute force fallback must give the same results
+	zone.setSpatialIndex(0.0f);
+	ASSERT_FALSE(zone.hasSpatialIndex());
+	ids.clear();
+	EXPECT_EQ(1u, zone.getAIsInRadius(glm::vec3(0.0f, 0.0f, -2.0f), 3.0f, ids));
+	ids.clear();
+	EXPECT_EQ(2u, zone.getNearestAIs(glm::vec3(9.1f, 0.0f, -2.0f), 2u, ids));
+	EXPECT_EQ(ai::Zone::CharacterIdList({6, 7}), ids);
+}
+
+TEST_F(ZoneTest, testSelectZoneRadius) {
+	ai::Zone zone("test1");
+	zone.setSpatialIndex(8.0f);
+	ai::TreeNodePtr root = std::make_shared<ai::PrioritySelector>("test", "", ai::True::get());
+	root->assignIndices();
+	std::vector<ai::AIPtr> ais;
+	for (int i = 0; i < 5; ++i) {
+		ai::ICharacterPtr character = std::make_shared<TestEntity>(i);
+		character->setPosition(glm::vec3(i * 10.0f, 0.0f, 0.0f));
+		ai::AIPtr ai = std::make_shared<ai::AI>(root);
+		ai->setCharacter(character);
+		ASSERT_TRUE(zone.addAI(ai)) << "Could not add ai to the zone";
+		ais.push_back(ai);
+	}
+	zone.update(0l);
+	ai::SelectZone all;
+	all.filter(ais[0]);
+	EXPECT_EQ(5u, ais[0]->getFilteredEntities().size());
+	ai::SelectZone inRange("10");
+	inRange.filter(ais[2]);
+	ai::FilteredEntities selection = ais[2]->getFilteredEntities();
+	std::sort(selection.begin(), selection.end());
+	EXPECT_EQ(ai::FilteredEntities({1, 2, 3}), selection);
+}
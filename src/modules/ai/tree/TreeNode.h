@@ -96,6 +96,16 @@ protected:
 	 * @brief Every node has an id to identify it. It's unique per type.
 	 */
 	int _id;
+	/**
+	 * @brief Dense index of the node in its behaviour tree. The @c AI stores the node states in
+	 * arrays that are indexed by this. @c -1 if the node wasn't indexed yet.
+	 * @sa assignIndices()
+	 */
+	int _index = -1;
+	/**
+	 * @brief The amount of indices that were handed out in the tree this node is the root of
+	 */
+	int _indexCount = 0;
 	TreeNodes _children;
 	std::string _name;
 	std::string _type;
@@ -110,6 +120,8 @@ protected:
 	void setLastExecMillis(const AIPtr& entity);
 
 	TreeNodePtr getParent_r(const TreeNodePtr& parent, int id) const;
+	int getMaxIndex_r() const;
+	void assignIndices_r(int& nextIndex);
 
 public:
 	/**
@@ -128,6 +140,20 @@ public:
 	 * @return unique id
 	 */
 	int getId() const;
+	/**
+	 * @return The index of this node in its behaviour tree or @c -1 if the node wasn't indexed yet
+	 */
+	int getIndex() const;
+	/**
+	 * @return The amount of indices that were handed out by assignIndices() in the tree this node is the root of
+	 */
+	int getIndexCount() const;
+	/**
+	 * @brief Hands out dense indices to the nodes of the tree this node is the root of. Nodes that already
+	 * have an index keep it - so this can be called again after the tree was modified.
+	 * @note A node must only be part of one tree, and this must not be called while the tree is executed.
+	 */
+	void assignIndices();
 
 	/**
 	 * @brief Each node can have a user defines name that can be retrieved with this method.
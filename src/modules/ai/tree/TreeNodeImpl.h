@@ -12,6 +12,39 @@ inline int TreeNode::getId() const {
 	return _id;
 }
 
+inline int TreeNode::getIndex() const {
+	return _index;
+}
+
+inline int TreeNode::getIndexCount() const {
+	return _indexCount;
+}
+
+inline int TreeNode::getMaxIndex_r() const {
+	int maxIndex = _index;
+	for (const TreeNodePtr& child : _children) {
+		maxIndex = std::max(maxIndex, child->getMaxIndex_r());
+	}
+	return maxIndex;
+}
+
+inline void TreeNode::assignIndices_r(int& nextIndex) {
+	if (_index < 0) {
+		_index = nextIndex++;
+	}
+	for (const TreeNodePtr& child : _children) {
+		child->assignIndices_r(nextIndex);
+	}
+}
+
+inline void TreeNode::assignIndices() {
+	// start after the highest index that is already in use - nodes might have been moved
+	// over from another root (e.g. if the root node was replaced)
+	int nextIndex = getMaxIndex_r() + 1;
+	assignIndices_r(nextIndex);
+	_indexCount = nextIndex;
+}
+
 inline void TreeNode::setName(const std::string& name) {
 	if (name.empty()) {
 		return;
@@ -69,38 +102,38 @@ inline void TreeNode::setLastExecMillis(const AIPtr& entity) {
 	if (!entity->_debuggingActive) {
 		return;
 	}
-	entity->_lastExecMillis[getId()] = entity->_time;
+	entity->getNodeState(*this).lastExecMillis = entity->_time;
 }
 
 inline int TreeNode::getSelectorState(const AIPtr& entity) const {
-	AI::SelectorStates::const_iterator i = entity->_selectorStates.find(getId());
-	if (i == entity->_selectorStates.end()) {
+	const AI::NodeState* nodeState = entity->findNodeState(*this);
+	if (nodeState == nullptr) {
 		return AI_NOTHING_SELECTED;
 	}
-	return i->second;
+	return nodeState->selectorState;
 }
 
 inline void TreeNode::setSelectorState(const AIPtr& entity, int selected) {
-	entity->_selectorStates[getId()] = selected;
+	entity->getNodeState(*this).selectorState = selected;
 }
 
 inline int TreeNode::getLimitState(const AIPtr& entity) const {
-	AI::LimitStates::const_iterator i = entity->_limitStates.find(getId());
-	if (i == entity->_limitStates.end()) {
+	const AI::NodeState* nodeState = entity->findNodeState(*this);
+	if (nodeState == nullptr) {
 		return 0;
 	}
-	return i->second;
+	return nodeState->limitState;
 }
 
 inline void TreeNode::setLimitState(const AIPtr& entity, int amount) {
-	entity->_limitStates[getId()] = amount;
+	entity->getNodeState(*this).limitState = amount;
 }
 
 inline TreeNodeStatus TreeNode::state(const AIPtr& entity, TreeNodeStatus treeNodeState) {
 	if (!entity->_debuggingActive) {
 		return treeNodeState;
 	}
-	entity->_lastStatus[getId()] = treeNodeState;
+	entity->getNodeState(*this).lastStatus = treeNodeState;
 	return treeNodeState;
 }
 
@@ -108,22 +141,22 @@ inline int64_t TreeNode::getLastExecMillis(const AIPtr& entity) const {
 	if (!entity->_debuggingActive) {
 		return -1L;
 	}
-	AI::LastExecMap::const_iterator i = entity->_lastExecMillis.find(getId());
-	if (i == entity->_lastExecMillis.end()) {
+	const AI::NodeState* nodeState = entity->findNodeState(*this);
+	if (nodeState == nullptr) {
 		return -1L;
 	}
-	return i->second;
+	return nodeState->lastExecMillis;
 }
 
 inline TreeNodeStatus TreeNode::getLastStatus(const AIPtr& entity) const {
 	if (!entity->_debuggingActive) {
 		return UNKNOWN;
 	}
-	AI::NodeStates::const_iterator i = entity->_lastStatus.find(getId());
-	if (i == entity->_lastStatus.end()) {
+	const AI::NodeState* nodeState = entity->findNodeState(*this);
+	if (nodeState == nullptr) {
 		return UNKNOWN;
 	}
-	return i->second;
+	return nodeState->lastStatus;
 }
 
 inline TreeNodePtr TreeNode::getChild(int id) const {
@@ -306,8 +306,12 @@ public:
 
 		bool empty;
 		{
-			ScopedReadLock scopedLock(_lock);
+			ScopedWriteLock scopedLock(_lock);
 			empty = _treeMap.empty();
+			// the trees are complete now - hand out the node indices for the per node states of the ai instances
+			for (auto& e : _treeMap) {
+				e.second->assignIndices();
+			}
 		}
 		if (empty) {
 			setError("No behaviour trees specified");
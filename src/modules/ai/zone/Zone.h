@@ -17,11 +17,16 @@
 #include "group/GroupMgr.h"
 #include "common/Thread.h"
 #include "common/ThreadPool.h"
+#include "common/ParallelFor.h"
+#include "common/SpatialGrid.h"
 #include "common/Types.h"
 #include "common/ExecutionTime.h"
 #include <unordered_map>
 #include <vector>
+#include <functional>
 #include <memory>
+#include <algorithm>
+#include <limits>
 
 namespace ai {
 
@@ -39,18 +44,35 @@ typedef std::shared_ptr<AI> AIPtr;
  */
 class Zone {
 public:
-	typedef std::unordered_map<CharacterId, AIPtr> AIMap;
+	typedef std::vector<AIPtr> AIList;
+	typedef std::shared_ptr<AIList> AIListPtr;
 	typedef std::vector<AIPtr> AIScheduleList;
 	typedef std::vector<CharacterId> CharacterIdList;
-	typedef AIMap::const_iterator AIMapConstIter;
-	typedef AIMap::iterator AIMapIter;
+	typedef std::unordered_map<CharacterId, size_t> AIIndexMap;
+	typedef std::shared_ptr<SpatialGrid> SpatialGridPtr;
+	typedef std::function<void()> ScheduledFunc;
 
 protected:
 	const std::string _name;
-	AIMap _ais;
+	/**
+	 * The dense list of all @c AI instances - removals are done by swapping with the last entry.
+	 * The list is only modified in @c Zone::update. Iterating it doesn't need a copy - see @c getAIs().
+	 */
+	AIListPtr _ais;
+	// the character ids of the entries in _ais
+	CharacterIdList _ids;
+	// character id => index in _ais
+	AIIndexMap _aiIndex;
+	/**
+	 * The optional spatial index for the radius queries. The positions are synced once per @c Zone::update
+	 * before the @c AI instances are ticked - so all queries of one tick see the same positions. Like
+	 * the @c AI list, the grid is copied on write if a query still uses the old one.
+	 */
+	SpatialGridPtr _grid;
 	AIScheduleList _scheduledAdd;
 	AIScheduleList _scheduledRemove;
 	CharacterIdList _scheduledDestroy;
+	std::vector<ScheduledFunc> _scheduledFuncs;
 	bool _debug;
 	ReadWriteLock _lock {"zone"};
 	ReadWriteLock _scheduleLock {"zone-schedulelock"};
@@ -76,10 +98,44 @@ protected:
 	 * @note This doesn't lock the zone - but because @c Zone::update already does it
 	 */
 	bool doDestroyAI(const CharacterId& id);
+	/**
+	 * @brief Swap removes the entry at the given position
+	 * @note This doesn't lock the zone - but because @c Zone::update already does it
+	 */
+	void eraseAI(AIIndexMap::iterator i);
+	/**
+	 * @brief The list that can get modified. If someone else is still iterating the current list, it is copied first.
+	 * @note This doesn't lock the zone - but because @c Zone::update already does it
+	 */
+	AIList& mutableAIs();
+	/**
+	 * @note This doesn't lock the zone - but because @c Zone::update already does it
+	 */
+	SpatialGrid* mutableGrid();
+	/**
+	 * @brief Moves the grid entries of all @c AI instances whose @c ICharacter left their cell
+	 * @note This doesn't lock the zone - but because @c Zone::update already does it
+	 */
+	void updateGrid();
+
+	inline SpatialGridPtr getGrid() const {
+		ScopedReadLock scopedLock(_lock);
+		return _grid;
+	}
+
+	/**
+	 * @return The current list of @c AI instances. Adding or removing @c AI instances in @c Zone::update
+	 * doesn't modify the returned list - so it can be iterated without holding the lock.
+	 * @note This locks the zone for reading
+	 */
+	inline AIListPtr getAIs() const {
+		ScopedReadLock scopedLock(_lock);
+		return _ais;
+	}
 
 public:
-	Zone(const std::string& name, int threadCount = std::min(1u, std::thread::hardware_concurrency())) :
-			_name(name), _debug(false), _threadPool(threadCount) {
+	Zone(const std::string& name, int threadCount = std::max(1u, std::thread::hardware_concurrency())) :
+			_name(name), _ais(std::make_shared<AIList>()), _debug(false), _threadPool(threadCount) {
 	}
 
 	virtual ~Zone() {}
@@ -143,6 +199,16 @@ public:
 	 */
 	bool destroyAI(const CharacterId& id);
 
+	/**
+	 * @brief Executes the given function in the next @c Zone::update - after the scheduled adds and removals
+	 * and before the @c AI instances are ticked. Use this to modify data that the ticks read without any
+	 * locking - e.g. the behaviour tree that is shared by the @c AI instances.
+	 *
+	 * @note This does not lock the zone for writing but a dedicated schedule lock. The function itself is
+	 * called without holding any zone lock.
+	 */
+	bool scheduleBetweenTicks(const ScheduledFunc& func);
+
 	/**
 	 * @brief Every zone has its own name that identifies it
 	 */
@@ -161,6 +227,36 @@ public:
 
 	const GroupMgr& getGroupMgr() const;
 
+	/**
+	 * @brief Enables the spatial index for the radius and nearest neighbour queries.
+	 *
+	 * Without the index, every query has to check all the @c AI instances of the zone.
+	 *
+	 * @param[in] cellSize The edge length of one grid cell - this should be in the range of the
+	 * usual query radius. A value <= @c 0 disables the index again.
+	 * @note The positions are synced with the @c ICharacter positions in each @c Zone::update
+	 * @note This locks the zone for writing - don't call it from within the @c AI tick
+	 */
+	void setSpatialIndex(float cellSize);
+	bool hasSpatialIndex() const;
+
+	/**
+	 * @brief Appends the ids of all the @c AI instances that are within the given radius on the x/z
+	 * plane around @c center to @c out
+	 * @return The amount of appended ids
+	 * @note This locks the zone for reading to get the current grid or @c AI list
+	 */
+	size_t getAIsInRadius(const glm::vec3& center, float radius, CharacterIdList& out) const;
+
+	/**
+	 * @brief Appends the ids of the @c k nearest @c AI instances (on the x/z plane) to @c out, the nearest first
+	 * @param[in] maxRadius Only consider @c AI instances within this radius
+	 * @return The amount of appended ids
+	 * @note This locks the zone for reading to get the current grid or @c AI list
+	 */
+	size_t getNearestAIs(const glm::vec3& center, size_t k, CharacterIdList& out,
+			float maxRadius = std::numeric_limits<float>::max()) const;
+
 	/**
 	 * @brief Lookup for a particular @c AI in the zone.
 	 *
@@ -170,12 +266,11 @@ public:
 	 */
 	inline AIPtr getAI(CharacterId id) const {
 		ScopedReadLock scopedLock(_lock);
-		auto i = _ais.find(id);
-		if (i == _ais.end()) {
+		auto i = _aiIndex.find(id);
+		if (i == _aiIndex.end()) {
 			return AIPtr();
 		}
-		const AIPtr& ai = i->second;
-		return ai;
+		return (*_ais)[i->second];
 	}
 
 	/**
@@ -249,61 +344,48 @@ public:
 
 	/**
 	 * @brief Executes a lambda or functor for all the @c AI instances in this zone
-	 * @note This is executed in a thread pool - so make sure to synchronize your lambda or functor.
+	 * @note This is executed in batches in the thread pool - so make sure to synchronize your lambda or functor.
 	 * We are waiting for the execution of this.
 	 *
-	 * @note This locks the zone for reading
+	 * @note This locks the zone for reading to get the current list of @c AI instances
 	 */
 	template<typename Func>
 	void executeParallel(Func& func) {
-		std::vector<std::future<void> > results;
-		_lock.lockRead();
-		AIMap copy(_ais);
-		_lock.unlockRead();
-		for (auto i = copy.begin(); i != _ais.end(); ++i) {
-			const AIPtr& ai = i->second;
-			results.emplace_back(executeAsync(ai, func));
-		}
-		for (auto & result: results) {
-			result.wait();
-		}
+		const AIListPtr ais = getAIs();
+		parallelFor(_threadPool, ais->size(), [&] (size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				func((*ais)[i]);
+			}
+		});
 	}
 
 	/**
 	 * @brief Executes a lambda or functor for all the @c AI instances in this zone.
-	 * @note This is executed in a thread pool - so make sure to synchronize your lambda or functor.
+	 * @note This is executed in batches in the thread pool - so make sure to synchronize your lambda or functor.
 	 * We are waiting for the execution of this.
 	 *
-	 * @note This locks the zone for reading
+	 * @note This locks the zone for reading to get the current list of @c AI instances
 	 */
 	template<typename Func>
 	void executeParallel(const Func& func) const {
-		std::vector<std::future<void> > results;
-		_lock.lockRead();
-		AIMap copy(_ais);
-		_lock.unlockRead();
-		for (auto i = copy.begin(); i != copy.end(); ++i) {
-			const AIPtr& ai = i->second;
-			results.emplace_back(executeAsync(ai, func));
-		}
-		for (auto & result: results) {
-			result.wait();
-		}
+		const AIListPtr ais = getAIs();
+		parallelFor(_threadPool, ais->size(), [&] (size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				func((*ais)[i]);
+			}
+		});
 	}
 
 	/**
 	 * @brief Executes a lambda or functor for all the @c AI instances in this zone
 	 * We are waiting for the execution of this.
 	 *
-	 * @note This locks the zone for reading
+	 * @note This locks the zone for reading to get the current list of @c AI instances
 	 */
 	template<typename Func>
 	void execute(const Func& func) const {
-		_lock.lockRead();
-		AIMap copy(_ais);
-		_lock.unlockRead();
-		for (auto i = copy.begin(); i != copy.end(); ++i) {
-			const AIPtr& ai = i->second;
+		const AIListPtr ais = getAIs();
+		for (const AIPtr& ai : *ais) {
 			func(ai);
 		}
 	}
@@ -312,22 +394,19 @@ public:
 	 * @brief Executes a lambda or functor for all the @c AI instances in this zone
 	 * We are waiting for the execution of this.
 	 *
-	 * @note This locks the zone for reading
+	 * @note This locks the zone for reading to get the current list of @c AI instances
 	 */
 	template<typename Func>
 	void execute(Func& func) {
-		_lock.lockRead();
-		AIMap copy(_ais);
-		_lock.unlockRead();
-		for (auto i = copy.begin(); i != copy.end(); ++i) {
-			const AIPtr& ai = i->second;
+		const AIListPtr ais = getAIs();
+		for (const AIPtr& ai : *ais) {
 			func(ai);
 		}
 	}
 
 	inline std::size_t size() const {
 		ScopedReadLock scopedLock(_lock);
-		return _ais.size();
+		return _ais->size();
 	}
 };
 
@@ -351,15 +430,146 @@ inline const GroupMgr& Zone::getGroupMgr() const {
 	return _groupManager;
 }
 
+inline Zone::AIList& Zone::mutableAIs() {
+	// someone still iterates the current list
+	if (_ais.use_count() > 1) {
+		_ais = std::make_shared<AIList>(*_ais);
+	}
+	return *_ais;
+}
+
+inline bool Zone::hasSpatialIndex() const {
+	ScopedReadLock scopedLock(_lock);
+	return (bool)_grid;
+}
+
+inline SpatialGrid* Zone::mutableGrid() {
+	if (!_grid) {
+		return nullptr;
+	}
+	// someone still queries the current grid
+	if (_grid.use_count() > 1) {
+		_grid = std::make_shared<SpatialGrid>(*_grid);
+	}
+	return _grid.get();
+}
+
+inline void Zone::updateGrid() {
+	SpatialGrid* grid = mutableGrid();
+	if (grid == nullptr) {
+		return;
+	}
+	const AIList& ais = *_ais;
+	const size_t n = ais.size();
+	for (size_t i = 0; i < n; ++i) {
+		grid->update(_ids[i], ais[i]->getCharacter()->getPosition());
+	}
+}
+
+inline void Zone::setSpatialIndex(float cellSize) {
+	ScopedWriteLock scopedLock(_lock);
+	if (cellSize <= 0.0f) {
+		_grid.reset();
+		return;
+	}
+	_grid = std::make_shared<SpatialGrid>(cellSize);
+	updateGrid();
+}
+
+inline size_t Zone::getAIsInRadius(const glm::vec3& center, float radius, CharacterIdList& out) const {
+	const SpatialGridPtr grid = getGrid();
+	if (grid) {
+		return grid->visit(center, radius, [&] (const SpatialGrid::Entry& entry) {
+			out.push_back(entry.id);
+		});
+	}
+	const float radiusSquared = radius * radius;
+	const AIListPtr ais = getAIs();
+	size_t added = 0u;
+	for (const AIPtr& ai : *ais) {
+		const glm::vec3& position = ai->getCharacter()->getPosition();
+		const float dx = position.x - center.x;
+		const float dz = position.z - center.z;
+		if (dx * dx + dz * dz <= radiusSquared) {
+			out.push_back(ai->getId());
+			++added;
+		}
+	}
+	return added;
+}
+
+inline size_t Zone::getNearestAIs(const glm::vec3& center, size_t k, CharacterIdList& out, float maxRadius) const {
+	if (k == 0u) {
+		return 0u;
+	}
+	std::vector<std::pair<float, CharacterId> > candidates;
+	const SpatialGridPtr grid = getGrid();
+	if (grid) {
+		// grow the search radius until there are enough candidates - every entry that is nearer
+		// than the k-th candidate is within the radius, too.
+		float radius = std::min(grid->cellSize(), maxRadius);
+		for (;;) {
+			candidates.clear();
+			grid->visit(center, radius, [&] (const SpatialGrid::Entry& entry) {
+				const float dx = entry.position.x - center.x;
+				const float dz = entry.position.z - center.z;
+				candidates.emplace_back(dx * dx + dz * dz, entry.id);
+			});
+			if (candidates.size() >= k || candidates.size() == grid->size() || radius >= maxRadius) {
+				break;
+			}
+			radius = std::min(radius * 2.0f, maxRadius);
+		}
+	} else {
+		const float radiusSquared = maxRadius * maxRadius;
+		const AIListPtr ais = getAIs();
+		for (const AIPtr& ai : *ais) {
+			const glm::vec3& position = ai->getCharacter()->getPosition();
+			const float dx = position.x - center.x;
+			const float dz = position.z - center.z;
+			const float distanceSquared = dx * dx + dz * dz;
+			if (distanceSquared <= radiusSquared) {
+				candidates.emplace_back(distanceSquared, ai->getId());
+			}
+		}
+	}
+	const size_t n = std::min(k, candidates.size());
+	std::partial_sort(candidates.begin(), candidates.begin() + n, candidates.end());
+	for (size_t i = 0; i < n; ++i) {
+		out.push_back(candidates[i].second);
+	}
+	return n;
+}
+
+inline void Zone::eraseAI(AIIndexMap::iterator i) {
+	AIList& ais = mutableAIs();
+	const size_t index = i->second;
+	if (SpatialGrid* grid = mutableGrid()) {
+		grid->remove(_ids[index]);
+	}
+	const size_t last = ais.size() - 1;
+	if (index != last) {
+		ais[index] = std::move(ais[last]);
+		_ids[index] = _ids[last];
+		_aiIndex[_ids[index]] = index;
+	}
+	ais.pop_back();
+	_ids.pop_back();
+	_aiIndex.erase(i);
+}
+
 inline bool Zone::doAddAI(const AIPtr& ai) {
 	if (ai == nullptr) {
 		return false;
 	}
 	const CharacterId& id = ai->getCharacter()->getId();
-	if (_ais.find(id) != _ais.end()) {
+	if (_aiIndex.find(id) != _aiIndex.end()) {
 		return false;
 	}
-	_ais.insert(std::make_pair(id, ai));
+	AIList& ais = mutableAIs();
+	_aiIndex.emplace(id, ais.size());
+	ais.push_back(ai);
+	_ids.push_back(id);
 	ai->setZone(this);
 	return true;
 }
@@ -369,22 +579,23 @@ inline bool Zone::doRemoveAI(const AIPtr& ai) {
 		return false;
 	}
 	const CharacterId& id = ai->getCharacter()->getId();
-	AIMapIter i = _ais.find(id);
-	if (i == _ais.end()) {
+	AIIndexMap::iterator i = _aiIndex.find(id);
+	if (i == _aiIndex.end()) {
 		return false;
 	}
-	i->second->setZone(nullptr);
-	_groupManager.removeFromAllGroups(i->second);
-	_ais.erase(i);
+	const AIPtr& stored = (*_ais)[i->second];
+	stored->setZone(nullptr);
+	_groupManager.removeFromAllGroups(stored);
+	eraseAI(i);
 	return true;
 }
 
 inline bool Zone::doDestroyAI(const CharacterId& id) {
-	AIMapIter i = _ais.find(id);
-	if (i == _ais.end()) {
+	AIIndexMap::iterator i = _aiIndex.find(id);
+	if (i == _aiIndex.end()) {
 		return false;
 	}
-	_ais.erase(i);
+	eraseAI(i);
 	return true;
 }
 
@@ -412,21 +623,35 @@ inline bool Zone::removeAI(const AIPtr& ai) {
 	return true;
 }
 
+inline bool Zone::scheduleBetweenTicks(const ScheduledFunc& func) {
+	if (!func) {
+		return false;
+	}
+	ScopedWriteLock scopedLock(_scheduleLock);
+	_scheduledFuncs.push_back(func);
+	return true;
+}
+
 inline void Zone::update(int64_t dt) {
+	std::vector<ScheduledFunc> scheduledFuncs;
 	{
 		AIScheduleList scheduledRemove;
 		AIScheduleList scheduledAdd;
 		CharacterIdList scheduledDestroy;
 		{
 			ScopedWriteLock scopedLock(_scheduleLock);
-			scheduledAdd = _scheduledAdd;
-			scheduledRemove = _scheduledRemove;
-			scheduledDestroy = _scheduledDestroy;
-			_scheduledAdd.clear();
-			_scheduledRemove.clear();
-			_scheduledDestroy.clear();
+			scheduledAdd.swap(_scheduledAdd);
+			scheduledRemove.swap(_scheduledRemove);
+			scheduledDestroy.swap(_scheduledDestroy);
+			scheduledFuncs.swap(_scheduledFuncs);
 		}
 		ScopedWriteLock scopedLock(_lock);
+		if (!scheduledAdd.empty()) {
+			AIList& ais = mutableAIs();
+			ais.reserve(ais.size() + scheduledAdd.size());
+			_aiIndex.reserve(_aiIndex.size() + scheduledAdd.size());
+			_ids.reserve(_ids.size() + scheduledAdd.size());
+		}
 		for (const AIPtr& ai : scheduledAdd) {
 			doAddAI(ai);
 		}
@@ -436,6 +661,11 @@ inline void Zone::update(int64_t dt) {
 		for (auto id : scheduledDestroy) {
 			doDestroyAI(id);
 		}
+		updateGrid();
+	}
+	// no tick is running now - and the functions might use the locking methods of the zone
+	for (const ScheduledFunc& scheduledFunc : scheduledFuncs) {
+		scheduledFunc();
 	}
 
 	auto func = [&] (const AIPtr& ai) {
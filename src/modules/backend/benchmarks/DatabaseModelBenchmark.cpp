@@ -0,0 +1,85 @@
+/**
+ * @file
+ */
+
+#include <gtest/gtest.h>
+#include "core/tests/Benchmark.h"
+#include "core/GameConfig.h"
+#include "core/Var.h"
+#include "DatabaseModels.h"
+#include "persistence/ConnectionPool.h"
+
+namespace backend {
+
+class DatabaseModelBenchmark: public testing::Test {
+protected:
+	const int _rows = 2000;
+	const int _iterations = 5;
+
+	std::vector<::persistence::Model::Row> _insertRows;
+	std::vector<::persistence::Model::Row> _upsertRows;
+
+	void SetUp() override {
+		core::Var::get(cfg::DatabaseMinConnections, "1");
+		core::Var::get(cfg::DatabaseMaxConnections, "2");
+		core::Var::get(cfg::DatabaseName, "engine");
+		core::Var::get(cfg::DatabaseHost, "localhost");
+		core::Var::get(cfg::DatabaseUser, "engine");
+		core::Var::get(cfg::DatabasePassword, "engine");
+		core::Singleton<::persistence::ConnectionPool>::getInstance().init();
+		ASSERT_TRUE(persistence::UserStore::createTable()) << "Could not create table";
+
+		for (int i = 0; i < _rows; ++i) {
+			const std::string email = "user" + std::to_string(i) + "@b.c";
+			_insertRows.push_back({email, "secret", "now", "0"});
+			_upsertRows.push_back({email, "secret", "now", std::to_string(i + 1)});
+		}
+	}
+
+	void TearDown() override {
+		core::Singleton<::persistence::ConnectionPool>::getInstance().shutdown();
+	}
+
+	void print(double millis) const {
+		std::printf("[ BENCHMARK] %.0f rows/s\n", (double)_rows / millis * 1000.0);
+	}
+};
+
+// one statement per row as a reference value
+TEST_F(DatabaseModelBenchmark, testInsert) {
+	const double millis = core::measure("UserStore insert", _iterations, [&] () {
+		persistence::UserStore::truncate();
+		persistence::UserStore u;
+		for (const ::persistence::Model::Row& row : _insertRows) {
+			u.insert(row[0], row[1], ::persistence::Timestamp::now());
+		}
+	});
+	print(millis);
+}
+
+TEST_F(DatabaseModelBenchmark, testInsertMany) {
+	const double millis = core::measure("UserStore insertMany", _iterations, [&] () {
+		persistence::UserStore::truncate();
+		EXPECT_TRUE(persistence::UserStore::insertMany(_insertRows));
+	});
+	print(millis);
+}
+
+TEST_F(DatabaseModelBenchmark, testCopyMany) {
+	const double millis = core::measure("UserStore copyMany", _iterations, [&] () {
+		persistence::UserStore::truncate();
+		EXPECT_TRUE(persistence::UserStore::copyMany(_insertRows));
+	});
+	print(millis);
+}
+
+// the table is not truncated - every iteration after the first one updates all rows
+TEST_F(DatabaseModelBenchmark, testUpsertMany) {
+	persistence::UserStore::truncate();
+	const double millis = core::measure("UserStore upsertMany", _iterations, [&] () {
+		EXPECT_TRUE(persistence::UserStore::upsertMany(_upsertRows));
+	});
+	print(millis);
+}
+
+}
@@ -3,7 +3,6 @@
  */
 
 #include "Entity.h"
-#include "core/Set.h"
 #include "core/Common.h"
 #include "core/Frustum.h"
 
@@ -29,6 +28,9 @@ void Entity::visibleRemove(const EntitySet& entities) {
 	}
 }
 
+void Entity::visibleUpdate() {
+}
+
 void Entity::init() {
 	const char *typeName = network::EnumNameEntityType(_entityType);
 	addContainer(typeName);
@@ -92,7 +94,8 @@ void Entity::sendAttribUpdate() {
 
 	std::unordered_set<attrib::DirtyValue> dirtyTypes = _dirtyTypes;
 	if (!dirtyTypes.empty()) {
-		flatbuffers::FlatBufferBuilder fbb;
+		network::ScopedBuilder builder;
+		flatbuffers::FlatBufferBuilder& fbb = builder;
 		auto attribs = fbb.CreateVector<flatbuffers::Offset<network::AttribEntry>>(dirtyTypes.size(),
 			[&] (size_t i) {
 				const attrib::DirtyValue& dirtyValue = *dirtyTypes.begin();
@@ -118,17 +121,21 @@ bool Entity::update(long dt) {
 }
 
 void Entity::updateVisible(const EntitySet& set) {
+	EntitySet add;
+	EntitySet remove;
 	_visibleLock.lockWrite();
-	const auto& stillVisible = core::setIntersection(set, _visible);
-	const EntitySet& remove = core::setDifference(stillVisible, _visible);
-	const EntitySet& add = core::setDifference(set, stillVisible);
-	_visible = core::setUnion(stillVisible, add);
-	core_assert(stillVisible.size() + add.size() == _visible.size());
-	_visibleLock.unlockWrite();
-
-	for (const auto& e : _visible) {
-		sendEntityUpdate(e);
+	for (const EntityPtr& e : _visible) {
+		if (set.find(e) == set.end()) {
+			remove.insert(e);
+		}
+	}
+	for (const EntityPtr& e : set) {
+		if (_visible.find(e) == _visible.end()) {
+			add.insert(e);
+		}
 	}
+	_visible = set;
+	_visibleLock.unlockWrite();
 
 	if (!add.empty()) {
 		visibleAdd(add);
@@ -136,35 +143,7 @@ void Entity::updateVisible(const EntitySet& set) {
 	if (!remove.empty()) {
 		visibleRemove(remove);
 	}
-}
-
-void Entity::sendEntityUpdate(const EntityPtr& entity) const {
-	if (_peer == nullptr) {
-		return;
-	}
-	flatbuffers::FlatBufferBuilder fbb;
-	const glm::vec3& _pos = entity->pos();
-	const network::Vec3 pos { _pos.x, _pos.y, _pos.z };
-	_messageSender->sendServerMessage(_peer, fbb, network::ServerMsgType::EntityUpdate, network::CreateEntityUpdate(fbb, entity->id(), &pos, entity->orientation()).Union());
-}
-
-void Entity::sendEntitySpawn(const EntityPtr& entity) const {
-	if (_peer == nullptr) {
-		return;
-	}
-	flatbuffers::FlatBufferBuilder fbb;
-	const glm::vec3& pos = entity->pos();
-	const network::Vec3 vec3 { pos.x, pos.y, pos.z };
-	const EntityId entityId = id();
-	_messageSender->sendServerMessage(_peer, fbb, network::ServerMsgType::EntitySpawn, network::CreateEntitySpawn(fbb, entity->id(), entity->entityType(), &vec3, entityId).Union());
-}
-
-void Entity::sendEntityRemove(const EntityPtr& entity) const {
-	if (_peer == nullptr) {
-		return;
-	}
-	flatbuffers::FlatBufferBuilder fbb;
-	_messageSender->sendServerMessage(_peer, fbb, network::ServerMsgType::EntityRemove, network::CreateEntityRemove(fbb, entity->id()).Union());
+	visibleUpdate();
 }
 
 bool Entity::inFrustum(const glm::vec3& position) const {
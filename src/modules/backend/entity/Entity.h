@@ -29,10 +29,10 @@ typedef std::unordered_set<EntityPtr> EntitySet;
 /**
  * @brief Every actor in the world is an entity
  *
- * Entities are updated via @c network::ServerMsgType::EntityUpdate
+ * Entities are updated via @c network::ServerMsgType::EntityUpdates
  * message for the clients that are seeing the entity
  *
- * @sa EntityUpdateHandler
+ * @sa EntityUpdatesHandler
  */
 class Entity {
 private:
@@ -62,11 +62,13 @@ protected:
 	 * @brief Called with the set of entities that just get invisible for this entity
 	 */
 	virtual void visibleRemove(const EntitySet& entities);
+	/**
+	 * @brief Called after every visibility update - even if the set of visible entities didn't change
+	 * @note The @c visibleAdd() and @c visibleRemove() callbacks of this update were already executed
+	 */
+	virtual void visibleUpdate();
 
 	void sendAttribUpdate();
-	void sendEntityUpdate(const EntityPtr& entity) const;
-	void sendEntitySpawn(const EntityPtr& entity) const;
-	void sendEntityRemove(const EntityPtr& entity) const;
 
 	void onAttribChange(const attrib::DirtyValue& v);
 public:
@@ -7,19 +7,23 @@
 #include "User.h"
 #include "DatabaseModels.h"
 #include "Npc.h"
+#include "voxel/World.h"
 
 #define broadcastMsg(msg, type) _messageSender->broadcastServerMessage(fbb, network::type, network::msg.Union());
 
 namespace backend {
 
+// the root node covers the whole float range - the nodes at this depth have an edge length of 128 units
+static constexpr int QuadTreeMaxDepth = 122;
+
 EntityStorage::EntityStorage(const network::MessageSenderPtr& messageSender, const voxel::WorldPtr& world, const core::TimeProviderPtr& timeProvider,
 		const attrib::ContainerProviderPtr& containerProvider, const PoiProviderPtr& poiProvider, const cooldown::CooldownProviderPtr& cooldownProvider) :
-		_quadTree(core::RectFloat::getMaxRect(), 100.0f), _quadTreeCache(_quadTree), _messageSender(messageSender), _world(world), _timeProvider(
+		_quadTree(core::RectFloat::getMaxRect(), QuadTreeMaxDepth), _messageSender(messageSender), _world(world), _timeProvider(
 				timeProvider), _containerProvider(containerProvider), _poiProvider(poiProvider), _cooldownProvider(cooldownProvider), _time(0L) {
 }
 
 core::RectFloat EntityStorage::QuadTreeNode::getRect() const {
-	return entity->rect();
+	return rect;
 }
 
 bool EntityStorage::QuadTreeNode::operator==(const QuadTreeNode& rhs) const {
@@ -76,7 +80,9 @@ bool EntityStorage::logout(EntityId userId) {
 	if (i == _users.end()) {
 		return false;
 	}
+	removeFromQuadTree(i->second);
 	_users.erase(i);
+	_world->removeViewer(userId);
 	return true;
 }
 
@@ -89,8 +95,8 @@ bool EntityStorage::removeNpc(ai::CharacterId id) {
 	if (i == _npcs.end()) {
 		return false;
 	}
-	_quadTree.remove(QuadTreeNode { i->second });
-	_npcs.erase(id);
+	removeFromQuadTree(i->second);
+	_npcs.erase(i);
 	return true;
 }
 
@@ -117,53 +123,94 @@ void EntityStorage::onFrame(long dt) {
 	}
 
 	updateQuadTree();
-	for (auto i : _users) {
+	_updatedEntities.clear();
+	_viewRects.clear();
+	for (const auto& i : _users) {
 		updateEntity(i.second, deltaLastTick);
 	}
 	for (auto i = _npcs.begin(); i != _npcs.end();) {
-		NpcPtr npc = i->second;
+		const NpcPtr npc = i->second;
 		if (!updateEntity(npc, deltaLastTick)) {
 			Log::info("remove npc %li", npc->id());
-			_quadTree.remove(QuadTreeNode { npc });
+			removeFromQuadTree(npc);
 			i = _npcs.erase(i);
 		} else {
 			++i;
 		}
 	}
+	updateVisibility();
 }
 
 void EntityStorage::updateQuadTree() {
-	// TODO: a full rebuild is not needed every frame
-	_quadTree.clear();
-	for (auto i : _npcs) {
-		_quadTree.insert(QuadTreeNode { i.second });
+	for (const auto& i : _npcs) {
+		updateQuadTree(i.second);
+	}
+	for (const auto& i : _users) {
+		updateQuadTree(i.second);
+	}
+}
+
+void EntityStorage::updateQuadTree(const EntityPtr& entity) {
+	const core::RectFloat& rect = entity->rect();
+	auto i = _quadTreeNodes.find(entity.get());
+	if (i == _quadTreeNodes.end()) {
+		const QuadTreeNode node { entity, rect };
+		if (_quadTree.insert(node)) {
+			_quadTreeNodes.insert(std::make_pair(entity.get(), node));
+		}
+		return;
 	}
-	for (auto i : _users) {
-		const UserPtr& user = i.second;
-		_quadTree.insert(QuadTreeNode { user });
+	QuadTreeNode& node = i->second;
+	if (node.rect == rect) {
+		return;
+	}
+	if (_quadTree.move(node, QuadTreeNode { entity, rect })) {
+		node.rect = rect;
+	} else {
+		_quadTreeNodes.erase(i);
 	}
 }
 
+void EntityStorage::removeFromQuadTree(const EntityPtr& entity) {
+	auto i = _quadTreeNodes.find(entity.get());
+	if (i == _quadTreeNodes.end()) {
+		return;
+	}
+	_quadTree.remove(i->second);
+	_quadTreeNodes.erase(i);
+}
+
 bool EntityStorage::updateEntity(const EntityPtr& entity, long dt) {
 	if (!entity->update(dt)) {
 		return false;
 	}
-	const core::RectFloat& rect = entity->viewRect();
-	// TODO: maybe move into the entity instance to reduce memory allocations.
-	core::QuadTree<QuadTreeNode, float>::Contents contents;
-	contents.reserve(entity->visibleCount() + 10);
-	_quadTreeCache.query(rect, contents);
-	EntitySet set;
-	set.reserve(contents.size());
-	for (const QuadTreeNode& node : contents) {
-		// TODO: check the distance - the rect might contain more than the circle would...
-		if (entity->inFrustum(*node.entity.get())) {
-			set.insert(node.entity);
+	_updatedEntities.push_back(entity);
+	_viewRects.push_back(entity->viewRect());
+	return true;
+}
+
+void EntityStorage::updateVisibility() {
+	for (QuadTree::Contents& contents : _visibleContents) {
+		contents.clear();
+	}
+	_quadTree.query(_viewRects, _visibleContents);
+	const size_t n = _updatedEntities.size();
+	for (size_t i = 0; i < n; ++i) {
+		const EntityPtr& entity = _updatedEntities[i];
+		const QuadTree::Contents& contents = _visibleContents[i];
+		EntitySet set;
+		set.reserve(contents.size());
+		for (const QuadTreeNode& node : contents) {
+			// TODO: check the distance - the rect might contain more than the circle would...
+			if (entity->inFrustum(*node.entity.get())) {
+				set.insert(node.entity);
+			}
 		}
+		set.erase(entity);
+		entity->updateVisible(set);
 	}
-	set.erase(entity);
-	entity->updateVisible(set);
-	return true;
+	// don't keep the entities alive until the next frame
+	_updatedEntities.clear();
 }
 
 }
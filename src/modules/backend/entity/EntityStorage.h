@@ -10,6 +10,7 @@
 #include "core/TimeProvider.h"
 #include "ai/common/Types.h"
 #include <unordered_map>
+#include <vector>
 
 namespace backend {
 
@@ -30,13 +31,22 @@ private:
 
 	struct QuadTreeNode {
 		EntityPtr entity;
+		// the rect the entity was inserted with - this is needed to find it again in the tree
+		core::RectFloat rect;
 
 		core::RectFloat getRect() const;
 		bool operator==(const QuadTreeNode& rhs) const;
 	};
+	typedef core::QuadTree<QuadTreeNode, float> QuadTree;
 
-	core::QuadTree<QuadTreeNode, float> _quadTree;
-	core::QuadTreeCache<QuadTreeNode, float> _quadTreeCache;
+	QuadTree _quadTree;
+	// the nodes of all entities in the quad tree - entities are only moved in the tree if their rect changed
+	std::unordered_map<const Entity*, QuadTreeNode> _quadTreeNodes;
+
+	// the entities that were updated in the current frame and need a visibility update
+	std::vector<EntityPtr> _updatedEntities;
+	std::vector<core::RectFloat> _viewRects;
+	std::vector<QuadTree::Contents> _visibleContents;
 
 	network::MessageSenderPtr _messageSender;
 	voxel::WorldPtr _world;
@@ -51,7 +61,11 @@ private:
 	// the users that are seeing this npc entity.
 	// users itself are not visible until they have taken over a npc
 	bool updateEntity(const EntityPtr& entity, long dt);
+	// queries the visible entities for all updated entities in one batch
+	void updateVisibility();
 	void updateQuadTree();
+	void updateQuadTree(const EntityPtr& entity);
+	void removeFromQuadTree(const EntityPtr& entity);
 
 	EntityId getUserId(const std::string& email, const std::string& password) const;
 public:
@@ -0,0 +1,39 @@
+/**
+ * @file
+ */
+
+#include "EntityUpdates.h"
+#include "network/EntityState.h"
+#include <algorithm>
+
+namespace backend {
+
+// estimated serialized sizes for the EntityUpdates budget
+static constexpr int EntityUpdatesOverhead = 64;
+static constexpr int EntitySpawnSize = 48;
+static constexpr int EntityRemoveSize = (int)sizeof(int64_t);
+static constexpr int EntityStateSize = (int)sizeof(network::EntityState);
+
+size_t entityUpdateStates(int budget, size_t spawns, size_t removes) {
+	const int fixedSize = EntityUpdatesOverhead + (int)spawns * EntitySpawnSize + (int)removes * EntityRemoveSize;
+	const int stateBudget = budget - fixedSize;
+	return stateBudget > 0 ? (size_t)(stateBudget / EntityStateSize) : 0u;
+}
+
+void selectEntityUpdates(std::vector<EntityUpdateCandidate>& candidates, size_t maxStates) {
+	if (candidates.size() > maxStates) {
+		auto n = candidates.begin() + maxStates;
+		std::nth_element(candidates.begin(), n, candidates.end(), [] (const EntityUpdateCandidate& a, const EntityUpdateCandidate& b) {
+			return a.priority < b.priority;
+		});
+		for (auto i = n; i != candidates.end(); ++i) {
+			++*i->skipped;
+		}
+		candidates.erase(n, candidates.end());
+	}
+	for (const EntityUpdateCandidate& c : candidates) {
+		*c.skipped = 0u;
+	}
+}
+
+}
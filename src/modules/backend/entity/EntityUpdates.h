@@ -0,0 +1,38 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+namespace backend {
+
+class Entity;
+
+/**
+ * @brief A visible entity whose state might be sent with the next @c EntityUpdates message
+ */
+struct EntityUpdateCandidate {
+	Entity* entity;
+	// the distance to the user - reduced by the amount of skipped updates
+	float priority;
+	// the amount of updates in a row the state didn't fit into the budget
+	uint32_t* skipped;
+};
+
+/**
+ * @brief The amount of entity states that fit into the byte budget of one @c EntityUpdates message
+ * @note The spawns and removes are always sent - they are subtracted from the budget first
+ */
+size_t entityUpdateStates(int budget, size_t spawns, size_t removes);
+
+/**
+ * @brief Keeps the @c maxStates candidates with the lowest priority value. The skip counter of the
+ * removed candidates is increased, the one of the kept candidates is reset.
+ */
+void selectEntityUpdates(std::vector<EntityUpdateCandidate>& candidates, size_t maxStates);
+
+}
@@ -54,11 +54,15 @@ void Npc::setPointOfInterest() {
 }
 
 double Npc::applyDamage(Npc* attacker, double damage) {
+	return applyDamage(attacker != nullptr ? attacker->id() : 0, attacker != nullptr, damage);
+}
+
+double Npc::applyDamage(ai::CharacterId attacker, bool hasAttacker, double damage) {
 	double health = _attribs.current(attrib::Type::HEALTH);
 	if (health > 0.0) {
 		health = std::max(0.0, health - damage);
-		if (attacker != nullptr) {
-			_ai->getAggroMgr().addAggro(attacker->id(), damage);
+		if (hasAttacker) {
+			_ai->getAggroMgr().addAggro(attacker, damage);
 		}
 		_attribs.setCurrent(attrib::Type::HEALTH, health);
 		return damage;
@@ -66,6 +70,20 @@ double Npc::applyDamage(Npc* attacker, double damage) {
 	return 0.0;
 }
 
+void Npc::applyScheduledDamage() {
+	std::vector<ScheduledDamage> scheduledDamage;
+	{
+		core::ScopedWriteLock lock(_damageLock);
+		if (_scheduledDamage.empty()) {
+			return;
+		}
+		scheduledDamage.swap(_scheduledDamage);
+	}
+	for (const ScheduledDamage& damage : scheduledDamage) {
+		applyDamage(damage.attacker, true, damage.damage);
+	}
+}
+
 bool Npc::die() {
 	return applyDamage(nullptr, _attribs.current(attrib::Type::HEALTH)) > 0.0;
 }
@@ -75,10 +93,18 @@ bool Npc::attack(ai::CharacterId id) {
 	if (strength <= 0.0) {
 		return false;
 	}
-	return _ai->getZone()->executeAsync(id, [=] (const ai::AIPtr & targetAi) {
-		AICharacter& targetChr = ai::character_cast<AICharacter>(targetAi->getCharacter());
-		targetChr.getNpc().applyDamage(this, strength);
-	});
+	ai::Zone* zone = _ai->getZone();
+	if (zone == nullptr) {
+		return false;
+	}
+	const ai::AIPtr& targetAi = zone->getAI(id);
+	if (!targetAi) {
+		return false;
+	}
+	Npc& target = ai::character_cast<AICharacter>(targetAi->getCharacter()).getNpc();
+	core::ScopedWriteLock lock(target._damageLock);
+	target._scheduledDamage.push_back(ScheduledDamage { (ai::CharacterId)this->id(), strength });
+	return true;
 }
 
 bool Npc::update(long dt) {
@@ -92,7 +118,7 @@ bool Npc::update(long dt) {
 }
 
 bool Npc::route(const glm::ivec3& target) {
-	std::list<glm::ivec3> result;
+	std::vector<glm::ivec3> result;
 	const glm::vec3& pos = _ai->getCharacter()->getPosition();
 	const glm::ivec3 start(pos);
 	const glm::ivec3 end(target.x, target.y, target.z);
@@ -6,8 +6,10 @@
 
 #include "backend/entity/ai/AICharacter.h"
 #include <atomic>
+#include <vector>
 #include "Entity.h"
 #include "backend/poi/PoiProvider.h"
+#include "core/ReadWriteLock.h"
 
 namespace backend {
 
@@ -21,7 +23,21 @@ private:
 	glm::ivec3 _homePosition;
 	ai::AIPtr _ai;
 
+	struct ScheduledDamage {
+		ai::CharacterId attacker;
+		double damage;
+	};
+	// the damage of the attackers - applied in the own tick of this npc
+	core::ReadWriteLock _damageLock {"npcdamage"};
+	std::vector<ScheduledDamage> _scheduledDamage;
+
 	void moveToGround();
+	/**
+	 * @brief Applies the damage that was scheduled by other npcs since the last tick
+	 * @note Called from the own @c AI tick
+	 */
+	void applyScheduledDamage();
+	double applyDamage(ai::CharacterId attacker, bool hasAttacker, double damage);
 
 	void init() override;
 
@@ -43,6 +59,10 @@ public:
 	const ai::AIPtr& ai();
 
 	bool die();
+	/**
+	 * @brief Schedules the damage for the given target - the target applies it in its next tick
+	 * @note The @c AI ticks run in parallel - the target must not be modified from the tick of the attacker
+	 */
 	bool attack(ai::CharacterId id);
 	/**
 	 * @brief Applies damage to the entity
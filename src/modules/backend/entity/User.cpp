@@ -5,6 +5,8 @@
 #include "User.h"
 #include "core/Var.h"
 #include "voxel/World.h"
+#include "network/EntityState.h"
+#include <algorithm>
 
 namespace backend {
 
@@ -18,20 +20,83 @@ User::User(ENetPeer* peer, EntityId id, const std::string& name, const network::
 	_pos = poi;
 	_entityType = network::EntityType::PLAYER;
 	_userTimeout = core::Var::getSafe(cfg::ServerUserTimeout);
+	_entityUpdateBudget = core::Var::getSafe(cfg::ServerEntityUpdateBudget);
+	_chunkPos = _world->getChunkPos(_pos);
+	_world->prefetchChunks(_pos, 1, id);
 }
 
 void User::visibleAdd(const EntitySet& entities) {
 	Entity::visibleAdd(entities);
-	for (const EntityPtr& e : entities) {
-		sendEntitySpawn(e);
-	}
+	_spawned.insert(entities.begin(), entities.end());
 }
 
 void User::visibleRemove(const EntitySet& entities) {
 	Entity::visibleRemove(entities);
 	for (const EntityPtr& e : entities) {
-		sendEntityRemove(e);
+		_skippedUpdates.erase(e->id());
+		if (_spawned.erase(e) == 0) {
+			_removed.push_back(e->id());
+		}
+	}
+}
+
+void User::visibleUpdate() {
+	Entity::visibleUpdate();
+	ENetPeer* p = peer();
+	if (p == nullptr) {
+		// everything is spawned again on reconnect
+		_spawned.clear();
+		_removed.clear();
+		return;
+	}
+
+	const size_t maxStates = entityUpdateStates(_entityUpdateBudget->intVal(), _spawned.size(), _removed.size());
+
+	_updateCandidates.clear();
+	visitVisible([&] (const EntityPtr& e) {
+		// the spawn already contains the current state
+		if (_spawned.find(e) != _spawned.end()) {
+			return;
+		}
+		uint32_t& skipped = _skippedUpdates[e->id()];
+		const float distance = glm::distance(_pos, e->pos());
+		_updateCandidates.push_back(EntityUpdateCandidate { e.get(), distance / (float)(skipped + 1u), &skipped });
+	});
+	selectEntityUpdates(_updateCandidates, maxStates);
+
+	float maxOffset = 0.0f;
+	for (const EntityUpdateCandidate& c : _updateCandidates) {
+		const glm::vec3& offset = glm::abs(c.entity->pos() - _pos);
+		maxOffset = glm::max(maxOffset, glm::max(offset.x, glm::max(offset.y, offset.z)));
 	}
+	const float scale = network::entityStateScale(maxOffset);
+
+	_entityStates.clear();
+	// invalid id means spectator
+	if (id() != -1) {
+		_entityStates.push_back(network::createEntityState(id(), _pos, orientation(), _pos, scale));
+	}
+	for (const EntityUpdateCandidate& c : _updateCandidates) {
+		_entityStates.push_back(network::createEntityState(c.entity->id(), c.entity->pos(), c.entity->orientation(), _pos, scale));
+	}
+
+	network::ScopedBuilder builder;
+	flatbuffers::FlatBufferBuilder& fbb = builder;
+	auto states = fbb.CreateVectorOfStructs(_entityStates);
+	auto spawns = fbb.CreateVector<flatbuffers::Offset<network::EntitySpawn>>(_spawned.size(),
+		[&] (size_t i) {
+			const EntityPtr& e = *_spawned.begin();
+			const glm::vec3& pos = e->pos();
+			const network::Vec3 vec3 { pos.x, pos.y, pos.z };
+			auto spawn = network::CreateEntitySpawn(fbb, e->id(), e->entityType(), &vec3, e->orientation());
+			_spawned.erase(_spawned.begin());
+			return spawn;
+		});
+	auto removes = fbb.CreateVector(_removed);
+	_removed.clear();
+	const network::Vec3 origin { _pos.x, _pos.y, _pos.z };
+	_messageSender->sendServerMessage(p, fbb, network::ServerMsgType::EntityUpdates,
+			network::CreateEntityUpdates(fbb, &origin, scale, states, spawns, removes).Union());
 }
 
 ENetPeer* User::setPeer(ENetPeer* peer) {
@@ -57,8 +122,9 @@ void User::disconnect() {
 void User::reconnect() {
 	Log::trace("reconnect user");
 	_attribs.markAsDirty();
+	_removed.clear();
 	visitVisible([&] (const EntityPtr& e) {
-		sendEntitySpawn(e);
+		_spawned.insert(e);
 	});
 }
 
@@ -104,23 +170,43 @@ bool User::update(long dt) {
 	_pos += glm::quat(glm::vec3(orientation(), _yaw, 0.0f)) * moveDelta;
 	// TODO: if not flying...
 	_pos.y = _world->findFloor(_pos.x, _pos.z, voxel::isFloor);
+	const glm::ivec3& chunkPos = _world->getChunkPos(_pos);
+	if (chunkPos != _chunkPos) {
+		_chunkPos = chunkPos;
+		_world->prefetchChunks(_pos, 1, id());
+	}
 	Log::trace("move: dt %li, speed: %f p(%f:%f:%f), pitch: %f, yaw: %f", dt, speed, _pos.x, _pos.y, _pos.z, orientation(), _yaw);
-
-	const network::Vec3 pos { _pos.x, _pos.y, _pos.z };
-	_messageSender->sendServerMessage(_peer, _entityUpdateFbb,
-			network::ServerMsgType::EntityUpdate,
-			network::CreateEntityUpdate(_entityUpdateFbb, id(), &pos, orientation()).Union());
+	// the own movement is not throttled by the visible entity updates
+	sendOwnState();
 
 	return true;
 }
 
+void User::sendOwnState() {
+	ENetPeer* p = peer();
+	if (p == nullptr) {
+		return;
+	}
+	network::ScopedBuilder builder;
+	flatbuffers::FlatBufferBuilder& fbb = builder;
+	// the user is the origin of the message
+	const float scale = network::entityStateScale(0.0f);
+	const network::EntityState state = network::createEntityState(id(), _pos, orientation(), _pos, scale);
+	auto states = fbb.CreateVectorOfStructs(&state, 1);
+	const network::Vec3 origin { _pos.x, _pos.y, _pos.z };
+	_messageSender->sendServerMessage(p, fbb, network::ServerMsgType::EntityUpdates,
+			network::CreateEntityUpdates(fbb, &origin, scale, states).Union());
+}
+
 void User::sendSeed(long seed) const {
-	flatbuffers::FlatBufferBuilder fbb;
+	network::ScopedBuilder builder;
+	flatbuffers::FlatBufferBuilder& fbb = builder;
 	_messageSender->sendServerMessage(_peer, fbb, network::ServerMsgType::Seed, network::CreateSeed(fbb, seed).Union());
 }
 
 void User::sendUserSpawn() const {
-	flatbuffers::FlatBufferBuilder fbb;
+	network::ScopedBuilder builder;
+	flatbuffers::FlatBufferBuilder& fbb = builder;
 	const network::Vec3 pos { _pos.x, _pos.y, _pos.z };
 	// TODO: broadcast to visible
 	_messageSender->broadcastServerMessage(fbb, network::ServerMsgType::UserSpawn, network::CreateUserSpawn(fbb, id(), fbb.CreateString(_name), &pos).Union());
@@ -6,8 +6,11 @@
 
 #include "network/MessageSender.h"
 #include "Entity.h"
+#include "EntityUpdates.h"
 #include "core/Var.h"
 #include "backend/poi/PoiProvider.h"
+#include <unordered_map>
+#include <vector>
 
 namespace backend {
 
@@ -24,15 +27,38 @@ private:
 	uint64_t _lastAction = 0u;
 	uint64_t _time = 0u;
 	core::VarPtr _userTimeout;
-	flatbuffers::FlatBufferBuilder _entityUpdateFbb;
+	core::VarPtr _entityUpdateBudget;
+	// the chunk the user is in - the chunks around it are generated in the background
+	glm::ivec3 _chunkPos;
+
+	// the changes of the visible entities that are sent with the next EntityUpdates message
+	EntitySet _spawned;
+	std::vector<EntityId> _removed;
+	// the amount of updates in a row the state of a visible entity didn't fit into the budget
+	std::unordered_map<EntityId, uint32_t> _skippedUpdates;
+
+	std::vector<EntityUpdateCandidate> _updateCandidates;
+	std::vector<network::EntityState> _entityStates;
 
 	bool isMove(network::MoveDirection dir) const;
 	void addMove(network::MoveDirection dir);
 	void removeMove(network::MoveDirection dir);
+	/**
+	 * @brief Sends the own state of a moving user every frame - an @c network::EntityUpdates message without
+	 * spawns and removes, the visible entities are only sent with visibleUpdate()
+	 */
+	void sendOwnState();
 
 protected:
 	void visibleAdd(const EntitySet& entities) override;
 	void visibleRemove(const EntitySet& entities) override;
+	/**
+	 * @brief Sends the aggregated @c network::EntityUpdates message for this tick
+	 *
+	 * Spawns and removes are always sent, the states of the visible entities are limited by the
+	 * @c cfg::ServerEntityUpdateBudget and sent in the order of their distance to the user.
+	 */
+	void visibleUpdate() override;
 
 public:
 	User(ENetPeer* peer, EntityId id, const std::string& name, const network::MessageSenderPtr& messageSender, const voxel::WorldPtr& world,
@@ -29,6 +29,7 @@ void AICharacter::setOrientation(float orientation) {
 }
 
 void AICharacter::update(int64_t dt, bool debuggingActive) {
+	_npc.applyScheduledDamage();
 	_npc.moveToGround();
 
 	// TODO: attrib for passive aggro
@@ -44,11 +44,9 @@ public:
 
 	TreeNodeStatus doAction(backend::AICharacter& chr, int64_t deltaMillis) override {
 		backend::Npc& npc = chr.getNpc();
-		const glm::ivec3 pos = glm::ivec3(npc.pos());
-		if (_spawnMgr->spawn(*npc.ai()->getZone(), npc.entityType(), 1, &pos) == 1) {
-			return FINISHED;
-		}
-		return FAILED;
+		// the ticks run in parallel - the spawn is done by the main thread
+		_spawnMgr->scheduleSpawn(npc.entityType(), glm::ivec3(npc.pos()));
+		return FINISHED;
 	}
 };
 
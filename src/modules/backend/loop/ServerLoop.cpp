@@ -21,6 +21,7 @@
 #include "backend/network/AttackHandler.h"
 #include "backend/network/MoveHandler.h"
 #include "core/command/CommandHandler.h"
+#include "core/Concurrency.h"
 #include "voxel/MaterialColor.h"
 
 namespace backend {
@@ -28,10 +29,28 @@ namespace backend {
 constexpr int aiDebugServerPort = 11338;
 constexpr const char* aiDebugServerInterface = "127.0.0.1";
 
-ServerLoop::ServerLoop(const network::NetworkPtr& network, const SpawnMgrPtr& spawnMgr, const voxel::WorldPtr& world, const EntityStoragePtr& entityStorage, const core::EventBusPtr& eventBus, const AIRegistryPtr& registry,
+// the resources that the stages of a frame are reading and writing
+// @note the chunk requests of the world are synchronized and thus not listed here
+enum : core::FrameStages::Resources {
+	// the network host and the message handlers
+	StageNetwork = 1 << 0,
+	// the points of interest - also used for the start position of a user that logs in
+	StagePoi = 1 << 1,
+	// the voxel data - might get reset by the world update
+	StageWorld = 1 << 2,
+	// the ai zone and the characters
+	StageZone = 1 << 3,
+	StageEntities = 1 << 4,
+	StageAIDebugger = 1 << 5,
+	// the callbacks of the asynchronous database queries
+	StageDatabase = 1 << 6
+};
+
+ServerLoop::ServerLoop(const network::NetworkPtr& network, const network::MessageSenderPtr& messageSender, const SpawnMgrPtr& spawnMgr, const voxel::WorldPtr& world, const EntityStoragePtr& entityStorage, const core::EventBusPtr& eventBus, const AIRegistryPtr& registry,
 		const attrib::ContainerProviderPtr& containerProvider, const PoiProviderPtr& poiProvider, const cooldown::CooldownProviderPtr& cooldownProvider) :
-		_network(network), _spawnMgr(spawnMgr), _world(world),
-		_entityStorage(entityStorage), _eventBus(eventBus), _registry(registry), _containerProvider(containerProvider), _poiProvider(poiProvider), _cooldownProvider(cooldownProvider) {
+		_network(network), _messageSender(messageSender), _spawnMgr(spawnMgr), _world(world),
+		_entityStorage(entityStorage), _eventBus(eventBus), _registry(registry), _containerProvider(containerProvider), _poiProvider(poiProvider), _cooldownProvider(cooldownProvider),
+		_threadPool(core::halfcpus(), "ServerLoop") {
 	_world->setClientData(false);
 	_eventBus->subscribe<network::NewConnectionEvent>(*this);
 	_eventBus->subscribe<network::DisconnectEvent>(*this);
@@ -65,11 +84,11 @@ bool ServerLoop::init() {
 	}
 
 	const network::ProtocolHandlerRegistryPtr& r = _network->registry();
-	r->registerHandler(network::EnumNameClientMsgType(network::ClientMsgType::UserConnect), std::make_shared<UserConnectHandler>(_network, _entityStorage, _world));
-	r->registerHandler(network::EnumNameClientMsgType(network::ClientMsgType::UserConnected), std::make_shared<UserConnectedHandler>());
-	r->registerHandler(network::EnumNameClientMsgType(network::ClientMsgType::UserDisconnect), std::make_shared<UserDisconnectHandler>());
-	r->registerHandler(network::EnumNameClientMsgType(network::ClientMsgType::Attack), std::make_shared<AttackHandler>());
-	r->registerHandler(network::EnumNameClientMsgType(network::ClientMsgType::Move), std::make_shared<MoveHandler>());
+	r->registerHandler(network::ClientMsgType::UserConnect, std::make_shared<UserConnectHandler>(_network, _entityStorage, _world));
+	r->registerHandler<UserConnectedHandler>();
+	r->registerHandler<UserDisconnectHandler>();
+	r->registerHandler<AttackHandler>();
+	r->registerHandler<MoveHandler>();
 
 	if (!voxel::initDefaultMaterialColors()) {
 		Log::error("Failed to initialize the palette data");
@@ -90,10 +109,57 @@ bool ServerLoop::init() {
 	} else {
 		Log::error("Could not start the ai debug server");
 	}
+
+	initStages();
+	core::Command::registerCommand("sv_stages", [this] (const core::CmdArgs& args) {
+		Log::info("frame: %.2fms (%i waves)", (double)_stages.frameMicros() / 1000.0, _stages.waves());
+		for (const core::FrameStages::Stage& stage : _stages.stages()) {
+			Log::info("%s: %.2fms (avg: %.2fms, wave: %i)", stage.name.c_str(), (double)stage.micros / 1000.0, stage.averageMicros / 1000.0, stage.wave);
+		}
+	}).setHelp("Print the execution times of the server frame stages");
 	return true;
 }
 
+void ServerLoop::initStages() {
+	// the message handlers are logging in users (placed at a point of interest) and trigger cooldowns. A new user
+	// looks up its start position in the world and prefetches the chunks around it.
+	_stages.add("Network", StageWorld, StageNetwork | StageEntities | StagePoi, [this] (long /*dt*/) {
+		_network->update();
+	});
+	// the results of the asynchronous queries are usually applied to the users
+	_stages.add("Database", StageWorld, StageDatabase | StageEntities, [] (long /*dt*/) {
+		core::Singleton<::persistence::ConnectionPool>::getInstance().update();
+	});
+	_stages.add("PoiUpdate", 0u, StagePoi, [this] (long dt) {
+		_poiProvider->update(dt);
+	});
+	_stages.add("WorldUpdate", 0u, StageWorld, [this] (long dt) {
+		_world->onFrame(dt);
+	});
+	// the npcs are moved by their ai
+	_stages.add("ZoneUpdate", StageWorld, StageZone | StageEntities, [this] (long dt) {
+		_zone->update(dt);
+	});
+	_stages.add("AIServerUpdate", StageZone, StageAIDebugger, [this] (long dt) {
+		_aiServer->update(dt);
+	});
+	_stages.add("SpawnMgrUpdate", StageWorld, StageZone | StageEntities, [this] (long dt) {
+		_spawnMgr->onFrame(*_zone, dt);
+	});
+	// the entities are sending their updates to the users
+	_stages.add("EntityStorage", StageWorld, StageZone | StageEntities | StageNetwork, [this] (long dt) {
+		_entityStorage->onFrame(dt);
+	});
+	// send the messages of this frame - the messages of every peer are coalesced into one packet
+	_stages.add("NetworkFlush", 0u, StageNetwork, [this] (long /*dt*/) {
+		_messageSender->flush();
+		_network->flush();
+	});
+	Log::debug("The server frame has %i stages in %i waves", (int)_stages.stages().size(), _stages.waves());
+}
+
 void ServerLoop::shutdown() {
+	core::Command::unregisterCommand("sv_stages");
 	_world->shutdown();
 	core::Singleton<::persistence::ConnectionPool>::getInstance().shutdown();
 	_spawnMgr->shutdown();
@@ -118,28 +184,7 @@ void ServerLoop::onFrame(long dt) {
 	core::Var::visitReplicate([] (const core::VarPtr& var) {
 		Log::info("TODO: %s needs replicate", var->name().c_str());
 	});
-	_network->update();
-	{ // TODO: move into own thread
-		core_trace_scoped(PoiUpdate);
-		_poiProvider->update(dt);
-	}
-	{ // TODO: move into own thread
-		core_trace_scoped(WorldUpdate);
-		_world->onFrame(dt);
-	}
-	{ // TODO: move into own thread
-		core_trace_scoped(AIServerUpdate);
-		_zone->update(dt);
-		_aiServer->update(dt);
-	}
-	{ // TODO: move into own thread
-		core_trace_scoped(SpawnMgrUpdate);
-		_spawnMgr->onFrame(*_zone, dt);
-	}
-	{
-		core_trace_scoped(EntityStorage);
-		_entityStorage->onFrame(dt);
-	}
+	_stages.run(_threadPool, dt);
 }
 
 void ServerLoop::onEvent(const network::DisconnectEvent& event) {
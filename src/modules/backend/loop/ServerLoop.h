@@ -8,9 +8,12 @@
 #include "core/Trace.h"
 #include "network/Network.h"
 #include "network/NetworkEvents.h"
+#include "network/MessageSender.h"
 #include "voxel/World.h"
 #include "backend/spawn/SpawnMgr.h"
 #include "core/Input.h"
+#include "core/FrameStages.h"
+#include "core/ThreadPool.h"
 #include "network/ProtocolHandlerRegistry.h"
 #include "backend/entity/EntityStorage.h"
 #include "core/EventBus.h"
@@ -27,6 +30,7 @@ typedef std::shared_ptr<AIRegistry> AIRegistryPtr;
 class ServerLoop: public core::IEventBusHandler<network::NewConnectionEvent>, core::IEventBusHandler<network::DisconnectEvent> {
 private:
 	network::NetworkPtr _network;
+	network::MessageSenderPtr _messageSender;
 	SpawnMgrPtr _spawnMgr;
 	voxel::WorldPtr _world;
 	ai::Zone* _zone = nullptr;
@@ -38,10 +42,13 @@ private:
 	PoiProviderPtr _poiProvider;
 	cooldown::CooldownProviderPtr _cooldownProvider;
 	core::Input _input;
+	core::ThreadPool _threadPool;
+	core::FrameStages _stages;
 
 	void readInput();
+	void initStages();
 public:
-	ServerLoop(const network::NetworkPtr& network, const SpawnMgrPtr& spawnMgr, const voxel::WorldPtr& world,
+	ServerLoop(const network::NetworkPtr& network, const network::MessageSenderPtr& messageSender, const SpawnMgrPtr& spawnMgr, const voxel::WorldPtr& world,
 			const EntityStoragePtr& entityStorage, const core::EventBusPtr& eventBus, const AIRegistryPtr& registry,
 			const attrib::ContainerProviderPtr& containerProvider, const PoiProviderPtr& poiProvider,
 			const cooldown::CooldownProviderPtr& cooldownProvider);
@@ -49,10 +56,18 @@ public:
 	bool init();
 	void shutdown();
 	void onFrame(long dt);
+	/**
+	 * @brief The stages of a server frame together with their execution times of the last frame
+	 */
+	const core::FrameStages& stages() const;
 	void onEvent(const network::DisconnectEvent& event);
 	void onEvent(const network::NewConnectionEvent& event);
 };
 
+inline const core::FrameStages& ServerLoop::stages() const {
+	return _stages;
+}
+
 typedef std::shared_ptr<ServerLoop> ServerLoopPtr;
 
 }
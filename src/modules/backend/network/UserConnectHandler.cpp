@@ -3,6 +3,7 @@
  */
 
 #include "UserConnectHandler.h"
+#include "network/PacketBatch.h"
 #include "ClientMessages_generated.h"
 #include "ServerMessages_generated.h"
 #include "backend/entity/User.h"
@@ -19,7 +20,7 @@ UserConnectHandler::UserConnectHandler(network::NetworkPtr network, backend::Ent
 }
 
 void UserConnectHandler::sendAuthFailed(ENetPeer* peer) {
-	ENetPacket* packet = enet_packet_create(_authFailed.GetBufferPointer(), _authFailed.GetSize(), ENET_PACKET_FLAG_RELIABLE);
+	ENetPacket* packet = network::createFramedPacket(_authFailed.GetBufferPointer(), _authFailed.GetSize(), ENET_PACKET_FLAG_RELIABLE);
 	_network->sendMessage(peer, packet);
 }
 
@@ -44,10 +44,12 @@ void PoiProvider::addPointOfInterest(const glm::vec3& pos) {
 }
 
 size_t PoiProvider::getPointOfInterestCount() const {
+	core::ScopedReadLock scoped(_lock);
 	return _pois.size();
 }
 
 glm::vec3 PoiProvider::getPointOfInterest() const {
+	core::ScopedReadLock scoped(_lock);
 	if (_pois.empty()) {
 		return _world->randomPos();
 	}
@@ -89,7 +89,20 @@ int SpawnMgr::spawn(ai::Zone& zone, network::EntityType type, int amount, const
 	return amount;
 }
 
+void SpawnMgr::scheduleSpawn(network::EntityType type, const glm::ivec3& pos) {
+	core::ScopedWriteLock lock(_scheduleLock);
+	_scheduledSpawns.push_back(ScheduledSpawn { type, pos });
+}
+
 void SpawnMgr::onFrame(ai::Zone& zone, long dt) {
+	std::vector<ScheduledSpawn> scheduledSpawns;
+	{
+		core::ScopedWriteLock lock(_scheduleLock);
+		scheduledSpawns.swap(_scheduledSpawns);
+	}
+	for (const ScheduledSpawn& scheduled : scheduledSpawns) {
+		spawn(zone, scheduled.type, 1, &scheduled.pos);
+	}
 	_time += dt;
 	if (_time >= spawnTime) {
 		_time -= spawnTime;
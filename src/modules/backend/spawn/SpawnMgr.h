@@ -7,7 +7,9 @@
 #include "backend/ForwardDecl.h"
 #include "ServerMessages_generated.h"
 #include "ai/common/Types.h"
+#include "core/ReadWriteLock.h"
 #include <glm/vec3.hpp>
+#include <vector>
 
 namespace backend {
 
@@ -23,6 +25,13 @@ private:
 	cooldown::CooldownProviderPtr _cooldownProvider;
 	long _time;
 
+	struct ScheduledSpawn {
+		network::EntityType type;
+		glm::ivec3 pos;
+	};
+	core::ReadWriteLock _scheduleLock {"spawnmgr"};
+	std::vector<ScheduledSpawn> _scheduledSpawns;
+
 	void spawnEntity(ai::Zone& zone, network::EntityType start, network::EntityType end, int maxAmount);
 	void spawnAnimals(ai::Zone& zone);
 	void spawnCharacters(ai::Zone& zone);
@@ -35,6 +44,11 @@ public:
 	void shutdown();
 
 	int spawn(ai::Zone& zone, network::EntityType type, int amount, const glm::ivec3* pos = nullptr);
+	/**
+	 * @brief Spawns a new entity in the next @c onFrame() call. Use this from within the @c AI tick - the ticks
+	 * are executed in parallel and the spawn modifies the entity storage.
+	 */
+	void scheduleSpawn(network::EntityType type, const glm::ivec3& pos);
 	void onFrame(ai::Zone& zone, long dt);
 };
 
@@ -49,4 +49,147 @@ TEST_F(DatabaseModelTest, testWrite) {
 	ASSERT_EQ(u2nd.userid(), u.userid());
 }
 
+
+TEST_F(DatabaseModelTest, testInsertStatement) {
+	const persistence::UserStore u;
+	const std::vector<::persistence::Model::Row> rows = {
+		{"a@b.c", "secret", "now", "1"},
+		{"b@b.c", "secret", "now", "2"}
+	};
+	std::vector<std::string> params;
+	EXPECT_EQ("INSERT INTO user_table (\"email\", \"password\", \"registrationdate\") VALUES ($1, $2, $3), ($4, $5, $6)",
+			u.insertStatement(rows, 0, rows.size(), false, params));
+	ASSERT_EQ(6u, params.size());
+	EXPECT_EQ("b@b.c", params[3]);
+	EXPECT_EQ("WITH upserted AS (INSERT INTO user_table (\"email\", \"password\", \"registrationdate\", \"userid\") VALUES ($1, $2, $3, $4)"
+			" ON CONFLICT (\"userid\") DO UPDATE SET \"email\" = EXCLUDED.\"email\", \"password\" = EXCLUDED.\"password\","
+			" \"registrationdate\" = EXCLUDED.\"registrationdate\" RETURNING \"userid\")"
+			" SELECT setval(pg_get_serial_sequence('user_table', 'userid'), GREATEST(nextval(pg_get_serial_sequence('user_table', 'userid')),"
+			" (SELECT MAX(\"userid\") + 1 FROM upserted)), false)",
+			u.insertStatement(rows, 1, 1, true, params));
+	ASSERT_EQ(4u, params.size());
+	EXPECT_EQ("2", params[3]);
+}
+
+TEST_F(DatabaseModelTest, testRow) {
+	persistence::UserStore u;
+	u.setEmail("a@b.c");
+	u.setPassword("secret");
+	u.setRegistrationdate(::persistence::Timestamp::now());
+	u.setUserid(42);
+	const ::persistence::Model::Row& row = u.row();
+	ASSERT_EQ(4u, row.size());
+	EXPECT_EQ("a@b.c", row[0]);
+	EXPECT_EQ("now", row[2]);
+	EXPECT_EQ("42", row[3]);
+}
+
+TEST_F(DatabaseModelTest, testInsertMany) {
+	ASSERT_TRUE(persistence::UserStore::createTable()) << "Could not create table";
+	persistence::UserStore::truncate();
+	std::vector<::persistence::Model::Row> rows;
+	for (int i = 0; i < 2500; ++i) {
+		rows.push_back({"insert" + std::to_string(i) + "@b.c", "secret", "now", "0"});
+	}
+	ASSERT_TRUE(persistence::UserStore::insertMany(rows));
+	const std::string email = "insert2499@b.c";
+	persistence::UserStore u(&email, nullptr, nullptr);
+	ASSERT_NE(0, u.userid());
+	// the unique email is violated - nothing of the transaction may end up in the table
+	rows.push_back({"new@b.c", "secret", "now", "0"});
+	rows.push_back({"insert0@b.c", "secret", "now", "0"});
+	ASSERT_FALSE(persistence::UserStore::insertMany(rows));
+	const std::string newEmail = "new@b.c";
+	persistence::UserStore n(&newEmail, nullptr, nullptr);
+	ASSERT_EQ(0, n.userid());
+}
+
+TEST_F(DatabaseModelTest, testUpsertMany) {
+	ASSERT_TRUE(persistence::UserStore::createTable()) << "Could not create table";
+	persistence::UserStore::truncate();
+	ASSERT_TRUE(persistence::UserStore::upsertMany({{"a@b.c", "secret", "now", "1"}, {"b@b.c", "secret", "now", "2"}}));
+	ASSERT_TRUE(persistence::UserStore::upsertMany({{"c@b.c", "secret", "now", "2"}}));
+	const std::string email = "c@b.c";
+	persistence::UserStore u(&email, nullptr, nullptr);
+	ASSERT_EQ(2, u.userid());
+}
+
+TEST_F(DatabaseModelTest, testUpsertManyDuplicatedKeys) {
+	ASSERT_TRUE(persistence::UserStore::createTable()) << "Could not create table";
+	persistence::UserStore::truncate();
+	// one statement must not update the same row twice - the last row of a key wins
+	ASSERT_TRUE(persistence::UserStore::upsertMany({{"a@b.c", "secret", "now", "1"}, {"b@b.c", "secret", "now", "1"}}));
+	const std::string email = "b@b.c";
+	persistence::UserStore u(&email, nullptr, nullptr);
+	ASSERT_EQ(1, u.userid());
+	// the autoincrement primary key is needed for the upsert
+	ASSERT_FALSE(persistence::UserStore::upsertMany({{"c@b.c", "secret", "now", "0"}}));
+}
+
+TEST_F(DatabaseModelTest, testInsertAfterUpsertMany) {
+	ASSERT_TRUE(persistence::UserStore::createTable()) << "Could not create table";
+	persistence::UserStore::truncate();
+	ASSERT_TRUE(persistence::UserStore::upsertMany({{"a@b.c", "secret", "now", "1"}, {"b@b.c", "secret", "now", "2"}}));
+	// the sequence must have been moved past the upserted keys
+	ASSERT_TRUE(persistence::UserStore::insertMany({{"c@b.c", "secret", "now", "0"}}));
+	const std::string email = "c@b.c";
+	persistence::UserStore u(&email, nullptr, nullptr);
+	ASSERT_GT(u.userid(), 2);
+}
+
+TEST_F(DatabaseModelTest, testCopyMany) {
+	ASSERT_TRUE(persistence::UserStore::createTable()) << "Could not create table";
+	persistence::UserStore::truncate();
+	std::vector<::persistence::Model::Row> rows;
+	for (int i = 0; i < 2500; ++i) {
+		rows.push_back({"copy" + std::to_string(i) + "@b.c", "sec\tret", "now", "0"});
+	}
+	ASSERT_TRUE(persistence::UserStore::copyMany(rows));
+	// the escaped tab must survive the copy
+	const std::string email = "copy1000@b.c";
+	const std::string password = "sec\tret";
+	persistence::UserStore u(&email, &password, nullptr);
+	ASSERT_NE(0, u.userid());
+}
+
+TEST_F(DatabaseModelTest, testWriteBehind) {
+	ASSERT_TRUE(persistence::UserStore::createTable()) << "Could not create table";
+	persistence::UserStore::truncate();
+	persistence::UserStore::WriteBehind queue(100u);
+	persistence::UserStore u;
+	u.setPassword("secret");
+	u.setRegistrationdate(::persistence::Timestamp::now());
+	for (int i = 0; i < 10; ++i) {
+		u.setUserid(1 + i % 2);
+		u.setEmail("write" + std::to_string(i) + "@b.c");
+		queue.write(u, i);
+	}
+	EXPECT_EQ(2u, queue.size());
+	EXPECT_EQ(8u, queue.coalesced());
+	EXPECT_FALSE(queue.update(99u));
+	ASSERT_TRUE(queue.flush());
+	EXPECT_EQ(0u, queue.size());
+	ASSERT_TRUE(queue.wait());
+	const std::string first = "write8@b.c";
+	EXPECT_EQ(1, persistence::UserStore(&first, nullptr, nullptr).userid());
+	const std::string second = "write9@b.c";
+	EXPECT_EQ(2, persistence::UserStore(&second, nullptr, nullptr).userid());
+
+	// the next flush must wait until the previous one is committed - the older values could win otherwise
+	u.setUserid(1);
+	u.setEmail("write10@b.c");
+	queue.write(u, 200u);
+	ASSERT_TRUE(queue.flush());
+	u.setEmail("write11@b.c");
+	queue.write(u, 201u);
+	if (!queue.flush()) {
+		EXPECT_EQ(1u, queue.size());
+		ASSERT_TRUE(queue.wait());
+		ASSERT_TRUE(queue.flush());
+	}
+	ASSERT_TRUE(queue.wait());
+	const std::string last = "write11@b.c";
+	EXPECT_EQ(1, persistence::UserStore(&last, nullptr, nullptr).userid());
+}
+
 }
@@ -0,0 +1,99 @@
+/**
+ * @file
+ */
+
+#include "core/tests/AbstractTest.h"
+#include "backend/entity/EntityUpdates.h"
+#include "network/EntityState.h"
+
+namespace backend {
+
+class EntityUpdatesTest: public core::AbstractTest {
+};
+
+TEST_F(EntityUpdatesTest, testPositionRoundTrip) {
+	const glm::vec3 origin(1000.0f, 64.0f, -2000.0f);
+	const glm::vec3 positions[] = { origin, origin + glm::vec3(0.5f, -1.25f, 3.0f), origin + glm::vec3(-100.0f, 20.0f, 99.9f) };
+	const float scale = network::entityStateScale(100.0f);
+	for (const glm::vec3& pos : positions) {
+		const network::EntityState& state = network::createEntityState(42, pos, 1.0f, origin, scale);
+		EXPECT_EQ(42, state.id());
+		const glm::vec3& result = network::entityStatePosition(state, origin, scale);
+		// half a quantization step is the max error
+		for (int i = 0; i < 3; ++i) {
+			EXPECT_NEAR(pos[i], result[i], scale * 0.5f + 0.0001f) << "Component " << i << " of " << glm::to_string(pos);
+		}
+	}
+}
+
+TEST_F(EntityUpdatesTest, testPositionRoundTripOrigin) {
+	const glm::vec3 origin(12.5f, 3.0f, -7.25f);
+	const float scale = network::entityStateScale(0.0f);
+	EXPECT_FLOAT_EQ(network::EntityStateMinScale, scale);
+	const network::EntityState& state = network::createEntityState(1, origin, 0.0f, origin, scale);
+	EXPECT_EQ(origin, network::entityStatePosition(state, origin, scale));
+}
+
+TEST_F(EntityUpdatesTest, testPositionClamp) {
+	// the offsets that don't fit into the scale are clamped instead of wrapped
+	const float scale = network::entityStateScale(10.0f);
+	const network::EntityState& state = network::createEntityState(1, glm::vec3(1000.0f, -1000.0f, 0.0f), 0.0f, glm::vec3(0.0f), scale);
+	EXPECT_EQ(std::numeric_limits<int16_t>::max(), state.x());
+	EXPECT_EQ(-std::numeric_limits<int16_t>::max(), state.y());
+}
+
+TEST_F(EntityUpdatesTest, testRotationRoundTrip) {
+	const float step = glm::two_pi<float>() / 65536.0f;
+	for (float rotation : { 0.0f, 1.0f, 3.0f, 6.0f }) {
+		EXPECT_NEAR(rotation, network::dequantizeRotation(network::quantizeRotation(rotation)), step);
+	}
+	EXPECT_NEAR(1.0f, network::dequantizeRotation(network::quantizeRotation(1.0f + glm::two_pi<float>())), step * 4.0f);
+}
+
+TEST_F(EntityUpdatesTest, testBudget) {
+	const size_t states = entityUpdateStates(1200, 0u, 0u);
+	EXPECT_GT(states, 0u);
+	// the spawns and removes are subtracted from the budget
+	EXPECT_LT(entityUpdateStates(1200, 4u, 0u), states);
+	EXPECT_LT(entityUpdateStates(1200, 0u, 4u), states);
+	EXPECT_EQ(0u, entityUpdateStates(1200, 100u, 0u));
+	EXPECT_EQ(0u, entityUpdateStates(0, 0u, 0u));
+}
+
+TEST_F(EntityUpdatesTest, testSelectNearest) {
+	uint32_t skipped[5] = { 0u, 0u, 0u, 3u, 0u };
+	std::vector<EntityUpdateCandidate> candidates;
+	const float priorities[] = { 50.0f, 10.0f, 40.0f, 5.0f, 20.0f };
+	for (int i = 0; i < 5; ++i) {
+		candidates.push_back(EntityUpdateCandidate { nullptr, priorities[i], &skipped[i] });
+	}
+	selectEntityUpdates(candidates, 3u);
+	ASSERT_EQ(3u, candidates.size());
+	for (const EntityUpdateCandidate& c : candidates) {
+		EXPECT_LE(c.priority, 20.0f);
+	}
+	// the sent states reset the counter - the skipped ones increase it
+	EXPECT_EQ(1u, skipped[0]);
+	EXPECT_EQ(0u, skipped[1]);
+	EXPECT_EQ(1u, skipped[2]);
+	EXPECT_EQ(0u, skipped[3]);
+	EXPECT_EQ(0u, skipped[4]);
+}
+
+TEST_F(EntityUpdatesTest, testSelectWithinBudget) {
+	uint32_t skipped[2] = { 2u, 2u };
+	std::vector<EntityUpdateCandidate> candidates {
+		EntityUpdateCandidate { nullptr, 1.0f, &skipped[0] },
+		EntityUpdateCandidate { nullptr, 2.0f, &skipped[1] }
+	};
+	selectEntityUpdates(candidates, 10u);
+	EXPECT_EQ(2u, candidates.size());
+	EXPECT_EQ(0u, skipped[0]);
+	EXPECT_EQ(0u, skipped[1]);
+	selectEntityUpdates(candidates, 0u);
+	EXPECT_TRUE(candidates.empty());
+	EXPECT_EQ(1u, skipped[0]);
+	EXPECT_EQ(1u, skipped[1]);
+}
+
+}
@@ -0,0 +1,64 @@
+/**
+ * @file
+ */
+
+#include "FrameStages.h"
+#include "Trace.h"
+#include <chrono>
+
+namespace core {
+
+static inline uint64_t nowMicros() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int FrameStages::add(const std::string& name, Resources reads, Resources writes, Func&& func) {
+	int wave = 0;
+	for (const Stage& stage : _stages) {
+		const bool dependency = (stage.writes & (reads | writes)) != 0u || (stage.reads & writes) != 0u;
+		if (dependency && stage.wave >= wave) {
+			wave = stage.wave + 1;
+		}
+	}
+	_stages.push_back(Stage { name, reads, writes, std::move(func), wave, 0u, 0.0 });
+	if (wave >= _waves) {
+		_waves = wave + 1;
+	}
+	return (int)_stages.size() - 1;
+}
+
+void FrameStages::execute(Stage& stage, long dt) {
+	TraceScoped trace(stage.name.c_str());
+	const uint64_t start = nowMicros();
+	stage.func(dt);
+	stage.micros = nowMicros() - start;
+	stage.averageMicros += ((double)stage.micros - stage.averageMicros) * 0.1;
+}
+
+void FrameStages::run(ThreadPool& threadPool, long dt) {
+	const uint64_t start = nowMicros();
+	for (int wave = 0; wave < _waves; ++wave) {
+		Stage* local = nullptr;
+		for (Stage& stage : _stages) {
+			if (stage.wave != wave) {
+				continue;
+			}
+			if (local != nullptr) {
+				_futures.push_back(threadPool.enqueue([this, local, dt] () {
+					execute(*local, dt);
+				}));
+			}
+			local = &stage;
+		}
+		if (local != nullptr) {
+			execute(*local, dt);
+		}
+		for (std::future<void>& future : _futures) {
+			future.get();
+		}
+		_futures.clear();
+	}
+	_frameMicros = nowMicros() - start;
+}
+
+}
@@ -0,0 +1,85 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "ThreadPool.h"
+#include <functional>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace core {
+
+/**
+ * @brief Splits a frame into stages that declare the resources they read and write.
+ *
+ * A stage depends on every stage that was added before and that writes a resource the stage reads or
+ * writes - or that reads a resource the stage writes. Stages without such a dependency between each
+ * other are executed in parallel on the given @c ThreadPool, the others are executed in the order they
+ * were added.
+ *
+ * The execution time of every stage is measured and can be queried via @c stages() after the frame.
+ */
+class FrameStages {
+public:
+	/**
+	 * @brief A bit mask of the resources - the meaning of the bits is up to the user
+	 */
+	typedef uint32_t Resources;
+	typedef std::function<void(long dt)> Func;
+
+	struct Stage {
+		std::string name;
+		Resources reads;
+		Resources writes;
+		Func func;
+		// the stages of the same wave are executed in parallel
+		int wave;
+		// the execution time of the last frame
+		uint64_t micros;
+		// the exponential moving average of the execution time
+		double averageMicros;
+	};
+
+private:
+	std::vector<Stage> _stages;
+	std::vector<std::future<void>> _futures;
+	int _waves = 0;
+	uint64_t _frameMicros = 0u;
+
+	void execute(Stage& stage, long dt);
+public:
+	/**
+	 * @brief Adds a new stage that is executed after all the stages it depends on
+	 * @return The index of the stage
+	 */
+	int add(const std::string& name, Resources reads, Resources writes, Func&& func);
+
+	/**
+	 * @brief Executes all stages and waits until all of them are finished.
+	 * @note The last stage of every wave is executed on the calling thread.
+	 */
+	void run(ThreadPool& threadPool, long dt);
+
+	inline const std::vector<Stage>& stages() const {
+		return _stages;
+	}
+
+	/**
+	 * @return The amount of waves of stages that are executed one after another
+	 */
+	inline int waves() const {
+		return _waves;
+	}
+
+	/**
+	 * @return The execution time of the last frame
+	 */
+	inline uint64_t frameMicros() const {
+		return _frameMicros;
+	}
+};
+
+}
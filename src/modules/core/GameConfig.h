@@ -31,6 +31,7 @@ constexpr const char *ClientWindowHeight = "cl_height";
 constexpr const char *ClientGamma = "cl_gamma";
 constexpr const char *ClientShadowMap = "cl_shadowmap";
 constexpr const char *ClientCameraMaxTargetDistance = "cl_cameramaxtargetdistance";
+constexpr const char *ClientMeshQueueBudget = "cl_meshqueuebudget";
 
 constexpr const char *ClientShadowMapShow = "cl_debug_shadowmapshow";
 constexpr const char *ClientDebugShadowMapCascade = "cl_debug_cascade";
@@ -38,6 +39,8 @@ constexpr const char *ClientDebugShadow = "cl_debug_shadow";
 
 constexpr const char *ServerAutoRegister = "sv_autoregister";
 constexpr const char *ServerUserTimeout = "sv_usertimeout";
+// the estimated amount of bytes per tick that the entity updates for a single user may use
+constexpr const char *ServerEntityUpdateBudget = "sv_entityupdatebudget";
 // the server side seed that is used to create the world
 constexpr const char *ServerSeed = "sv_seed";
 constexpr const char *ServerHost = "sv_host";
@@ -50,6 +53,10 @@ constexpr const char *CoreLogLevel = "core_loglevel";
 
 // The size of the chunk that is extracted with each step
 constexpr const char *VoxelMeshSize = "voxel_meshsize";
+// Use the binary greedy mesher instead of the cubic surface extractor
+constexpr const char *VoxelGreedyMeshing = "voxel_greedymeshing";
+// The amount of asynchronous path searches that are started per frame
+constexpr const char *VoxelPathBudget = "voxel_pathbudget";
 
 constexpr const char *DatabaseName = "db_name";
 constexpr const char *DatabaseHost = "db_host";
@@ -57,6 +64,12 @@ constexpr const char *DatabasePassword = "db_pw";
 constexpr const char *DatabaseUser = "db_user";
 constexpr const char *DatabaseMinConnections = "db_minconnections";
 constexpr const char *DatabaseMaxConnections = "db_maxconnections";
+// The milliseconds to wait for a pooled connection if all of them are in use
+constexpr const char *DatabaseAcquireTimeout = "db_acquiretimeout";
+// The milliseconds a pooled connection may be idle before it is checked again before it is handed out
+constexpr const char *DatabaseIdleCheck = "db_idlecheck";
+// The amount of threads with a dedicated connection that are executing the asynchronous queries
+constexpr const char *DatabaseWorkers = "db_workers";
 
 constexpr const char *AppHomePath = "app_homepath";
 constexpr const char *AppBasePath = "app_basepath";
@@ -162,6 +162,26 @@ private:
 	QuadTreeNode _root;
 	// dirty flag can be used for query caches
 	bool _dirty;
+	// buffers for the batch queries: z-order key and index of the query areas
+	std::vector<std::pair<uint32_t, size_t> > _batchOrder;
+	Contents _batchCandidates;
+
+	static inline Rect<TYPE> merge(const Rect<TYPE>& a, const Rect<TYPE>& b) {
+		return Rect<TYPE>(std::min(a.getMinX(), b.getMinX()), std::min(a.getMinZ(), b.getMinZ()),
+				std::max(a.getMaxX(), b.getMaxX()), std::max(a.getMaxZ(), b.getMaxZ()));
+	}
+
+	// interleaves the bits of the two 16 bit values
+	static inline uint32_t zorder(uint32_t x, uint32_t z) {
+		auto spread = [] (uint32_t v) {
+			v = (v | (v << 8)) & 0x00FF00FFu;
+			v = (v | (v << 4)) & 0x0F0F0F0Fu;
+			v = (v | (v << 2)) & 0x33333333u;
+			v = (v | (v << 1)) & 0x55555555u;
+			return v;
+		};
+		return spread(x) | (spread(z) << 1);
+	}
 public:
 	QuadTree(const Rect<TYPE>& rectangle, int maxDepth = 10) :
 			_root(rectangle, maxDepth, 0), _dirty(false) {
@@ -179,6 +199,11 @@ public:
 		return false;
 	}
 
+	/**
+	 * @brief Removes the item by walking down the path given by its rect - this is O(depth).
+	 * @note The rect of the item must be the same as at the time it was inserted. Items whose rect
+	 * changes over time should store a snapshot of the rect.
+	 */
 	inline bool remove(const NODE& item) {
 		if (_root.remove(item)) {
 			_dirty = true;
@@ -187,11 +212,88 @@ public:
 		return false;
 	}
 
+	/**
+	 * @brief Moves an item without touching the rest of the tree
+	 * @param[in] oldItem The item with the rect it was inserted with
+	 * @param[in] newItem The item with its new rect
+	 * @return @c false if the old item wasn't found or the new rect is outside of the tree. The item is
+	 * not part of the tree in this case.
+	 */
+	inline bool move(const NODE& oldItem, const NODE& newItem) {
+		if (!_root.remove(oldItem)) {
+			return false;
+		}
+		_dirty = true;
+		return _root.insert(newItem);
+	}
+
 	inline void query(const Rect<TYPE>& area, Contents& results) const {
 		core_trace_scoped(QuadTreeQuery);
 		_root.query(area, results);
 	}
 
+	/**
+	 * @brief Executes the queries for all the given areas. The areas are sorted along a z-order curve and
+	 * neighbouring areas are grouped - each group only walks the tree once for the union of its areas. The
+	 * result of that query is then filtered for the single areas.
+	 *
+	 * @param[out] results One result list for each of the given areas - with the same content as the single
+	 * area @c query() would return. The lists are appended to.
+	 */
+	void query(const std::vector<Rect<TYPE> >& areas, std::vector<Contents>& results) {
+		core_trace_scoped(QuadTreeBatchQuery);
+		// more areas per group means less traversals but more candidates that are filtered for each area
+		const size_t maxGroupSize = 4u;
+		results.resize(areas.size());
+		if (areas.empty()) {
+			return;
+		}
+		Rect<TYPE> bounds = areas[0];
+		for (const Rect<TYPE>& area : areas) {
+			bounds = merge(bounds, area);
+		}
+		const double width = std::max(1.0, (double)bounds.getMaxX() - (double)bounds.getMinX());
+		const double depth = std::max(1.0, (double)bounds.getMaxZ() - (double)bounds.getMinZ());
+		_batchOrder.clear();
+		for (size_t i = 0; i < areas.size(); ++i) {
+			const uint32_t x = (uint32_t)(((double)areas[i].getMinX() - (double)bounds.getMinX()) / width * 65535.0);
+			const uint32_t z = (uint32_t)(((double)areas[i].getMinZ() - (double)bounds.getMinZ()) / depth * 65535.0);
+			_batchOrder.emplace_back(zorder(x, z), i);
+		}
+		std::sort(_batchOrder.begin(), _batchOrder.end());
+
+		const size_t n = _batchOrder.size();
+		for (size_t groupStart = 0u; groupStart < n;) {
+			const Rect<TYPE>& first = areas[_batchOrder[groupStart].second];
+			const double maxGroupWidth = 2.0 * ((double)first.getMaxX() - (double)first.getMinX());
+			const double maxGroupDepth = 2.0 * ((double)first.getMaxZ() - (double)first.getMinZ());
+			Rect<TYPE> group = first;
+			size_t groupEnd = groupStart + 1u;
+			// don't group areas that are too far away from each other
+			for (; groupEnd < n && groupEnd - groupStart < maxGroupSize; ++groupEnd) {
+				const Rect<TYPE>& merged = merge(group, areas[_batchOrder[groupEnd].second]);
+				if ((double)merged.getMaxX() - (double)merged.getMinX() > maxGroupWidth
+						|| (double)merged.getMaxZ() - (double)merged.getMinZ() > maxGroupDepth) {
+					break;
+				}
+				group = merged;
+			}
+			_batchCandidates.clear();
+			_root.query(group, _batchCandidates);
+			for (size_t i = groupStart; i < groupEnd; ++i) {
+				const size_t index = _batchOrder[i].second;
+				const Rect<TYPE>& area = areas[index];
+				Contents& contents = results[index];
+				for (const NODE& item : _batchCandidates) {
+					if (area.intersectsWith(QuadTreeNode::rect(item))) {
+						contents.push_back(item);
+					}
+				}
+			}
+			groupStart = groupEnd;
+		}
+	}
+
 	void clear() {
 		auto size = _root._contents.size();
 		_dirty = true;
@@ -0,0 +1,81 @@
+/**
+ * @file
+ */
+
+#include "RangeAllocator.h"
+#include "core/Assert.h"
+#include <iterator>
+
+namespace core {
+
+RangeAllocator::RangeAllocator(uint32_t capacity) :
+		_capacity(0u) {
+	grow(capacity);
+}
+
+bool RangeAllocator::allocate(uint32_t size, uint32_t& offset) {
+	if (size == 0u) {
+		return false;
+	}
+	for (auto i = _free.begin(); i != _free.end(); ++i) {
+		if (i->second < size) {
+			continue;
+		}
+		offset = i->first;
+		const uint32_t remaining = i->second - size;
+		_free.erase(i);
+		if (remaining > 0u) {
+			_free.emplace(offset + size, remaining);
+		}
+		_used += size;
+		return true;
+	}
+	return false;
+}
+
+void RangeAllocator::free(uint32_t offset, uint32_t size) {
+	if (size == 0u) {
+		return;
+	}
+	core_assert_msg(offset + size <= _capacity, "Range %u:%u exceeds the capacity %u", offset, size, _capacity);
+	core_assert_msg(_used >= size, "Range %u:%u was not allocated", offset, size);
+	_used -= size;
+
+	auto next = _free.lower_bound(offset);
+	core_assert_msg(next == _free.end() || next->first >= offset + size, "Range %u:%u overlaps a free range", offset, size);
+	if (next != _free.begin()) {
+		auto prev = std::prev(next);
+		core_assert_msg(prev->first + prev->second <= offset, "Range %u:%u overlaps a free range", offset, size);
+		if (prev->first + prev->second == offset) {
+			offset = prev->first;
+			size += prev->second;
+			_free.erase(prev);
+		}
+	}
+	if (next != _free.end() && offset + size == next->first) {
+		size += next->second;
+		_free.erase(next);
+	}
+	_free.emplace(offset, size);
+}
+
+void RangeAllocator::grow(uint32_t capacity) {
+	if (capacity <= _capacity) {
+		return;
+	}
+	const uint32_t oldCapacity = _capacity;
+	_capacity = capacity;
+	// hand the new range in as if it was allocated - this merges it with a free range at the end
+	_used += capacity - oldCapacity;
+	free(oldCapacity, capacity - oldCapacity);
+}
+
+void RangeAllocator::clear() {
+	_free.clear();
+	_used = 0u;
+	if (_capacity > 0u) {
+		_free.emplace(0u, _capacity);
+	}
+}
+
+}
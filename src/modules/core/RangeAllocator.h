@@ -0,0 +1,67 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include <map>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace core {
+
+/**
+ * @brief Manages the free ranges of a linear address space - e.g. a big gpu buffer that is shared by
+ * a lot of small meshes. Doesn't allocate any memory itself.
+ *
+ * Freed ranges are merged with their free neighbours.
+ */
+class RangeAllocator {
+private:
+	// offset => size of the free ranges
+	std::map<uint32_t, uint32_t> _free;
+	uint32_t _capacity;
+	uint32_t _used = 0u;
+public:
+	RangeAllocator(uint32_t capacity = 0u);
+
+	/**
+	 * @brief First fit allocation of the given amount of elements
+	 * @param[out] offset The start of the allocated range
+	 * @return @c false if there is no free range with the given size - you could grow() the allocator in this case.
+	 */
+	bool allocate(uint32_t size, uint32_t& offset);
+	/**
+	 * @brief Hand a range back that was returned by allocate()
+	 */
+	void free(uint32_t offset, uint32_t size);
+	/**
+	 * @brief Extends the address space - already allocated ranges keep their offsets
+	 */
+	void grow(uint32_t capacity);
+	/**
+	 * @brief Frees all ranges
+	 */
+	void clear();
+
+	uint32_t capacity() const;
+	uint32_t used() const;
+	/**
+	 * @return The amount of free ranges - this is a measure for the fragmentation
+	 */
+	size_t freeRanges() const;
+};
+
+inline uint32_t RangeAllocator::capacity() const {
+	return _capacity;
+}
+
+inline uint32_t RangeAllocator::used() const {
+	return _used;
+}
+
+inline size_t RangeAllocator::freeRanges() const {
+	return _free.size();
+}
+
+}
@@ -0,0 +1,127 @@
+/**
+ * @file
+ */
+
+#include <gtest/gtest.h>
+#include "core/tests/Benchmark.h"
+#include "core/QuadTree.h"
+#include <random>
+#include <string>
+
+namespace core {
+
+class QuadTreeBenchmark: public testing::Test {
+protected:
+	struct Node {
+		int id;
+		RectFloat rect;
+
+		RectFloat getRect() const {
+			return rect;
+		}
+
+		bool operator==(const Node& rhs) const {
+			return rhs.id == id;
+		}
+	};
+	typedef QuadTree<Node, float> Tree;
+
+	// the entity storage layout: the whole float range with leaves of 128 units, entities spread over a few km
+	const RectFloat _area = RectFloat::getMaxRect();
+	const int _maxDepth = 122;
+	const float _worldSize = 4096.0f;
+	const float _entitySize = 1.0f;
+	const float _viewDistance = 50.0f;
+
+	std::vector<glm::vec2> _positions;
+	std::vector<RectFloat> _inserted;
+	std::mt19937 _rnd { 42 };
+
+	inline RectFloat rect(const glm::vec2& pos, float size) const {
+		return RectFloat(pos.x - size, pos.y - size, pos.x + size, pos.y + size);
+	}
+
+	void spawn(int entities) {
+		std::uniform_real_distribution<float> dist(0.0f, _worldSize);
+		_positions.clear();
+		for (int i = 0; i < entities; ++i) {
+			_positions.emplace_back(dist(_rnd), dist(_rnd));
+		}
+	}
+
+	// every tenth entity moves a bit per tick
+	void move(int tick) {
+		std::uniform_real_distribution<float> dist(-2.0f, 2.0f);
+		for (size_t i = tick % 10; i < _positions.size(); i += 10) {
+			_positions[i] += glm::vec2(dist(_rnd), dist(_rnd));
+		}
+	}
+
+	void run(int entities) {
+		spawn(entities);
+		const int n = (int)_positions.size();
+		const int iterations = 10;
+		const std::string suffix = std::to_string(entities);
+		size_t found = 0u;
+
+		Tree rebuild(_area, _maxDepth);
+		int tick = 0;
+		measure(("rebuild" + suffix).c_str(), iterations, [&] () {
+			move(tick++);
+			rebuild.clear();
+			for (int i = 0; i < n; ++i) {
+				rebuild.insert(Node { i, rect(_positions[i], _entitySize) });
+			}
+			for (int i = 0; i < n; ++i) {
+				Tree::Contents contents;
+				rebuild.query(rect(_positions[i], _viewDistance), contents);
+				found += contents.size();
+			}
+		});
+
+		spawn(entities);
+		Tree incremental(_area, _maxDepth);
+		_inserted.clear();
+		for (int i = 0; i < n; ++i) {
+			_inserted.push_back(rect(_positions[i], _entitySize));
+			incremental.insert(Node { i, _inserted.back() });
+		}
+		std::vector<RectFloat> viewRects;
+		std::vector<Tree::Contents> results;
+		tick = 0;
+		measure(("incremental" + suffix).c_str(), iterations, [&] () {
+			move(tick++);
+			viewRects.clear();
+			for (int i = 0; i < n; ++i) {
+				const RectFloat& r = rect(_positions[i], _entitySize);
+				if (!(r == _inserted[i])) {
+					incremental.move(Node { i, _inserted[i] }, Node { i, r });
+					_inserted[i] = r;
+				}
+				viewRects.push_back(rect(_positions[i], _viewDistance));
+			}
+			for (Tree::Contents& contents : results) {
+				contents.clear();
+			}
+			incremental.query(viewRects, results);
+			for (const Tree::Contents& contents : results) {
+				found += contents.size();
+			}
+		});
+		ASSERT_GT(found, 0u);
+	}
+};
+
+TEST_F(QuadTreeBenchmark, benchmark1k) {
+	run(1000);
+}
+
+TEST_F(QuadTreeBenchmark, benchmark5k) {
+	run(5000);
+}
+
+TEST_F(QuadTreeBenchmark, benchmark20k) {
+	run(20000);
+}
+
+}
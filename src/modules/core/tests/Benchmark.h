@@ -0,0 +1,37 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+namespace core {
+
+/**
+ * @brief Executes the given functor @c iterations times (after one warm up run) and
+ * prints the average wall clock time. The value is also recorded as test property to
+ * end up in the xml output of gtest.
+ *
+ * @note Must be called from within a running gtest test.
+ * @return The average time in milliseconds per iteration
+ */
+template<class FUNC>
+double measure(const char *name, int iterations, FUNC&& func) {
+	func();
+	const auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < iterations; ++i) {
+		func();
+	}
+	const auto end = std::chrono::high_resolution_clock::now();
+	const std::chrono::duration<double, std::milli> elapsed = end - start;
+	const double millisPerIteration = elapsed.count() / (double)iterations;
+	std::printf("[ BENCHMARK] %s: %.4f ms (%i iterations)\n", name, millisPerIteration, iterations);
+	::testing::Test::RecordProperty(name, std::to_string(millisPerIteration));
+	return millisPerIteration;
+}
+
+}
@@ -0,0 +1,87 @@
+/**
+ * @file
+ */
+
+#include "AbstractTest.h"
+#include "core/FrameStages.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+namespace core {
+
+class FrameStagesTest: public AbstractTest {
+protected:
+	enum : FrameStages::Resources {
+		A = 1 << 0,
+		B = 1 << 1,
+		C = 1 << 2
+	};
+};
+
+TEST_F(FrameStagesTest, testWaves) {
+	FrameStages stages;
+	ASSERT_EQ(0, stages.add("writeA", 0u, A, [] (long) {}));
+	ASSERT_EQ(1, stages.add("writeB", 0u, B, [] (long) {}));
+	ASSERT_EQ(2, stages.add("readA", A, 0u, [] (long) {}));
+	ASSERT_EQ(3, stages.add("readAB", A | B, 0u, [] (long) {}));
+	ASSERT_EQ(4, stages.add("writeAC", 0u, A | C, [] (long) {}));
+	const std::vector<FrameStages::Stage>& s = stages.stages();
+	EXPECT_EQ(0, s[0].wave);
+	EXPECT_EQ(0, s[1].wave) << "Stages without shared resources should run in parallel";
+	EXPECT_EQ(1, s[2].wave) << "A read must wait for the write";
+	EXPECT_EQ(1, s[3].wave) << "Two reads should run in parallel";
+	EXPECT_EQ(2, s[4].wave) << "A write must wait for the reads";
+	EXPECT_EQ(3, stages.waves());
+}
+
+TEST_F(FrameStagesTest, testOrder) {
+	ThreadPool pool(4);
+	FrameStages stages;
+	std::mutex mutex;
+	std::vector<std::string> order;
+	auto record = [&] (const char *name) {
+		return [&, name] (long dt) {
+			ASSERT_EQ(42, dt);
+			std::lock_guard<std::mutex> lock(mutex);
+			order.push_back(name);
+		};
+	};
+	stages.add("network", 0u, A, record("network"));
+	stages.add("world", 0u, B, record("world"));
+	stages.add("entities", A | B, C, record("entities"));
+	stages.add("flush", C, A, record("flush"));
+	for (int i = 0; i < 10; ++i) {
+		order.clear();
+		stages.run(pool, 42L);
+		ASSERT_EQ(4u, order.size());
+		EXPECT_EQ("entities", order[2]);
+		EXPECT_EQ("flush", order[3]);
+	}
+}
+
+TEST_F(FrameStagesTest, testParallel) {
+	ThreadPool pool(4);
+	FrameStages stages;
+	std::atomic_int running(0);
+	std::atomic_int maxRunning(0);
+	auto func = [&] (long) {
+		const int n = ++running;
+		int expected = maxRunning;
+		while (n > expected && !maxRunning.compare_exchange_weak(expected, n)) {
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		--running;
+	};
+	stages.add("a", 0u, A, func);
+	stages.add("b", 0u, B, func);
+	stages.add("c", 0u, C, func);
+	stages.run(pool, 0L);
+	EXPECT_EQ(3, maxRunning) << "The stages of a wave should be executed in parallel";
+	for (const FrameStages::Stage& stage : stages.stages()) {
+		EXPECT_GE(stage.micros, 10000u) << stage.name;
+	}
+	EXPECT_GE(stages.frameMicros(), 10000u);
+}
+
+}
@@ -4,6 +4,7 @@
 
 #include <gtest/gtest.h>
 #include "core/QuadTree.h"
+#include <random>
 
 namespace core {
 
@@ -23,8 +24,29 @@ public:
 	bool operator==(const Item& rhs) const {
 		return rhs._id == _id;
 	}
+
+	int id() const {
+		return _id;
+	}
 };
 
+static std::vector<int> ids(const QuadTree<Item, float>::Contents& contents) {
+	std::vector<int> result;
+	for (const Item& item : contents) {
+		result.push_back(item.id());
+	}
+	std::sort(result.begin(), result.end());
+	return result;
+}
+
+static RectFloat randomRect(std::mt19937& rnd) {
+	std::uniform_real_distribution<float> pos(0.0f, 990.0f);
+	std::uniform_real_distribution<float> size(1.0f, 10.0f);
+	const float x = pos(rnd);
+	const float z = pos(rnd);
+	return RectFloat(x, z, x + size(rnd), z + size(rnd));
+}
+
 TEST(QuadTreeTest, testAdd) {
 	QuadTree<Item, float> quadTree(RectFloat(0, 0, 100, 100));
 	EXPECT_EQ(0, quadTree.count())<< "Expected to have no entries in the quad tree";
@@ -75,4 +97,73 @@ TEST(QuadTreeTest, testQuery) {
 	}
 }
 
+TEST(QuadTreeTest, testMove) {
+	QuadTree<Item, float> quadTree(RectFloat(0.0f, 0.0f, 100.0f, 100.0f));
+	const Item item(RectFloat(51.0f, 51.0f, 53.0f, 53.0f), 1);
+	EXPECT_TRUE(quadTree.insert(item));
+	const Item moved(RectFloat(11.0f, 11.0f, 13.0f, 13.0f), 1);
+	EXPECT_TRUE(quadTree.move(item, moved));
+	EXPECT_EQ(1, quadTree.count());
+	QuadTree<Item, float>::Contents contents;
+	quadTree.query(item.getRect(), contents);
+	EXPECT_TRUE(contents.empty()) << "Expected to find nothing at the old position";
+	quadTree.query(moved.getRect(), contents);
+	EXPECT_EQ(1u, contents.size()) << "Expected to find the item at the new position";
+	EXPECT_FALSE(quadTree.move(item, moved)) << "The old rect is no longer in the tree";
+}
+
+TEST(QuadTreeTest, testIncrementalMatchesRebuild) {
+	const RectFloat area(0.0f, 0.0f, 1000.0f, 1000.0f);
+	std::mt19937 rnd(42);
+	std::vector<Item> items;
+	QuadTree<Item, float> incremental(area);
+	for (int i = 0; i < 1000; ++i) {
+		items.emplace_back(randomRect(rnd), i);
+		ASSERT_TRUE(incremental.insert(items.back()));
+	}
+	for (int round = 0; round < 10; ++round) {
+		for (size_t i = round; i < items.size(); i += 3) {
+			const Item moved(randomRect(rnd), items[i].id());
+			ASSERT_TRUE(incremental.move(items[i], moved));
+			items[i] = moved;
+		}
+	}
+	QuadTree<Item, float> rebuild(area);
+	for (const Item& item : items) {
+		ASSERT_TRUE(rebuild.insert(item));
+	}
+	ASSERT_EQ(rebuild.count(), incremental.count());
+	for (int i = 0; i < 100; ++i) {
+		const RectFloat& query = randomRect(rnd);
+		const RectFloat big(query.getMinX(), query.getMinZ(), query.getMaxX() + 100.0f, query.getMaxZ() + 100.0f);
+		QuadTree<Item, float>::Contents expected;
+		QuadTree<Item, float>::Contents contents;
+		rebuild.query(big, expected);
+		incremental.query(big, contents);
+		ASSERT_EQ(ids(expected), ids(contents));
+	}
+}
+
+TEST(QuadTreeTest, testBatchQuery) {
+	std::mt19937 rnd(42);
+	QuadTree<Item, float> quadTree(RectFloat(0.0f, 0.0f, 1000.0f, 1000.0f));
+	for (int i = 0; i < 1000; ++i) {
+		ASSERT_TRUE(quadTree.insert(Item(randomRect(rnd), i)));
+	}
+	std::vector<RectFloat> areas;
+	for (int i = 0; i < 50; ++i) {
+		const RectFloat& r = randomRect(rnd);
+		areas.emplace_back(r.getMinX(), r.getMinZ(), r.getMaxX() + 50.0f, r.getMaxZ() + 50.0f);
+	}
+	areas.push_back(RectFloat(0.0f, 0.0f, 1000.0f, 1000.0f));
+	std::vector<QuadTree<Item, float>::Contents> results;
+	quadTree.query(areas, results);
+	ASSERT_EQ(areas.size(), results.size());
+	for (size_t i = 0; i < areas.size(); ++i) {
+		QuadTree<Item, float>::Contents expected;
+		quadTree.query(areas[i], expected);
+		ASSERT_EQ(ids(expected), ids(results[i])) << "Batch query " << i << " differs";
+	}
+}
+
 }
@@ -0,0 +1,85 @@
+/**
+ * @file
+ */
+
+#include <gtest/gtest.h>
+#include "core/RangeAllocator.h"
+
+namespace core {
+
+TEST(RangeAllocatorTest, testAllocate) {
+	RangeAllocator allocator(100u);
+	uint32_t offset1 = 0u;
+	uint32_t offset2 = 0u;
+	ASSERT_TRUE(allocator.allocate(60u, offset1));
+	ASSERT_TRUE(allocator.allocate(40u, offset2));
+	EXPECT_EQ(0u, offset1);
+	EXPECT_EQ(60u, offset2);
+	EXPECT_EQ(100u, allocator.used());
+	uint32_t offset3 = 0u;
+	EXPECT_FALSE(allocator.allocate(1u, offset3));
+	EXPECT_FALSE(allocator.allocate(0u, offset3));
+}
+
+TEST(RangeAllocatorTest, testFreeMergesNeighbours) {
+	RangeAllocator allocator(30u);
+	uint32_t offsets[3];
+	for (uint32_t& offset : offsets) {
+		ASSERT_TRUE(allocator.allocate(10u, offset));
+	}
+	EXPECT_EQ(0u, allocator.freeRanges());
+	allocator.free(offsets[0], 10u);
+	allocator.free(offsets[2], 10u);
+	EXPECT_EQ(2u, allocator.freeRanges());
+	uint32_t offset = 0u;
+	EXPECT_FALSE(allocator.allocate(20u, offset)) << "Free ranges are not adjacent";
+	allocator.free(offsets[1], 10u);
+	EXPECT_EQ(1u, allocator.freeRanges());
+	EXPECT_EQ(0u, allocator.used());
+	ASSERT_TRUE(allocator.allocate(30u, offset));
+	EXPECT_EQ(0u, offset);
+}
+
+TEST(RangeAllocatorTest, testFirstFit) {
+	RangeAllocator allocator(100u);
+	uint32_t a, b, c;
+	ASSERT_TRUE(allocator.allocate(10u, a));
+	ASSERT_TRUE(allocator.allocate(20u, b));
+	ASSERT_TRUE(allocator.allocate(10u, c));
+	allocator.free(b, 20u);
+	uint32_t offset = 0u;
+	ASSERT_TRUE(allocator.allocate(15u, offset));
+	EXPECT_EQ(b, offset) << "The hole should be reused";
+	ASSERT_TRUE(allocator.allocate(5u, offset));
+	EXPECT_EQ(b + 15u, offset);
+	ASSERT_TRUE(allocator.allocate(6u, offset));
+	EXPECT_EQ(c + 10u, offset);
+}
+
+TEST(RangeAllocatorTest, testGrow) {
+	RangeAllocator allocator(10u);
+	uint32_t a, b;
+	ASSERT_TRUE(allocator.allocate(5u, a));
+	ASSERT_TRUE(allocator.allocate(5u, b));
+	allocator.free(b, 5u);
+	uint32_t offset = 0u;
+	ASSERT_FALSE(allocator.allocate(10u, offset));
+	allocator.grow(20u);
+	EXPECT_EQ(20u, allocator.capacity());
+	EXPECT_EQ(1u, allocator.freeRanges()) << "The new range should be merged with the free range at the end";
+	ASSERT_TRUE(allocator.allocate(15u, offset));
+	EXPECT_EQ(5u, offset);
+	EXPECT_EQ(20u, allocator.used());
+}
+
+TEST(RangeAllocatorTest, testClear) {
+	RangeAllocator allocator(10u);
+	uint32_t offset = 0u;
+	ASSERT_TRUE(allocator.allocate(5u, offset));
+	allocator.clear();
+	EXPECT_EQ(0u, allocator.used());
+	ASSERT_TRUE(allocator.allocate(10u, offset));
+	EXPECT_EQ(0u, offset);
+}
+
+}
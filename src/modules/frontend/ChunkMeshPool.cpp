@@ -0,0 +1,74 @@
+/**
+ * @file
+ */
+
+#include "ChunkMeshPool.h"
+#include <algorithm>
+
+namespace frontend {
+
+namespace {
+
+bool allocateRange(core::RangeAllocator& allocator, uint32_t size, uint32_t& offset) {
+	if (allocator.allocate(size, offset)) {
+		return true;
+	}
+	allocator.grow(std::max(allocator.capacity() * 2u, allocator.capacity() + size));
+	return allocator.allocate(size, offset);
+}
+
+}
+
+ChunkMeshPool::ChunkMeshPool(uint32_t vertexCapacity, uint32_t indexCapacity) :
+		_vertices(vertexCapacity), _indices(indexCapacity) {
+}
+
+bool ChunkMeshPool::allocate(const voxel::ChunkMesh& mesh, ChunkMeshRange& range) {
+	range = ChunkMeshRange();
+	const uint32_t vertices = mesh.getNoOfVertices();
+	const uint32_t indices = mesh.getNoOfIndices();
+	if (vertices == 0u || indices == 0u) {
+		return false;
+	}
+	if (!allocateRange(_vertices, vertices, range.vertexOffset)) {
+		return false;
+	}
+	if (!allocateRange(_indices, indices, range.indexOffset)) {
+		_vertices.free(range.vertexOffset, vertices);
+		range = ChunkMeshRange();
+		return false;
+	}
+	range.vertices = vertices;
+	range.indices = indices;
+	return true;
+}
+
+void ChunkMeshPool::free(ChunkMeshRange& range) {
+	if (!range.valid()) {
+		return;
+	}
+	_vertices.free(range.vertexOffset, range.vertices);
+	_indices.free(range.indexOffset, range.indices);
+	range = ChunkMeshRange();
+}
+
+void ChunkMeshPool::clear() {
+	_vertices.clear();
+	_indices.clear();
+}
+
+void ChunkMeshPool::addDrawRanges(const voxel::ChunkMesh& mesh, const ChunkMeshRange& range, std::vector<ChunkDrawRange>& draws) {
+	if (!range.valid()) {
+		return;
+	}
+	const std::vector<voxel::MeshSegment>& segments = mesh.getSegments();
+	if (segments.empty()) {
+		draws.push_back(ChunkDrawRange{mesh.getOffset(), range.indexOffset, range.indices, range.vertexOffset});
+		return;
+	}
+	for (const voxel::MeshSegment& segment : segments) {
+		draws.push_back(ChunkDrawRange{mesh.getOffset(), range.indexOffset + segment.firstIndex, segment.numIndices, range.vertexOffset + segment.firstVertex});
+	}
+}
+
+}
@@ -0,0 +1,95 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/RangeAllocator.h"
+#include "core/GLM.h"
+#include "voxel/polyvox/Mesh.h"
+#include <vector>
+
+namespace frontend {
+
+/**
+ * @brief The location of one chunk mesh in the pooled vertex and index buffers
+ */
+struct ChunkMeshRange {
+	uint32_t vertexOffset = 0u;
+	uint32_t vertices = 0u;
+	uint32_t indexOffset = 0u;
+	uint32_t indices = 0u;
+
+	inline bool valid() const {
+		return indices > 0u;
+	}
+};
+
+/**
+ * @brief One draw call for a chunk mesh range. The vertices are relative to the mesh offset, which is
+ * applied via the model matrix. The indices are relative to the first vertex of the mesh, which is applied
+ * as base vertex of the draw call.
+ */
+struct ChunkDrawRange {
+	glm::ivec3 offset;
+	uint32_t baseIndex;
+	uint32_t numIndices;
+	uint32_t baseVertex;
+};
+
+/**
+ * @brief Manages the ranges of the chunk meshes in one big vertex and index buffer. The meshes are only
+ * uploaded once when they were extracted - and not every frame. This class doesn't know anything about
+ * the gpu buffers, it only hands out the offsets.
+ *
+ * If the pool runs out of space, the capacity is doubled. The already allocated ranges keep their offsets,
+ * but the gpu buffers must be reallocated with the new capacity and all meshes must be uploaded again.
+ */
+class ChunkMeshPool {
+private:
+	core::RangeAllocator _vertices;
+	core::RangeAllocator _indices;
+public:
+	ChunkMeshPool(uint32_t vertexCapacity, uint32_t indexCapacity);
+
+	/**
+	 * @brief Allocates the ranges for the vertices and indices of the given mesh
+	 * @return @c false if the mesh is empty - no range is allocated in this case
+	 * @note Check the capacities after this call - the pool might have grown
+	 */
+	bool allocate(const voxel::ChunkMesh& mesh, ChunkMeshRange& range);
+	/**
+	 * @brief Hands the ranges back to the pool and resets the given range
+	 */
+	void free(ChunkMeshRange& range);
+	void clear();
+
+	uint32_t vertexCapacity() const;
+	uint32_t indexCapacity() const;
+	uint32_t usedVertices() const;
+	uint32_t usedIndices() const;
+
+	/**
+	 * @brief Adds one draw call per segment of the given mesh that was allocated in the given range
+	 * @sa voxel::MeshSegment
+	 */
+	static void addDrawRanges(const voxel::ChunkMesh& mesh, const ChunkMeshRange& range, std::vector<ChunkDrawRange>& draws);
+};
+
+inline uint32_t ChunkMeshPool::vertexCapacity() const {
+	return _vertices.capacity();
+}
+
+inline uint32_t ChunkMeshPool::indexCapacity() const {
+	return _indices.capacity();
+}
+
+inline uint32_t ChunkMeshPool::usedVertices() const {
+	return _vertices.used();
+}
+
+inline uint32_t ChunkMeshPool::usedIndices() const {
+	return _indices.used();
+}
+
+}
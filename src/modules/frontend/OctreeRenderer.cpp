@@ -65,15 +65,18 @@ void OctreeRenderer::processOctreeNodeStructure(voxel::OctreeNode* octreeNode, R
 			glm::ivec3 maxs(std::numeric_limits<int>::min());
 
 			for (auto& v : mesh->getVertexVector()) {
-				mins = glm::min(mins, v.position);
-				maxs = glm::max(maxs, v.position);
+				mins = glm::min(mins, glm::ivec3(v.position));
+				maxs = glm::max(maxs, glm::ivec3(v.position));
 			}
 			for (auto& v : waterMesh->getVertexVector()) {
-				mins = glm::min(mins, v.position);
-				maxs = glm::max(maxs, v.position);
+				mins = glm::min(mins, glm::ivec3(v.position));
+				maxs = glm::max(maxs, glm::ivec3(v.position));
 			}
 
-			node->_aabb = core::AABB<float>(mins, maxs);
+			// the surface extraction task doesn't scale the meshes of the downsampled volumes back
+			const float scale = (float)(1 << octreeNode->height());
+			node->_model = glm::scale(glm::translate(glm::vec3(mesh->getOffset()) * scale), glm::vec3(scale));
+			node->_aabb = core::AABB<float>(glm::vec3(node->_model * glm::vec4(mins, 1.0f)), glm::vec3(node->_model * glm::vec4(maxs, 1.0f)));
 			node->_vb.update(node->_vertexBuffer, mesh->getVertexVector());
 			node->_vb.update(node->_indexBuffer, mesh->getIndexVector());
 		}
@@ -110,10 +113,11 @@ void OctreeRenderer::processOctreeNodeStructure(voxel::OctreeNode* octreeNode, R
 	node->_nodeAndChildrenLastSynced = octree->time();
 }
 
-void OctreeRenderer::renderOctreeNode(const video::Camera& camera, RenderOctreeNode* renderNode) {
+void OctreeRenderer::renderOctreeNode(const video::Camera& camera, const video::Shader& shader, RenderOctreeNode* renderNode) {
 	const int numIndices = renderNode->_vb.elements(renderNode->_indexBuffer, 1, sizeof(voxel::IndexType));
 	if (numIndices > 0 && renderNode->_renderThisNode) {
 		if (camera.isVisible(renderNode->_aabb)) {
+			shader.setUniformMatrix("u_model", renderNode->_model);
 			renderNode->_vb.bind();
 			video::drawElements<voxel::IndexType>(video::Primitive::Triangles, numIndices);
 			renderNode->_vb.unbind();
@@ -127,7 +131,7 @@ void OctreeRenderer::renderOctreeNode(const video::Camera& camera, RenderOctreeN
 				if (renderChildNode == nullptr) {
 					continue;
 				}
-				renderOctreeNode(camera, renderChildNode);
+				renderOctreeNode(camera, shader, renderChildNode);
 			}
 		}
 	}
@@ -165,8 +169,7 @@ void OctreeRenderer::render(const video::Camera& camera) {
 		_depthBuffer.bindTexture(i);
 		video::ScopedShader scoped(_shadowMapShader);
 		_shadowMapShader.setLightviewprojection(cascades[i]);
-		_shadowMapShader.setModel(glm::mat4());
-		renderOctreeNode(camera, _rootNode);
+		renderOctreeNode(camera, _shadowMapShader, _rootNode);
 	}
 	_depthBuffer.unbind();
 	video::cullFace(video::Face::Back);
@@ -187,10 +190,9 @@ void OctreeRenderer::render(const video::Camera& camera) {
 	_worldShader.setViewprojection(camera.viewProjectionMatrix());
 	_worldShader.setShadowmap(video::TextureUnit::One);
 	_worldShader.setDepthsize(glm::vec2(_depthBuffer.dimension()));
-	_worldShader.setModel(glm::mat4());
 	_worldShader.setCascades(cascades);
 	_worldShader.setDistances(distances);
-	renderOctreeNode(camera, _rootNode);
+	renderOctreeNode(camera, _worldShader, _rootNode);
 
 	_colorTexture.unbind();
 }
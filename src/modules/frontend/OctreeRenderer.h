@@ -28,6 +28,8 @@ private:
 		video::Id _vertexBuffer;
 
 		core::AABB<float> _aabb{glm::zero<glm::vec3>(), glm::zero<glm::vec3>()};
+		/** the vertex positions are relative to the mesh offset and downscaled by the node height */
+		glm::mat4 _model;
 
 		voxel::TimeStamp _structureLastSynced = 0;
 		voxel::TimeStamp _propertiesLastSynced = 0;
@@ -61,7 +63,7 @@ private:
 	video::DepthBuffer _depthBuffer;
 
 	void processOctreeNodeStructure(voxel::OctreeNode* octreeNode, RenderOctreeNode* openGLOctreeNode);
-	void renderOctreeNode(const video::Camera& camera, RenderOctreeNode* openGLOctreeNode);
+	void renderOctreeNode(const video::Camera& camera, const video::Shader& shader, RenderOctreeNode* openGLOctreeNode);
 
 public:
 	bool init(voxel::PagedVolume* volume, const voxel::Region& region, int baseNodeSize = 32);
@@ -1,11 +1,12 @@
 #include "RawVolumeRenderer.h"
-#include "voxel/polyvox/CubicSurfaceExtractor.h"
+#include "voxel/polyvox/SurfaceExtractor.h"
 #include "voxel/MaterialColor.h"
 #include "video/ScopedLineWidth.h"
 #include "video/ScopedPolygonMode.h"
 #include "frontend/ShaderAttribute.h"
 #include "video/Camera.h"
 #include "core/Color.h"
+#include <algorithm>
 
 namespace frontend {
 
@@ -27,8 +28,8 @@ struct CustomIsQuadNeeded {
 
 const std::string MaxDepthBufferUniformName = "u_cascades";
 
-RawVolumeRenderer::RawVolumeRenderer() :
-		_shadowMapShader(shader::ShadowmapShader::getInstance()),
+RawVolumeRenderer::RawVolumeRenderer(voxel::SurfaceExtractor extractor) :
+		_extractor(extractor), _shadowMapShader(shader::ShadowmapShader::getInstance()),
 		_worldShader(shader::WorldShader::getInstance()) {
 	_sunDirection = glm::vec3(glm::left.x, glm::down.y, 0.0f);
 }
@@ -102,10 +103,6 @@ bool RawVolumeRenderer::init() {
 
 	_whiteTexture = video::createWhiteTexture("**whitetexture**");
 
-	for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
-		_mesh[idx] = new voxel::Mesh(128, 128, true);
-	}
-
 	return true;
 }
 
@@ -119,6 +116,19 @@ bool RawVolumeRenderer::update(int idx, const std::vector<voxel::VoxelVertex>& v
 		return false;
 	}
 	core_trace_scoped(RawVolumeRendererUpdate);
+	_draws[idx].clear();
+	if (!indices.empty()) {
+		_draws[idx].push_back(ChunkDrawRange{glm::zero<glm::ivec3>(), 0u, (uint32_t)indices.size(), 0u});
+	}
+	return upload(idx, vertices, indices);
+}
+
+bool RawVolumeRenderer::upload(int idx, const std::vector<voxel::VoxelVertex>& vertices, const std::vector<voxel::IndexType>& indices) {
+	if (indices.empty()) {
+		_vertexBuffer[idx].update(_vertexBufferIndex[idx], nullptr, 0);
+		_vertexBuffer[idx].update(_indexBufferIndex[idx], nullptr, 0);
+		return true;
+	}
 	if (!_vertexBuffer[idx].update(_vertexBufferIndex[idx], vertices)) {
 		Log::error("Failed to update the vertex buffer");
 		return false;
@@ -143,43 +153,80 @@ bool RawVolumeRenderer::extract(int idx) {
 		return false;
 	}
 
-	voxel::Mesh* mesh = _mesh[idx];
-	if (mesh == nullptr) {
-		return false;
-	}
-	extract(volume, mesh);
-	update(idx, mesh);
+	extract(volume, _meshes[idx]);
+	update(idx, _meshes[idx]);
 	return true;
 }
 
-void RawVolumeRenderer::update(int idx, voxel::Mesh* mesh) {
-	if (_mesh[idx] != mesh) {
-		delete _mesh[idx];
-		_mesh[idx] = mesh;
+void RawVolumeRenderer::update(int idx, const Meshes& meshes) {
+	core_assert(idx >= 0 && idx < MAX_VOLUMES);
+	for (voxel::Mesh* mesh : _meshes[idx]) {
+		if (std::find(meshes.begin(), meshes.end(), mesh) == meshes.end()) {
+			delete mesh;
+		}
 	}
-	const size_t meshNumberIndices = mesh->getNoOfIndices();
-	if (meshNumberIndices == 0u) {
-		_vertexBuffer[idx].update(_vertexBufferIndex[idx], nullptr, 0);
-		_vertexBuffer[idx].update(_indexBufferIndex[idx], nullptr, 0);
-		return;
+	_meshes[idx] = meshes;
+
+	size_t numVertices = 0u;
+	size_t numIndices = 0u;
+	for (const voxel::Mesh* mesh : meshes) {
+		numVertices += mesh->getNoOfVertices();
+		numIndices += mesh->getNoOfIndices();
 	}
-	update(idx, mesh->getVertexVector(), mesh->getIndexVector());
+	std::vector<voxel::VoxelVertex> vertices;
+	std::vector<voxel::IndexType> indices;
+	vertices.reserve(numVertices);
+	indices.reserve(numIndices);
+	_draws[idx].clear();
+	for (const voxel::Mesh* mesh : meshes) {
+		if (mesh->getNoOfIndices() == 0u) {
+			continue;
+		}
+		_draws[idx].push_back(ChunkDrawRange{mesh->getOffset(), (uint32_t)indices.size(), (uint32_t)mesh->getNoOfIndices(), (uint32_t)vertices.size()});
+		vertices.insert(vertices.end(), mesh->getVertexVector().begin(), mesh->getVertexVector().end());
+		indices.insert(indices.end(), mesh->getIndexVector().begin(), mesh->getIndexVector().end());
+	}
+	upload(idx, vertices, indices);
 }
 
-void RawVolumeRenderer::extract(voxel::RawVolume* volume, voxel::Mesh* mesh) const {
+void RawVolumeRenderer::extract(voxel::RawVolume* volume, Meshes& meshes) const {
 	voxel::Region region = volume->getRegion();
 	region.shiftUpperCorner(1, 1, 1);
-	voxel::extractCubicMesh(volume, region, mesh, CustomIsQuadNeeded());
+	const glm::ivec3& mins = region.getLowerCorner();
+	const glm::ivec3& maxs = region.getUpperCorner();
+	// the quads between two meshes are extracted by the mesh with the greater coordinate - so the
+	// regions don't have to overlap
+	size_t n = 0u;
+	for (int z = mins.z; z <= maxs.z; z += MaxMeshSize) {
+		for (int y = mins.y; y <= maxs.y; y += MaxMeshSize) {
+			for (int x = mins.x; x <= maxs.x; x += MaxMeshSize) {
+				const glm::ivec3 lower(x, y, z);
+				const glm::ivec3 upper = glm::min(lower + (MaxMeshSize - 1), maxs);
+				if (n >= meshes.size()) {
+					meshes.push_back(new voxel::Mesh(128, 128, true));
+				}
+				voxel::extractSurface(_extractor, volume, voxel::Region(lower, upper), meshes[n], CustomIsQuadNeeded());
+				++n;
+			}
+		}
+	}
+	for (size_t i = n; i < meshes.size(); ++i) {
+		delete meshes[i];
+	}
+	meshes.resize(n);
 }
 
 void RawVolumeRenderer::render(const video::Camera& camera) {
 	core_trace_scoped(RawVolumeRendererRender);
 
-	uint32_t numIndices = 0u;
+	bool empty = true;
 	for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
-		numIndices += _vertexBuffer[idx].elements(_indexBufferIndex[idx], 1, sizeof(voxel::IndexType));
+		if (!_draws[idx].empty()) {
+			empty = false;
+			break;
+		}
 	}
-	if (numIndices == 0u) {
+	if (empty) {
 		return;
 	}
 
@@ -205,17 +252,17 @@ void RawVolumeRenderer::render(const video::Camera& camera) {
 		_depthBuffer.bind();
 		video::ScopedShader scoped(_shadowMapShader);
 		for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
-			const uint32_t nIndices = _vertexBuffer[idx].elements(_indexBufferIndex[idx], 1, sizeof(voxel::IndexType));
-			if (nIndices == 0) {
+			if (_draws[idx].empty()) {
 				continue;
 			}
 			core_assert_always(_vertexBuffer[idx].bind());
-			_shadowMapShader.setModel(glm::translate(_offsets[idx]));
 			for (int i = 0; i < maxDepthBuffers; ++i) {
 				_depthBuffer.bindTexture(i);
 				_shadowMapShader.setLightviewprojection(cascades[i]);
-				static_assert(sizeof(voxel::IndexType) == sizeof(uint32_t), "Index type doesn't match");
-				video::drawElements<voxel::IndexType>(video::Primitive::Triangles, nIndices);
+				for (const ChunkDrawRange& draw : _draws[idx]) {
+					_shadowMapShader.setModel(glm::translate(glm::vec3(_offsets[idx] + draw.offset)));
+					video::drawElementsBaseVertex<voxel::IndexType>(video::Primitive::Triangles, draw.numIndices, draw.baseIndex, draw.baseVertex);
+				}
 			}
 			_vertexBuffer[idx].unbind();
 		}
@@ -240,14 +287,14 @@ void RawVolumeRenderer::render(const video::Camera& camera) {
 		video::ScopedPolygonMode polygonMode(camera.polygonMode());
 		video::bindTexture(video::TextureUnit::One, _depthBuffer);
 		for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
-			const uint32_t nIndices = _vertexBuffer[idx].elements(_indexBufferIndex[idx], 1, sizeof(voxel::IndexType));
-			if (nIndices == 0) {
+			if (_draws[idx].empty()) {
 				continue;
 			}
 			core_assert_always(_vertexBuffer[idx].bind());
-			_worldShader.setModel(glm::translate(_offsets[idx]));
-			static_assert(sizeof(voxel::IndexType) == sizeof(uint32_t), "Index type doesn't match");
-			video::drawElements<voxel::IndexType>(video::Primitive::Triangles, nIndices);
+			for (const ChunkDrawRange& draw : _draws[idx]) {
+				_worldShader.setModel(glm::translate(glm::vec3(_offsets[idx] + draw.offset)));
+				video::drawElementsBaseVertex<voxel::IndexType>(video::Primitive::Triangles, draw.numIndices, draw.baseIndex, draw.baseVertex);
+			}
 			_vertexBuffer[idx].unbind();
 		}
 	}
@@ -296,8 +343,11 @@ std::vector<voxel::RawVolume*> RawVolumeRenderer::shutdown() {
 		_vertexBuffer[idx].shutdown();
 		_vertexBufferIndex[idx] = -1;
 		_indexBufferIndex[idx] = -1;
-		delete _mesh[idx];
-		_mesh[idx] = nullptr;
+		for (voxel::Mesh* mesh : _meshes[idx]) {
+			delete mesh;
+		}
+		_meshes[idx].clear();
+		_draws[idx].clear();
 		old.push_back(_rawVolume[idx]);
 		_rawVolume[idx] = nullptr;
 	}
@@ -4,7 +4,9 @@
 #include "video/VertexBuffer.h"
 #include "FrontendShaders.h"
 #include "voxel/polyvox/Mesh.h"
+#include "voxel/polyvox/SurfaceExtractor.h"
 #include "frontend/Shadow.h"
+#include "frontend/ChunkMeshPool.h"
 #include "video/UniformBuffer.h"
 #include "video/Texture.h"
 #include "video/DepthBuffer.h"
@@ -18,14 +20,26 @@ namespace frontend {
 /**
  * @brief Handles the shaders, vertex buffers and rendering of a voxel::RawVolume
  *
+ * The volume is extracted into several meshes if it exceeds the range of the vertex positions (see
+ * @c MaxMeshSize). They share one vertex and index buffer per volume and are drawn with their own offset.
+ *
  * @sa voxel::RawVolume
  */
 class RawVolumeRenderer {
+public:
+	typedef std::vector<voxel::Mesh*> Meshes;
+	/**
+	 * @brief The max amount of voxels per axis that are extracted into one mesh - the vertex
+	 * positions are stored relative to the mesh offset as 8 bit values.
+	 */
+	static constexpr int MaxMeshSize = 255;
 protected:
 	static constexpr int MAX_VOLUMES = 4;
 	voxel::RawVolume* _rawVolume[MAX_VOLUMES] {};
-	voxel::Mesh* _mesh[MAX_VOLUMES] {};
+	Meshes _meshes[MAX_VOLUMES];
+	std::vector<ChunkDrawRange> _draws[MAX_VOLUMES];
 	glm::ivec3 _offsets[MAX_VOLUMES] {};
+	voxel::SurfaceExtractor _extractor;
 
 	video::VertexBuffer _vertexBuffer[MAX_VOLUMES];
 	shader::Materialblock _materialBlock;
@@ -42,17 +56,23 @@ protected:
 	glm::vec3 _diffuseColor = glm::vec3(1.0, 1.0, 1.0);
 	glm::vec3 _ambientColor = glm::vec3(0.2, 0.2, 0.2);
 	glm::vec3 _sunDirection;
+
+	bool upload(int idx, const std::vector<voxel::VoxelVertex>& vertices, const std::vector<voxel::IndexType>& indices);
 public:
-	RawVolumeRenderer();
+	RawVolumeRenderer(voxel::SurfaceExtractor extractor = voxel::SurfaceExtractor::Cubic);
 
 	void render(const video::Camera& camera);
 
 	/**
 	 * @brief Updates the vertex buffers manually
+	 * @note The vertex positions are relative to the offset of the mesh at the given index
 	 * @sa extract()
 	 */
 	bool update(int idx, const std::vector<voxel::VoxelVertex>& vertices, const std::vector<voxel::IndexType>& indices);
-	void update(int idx, voxel::Mesh* mesh);
+	/**
+	 * @brief Takes the ownership of the given meshes and uploads them into the vertex buffers
+	 */
+	void update(int idx, const Meshes& meshes);
 
 	/**
 	 * @brief Reextract the whole volume region and updates the vertex buffers.
@@ -60,7 +80,11 @@ public:
 	 */
 	void extractAll();
 	bool extract(int i);
-	void extract(voxel::RawVolume* volume, voxel::Mesh* mesh) const;
+	/**
+	 * @brief Extracts the whole volume region into meshes of at most @c MaxMeshSize voxels per axis.
+	 * @param[in,out] meshes Missing meshes are allocated, meshes that are no longer needed are deleted.
+	 */
+	void extract(voxel::RawVolume* volume, Meshes& meshes) const;
 
 	/**
 	 * @param[in,out] volume The RawVolume pointer
@@ -71,7 +95,11 @@ public:
 	voxel::RawVolume* setVolume(int idx, voxel::RawVolume* volume, const glm::ivec3& offset = glm::zero<glm::ivec3>());
 	bool setOffset(int idx, const glm::ivec3& offset);
 
-	const voxel::Mesh* mesh(int idx) const;
+	const Meshes& meshes(int idx) const;
+	/**
+	 * @return @c true if there are no indices for the volume at the given index
+	 */
+	bool empty(int idx) const;
 	/**
 	 * @sa setVolume()
 	 */
@@ -117,11 +145,16 @@ inline const voxel::RawVolume* RawVolumeRenderer::volume(int idx) const {
 	return _rawVolume[idx];
 }
 
-inline const voxel::Mesh* RawVolumeRenderer::mesh(int idx) const {
+inline const RawVolumeRenderer::Meshes& RawVolumeRenderer::meshes(int idx) const {
+	core_assert(idx >= 0 && idx < MAX_VOLUMES);
+	return _meshes[idx];
+}
+
+inline bool RawVolumeRenderer::empty(int idx) const {
 	if (idx < 0 || idx >= MAX_VOLUMES) {
-		return nullptr;
+		return true;
 	}
-	return _mesh[idx];
+	return _draws[idx].empty();
 }
 
 }
@@ -8,6 +8,7 @@
 #include "voxel/Spiral.h"
 #include "core/App.h"
 #include "core/Var.h"
+#include "core/TimeProvider.h"
 #include "voxel/MaterialColor.h"
 #include "frontend/PlantDistributor.h"
 #include "video/ScopedViewPort.h"
@@ -17,14 +18,56 @@
 
 constexpr int MinCullingDistance = 500;
 constexpr int MinExtractionCullingDistance = 1000;
+// initial capacities of the pooled chunk mesh buffers - they grow on demand
+constexpr uint32_t OpaqueVertexCapacity = 512 * 1024;
+constexpr uint32_t OpaqueIndexCapacity = 1024 * 1024;
+constexpr uint32_t WaterVertexCapacity = 64 * 1024;
+constexpr uint32_t WaterIndexCapacity = 128 * 1024;
 
 namespace frontend {
 
 const std::string MaxDepthBufferUniformName = "u_cascades";
 
-// TODO: respect max vertex/index size of the one-big-vbo/ibo
+namespace {
+
+/**
+ * @brief Reallocates the gpu buffers if the pool capacity changed
+ * @return @c true if the buffers were reallocated - the content is lost in this case
+ */
+bool reserveBuffers(const ChunkMeshPool& pool, video::VertexBuffer& buffer, int32_t vbo, int32_t ibo) {
+	const size_t vertexSize = pool.vertexCapacity() * sizeof(voxel::VoxelVertex);
+	const size_t indexSize = pool.indexCapacity() * sizeof(voxel::ChunkIndexType);
+	if (buffer.size(vbo) == vertexSize && buffer.size(ibo) == indexSize) {
+		return false;
+	}
+	Log::debug("Reallocate chunk mesh buffers for %u vertices and %u indices", pool.vertexCapacity(), pool.indexCapacity());
+	core_assert_always(buffer.update(vbo, nullptr, vertexSize));
+	core_assert_always(buffer.update(ibo, nullptr, indexSize));
+	return true;
+}
+
+bool uploadRange(video::VertexBuffer& buffer, int32_t vbo, int32_t ibo, const voxel::ChunkMesh& mesh, const ChunkMeshRange& range) {
+	if (!range.valid()) {
+		return true;
+	}
+	const size_t vertexSize = sizeof(voxel::VoxelVertex);
+	if (!buffer.update(vbo, range.vertexOffset * vertexSize, mesh.getRawVertexData(), range.vertices * vertexSize)) {
+		return false;
+	}
+	const size_t indexSize = sizeof(voxel::ChunkIndexType);
+	return buffer.update(ibo, range.indexOffset * indexSize, mesh.getRawIndexData(), range.indices * indexSize);
+}
+
+}
+
 WorldRenderer::WorldRenderer(const voxel::WorldPtr& world) :
-		_octree(core::AABB<int>(), 30), _viewDistance(MinCullingDistance), _world(world) {
+		_octree(core::AABB<int>(), 30), _opaquePool(OpaqueVertexCapacity, OpaqueIndexCapacity),
+		_waterPool(WaterVertexCapacity, WaterIndexCapacity), _viewDistance(MinCullingDistance), _world(world) {
+	_chunkBufferIndex.reserve(MAX_CHUNKBUFFERS);
+	_freeChunkBuffers.reserve(MAX_CHUNKBUFFERS);
+	for (int i = MAX_CHUNKBUFFERS - 1; i >= 0; --i) {
+		_freeChunkBuffers.push_back(i);
+	}
 }
 
 WorldRenderer::~WorldRenderer() {
@@ -33,8 +76,20 @@ WorldRenderer::~WorldRenderer() {
 void WorldRenderer::reset() {
 	for (ChunkBuffer& chunkBuffer : _chunkBuffers) {
 		chunkBuffer.inuse = false;
-	}
+		chunkBuffer.opaque = ChunkMeshRange();
+		chunkBuffer.water = ChunkMeshRange();
+	}
+	_chunkBufferIndex.clear();
+	_freeChunkBuffers.clear();
+	for (int i = MAX_CHUNKBUFFERS - 1; i >= 0; --i) {
+		_freeChunkBuffers.push_back(i);
+	}
+	_opaquePool.clear();
+	_waterPool.clear();
+	_opaqueDraws.clear();
+	_waterDraws.clear();
 	_octree.clear();
+	_plantsDirty = true;
 	_activeChunkBuffers = 0;
 	_entities.clear();
 	_queryResults = 0;
@@ -90,8 +145,40 @@ bool WorldRenderer::removeEntity(ClientEntityId id) {
 	return true;
 }
 
-void WorldRenderer::fillPlantPositionsFromMeshes() {
+void WorldRenderer::addPlantPositions(const ChunkBuffer& chunkBuffer) {
+	if (chunkBuffer.instancedPositions.empty()) {
+		return;
+	}
 	const int plantMeshAmount = SDL_arraysize(_meshPlantList);
+	std::vector<glm::vec3> p = chunkBuffer.instancedPositions;
+	core::Random rnd(_world->seed() + chunkBuffer.translation().x + chunkBuffer.translation().y + chunkBuffer.translation().z);
+	rnd.shuffle(p.begin(), p.end());
+	const int plantMeshes = p.size() / plantMeshAmount;
+	int delta = p.size() - plantMeshes * plantMeshAmount;
+	for (PlantBuffer& vbo : _meshPlantList) {
+		auto it = std::next(p.begin(), plantMeshes + delta);
+		std::move(p.begin(), it, std::back_inserter(vbo.instancedPositions));
+		p.erase(p.begin(), it);
+		delta = 0;
+	}
+}
+
+void WorldRenderer::uploadPlantPositions(PlantBuffer& vbo, size_t first) {
+	const std::vector<glm::vec3>& positions = vbo.instancedPositions;
+	const size_t elementSize = sizeof(glm::vec3);
+	if (positions.size() * elementSize > vbo.vb.size(vbo.offsetBuffer)) {
+		// allocate the capacity of the vector - to not reallocate the buffer for every new chunk
+		core_assert_always(vbo.vb.update(vbo.offsetBuffer, nullptr, positions.capacity() * elementSize));
+		first = 0u;
+	}
+	if (first >= positions.size()) {
+		return;
+	}
+	core_assert_always(vbo.vb.update(vbo.offsetBuffer, first * elementSize, &positions[first], (positions.size() - first) * elementSize));
+}
+
+void WorldRenderer::fillPlantPositionsFromMeshes() {
+	core_trace_gl_scoped(WorldRendererFillPlantPositions);
 	for (PlantBuffer& vbo : _meshPlantList) {
 		vbo.instancedPositions.clear();
 	}
@@ -99,25 +186,12 @@ void WorldRenderer::fillPlantPositionsFromMeshes() {
 		if (!chunkBuffer.inuse) {
 			continue;
 		}
-		if (chunkBuffer.instancedPositions.empty()) {
-			continue;
-		}
-		std::vector<glm::vec3> p = chunkBuffer.instancedPositions;
-		core::Random rnd(_world->seed() + chunkBuffer.translation().x + chunkBuffer.translation().y + chunkBuffer.translation().z);
-		rnd.shuffle(p.begin(), p.end());
-		const int plantMeshes = p.size() / plantMeshAmount;
-		int delta = p.size() - plantMeshes * plantMeshAmount;
-		for (PlantBuffer& vbo : _meshPlantList) {
-			auto it = std::next(p.begin(), plantMeshes + delta);
-			std::move(p.begin(), it, std::back_inserter(vbo.instancedPositions));
-			p.erase(p.begin(), it);
-			delta = 0;
-		}
+		addPlantPositions(chunkBuffer);
 	}
 	for (PlantBuffer& vbo : _meshPlantList) {
-		const std::vector<glm::vec3>& positions = vbo.instancedPositions;
-		vbo.vb.update(vbo.offsetBuffer, positions);
+		uploadPlantPositions(vbo, 0u);
 	}
+	_plantsDirty = false;
 }
 
 void WorldRenderer::updateAABB(ChunkBuffer& chunkBuffer) const {
@@ -126,61 +200,127 @@ void WorldRenderer::updateAABB(ChunkBuffer& chunkBuffer) const {
 
 	const voxel::ChunkMeshes& meshes = chunkBuffer.meshes;
 	for (auto& v : meshes.opaqueMesh.getVertexVector()) {
-		mins = glm::min(mins, v.position);
-		maxs = glm::max(maxs, v.position);
+		const glm::ivec3 pos = glm::ivec3(v.position) + meshes.opaqueMesh.getOffset();
+		mins = glm::min(mins, pos);
+		maxs = glm::max(maxs, pos);
 	}
 	for (auto& v : meshes.waterMesh.getVertexVector()) {
-		mins = glm::min(mins, v.position);
-		maxs = glm::max(maxs, v.position);
+		const glm::ivec3 pos = glm::ivec3(v.position) + meshes.waterMesh.getOffset();
+		mins = glm::min(mins, pos);
+		maxs = glm::max(maxs, pos);
 	}
 
 	chunkBuffer._aabb = core::AABB<int>(mins, maxs);
 }
 
 void WorldRenderer::handleMeshQueue() {
-	voxel::ChunkMeshes meshes(0, 0, 0, 0);
-	if (!_world->pop(meshes)) {
-		return;
-	}
-	// Now add the mesh to the list of meshes to render.
 	core_trace_gl_scoped(WorldRendererHandleMeshQueue);
-
-	ChunkBuffer* freeChunkBuffer = nullptr;
-	for (ChunkBuffer& chunkBuffer : _chunkBuffers) {
-		if (freeChunkBuffer == nullptr && !chunkBuffer.inuse) {
-			freeChunkBuffer = &chunkBuffer;
-		}
-		// check whether we update an existing one
-		if (chunkBuffer.translation() == meshes.translation()) {
-			freeChunkBuffer = &chunkBuffer;
+	const double budget = _meshQueueBudget->floatVal() / 1000.0;
+	const double start = core::TimeProvider::currentNanos();
+	// at least one mesh is added per frame - and then as many as the budget allows
+	do {
+		voxel::ChunkMeshes meshes(0, 0, 0, 0);
+		if (!_world->pop(meshes)) {
 			break;
 		}
-	}
+		addChunkMeshes(std::move(meshes));
+	} while (core::TimeProvider::currentNanos() - start < budget);
 
-	if (freeChunkBuffer == nullptr) {
-		Log::warn("Could not find free chunk buffer slot");
-		return;
+	if (_plantsDirty) {
+		fillPlantPositionsFromMeshes();
 	}
-	if (!freeChunkBuffer->inuse) {
-		freeChunkBuffer->inuse = true;
+}
+
+void WorldRenderer::addChunkMeshes(voxel::ChunkMeshes&& meshes) {
+	ChunkBuffer* chunkBuffer;
+	auto i = _chunkBufferIndex.find(meshes.translation());
+	if (i != _chunkBufferIndex.end()) {
+		// we update an existing one
+		chunkBuffer = &_chunkBuffers[i->second];
+		releaseChunkBuffer(*chunkBuffer);
+		_octree.remove(chunkBuffer);
+		_plantsDirty = true;
+	} else {
+		chunkBuffer = findFreeChunkBuffer();
+		if (chunkBuffer == nullptr) {
+			Log::warn("Could not find free chunk buffer slot");
+			return;
+		}
+		chunkBuffer->inuse = true;
 		++_activeChunkBuffers;
+		_chunkBufferIndex.emplace(meshes.translation(), (int)(chunkBuffer - _chunkBuffers));
+	}
+	chunkBuffer->meshes = std::move(meshes);
+	if (!uploadChunkBuffer(*chunkBuffer)) {
+		Log::error("Failed to upload the chunk meshes");
+	}
+	updateAABB(*chunkBuffer);
+	distributePlants(_world, chunkBuffer->translation(), chunkBuffer->instancedPositions);
+	if (!_plantsDirty) {
+		// only upload the plants of the new chunk - the others are already in the buffers
+		size_t first[SDL_arraysize(_meshPlantList)];
+		for (size_t j = 0; j < SDL_arraysize(_meshPlantList); ++j) {
+			first[j] = _meshPlantList[j].instancedPositions.size();
+		}
+		addPlantPositions(*chunkBuffer);
+		for (size_t j = 0; j < SDL_arraysize(_meshPlantList); ++j) {
+			uploadPlantPositions(_meshPlantList[j], first[j]);
+		}
 	}
-	freeChunkBuffer->meshes = std::move(meshes);
-	updateAABB(*freeChunkBuffer);
-	distributePlants(_world, freeChunkBuffer->translation(), freeChunkBuffer->instancedPositions);
-	fillPlantPositionsFromMeshes();
-	if (!_octree.insert(freeChunkBuffer)) {
+	if (!_octree.insert(chunkBuffer)) {
 		Log::warn("Failed to insert into octree");
 	}
 }
 
-WorldRenderer::ChunkBuffer* WorldRenderer::findFreeChunkBuffer() {
-	for (int i = 0; i < (int)SDL_arraysize(_chunkBuffers); ++i) {
-		if (!_chunkBuffers[i].inuse) {
-			return &_chunkBuffers[i];
+bool WorldRenderer::uploadChunkBuffer(ChunkBuffer& chunkBuffer) {
+	core_trace_gl_scoped(WorldRendererUploadChunkBuffer);
+	const voxel::ChunkMeshes& meshes = chunkBuffer.meshes;
+	_opaquePool.allocate(meshes.opaqueMesh, chunkBuffer.opaque);
+	_waterPool.allocate(meshes.waterMesh, chunkBuffer.water);
+
+	const bool opaqueReallocated = reserveBuffers(_opaquePool, _opaqueBuffer, _opaqueVbo, _opaqueIbo);
+	const bool waterReallocated = reserveBuffers(_waterPool, _waterBuffer, _waterVbo, _waterIbo);
+	if (!opaqueReallocated && !waterReallocated) {
+		return uploadRange(_opaqueBuffer, _opaqueVbo, _opaqueIbo, meshes.opaqueMesh, chunkBuffer.opaque)
+			&& uploadRange(_waterBuffer, _waterVbo, _waterIbo, meshes.waterMesh, chunkBuffer.water);
+	}
+
+	// the pool has grown and the buffers lost their content - the ranges keep their offsets, so
+	// all the meshes (including the given one) are uploaded to the same locations again
+	bool success = true;
+	for (const ChunkBuffer& cb : _chunkBuffers) {
+		if (!cb.inuse) {
+			continue;
+		}
+		if (opaqueReallocated) {
+			success &= uploadRange(_opaqueBuffer, _opaqueVbo, _opaqueIbo, cb.meshes.opaqueMesh, cb.opaque);
+		}
+		if (waterReallocated) {
+			success &= uploadRange(_waterBuffer, _waterVbo, _waterIbo, cb.meshes.waterMesh, cb.water);
 		}
 	}
-	return nullptr;
+	if (!opaqueReallocated) {
+		success &= uploadRange(_opaqueBuffer, _opaqueVbo, _opaqueIbo, meshes.opaqueMesh, chunkBuffer.opaque);
+	}
+	if (!waterReallocated) {
+		success &= uploadRange(_waterBuffer, _waterVbo, _waterIbo, meshes.waterMesh, chunkBuffer.water);
+	}
+	return success;
+}
+
+void WorldRenderer::releaseChunkBuffer(ChunkBuffer& chunkBuffer) {
+	_opaquePool.free(chunkBuffer.opaque);
+	_waterPool.free(chunkBuffer.water);
+}
+
+WorldRenderer::ChunkBuffer* WorldRenderer::findFreeChunkBuffer() {
+	if (_freeChunkBuffers.empty()) {
+		return nullptr;
+	}
+	const int slot = _freeChunkBuffers.back();
+	_freeChunkBuffers.pop_back();
+	core_assert(!_chunkBuffers[slot].inuse);
+	return &_chunkBuffers[slot];
 }
 
 bool WorldRenderer::checkShaders() const {
@@ -193,27 +333,10 @@ bool WorldRenderer::checkShaders() const {
 	return same;
 }
 
-static size_t transform(size_t indexOffset, const voxel::Mesh& mesh, std::vector<voxel::VoxelVertex>& verts, std::vector<voxel::IndexType>& idxs) {
-	const std::vector<voxel::IndexType>& indices = mesh.getIndexVector();
-	std::transform(indices.begin(), indices.end(),
-		std::back_inserter(idxs),
-		[=] (voxel::IndexType index) {
-			return index + indexOffset;
-		}
-	);
-
-	const std::vector<voxel::VoxelVertex>& vertices = mesh.getVertexVector();
-	verts.insert(verts.end(), vertices.begin(), vertices.end());
-	return vertices.size();
-}
-
 int WorldRenderer::cull(const video::Camera& camera) {
-	_opaqueIndices.clear();
-	_opaqueVertices.clear();
-	_waterIndices.clear();
-	_waterVertices.clear();
-	size_t opaqueIndexOffset = 0;
-	size_t waterIndexOffset = 0;
+	_opaqueDraws.clear();
+	_waterDraws.clear();
+	_visibleVertices = 0;
 	int visibleChunks = 0;
 	std::vector<ChunkBuffer*> contents;
 	contents.reserve(_activeChunkBuffers);
@@ -226,33 +349,41 @@ int WorldRenderer::cull(const video::Camera& camera) {
 			continue;
 		}
 		const voxel::ChunkMeshes& meshes = chunkBuffer->meshes;
-		opaqueIndexOffset += transform(opaqueIndexOffset, meshes.opaqueMesh, _opaqueVertices, _opaqueIndices);
-		waterIndexOffset += transform(waterIndexOffset, meshes.waterMesh, _waterVertices, _waterIndices);
+		ChunkMeshPool::addDrawRanges(meshes.opaqueMesh, chunkBuffer->opaque, _opaqueDraws);
+		ChunkMeshPool::addDrawRanges(meshes.waterMesh, chunkBuffer->water, _waterDraws);
+		_visibleVertices += chunkBuffer->opaque.vertices + chunkBuffer->water.vertices;
 		++visibleChunks;
 	}
 	return visibleChunks;
 }
 
-bool WorldRenderer::renderOpaqueBuffers() {
-	const uint32_t numIndices = _opaqueBuffer.elements(_opaqueIbo, 1, sizeof(voxel::IndexType));
-	if (numIndices == 0u) {
-		return false;
+int WorldRenderer::renderDrawRanges(const video::Shader& shader, const std::vector<ChunkDrawRange>& draws) const {
+	const int modelLocation = shader.getUniformLocation("u_model");
+	for (const ChunkDrawRange& draw : draws) {
+		shader.setUniformMatrix(modelLocation, glm::translate(glm::vec3(draw.offset)));
+		video::drawElementsBaseVertex<voxel::ChunkIndexType>(video::Primitive::Triangles, draw.numIndices, draw.baseIndex, draw.baseVertex);
+	}
+	return draws.size();
+}
+
+int WorldRenderer::renderOpaqueBuffers(const video::Shader& shader) {
+	if (_opaqueDraws.empty()) {
+		return 0;
 	}
 	_opaqueBuffer.bind();
-	video::drawElements<voxel::IndexType>(video::Primitive::Triangles, numIndices);
+	const int drawCalls = renderDrawRanges(shader, _opaqueDraws);
 	_opaqueBuffer.unbind();
-	return true;
+	return drawCalls;
 }
 
-bool WorldRenderer::renderWaterBuffers() {
-	const uint32_t numIndices = _waterBuffer.elements(_waterIbo, 1, sizeof(voxel::IndexType));
-	if (numIndices == 0u) {
-		return false;
+int WorldRenderer::renderWaterBuffers(const video::Shader& shader) {
+	if (_waterDraws.empty()) {
+		return 0;
 	}
 	_waterBuffer.bind();
-	video::drawElements<voxel::IndexType>(video::Primitive::Triangles, numIndices);
+	const int drawCalls = renderDrawRanges(shader, _waterDraws);
 	_waterBuffer.unbind();
-	return true;
+	return drawCalls;
 }
 
 int WorldRenderer::renderPlants(const std::list<PlantBuffer*>& vbos, int* vertices) {
@@ -283,20 +414,15 @@ int WorldRenderer::renderWorld(const video::Camera& camera, int* vertices) {
 
 	_visibleChunks = cull(camera);
 	if (vertices != nullptr) {
-		*vertices = _opaqueVertices.size() + _waterVertices.size();
+		*vertices = _visibleVertices;
 	}
 	if (_visibleChunks == 0) {
 		return 0;
 	}
-	if (_opaqueIndices.empty() && _waterIndices.empty()) {
+	if (_opaqueDraws.empty() && _waterDraws.empty()) {
 		return 0;
 	}
 
-	core_assert_always(_opaqueBuffer.update(_opaqueVbo, _opaqueVertices));
-	core_assert_always(_opaqueBuffer.update(_opaqueIbo, _opaqueIndices));
-	core_assert_always(_waterBuffer.update(_waterVbo, _waterVertices));
-	core_assert_always(_waterBuffer.update(_waterIbo, _waterIndices));
-
 	const bool shadowMap = _shadowMap->boolVal();
 
 	{
@@ -379,9 +505,7 @@ int WorldRenderer::renderWorld(const video::Camera& camera, int* vertices) {
 			{
 				video::ScopedShader scoped(_shadowMapShader);
 				_shadowMapShader.setLightviewprojection(cascades[i]);
-				_shadowMapShader.setModel(glm::mat4());
-				renderOpaqueBuffers();
-				++drawCallsWorld;
+				drawCallsWorld += renderOpaqueBuffers(_shadowMapShader);
 			}
 			{
 				video::ScopedShader scoped(_shadowMapInstancedShader);
@@ -406,14 +530,11 @@ int WorldRenderer::renderWorld(const video::Camera& camera, int* vertices) {
 
 	{
 		video::ScopedShader scoped(_worldShader);
-		_worldShader.setModel(glm::mat4());
 		if (shadowMap) {
 			_worldShader.setCascades(cascades);
 			_worldShader.setDistances(distances);
 		}
-		if (renderOpaqueBuffers()) {
-			++drawCallsWorld;
-		}
+		drawCallsWorld += renderOpaqueBuffers(_worldShader);
 	}
 	{
 		video::ScopedShader scoped(_worldInstancedShader);
@@ -426,14 +547,11 @@ int WorldRenderer::renderWorld(const video::Camera& camera, int* vertices) {
 	}
 	{
 		video::ScopedShader scoped(_waterShader);
-		_waterShader.setModel(glm::mat4());
 		if (shadowMap) {
 			_waterShader.setCascades(cascades);
 			_waterShader.setDistances(distances);
 		}
-		if (renderWaterBuffers()) {
-			++drawCallsWorld;
-		}
+		drawCallsWorld += renderWaterBuffers(_waterShader);
 	}
 
 	video::bindVertexArray(video::InvalidId);
@@ -614,6 +732,8 @@ void WorldRenderer::extractMeshAroundCamera(const glm::ivec3& meshGridPos, int r
 	}
 	Log::debug("set last grid position to %i:%i", meshGridPos.x, meshGridPos.z);
 	_lastGridPosition = meshGridPos;
+	// generate the chunks a little bit further than the meshes are extracted - they are needed as soon as the camera moves on
+	_world->prefetchChunks(meshGridPos, radius * meshSize / _world->getChunkSize() + 1);
 	glm::ivec3 pos = meshGridPos;
 	pos.y = 0;
 	voxel::Spiral o;
@@ -639,9 +759,12 @@ void WorldRenderer::stats(Stats& stats) const {
 void WorldRenderer::onConstruct() {
 	_shadowMap = core::Var::getSafe(cfg::ClientShadowMap);
 	_shadowMapShow = core::Var::get(cfg::ClientShadowMapShow, "false");
+	// milliseconds per frame to spend on adding new chunk meshes
+	_meshQueueBudget = core::Var::get(cfg::ClientMeshQueueBudget, "2");
 }
 
 bool WorldRenderer::initOpaqueBuffer() {
+	_opaqueBuffer.setMode(video::VertexBufferMode::Dynamic);
 	_opaqueVbo = _opaqueBuffer.create();
 	if (_opaqueVbo == -1) {
 		Log::error("Failed to create vertex buffer");
@@ -673,6 +796,7 @@ bool WorldRenderer::initOpaqueBuffer() {
 }
 
 bool WorldRenderer::initWaterBuffer() {
+	_waterBuffer.setMode(video::VertexBufferMode::Dynamic);
 	_waterVbo = _waterBuffer.create();
 	if (_waterVbo == -1) {
 		Log::error("Failed to create water vertex buffer");
@@ -775,6 +899,8 @@ bool WorldRenderer::init(const glm::ivec2& position, const glm::ivec2& dimension
 	if (!initWaterBuffer()) {
 		return false;
 	}
+	reserveBuffers(_opaquePool, _opaqueBuffer, _opaqueVbo, _opaqueIbo);
+	reserveBuffers(_waterPool, _waterBuffer, _waterVbo, _waterIbo);
 
 	if (!_shadow.init()) {
 		return false;
@@ -800,9 +926,13 @@ void WorldRenderer::onRunning(const video::Camera& camera, long dt) {
 		Log::trace("distance is: %i (%i)", distance, maxAllowedDistance);
 		if (distance >= maxAllowedDistance) {
 			_world->allowReExtraction(chunkBuffer.translation());
+			releaseChunkBuffer(chunkBuffer);
+			_chunkBufferIndex.erase(chunkBuffer.translation());
+			_freeChunkBuffers.push_back((int)(&chunkBuffer - _chunkBuffers));
 			chunkBuffer.inuse = false;
 			--_activeChunkBuffers;
 			_octree.remove(&chunkBuffer);
+			_plantsDirty = true;
 			Log::debug("Remove mesh from %i:%i", chunkBuffer.translation().x, chunkBuffer.translation().z);
 		}
 	}
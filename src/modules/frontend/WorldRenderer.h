@@ -21,6 +21,7 @@
 #include "ClientEntity.h"
 #include "frontend/Shadow.h"
 #include "frontend/RandomColorTexture.h"
+#include "frontend/ChunkMeshPool.h"
 
 #include <unordered_map>
 #include <list>
@@ -55,6 +56,9 @@ protected:
 		bool inuse = false;
 		core::AABB<int> _aabb = {glm::zero<glm::ivec3>(), glm::zero<glm::ivec3>()};
 		voxel::ChunkMeshes meshes {0, 0, 0, 0};
+		// the location of the meshes in the pooled gpu buffers
+		ChunkMeshRange opaque;
+		ChunkMeshRange water;
 		std::vector<glm::vec3> instancedPositions;
 
 		inline const glm::ivec3& translation() const {
@@ -69,19 +73,31 @@ protected:
 	core::Octree<ChunkBuffer*> _octree;
 	static constexpr int MAX_CHUNKBUFFERS = 4096;
 	ChunkBuffer _chunkBuffers[MAX_CHUNKBUFFERS];
+	// translation => slot in _chunkBuffers for all the chunk buffers that are in use
+	std::unordered_map<glm::ivec3, int, std::hash<glm::ivec3> > _chunkBufferIndex;
+	// the slots in _chunkBuffers that are not in use
+	std::vector<int> _freeChunkBuffers;
 	int _activeChunkBuffers = 0;
+	// a chunk buffer was removed or replaced - the plant positions must be collected again
+	bool _plantsDirty = false;
 	int _visibleChunks = 0;
 	int _queryResults = 0;
 	PlantBuffer _meshPlantList[(int)voxel::PlantType::MaxPlantTypes];
 
 	std::list<PlantBuffer*> _visiblePlant;
-	std::vector<voxel::VoxelVertex> _opaqueVertices;
-	std::vector<voxel::IndexType> _opaqueIndices;
+	// the vertices of the visible chunks
+	int _visibleVertices = 0;
+	std::vector<ChunkDrawRange> _opaqueDraws;
+	std::vector<ChunkDrawRange> _waterDraws;
+	/**
+	 * The chunk meshes are uploaded once into the pooled buffers when they are extracted - the
+	 * pool hands out the ranges in the buffers.
+	 */
+	ChunkMeshPool _opaquePool;
 	video::VertexBuffer _opaqueBuffer;
 	int32_t _opaqueIbo = -1;
 	int32_t _opaqueVbo = -1;
-	std::vector<voxel::VoxelVertex> _waterVertices;
-	std::vector<voxel::IndexType> _waterIndices;
+	ChunkMeshPool _waterPool;
 	video::VertexBuffer _waterBuffer;
 	int32_t _waterIbo = -1;
 	int32_t _waterVbo = -1;
@@ -109,6 +125,7 @@ protected:
 	glm::ivec3 _lastGridPosition = { std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::min() };
 	voxel::WorldPtr _world;
 	core::VarPtr _shadowMap;
+	core::VarPtr _meshQueueBudget;
 	core::VarPtr _shadowMapShow;
 
 	video::VertexBuffer _shadowMapDebugBuffer;
@@ -128,12 +145,32 @@ protected:
 	 */
 	bool createVertexBufferInternal(const video::Shader& shader, const voxel::Mesh &mesh, PlantBuffer& vbo);
 	bool createInstancedVertexBuffer(const voxel::Mesh &mesh, int amount, PlantBuffer& vbo);
+	/**
+	 * @brief Takes the extracted meshes from the world as long as the time budget allows it
+	 */
 	void handleMeshQueue();
+	void addChunkMeshes(voxel::ChunkMeshes&& meshes);
+	/**
+	 * @brief Allocates the ranges for the chunk meshes in the pooled buffers and uploads them
+	 */
+	bool uploadChunkBuffer(ChunkBuffer& chunkBuffer);
+	/**
+	 * @brief Hands the ranges of the chunk meshes back to the pools
+	 */
+	void releaseChunkBuffer(ChunkBuffer& chunkBuffer);
 	void updateAABB(ChunkBuffer& chunkBuffer) const;
 	/**
 	 * @brief Redistribute the plants on the meshes that are already extracted
 	 */
 	void fillPlantPositionsFromMeshes();
+	/**
+	 * @brief Appends the plant positions of the given chunk to the plant buffers
+	 */
+	void addPlantPositions(const ChunkBuffer& chunkBuffer);
+	/**
+	 * @brief Uploads the plant positions starting at the given instance
+	 */
+	void uploadPlantPositions(PlantBuffer& vbo, size_t first);
 
 	int getDistanceSquare(const glm::ivec3& pos) const;
 	/**
@@ -146,8 +183,18 @@ protected:
 	 */
 	int cull(const video::Camera& camera);
 	int renderPlants(const std::list<PlantBuffer*>& vbos, int* vertices);
-	bool renderOpaqueBuffers();
-	bool renderWaterBuffers();
+	int renderDrawRanges(const video::Shader& shader, const std::vector<ChunkDrawRange>& draws) const;
+	/**
+	 * @return The amount of draw calls
+	 */
+	int renderOpaqueBuffers(const video::Shader& shader);
+	/**
+	 * @return The amount of draw calls
+	 */
+	int renderWaterBuffers(const video::Shader& shader);
+	/**
+	 * @brief Takes a slot from the free list
+	 */
 	ChunkBuffer* findFreeChunkBuffer();
 	bool checkShaders() const;
 
@@ -0,0 +1,125 @@
+/**
+ * @file
+ */
+
+#include <gtest/gtest.h>
+#include "frontend/ChunkMeshPool.h"
+
+namespace frontend {
+
+class ChunkMeshPoolTest: public testing::Test {
+protected:
+	voxel::ChunkMesh createMesh(int quads) const {
+		voxel::ChunkMesh mesh(quads * 4, quads * 6);
+		for (int i = 0; i < quads; ++i) {
+			const voxel::ChunkIndexType i0 = mesh.addVertex(voxel::VoxelVertex());
+			const voxel::ChunkIndexType i1 = mesh.addVertex(voxel::VoxelVertex());
+			const voxel::ChunkIndexType i2 = mesh.addVertex(voxel::VoxelVertex());
+			const voxel::ChunkIndexType i3 = mesh.addVertex(voxel::VoxelVertex());
+			mesh.addTriangle(i0, i1, i2);
+			mesh.addTriangle(i0, i2, i3);
+		}
+		return mesh;
+	}
+};
+
+TEST_F(ChunkMeshPoolTest, testAllocate) {
+	ChunkMeshPool pool(16u, 24u);
+	const voxel::ChunkMesh& mesh = createMesh(2);
+	ChunkMeshRange range1;
+	ChunkMeshRange range2;
+	ASSERT_TRUE(pool.allocate(mesh, range1));
+	ASSERT_TRUE(pool.allocate(mesh, range2));
+	EXPECT_EQ(0u, range1.vertexOffset);
+	EXPECT_EQ(0u, range1.indexOffset);
+	EXPECT_EQ(8u, range2.vertexOffset);
+	EXPECT_EQ(12u, range2.indexOffset);
+	EXPECT_EQ(8u, range2.vertices);
+	EXPECT_EQ(12u, range2.indices);
+	EXPECT_EQ(16u, pool.usedVertices());
+	EXPECT_EQ(24u, pool.usedIndices());
+}
+
+TEST_F(ChunkMeshPoolTest, testEmptyMesh) {
+	ChunkMeshPool pool(16u, 24u);
+	const voxel::ChunkMesh& mesh = createMesh(0);
+	ChunkMeshRange range;
+	EXPECT_FALSE(pool.allocate(mesh, range));
+	EXPECT_FALSE(range.valid());
+	pool.free(range);
+	EXPECT_EQ(0u, pool.usedVertices());
+}
+
+TEST_F(ChunkMeshPoolTest, testFreeReuse) {
+	ChunkMeshPool pool(16u, 24u);
+	const voxel::ChunkMesh& mesh = createMesh(2);
+	ChunkMeshRange range1;
+	ChunkMeshRange range2;
+	ASSERT_TRUE(pool.allocate(mesh, range1));
+	ASSERT_TRUE(pool.allocate(mesh, range2));
+	pool.free(range1);
+	EXPECT_FALSE(range1.valid());
+	EXPECT_EQ(8u, pool.usedVertices());
+	ASSERT_TRUE(pool.allocate(createMesh(1), range1));
+	EXPECT_EQ(0u, range1.vertexOffset) << "The freed range should be reused";
+	EXPECT_EQ(16u, pool.vertexCapacity()) << "The pool should not grow if there is a free range";
+}
+
+TEST_F(ChunkMeshPoolTest, testGrow) {
+	ChunkMeshPool pool(8u, 12u);
+	const voxel::ChunkMesh& mesh = createMesh(2);
+	ChunkMeshRange range1;
+	ChunkMeshRange range2;
+	ASSERT_TRUE(pool.allocate(mesh, range1));
+	ASSERT_TRUE(pool.allocate(mesh, range2));
+	EXPECT_EQ(16u, pool.vertexCapacity());
+	EXPECT_EQ(24u, pool.indexCapacity());
+	EXPECT_EQ(0u, range1.vertexOffset) << "Allocated ranges must keep their offsets";
+	EXPECT_EQ(8u, range2.vertexOffset);
+	EXPECT_EQ(12u, range2.indexOffset);
+}
+
+TEST_F(ChunkMeshPoolTest, testDrawRanges) {
+	ChunkMeshPool pool(16u, 24u);
+	ChunkMeshRange range1;
+	ChunkMeshRange range2;
+	ChunkMeshRange empty;
+	const voxel::ChunkMesh& mesh1 = createMesh(1);
+	voxel::ChunkMesh mesh2 = createMesh(2);
+	mesh2.setOffset(glm::ivec3(32, 0, 16));
+	ASSERT_TRUE(pool.allocate(mesh1, range1));
+	ASSERT_TRUE(pool.allocate(mesh2, range2));
+	std::vector<ChunkDrawRange> draws;
+	ChunkMeshPool::addDrawRanges(mesh1, range1, draws);
+	ChunkMeshPool::addDrawRanges(createMesh(0), empty, draws);
+	ChunkMeshPool::addDrawRanges(mesh2, range2, draws);
+	ASSERT_EQ(2u, draws.size());
+	EXPECT_EQ(glm::ivec3(32, 0, 16), draws[1].offset);
+	EXPECT_EQ(6u, draws[1].baseIndex);
+	EXPECT_EQ(12u, draws[1].numIndices);
+	EXPECT_EQ(4u, draws[1].baseVertex);
+}
+
+TEST_F(ChunkMeshPoolTest, testDrawRangesSegments) {
+	ChunkMeshPool pool(16u, 24u);
+	ChunkMeshRange range1;
+	ChunkMeshRange range2;
+	voxel::ChunkMesh mesh(0, 0, true);
+	ASSERT_TRUE(mesh.addSegment(createMesh(1)));
+	ASSERT_TRUE(mesh.addSegment(createMesh(2)));
+	ASSERT_EQ(2u, mesh.getSegments().size());
+	ASSERT_TRUE(pool.allocate(createMesh(1), range1));
+	ASSERT_TRUE(pool.allocate(mesh, range2));
+	std::vector<ChunkDrawRange> draws;
+	ChunkMeshPool::addDrawRanges(mesh, range2, draws);
+	ASSERT_EQ(2u, draws.size());
+	EXPECT_EQ(6u, draws[0].baseIndex);
+	EXPECT_EQ(6u, draws[0].numIndices);
+	EXPECT_EQ(4u, draws[0].baseVertex);
+	EXPECT_EQ(12u, draws[1].baseIndex);
+	EXPECT_EQ(12u, draws[1].numIndices);
+	EXPECT_EQ(8u, draws[1].baseVertex);
+	EXPECT_EQ(0u, mesh.getIndex(6)) << "The indices of a segment must be relative to its first vertex";
+}
+
+}
@@ -0,0 +1,59 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "ServerMessages_generated.h"
+#include "core/GLM.h"
+#include <stdint.h>
+#include <limits>
+
+namespace network {
+
+/**
+ * @brief The smallest quantization step - used if all positions are at the origin
+ */
+constexpr float EntityStateMinScale = 1.0f / 256.0f;
+
+/**
+ * @brief Calculates the quantization step that is needed to express the given offset from the origin
+ */
+inline float entityStateScale(float maxOffset) {
+	return glm::max(maxOffset / (float)std::numeric_limits<int16_t>::max(), EntityStateMinScale);
+}
+
+inline int16_t quantizePosition(float offset, float scale) {
+	const float limit = (float)std::numeric_limits<int16_t>::max();
+	return (int16_t)glm::clamp(glm::round(offset / scale), -limit, limit);
+}
+
+inline uint16_t quantizeRotation(float rotation) {
+	const float twoPi = glm::two_pi<float>();
+	const float normalized = glm::mod(rotation, twoPi) / twoPi;
+	return (uint16_t)((uint32_t)glm::round(normalized * 65536.0f) & 0xFFFF);
+}
+
+inline float dequantizeRotation(uint16_t rotation) {
+	return (float)rotation / 65536.0f * glm::two_pi<float>();
+}
+
+/**
+ * @brief Creates the quantized state of an entity for the @c EntityUpdates message
+ * @param[in] origin The origin of the message
+ * @param[in] scale The quantization step of the message - see @c entityStateScale()
+ */
+inline EntityState createEntityState(int64_t id, const glm::vec3& pos, float rotation, const glm::vec3& origin, float scale) {
+	const glm::vec3 offset = pos - origin;
+	return EntityState(id, quantizePosition(offset.x, scale), quantizePosition(offset.y, scale),
+			quantizePosition(offset.z, scale), quantizeRotation(rotation));
+}
+
+/**
+ * @return The world position of the given state
+ */
+inline glm::vec3 entityStatePosition(const EntityState& state, const glm::vec3& origin, float scale) {
+	return origin + glm::vec3(state.x(), state.y(), state.z()) * scale;
+}
+
+}
@@ -14,6 +14,8 @@ class IMsgProtocolHandler: public IProtocolHandler {
 private:
 	bool _needsAttachment;
 public:
+	typedef MSGTYPE MessageType;
+
 	IMsgProtocolHandler(bool needsAttachment = false) :
 			_needsAttachment(needsAttachment) {
 	}
@@ -8,18 +8,41 @@
 
 namespace network {
 
-inline ENetPacket* createServerPacket(FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, uint32_t flags) {
+// unreliable packets are dropped completely if one of their fragments gets lost - so keep them in one datagram
+static constexpr size_t MaxUnreliableBatchSize = 1200u;
+static constexpr size_t MaxReliableBatchSize = 16u * 1024u;
+static constexpr size_t MaxPooledBuilders = 8u;
+
+static thread_local std::vector<std::unique_ptr<FlatBufferBuilder>> _builderPool;
+
+ScopedBuilder::ScopedBuilder() {
+	if (_builderPool.empty()) {
+		_fbb = new FlatBufferBuilder();
+		return;
+	}
+	_fbb = _builderPool.back().release();
+	_builderPool.pop_back();
+}
+
+ScopedBuilder::~ScopedBuilder() {
+	if (_builderPool.size() >= MaxPooledBuilders) {
+		delete _fbb;
+		return;
+	}
+	_fbb->Clear();
+	_builderPool.emplace_back(_fbb);
+}
+
+inline void finishServerMessage(FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data) {
 	auto msg = CreateServerMessage(fbb, type, data);
 	FinishServerMessageBuffer(fbb, msg);
-	ENetPacket* packet = enet_packet_create(fbb.GetBufferPointer(), fbb.GetSize(), flags);
-	Log::trace("Create server package: %s - size %ui", EnumNameServerMsgType(type), fbb.GetSize());
-	return packet;
+	Log::trace("Create server message: %s - size %ui", EnumNameServerMsgType(type), fbb.GetSize());
 }
 
 inline ENetPacket* createClientPacket(FlatBufferBuilder& fbb, ClientMsgType type, Offset<void> data, uint32_t flags) {
 	auto msg = CreateClientMessage(fbb, type, data);
 	FinishClientMessageBuffer(fbb, msg);
-	ENetPacket* packet = enet_packet_create(fbb.GetBufferPointer(), fbb.GetSize(), flags);
+	ENetPacket* packet = createFramedPacket(fbb.GetBufferPointer(), fbb.GetSize(), flags);
 	Log::trace("Create client package: %s - size %ui", EnumNameClientMsgType(type), fbb.GetSize());
 	return packet;
 }
@@ -28,6 +51,49 @@ MessageSender::MessageSender(NetworkPtr network) :
 		_network(network) {
 }
 
+void MessageSender::queue(ENetPeer* peer, const uint8_t* data, uint32_t size, uint32_t flags) {
+	std::vector<PacketBatch>& batches = _batches[peer];
+	PacketBatch* batch = nullptr;
+	for (PacketBatch& b : batches) {
+		if (b.flags() == flags) {
+			batch = &b;
+			break;
+		}
+	}
+	if (batch == nullptr) {
+		// reliable batches are sent first
+		if ((flags & ENET_PACKET_FLAG_RELIABLE) != 0u) {
+			batches.emplace(batches.begin(), flags);
+			batch = &batches.front();
+		} else {
+			batches.emplace_back(flags);
+			batch = &batches.back();
+		}
+	}
+	const size_t maxSize = (flags & ENET_PACKET_FLAG_RELIABLE) != 0u ? MaxReliableBatchSize : MaxUnreliableBatchSize;
+	if (!batch->empty() && batch->size() + FrameHeaderSize + size > maxSize) {
+		send(peer, *batch);
+	}
+	batch->add(data, size);
+}
+
+void MessageSender::send(ENetPeer* peer, PacketBatch& batch) {
+	const int messages = batch.messages();
+	ENetPacket* packet = batch.createPacket();
+	if (packet == nullptr) {
+		return;
+	}
+	if (!_network->sendMessage(peer, packet)) {
+		Log::debug("Failed to send %i messages to peer (State: %i)", messages, peer->state);
+		if (packet->referenceCount == 0) {
+			enet_packet_destroy(packet);
+		}
+		return;
+	}
+	++_sentPackets;
+	_sentMessages += messages;
+}
+
 void MessageSender::sendServerMessage(ENetPeer* peer, FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, uint32_t flags) {
 	core_assert(peer != nullptr);
 	sendServerMessage(&peer, 1, fbb, type, data, flags);
@@ -36,30 +102,53 @@ void MessageSender::sendServerMessage(ENetPeer* peer, FlatBufferBuilder& fbb, Se
 void MessageSender::sendServerMessage(ENetPeer** peers, int numPeers, FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, uint32_t flags) {
 	Log::debug("Send %s", EnumNameServerMsgType(type));
 	core_assert(numPeers > 0);
-	auto packet = createServerPacket(fbb, type, data, flags);
-	for (int i = 0; i < numPeers; ++i) {
-		const bool success = _network->sendMessage(peers[i], packet);
-		if (success) {
-			continue;
+	finishServerMessage(fbb, type, data);
+	{
+		std::lock_guard<std::mutex> lock(_batchMutex);
+		for (int i = 0; i < numPeers; ++i) {
+			queue(peers[i], fbb.GetBufferPointer(), fbb.GetSize(), flags);
 		}
-		Log::debug("Failed to send the message %s to peer %i (State: %i)", EnumNameServerMsgType(type), i, peers[i]->state);
 	}
 	fbb.Clear();
 }
 
 void MessageSender::broadcastServerMessage(FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, int channel, uint32_t flags) {
 	Log::debug("Broadcast %s", EnumNameServerMsgType(type));
-	_network->broadcast(createServerPacket(fbb, type, data, flags), channel);
+	finishServerMessage(fbb, type, data);
+	ENetPacket* packet = createFramedPacket(fbb.GetBufferPointer(), fbb.GetSize(), flags);
 	fbb.Clear();
+	std::lock_guard<std::mutex> lock(_batchMutex);
+	flushBatches();
+	_network->broadcast(packet, channel);
+	++_sentPackets;
+	++_sentMessages;
 }
 
 void MessageSender::sendClientMessage(ENetPeer* peer, FlatBufferBuilder& fbb, ClientMsgType type, Offset<void> data, uint32_t flags) {
 	if (peer == nullptr) {
 		Log::debug("don't send client message, no peer available");
+		fbb.Clear();
 		return;
 	}
 	_network->sendMessage(peer, createClientPacket(fbb, type, data, flags));
 	fbb.Clear();
+	++_sentPackets;
+	++_sentMessages;
+}
+
+void MessageSender::flushBatches() {
+	for (auto& e : _batches) {
+		for (PacketBatch& batch : e.second) {
+			if (!batch.empty()) {
+				send(e.first, batch);
+			}
+		}
+	}
+}
+
+void MessageSender::flush() {
+	std::lock_guard<std::mutex> lock(_batchMutex);
+	flushBatches();
 }
 
 }
@@ -5,29 +5,84 @@
 #pragma once
 
 #include "Network.h"
+#include "PacketBatch.h"
 #include "ServerMessages_generated.h"
 #include "ClientMessages_generated.h"
 #include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace network {
 
 using namespace flatbuffers;
 
+/**
+ * @brief Hands out a @c FlatBufferBuilder of a thread local pool - it's cleared and given back
+ * to the pool on destruction.
+ */
+class ScopedBuilder {
+private:
+	FlatBufferBuilder* _fbb;
+public:
+	ScopedBuilder();
+	~ScopedBuilder();
+
+	ScopedBuilder(const ScopedBuilder&) = delete;
+	ScopedBuilder& operator=(const ScopedBuilder&) = delete;
+
+	inline operator FlatBufferBuilder&() {
+		return *_fbb;
+	}
+};
+
+/**
+ * @brief Sends the flatbuffers messages to the peers
+ *
+ * The server messages for a peer are collected in a @c PacketBatch per packet flags and are
+ * sent as one packet on @c flush(). The messages of a batch keep their order.
+ */
 class MessageSender {
 private:
 	NetworkPtr _network;
 
+	std::mutex _batchMutex;
+	std::unordered_map<ENetPeer*, std::vector<PacketBatch>> _batches;
+	uint64_t _sentPackets = 0u;
+	uint64_t _sentMessages = 0u;
+
+	void queue(ENetPeer* peer, const uint8_t* data, uint32_t size, uint32_t flags);
+	void send(ENetPeer* peer, PacketBatch& batch);
+	void flushBatches();
+
 public:
 	MessageSender(NetworkPtr network);
 
 	void sendServerMessage(ENetPeer* peer, FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, uint32_t flags = ENET_PACKET_FLAG_RELIABLE);
 	void sendServerMessage(std::vector<ENetPeer*> peers, FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, uint32_t flags = ENET_PACKET_FLAG_RELIABLE);
 	void sendServerMessage(ENetPeer** peers, int numPeers, FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, uint32_t flags = ENET_PACKET_FLAG_RELIABLE);
+	/**
+	 * @note The queued messages are flushed before the broadcast to keep the order
+	 */
 	void broadcastServerMessage(FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, int channel = 0, uint32_t flags = ENET_PACKET_FLAG_RELIABLE);
 	/**
 	 * @brief Sends a message to the client
 	 */
 	void sendClientMessage(ENetPeer* peer, FlatBufferBuilder& fbb, ClientMsgType type, Offset<void> data, uint32_t flags = ENET_PACKET_FLAG_RELIABLE);
+
+	/**
+	 * @brief Sends the queued messages of every peer - reliable messages are sent first
+	 */
+	void flush();
+
+	/**
+	 * @return The amount of packets that were handed over to the network
+	 */
+	uint64_t sentPackets() const;
+	/**
+	 * @return The amount of messages that were sent - multiple messages might share one packet
+	 */
+	uint64_t sentMessages() const;
 };
 
 typedef std::shared_ptr<MessageSender> MessageSenderPtr;
@@ -36,5 +91,12 @@ inline void MessageSender::sendServerMessage(std::vector<ENetPeer*> peers, FlatB
 	sendServerMessage(&peers.front(), peers.size(), fbb, type, data, flags);
 }
 
+inline uint64_t MessageSender::sentPackets() const {
+	return _sentPackets;
+}
+
+inline uint64_t MessageSender::sentMessages() const {
+	return _sentMessages;
+}
 
 }
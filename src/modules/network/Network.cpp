@@ -6,6 +6,7 @@
 #include "IProtocolHandler.h"
 #include "ProtocolHandlerRegistry.h"
 #include "NetworkEvents.h"
+#include "PacketBatch.h"
 #include "ClientMessages_generated.h"
 #include "ServerMessages_generated.h"
 #include "core/Trace.h"
@@ -149,42 +150,52 @@ void Network::disconnectPeer(ENetPeer *peer, uint32_t timeout) {
 	}
 }
 
-bool Network::packetReceived(ENetEvent& event, bool server) {
-	flatbuffers::Verifier v(event.packet->data, event.packet->dataLength);
+bool Network::dispatch(ENetPeer* peer, const uint8_t* data, size_t size, bool server) {
+	flatbuffers::Verifier v(data, size);
 
 	if (!server) {
 		if (!VerifyServerMessageBuffer(v)) {
-			Log::error("Illegal server packet received with length: %i", (int)event.packet->dataLength);
+			Log::error("Illegal server message received with length: %i", (int)size);
 			return false;
 		}
-		const ServerMessage *req = GetServerMessage(event.packet->data);
+		const ServerMessage *req = GetServerMessage(data);
 		ServerMsgType type = req->data_type();
-		ProtocolHandlerPtr handler = _protocolHandlerRegistry->getHandler(EnumNameServerMsgType(type));
-		if (!handler) {
+		IProtocolHandler* handler = _protocolHandlerRegistry->getHandler(type);
+		if (handler == nullptr) {
 			Log::error("No handler for server msg type %s", EnumNameServerMsgType(type));
 			return false;
 		}
 		Log::debug("Received %s", EnumNameServerMsgType(type));
-		handler->execute(event.peer, reinterpret_cast<const flatbuffers::Table*>(req->data()));
+		handler->execute(peer, reinterpret_cast<const flatbuffers::Table*>(req->data()));
 		return true;
 	}
 
 	if (!VerifyClientMessageBuffer(v)) {
-		Log::error("Illegal client packet received with length: %i", (int)event.packet->dataLength);
+		Log::error("Illegal client message received with length: %i", (int)size);
 		return false;
 	}
-	const ClientMessage *req = GetClientMessage(event.packet->data);
+	const ClientMessage *req = GetClientMessage(data);
 	ClientMsgType type = req->data_type();
-	ProtocolHandlerPtr handler = _protocolHandlerRegistry->getHandler(EnumNameClientMsgType(type));
-	if (!handler) {
+	IProtocolHandler* handler = _protocolHandlerRegistry->getHandler(type);
+	if (handler == nullptr) {
 		Log::error("No handler for client msg type %s", EnumNameClientMsgType(type));
 		return false;
 	}
 	Log::debug("Received %s", EnumNameClientMsgType(type));
-	handler->execute(event.peer, reinterpret_cast<const flatbuffers::Table*>(req->data()));
+	handler->execute(peer, reinterpret_cast<const flatbuffers::Table*>(req->data()));
 	return true;
 }
 
+bool Network::packetReceived(ENetEvent& event, bool server) {
+	const bool valid = readFrames(event.packet->data, event.packet->dataLength, [&] (const uint8_t* data, uint32_t size) {
+		return dispatch(event.peer, data, size, server);
+	});
+	if (!valid) {
+		Log::error("Illegal packet received with length: %i", (int)event.packet->dataLength);
+	}
+	return valid;
+}
+
 void Network::updateHost(ENetHost* host, bool server) {
 	if (host == nullptr) {
 		return;
@@ -222,4 +233,13 @@ void Network::update() {
 	updateHost(_client, false);
 }
 
+void Network::flush() {
+	if (_server != nullptr) {
+		enet_host_flush(_server);
+	}
+	if (_client != nullptr) {
+		enet_host_flush(_client);
+	}
+}
+
 }
@@ -21,6 +21,8 @@ private:
 	ENetHost* _server;
 	ENetHost* _client;
 
+	bool dispatch(ENetPeer* peer, const uint8_t* data, size_t size, bool server);
+	// a packet contains one or more framed messages - see @c PacketBatch
 	bool packetReceived(ENetEvent& event, bool server);
 	void disconnectPeer(ENetPeer *peer, uint32_t timeout = 3000);
 	void updateHost(ENetHost* host, bool server);
@@ -31,6 +33,10 @@ public:
 	bool init();
 	void shutdown();
 	void update();
+	/**
+	 * @brief Sends all queued packets without waiting for the next @c update()
+	 */
+	void flush();
 
 	// Server related methods
 	bool bind(uint16_t port, const std::string& hostname = "", int maxPeers = 1024, int maxChannels = 1);
@@ -0,0 +1,52 @@
+/**
+ * @file
+ */
+
+#include "PacketBatch.h"
+#include <string.h>
+
+namespace network {
+
+static inline uint32_t framedSize(uint32_t size) {
+	return FrameHeaderSize + ((size + FrameAlignment - 1u) & ~(FrameAlignment - 1u));
+}
+
+static void writeFrame(uint8_t* out, const uint8_t* data, uint32_t size) {
+	out[0] = (uint8_t)(size & 0xFF);
+	out[1] = (uint8_t)((size >> 8) & 0xFF);
+	out[2] = (uint8_t)((size >> 16) & 0xFF);
+	out[3] = (uint8_t)((size >> 24) & 0xFF);
+	memset(out + 4, 0, FrameHeaderSize - 4u);
+	memcpy(out + FrameHeaderSize, data, size);
+	const uint32_t padding = framedSize(size) - FrameHeaderSize - size;
+	memset(out + FrameHeaderSize + size, 0, padding);
+}
+
+PacketBatch::PacketBatch(uint32_t flags) :
+		_flags(flags) {
+}
+
+void PacketBatch::add(const uint8_t* data, uint32_t size) {
+	const size_t offset = _buffer.size();
+	_buffer.resize(offset + framedSize(size));
+	writeFrame(&_buffer[offset], data, size);
+	++_messages;
+}
+
+ENetPacket* PacketBatch::createPacket() {
+	ENetPacket* packet = enet_packet_create(_buffer.data(), _buffer.size(), _flags);
+	_buffer.clear();
+	_messages = 0;
+	return packet;
+}
+
+ENetPacket* createFramedPacket(const uint8_t* data, uint32_t size, uint32_t flags) {
+	ENetPacket* packet = enet_packet_create(nullptr, framedSize(size), flags);
+	if (packet == nullptr) {
+		return nullptr;
+	}
+	writeFrame(packet->data, data, size);
+	return packet;
+}
+
+}
@@ -0,0 +1,94 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+extern "C" {
+#include <enet/enet.h>
+}
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace network {
+
+/**
+ * @brief Every packet contains one or more messages that are prefixed by a frame header.
+ *
+ * The header holds the little endian size of the message, followed by four reserved bytes.
+ * The messages are padded to a multiple of @c FrameAlignment to keep the flatbuffers of all
+ * frames aligned.
+ */
+constexpr uint32_t FrameHeaderSize = 8u;
+constexpr uint32_t FrameAlignment = 8u;
+
+/**
+ * @brief Collects the messages for a peer that are sent with the same packet flags
+ */
+class PacketBatch {
+private:
+	std::vector<uint8_t> _buffer;
+	uint32_t _flags;
+	int _messages = 0;
+
+public:
+	explicit PacketBatch(uint32_t flags);
+
+	void add(const uint8_t* data, uint32_t size);
+
+	/**
+	 * @brief Creates a packet of all messages that were added and resets the batch
+	 */
+	ENetPacket* createPacket();
+
+	inline uint32_t flags() const {
+		return _flags;
+	}
+
+	inline size_t size() const {
+		return _buffer.size();
+	}
+
+	inline int messages() const {
+		return _messages;
+	}
+
+	inline bool empty() const {
+		return _messages == 0;
+	}
+};
+
+/**
+ * @brief Creates a packet with just a single message
+ */
+extern ENetPacket* createFramedPacket(const uint8_t* data, uint32_t size, uint32_t flags);
+
+/**
+ * @brief Executes the given functor for every message of the packet
+ * @param func Is called with the data and the size of the message - and should return
+ * @c false to stop the iteration.
+ * @return @c false if the packet is malformed or the functor returned @c false
+ */
+template<class FUNC>
+bool readFrames(const uint8_t* data, size_t length, FUNC&& func) {
+	size_t offset = 0u;
+	while (offset < length) {
+		if (length - offset < FrameHeaderSize) {
+			return false;
+		}
+		const uint8_t* header = data + offset;
+		const uint32_t size = (uint32_t)header[0] | ((uint32_t)header[1] << 8) | ((uint32_t)header[2] << 16) | ((uint32_t)header[3] << 24);
+		offset += FrameHeaderSize;
+		if (size == 0u || size > length - offset) {
+			return false;
+		}
+		if (!func(data + offset, size)) {
+			return false;
+		}
+		offset += (size + FrameAlignment - 1u) & ~(FrameAlignment - 1u);
+	}
+	return true;
+}
+
+}
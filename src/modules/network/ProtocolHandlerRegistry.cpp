@@ -6,14 +6,22 @@ namespace network {
 ProtocolHandlerRegistry::ProtocolHandlerRegistry() {
 }
 
-ProtocolHandlerPtr ProtocolHandlerRegistry::getHandler(const char* type) {
-	ProtocolHandlers::iterator i = _registry.find(type);
-	if (i != _registry.end()) {
-		return i->second;
+void ProtocolHandlerRegistry::registerHandler(ServerMsgType type, const ProtocolHandlerPtr& handler) {
+	const size_t index = (size_t)type;
+	if (index >= _serverHandlers.size()) {
+		::Log::error("Invalid server msg type %i", (int)index);
+		return;
 	}
+	_serverHandlers[index] = handler;
+}
 
-	::Log::error("Failed to get protocol handler for %s", type);
-	return ProtocolHandlerPtr();
+void ProtocolHandlerRegistry::registerHandler(ClientMsgType type, const ProtocolHandlerPtr& handler) {
+	const size_t index = (size_t)type;
+	if (index >= _clientHandlers.size()) {
+		::Log::error("Invalid client msg type %i", (int)index);
+		return;
+	}
+	_clientHandlers[index] = handler;
 }
 
 }
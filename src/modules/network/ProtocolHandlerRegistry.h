@@ -4,27 +4,78 @@
 
 #pragma once
 
+#include <array>
 #include <memory>
-#include <unordered_map>
 #include "IProtocolHandler.h"
+#include "ServerMessages_generated.h"
+#include "ClientMessages_generated.h"
 
 namespace network {
 
+/**
+ * @brief Maps a flatbuffers message table to its @c ServerMsgType or @c ClientMsgType at compile time
+ */
+template<class MSGTYPE, bool SERVER = ServerMsgTypeTraits<MSGTYPE>::enum_value != ServerMsgType::NONE>
+struct MsgTypeOf {
+	static constexpr ServerMsgType value = ServerMsgTypeTraits<MSGTYPE>::enum_value;
+};
+
+template<class MSGTYPE>
+struct MsgTypeOf<MSGTYPE, false> {
+	static_assert(ClientMsgTypeTraits<MSGTYPE>::enum_value != ClientMsgType::NONE, "The type is not part of the server or client messages");
+	static constexpr ClientMsgType value = ClientMsgTypeTraits<MSGTYPE>::enum_value;
+};
+
+/**
+ * @brief The handlers for the server and the client messages - the lookup is a plain array access
+ * with the message type enum value as index.
+ */
 class ProtocolHandlerRegistry {
 private:
-	typedef std::unordered_map<const char*, ProtocolHandlerPtr> ProtocolHandlers;
-	ProtocolHandlers _registry;
+	std::array<ProtocolHandlerPtr, (size_t)ServerMsgType::MAX + 1> _serverHandlers;
+	std::array<ProtocolHandlerPtr, (size_t)ClientMsgType::MAX + 1> _clientHandlers;
 
 public:
 	ProtocolHandlerRegistry();
 
-	ProtocolHandlerPtr getHandler(const char* type);
+	/**
+	 * @return The handler for the given message type or @c nullptr if no handler is registered
+	 */
+	IProtocolHandler* getHandler(ServerMsgType type) const;
+	IProtocolHandler* getHandler(ClientMsgType type) const;
 
-	inline void registerHandler(const char* type, const ProtocolHandlerPtr& handler) {
-		_registry.insert(std::make_pair(type, handler));
+	/**
+	 * @note A handler that was already registered for the given type is replaced
+	 */
+	void registerHandler(ServerMsgType type, const ProtocolHandlerPtr& handler);
+	void registerHandler(ClientMsgType type, const ProtocolHandlerPtr& handler);
+
+	/**
+	 * @brief Creates and registers a handler for the @c MessageType of the given @c IMsgProtocolHandler
+	 * implementation. The message type enum value is resolved at compile time.
+	 */
+	template<class HANDLER, class ... ARGS>
+	void registerHandler(ARGS&&... args) {
+		registerHandler(MsgTypeOf<typename HANDLER::MessageType>::value, std::make_shared<HANDLER>(std::forward<ARGS>(args)...));
 	}
 };
 
+inline IProtocolHandler* ProtocolHandlerRegistry::getHandler(ServerMsgType type) const {
+	const size_t index = (size_t)type;
+	if (index >= _serverHandlers.size()) {
+		return nullptr;
+	}
+	return _serverHandlers[index].get();
+}
+
+inline IProtocolHandler* ProtocolHandlerRegistry::getHandler(ClientMsgType type) const {
+	const size_t index = (size_t)type;
+	if (index >= _clientHandlers.size()) {
+		return nullptr;
+	}
+	return _clientHandlers[index].get();
+}
+
 typedef std::shared_ptr<ProtocolHandlerRegistry> ProtocolHandlerRegistryPtr;
 
 }
@@ -0,0 +1,71 @@
+/**
+ * @file
+ */
+
+#include <gtest/gtest.h>
+#include "core/tests/Benchmark.h"
+#include "network/ProtocolHandlerRegistry.h"
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace network {
+
+class ProtocolHandlerRegistryBenchmark: public testing::Test {
+protected:
+	class Counter: public IProtocolHandler {
+	public:
+		uint64_t count = 0u;
+
+		void execute(ENetPeer* peer, const void* raw) override {
+			++count;
+		}
+	};
+
+	const int _messages = 1000000;
+	const int _iterations = 20;
+
+	std::vector<ServerMsgType> _types;
+	std::shared_ptr<Counter> _counter = std::make_shared<Counter>();
+
+	void SetUp() override {
+		std::mt19937 rnd(42);
+		std::uniform_int_distribution<int> dist((int)ServerMsgType::MIN + 1, (int)ServerMsgType::MAX);
+		_types.reserve(_messages);
+		for (int i = 0; i < _messages; ++i) {
+			_types.push_back((ServerMsgType)dist(rnd));
+		}
+	}
+};
+
+TEST_F(ProtocolHandlerRegistryBenchmark, testDispatch) {
+	ProtocolHandlerRegistry registry;
+	for (int i = (int)ServerMsgType::MIN + 1; i <= (int)ServerMsgType::MAX; ++i) {
+		registry.registerHandler((ServerMsgType)i, _counter);
+	}
+	const double millis = core::measure("ProtocolHandlerRegistry dispatch", _iterations, [&] () {
+		for (ServerMsgType type : _types) {
+			registry.getHandler(type)->execute(nullptr, nullptr);
+		}
+	});
+	std::printf("[ BENCHMARK] %.1f million messages/s\n", (double)_messages / millis / 1000.0);
+	EXPECT_EQ((uint64_t)_messages * (_iterations + 1), _counter->count);
+}
+
+// the former lookup by the enum name as a reference value
+TEST_F(ProtocolHandlerRegistryBenchmark, testDispatchByName) {
+	std::unordered_map<const char*, ProtocolHandlerPtr> registry;
+	for (int i = (int)ServerMsgType::MIN + 1; i <= (int)ServerMsgType::MAX; ++i) {
+		registry.insert(std::make_pair(EnumNameServerMsgType((ServerMsgType)i), _counter));
+	}
+	const double millis = core::measure("ProtocolHandlerRegistry dispatch by name", _iterations, [&] () {
+		for (ServerMsgType type : _types) {
+			ProtocolHandlerPtr handler = registry.find(EnumNameServerMsgType(type))->second;
+			handler->execute(nullptr, nullptr);
+		}
+	});
+	std::printf("[ BENCHMARK] %.1f million messages/s\n", (double)_messages / millis / 1000.0);
+	EXPECT_EQ((uint64_t)_messages * (_iterations + 1), _counter->count);
+}
+
+}
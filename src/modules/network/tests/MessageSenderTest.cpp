@@ -0,0 +1,189 @@
+/**
+ * @file
+ */
+
+#include "core/tests/AbstractTest.h"
+#include "network/Network.h"
+#include "network/MessageSender.h"
+#include "network/NetworkEvents.h"
+#include "network/PacketBatch.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace network {
+
+namespace {
+
+const uint16_t testPort = 11399;
+
+class ConnectionListener: public core::IEventBusHandler<NewConnectionEvent> {
+public:
+	ENetPeer* peer = nullptr;
+
+	void onEvent(const NewConnectionEvent& event) override {
+		peer = event.peer();
+	}
+};
+
+class SeedRecorder: public IProtocolHandler {
+public:
+	std::vector<long> seeds;
+
+	void execute(ENetPeer* peer, const void* raw) override {
+		seeds.push_back(getMsg<Seed>(raw)->seed());
+	}
+};
+
+class UserConnectedCounter: public IProtocolHandler {
+public:
+	int count = 0;
+
+	void execute(ENetPeer* peer, const void* raw) override {
+		++count;
+	}
+};
+
+}
+
+/**
+ * @brief Connects a client and a server network in the same process via loopback
+ */
+class MessageSenderTest: public core::AbstractTest {
+protected:
+	core::EventBusPtr _serverEventBus;
+	core::EventBusPtr _clientEventBus;
+	NetworkPtr _server;
+	NetworkPtr _client;
+	MessageSenderPtr _serverSender;
+	MessageSenderPtr _clientSender;
+	ConnectionListener _serverListener;
+	ConnectionListener _clientListener;
+	std::shared_ptr<SeedRecorder> _seeds;
+	std::shared_ptr<UserConnectedCounter> _userConnected;
+
+	// services both hosts until the given condition is met
+	template<class FUNC>
+	bool pump(FUNC&& condition) {
+		for (int i = 0; i < 2000; ++i) {
+			_server->update();
+			_client->update();
+			if (condition()) {
+				return true;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		return false;
+	}
+
+public:
+	void SetUp() override {
+		core::AbstractTest::SetUp();
+		_serverEventBus = std::make_shared<core::EventBus>();
+		_clientEventBus = std::make_shared<core::EventBus>();
+		_serverEventBus->subscribe<NewConnectionEvent>(_serverListener);
+		_clientEventBus->subscribe<NewConnectionEvent>(_clientListener);
+
+		const ProtocolHandlerRegistryPtr& serverRegistry = std::make_shared<ProtocolHandlerRegistry>();
+		const ProtocolHandlerRegistryPtr& clientRegistry = std::make_shared<ProtocolHandlerRegistry>();
+		_seeds = std::make_shared<SeedRecorder>();
+		_userConnected = std::make_shared<UserConnectedCounter>();
+		clientRegistry->registerHandler(ServerMsgType::Seed, _seeds);
+		serverRegistry->registerHandler(ClientMsgType::UserConnected, _userConnected);
+
+		_server = std::make_shared<Network>(serverRegistry, _serverEventBus);
+		_client = std::make_shared<Network>(clientRegistry, _clientEventBus);
+		_serverSender = std::make_shared<MessageSender>(_server);
+		_clientSender = std::make_shared<MessageSender>(_client);
+		ASSERT_TRUE(_server->init());
+		ASSERT_TRUE(_client->init());
+		ASSERT_TRUE(_server->bind(testPort, "127.0.0.1"));
+		ASSERT_NE(nullptr, _client->connect(testPort, "127.0.0.1"));
+		ASSERT_TRUE(pump([this] () {return _serverListener.peer != nullptr && _clientListener.peer != nullptr;}))
+			<< "Could not establish the loopback connection";
+	}
+
+	void TearDown() override {
+		_client->shutdown();
+		_server->shutdown();
+		core::AbstractTest::TearDown();
+	}
+
+	void sendSeed(long seed, uint32_t flags = ENET_PACKET_FLAG_RELIABLE) {
+		ScopedBuilder builder;
+		FlatBufferBuilder& fbb = builder;
+		_serverSender->sendServerMessage(_serverListener.peer, fbb, ServerMsgType::Seed, CreateSeed(fbb, seed).Union(), flags);
+	}
+};
+
+TEST_F(MessageSenderTest, testBatchOrder) {
+	const int n = 100;
+	for (int i = 0; i < n; ++i) {
+		sendSeed(i);
+	}
+	EXPECT_EQ(0u, _serverSender->sentPackets()) << "Messages should be queued until the flush";
+	_serverSender->flush();
+	ASSERT_TRUE(pump([this, n] () {return (int)_seeds->seeds.size() >= n;}));
+	ASSERT_EQ(n, (int)_seeds->seeds.size());
+	for (int i = 0; i < n; ++i) {
+		ASSERT_EQ(i, _seeds->seeds[i]) << "The order of the messages was not kept";
+	}
+	EXPECT_EQ((uint64_t)n, _serverSender->sentMessages());
+	EXPECT_EQ(1u, _serverSender->sentPackets()) << "All messages of the frame should be coalesced into one packet";
+}
+
+TEST_F(MessageSenderTest, testReliableAndUnreliable) {
+	for (int i = 0; i < 10; ++i) {
+		sendSeed(i, ENET_PACKET_FLAG_RELIABLE);
+		sendSeed(1000 + i, 0u);
+	}
+	_serverSender->flush();
+	EXPECT_EQ(2u, _serverSender->sentPackets()) << "Expected one packet per packet flags";
+	ASSERT_TRUE(pump([this] () {return _seeds->seeds.size() >= 20u;}));
+	std::vector<long> reliable;
+	for (long seed : _seeds->seeds) {
+		if (seed < 1000) {
+			reliable.push_back(seed);
+		}
+	}
+	ASSERT_EQ(10u, reliable.size());
+	for (int i = 0; i < 10; ++i) {
+		EXPECT_EQ(i, reliable[i]);
+	}
+
+	// the client messages are framed, too
+	ScopedBuilder builder;
+	FlatBufferBuilder& fbb = builder;
+	_clientSender->sendClientMessage(_clientListener.peer, fbb, ClientMsgType::UserConnected, CreateUserConnected(fbb).Union());
+	ASSERT_TRUE(pump([this] () {return _userConnected->count == 1;}));
+}
+
+class PacketBatchTest: public core::AbstractTest {
+};
+
+TEST_F(PacketBatchTest, testReadFrames) {
+	const uint8_t a[] = { 1, 2, 3 };
+	const uint8_t b[] = { 4, 5, 6, 7, 8, 9, 10, 11, 12 };
+	PacketBatch batch(ENET_PACKET_FLAG_RELIABLE);
+	batch.add(a, sizeof(a));
+	batch.add(b, sizeof(b));
+	ASSERT_EQ(2, batch.messages());
+	ENetPacket* packet = batch.createPacket();
+	ASSERT_NE(nullptr, packet);
+	ASSERT_TRUE(batch.empty());
+	ASSERT_EQ(0u, packet->dataLength % FrameAlignment);
+	std::vector<uint32_t> sizes;
+	ASSERT_TRUE(readFrames(packet->data, packet->dataLength, [&] (const uint8_t* data, uint32_t size) {
+		EXPECT_EQ(0u, (uintptr_t)(data - packet->data) % FrameAlignment);
+		sizes.push_back(size);
+		return true;
+	}));
+	ASSERT_EQ(2u, sizes.size());
+	EXPECT_EQ(sizeof(a), sizes[0]);
+	EXPECT_EQ(sizeof(b), sizes[1]);
+	EXPECT_FALSE(readFrames(packet->data, packet->dataLength - FrameAlignment, [] (const uint8_t*, uint32_t) {return true;}))
+		<< "A truncated packet must be detected";
+	enet_packet_destroy(packet);
+}
+
+}
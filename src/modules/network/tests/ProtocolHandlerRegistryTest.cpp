@@ -0,0 +1,133 @@
+/**
+ * @file
+ */
+
+#include <gtest/gtest.h>
+#include "network/ProtocolHandlerRegistry.h"
+#include "network/IMsgProtocolHandler.h"
+#include <vector>
+
+namespace network {
+
+using namespace flatbuffers;
+
+namespace {
+
+class TypeRecorder: public IProtocolHandler {
+public:
+	std::vector<int>& types;
+	const int type;
+
+	TypeRecorder(std::vector<int>& _types, int _type) :
+			types(_types), type(_type) {
+	}
+
+	void execute(ENetPeer* peer, const void* raw) override {
+		types.push_back(type);
+	}
+};
+
+class SeedHandler: public IMsgProtocolHandler<Seed, void> {
+public:
+	void execute(void* attachment, const Seed* message) override {
+	}
+};
+
+class MoveHandler: public IMsgProtocolHandler<Move, void> {
+public:
+	void execute(void* attachment, const Move* message) override {
+	}
+};
+
+// every union member is an empty table here - fields without a value are not part of the buffer
+inline Offset<void> createEmptyTable(FlatBufferBuilder& fbb) {
+	return Offset<void>(fbb.EndTable(fbb.StartTable(), 0));
+}
+
+}
+
+class ProtocolHandlerRegistryTest: public testing::Test {
+protected:
+	ProtocolHandlerRegistry _registry;
+	std::vector<int> _types;
+
+	// the same lookup that Network::dispatch does after the verification
+	bool dispatchServerMessage(ServerMsgType type) {
+		FlatBufferBuilder fbb;
+		FinishServerMessageBuffer(fbb, CreateServerMessage(fbb, type, createEmptyTable(fbb)));
+		const ServerMessage* msg = GetServerMessage(fbb.GetBufferPointer());
+		IProtocolHandler* handler = _registry.getHandler(msg->data_type());
+		if (handler == nullptr) {
+			return false;
+		}
+		handler->execute(nullptr, msg->data());
+		return true;
+	}
+
+	bool dispatchClientMessage(ClientMsgType type) {
+		FlatBufferBuilder fbb;
+		FinishClientMessageBuffer(fbb, CreateClientMessage(fbb, type, createEmptyTable(fbb)));
+		const ClientMessage* msg = GetClientMessage(fbb.GetBufferPointer());
+		IProtocolHandler* handler = _registry.getHandler(msg->data_type());
+		if (handler == nullptr) {
+			return false;
+		}
+		handler->execute(nullptr, msg->data());
+		return true;
+	}
+};
+
+TEST_F(ProtocolHandlerRegistryTest, testDispatchEveryServerMessage) {
+	std::vector<int> expected;
+	for (int i = (int)ServerMsgType::MIN + 1; i <= (int)ServerMsgType::MAX; ++i) {
+		_registry.registerHandler((ServerMsgType)i, std::make_shared<TypeRecorder>(_types, i));
+		expected.push_back(i);
+	}
+	for (int i = (int)ServerMsgType::MIN + 1; i <= (int)ServerMsgType::MAX; ++i) {
+		EXPECT_TRUE(dispatchServerMessage((ServerMsgType)i)) << EnumNameServerMsgType((ServerMsgType)i);
+	}
+	EXPECT_EQ(expected, _types);
+	// the client handlers don't share the slots of the server handlers
+	for (int i = (int)ClientMsgType::MIN + 1; i <= (int)ClientMsgType::MAX; ++i) {
+		EXPECT_EQ(nullptr, _registry.getHandler((ClientMsgType)i)) << EnumNameClientMsgType((ClientMsgType)i);
+	}
+}
+
+TEST_F(ProtocolHandlerRegistryTest, testDispatchEveryClientMessage) {
+	std::vector<int> expected;
+	for (int i = (int)ClientMsgType::MIN + 1; i <= (int)ClientMsgType::MAX; ++i) {
+		_registry.registerHandler((ClientMsgType)i, std::make_shared<TypeRecorder>(_types, i));
+		expected.push_back(i);
+	}
+	for (int i = (int)ClientMsgType::MIN + 1; i <= (int)ClientMsgType::MAX; ++i) {
+		EXPECT_TRUE(dispatchClientMessage((ClientMsgType)i)) << EnumNameClientMsgType((ClientMsgType)i);
+	}
+	EXPECT_EQ(expected, _types);
+}
+
+TEST_F(ProtocolHandlerRegistryTest, testMissingHandler) {
+	EXPECT_FALSE(dispatchServerMessage(ServerMsgType::Seed));
+	EXPECT_EQ(nullptr, _registry.getHandler(ServerMsgType::NONE));
+	EXPECT_EQ(nullptr, _registry.getHandler((ServerMsgType)((int)ServerMsgType::MAX + 1)));
+	EXPECT_EQ(nullptr, _registry.getHandler((ClientMsgType)((int)ClientMsgType::MAX + 1)));
+}
+
+TEST_F(ProtocolHandlerRegistryTest, testReplaceHandler) {
+	_registry.registerHandler(ServerMsgType::Seed, std::make_shared<TypeRecorder>(_types, 1));
+	_registry.registerHandler(ServerMsgType::Seed, std::make_shared<TypeRecorder>(_types, 2));
+	EXPECT_TRUE(dispatchServerMessage(ServerMsgType::Seed));
+	ASSERT_EQ(1u, _types.size());
+	EXPECT_EQ(2, _types[0]);
+}
+
+TEST_F(ProtocolHandlerRegistryTest, testRegisterByMessageType) {
+	static_assert(MsgTypeOf<Seed>::value == ServerMsgType::Seed, "Unexpected server msg type");
+	static_assert(MsgTypeOf<Move>::value == ClientMsgType::Move, "Unexpected client msg type");
+	_registry.registerHandler<SeedHandler>();
+	_registry.registerHandler<MoveHandler>();
+	EXPECT_NE(nullptr, dynamic_cast<SeedHandler*>(_registry.getHandler(ServerMsgType::Seed)));
+	EXPECT_NE(nullptr, dynamic_cast<MoveHandler*>(_registry.getHandler(ClientMsgType::Move)));
+	EXPECT_EQ(nullptr, _registry.getHandler(ServerMsgType::EntityUpdate));
+}
+
+}
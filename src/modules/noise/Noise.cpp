@@ -9,6 +9,7 @@
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/norm.hpp>
 #include <limits>
+#include <algorithm>
 
 #define GLM_NOISE 0
 #define CINDER_NOISE 1
@@ -56,6 +57,53 @@ float Noise4D(const glm::vec4& pos, int octaves, float persistence, float freque
 	return Noise(pos, octaves, persistence, 2.0f, frequency, amplitude);
 }
 
+/**
+ * @brief Batched version of the fractional brownian motion. The positions are processed in blocks
+ * to keep the scaled coordinates in the cache while all octaves are applied.
+ */
+template<int Components>
+static void Noise(const float* const* coords, float* out, int amount, int octaves, float persistence, float lacunarity, float frequency, float amplitude) {
+	core_trace_scoped(NoiseBatch);
+	constexpr int BlockSize = 256;
+	float scaled[Components][BlockSize];
+	float n[BlockSize];
+	for (int offset = 0; offset < amount; offset += BlockSize) {
+		const int blockAmount = std::min(BlockSize, amount - offset);
+		float* blockOut = out + offset;
+		std::fill(blockOut, blockOut + blockAmount, 0.0f);
+		float octaveFrequency = frequency;
+		float octaveAmplitude = amplitude;
+		for (int i = 0; i < octaves; ++i) {
+			for (int c = 0; c < Components; ++c) {
+				const float* in = coords[c] + offset;
+				for (int j = 0; j < blockAmount; ++j) {
+					scaled[c][j] = in[j] * octaveFrequency;
+				}
+			}
+			if (Components == 2) {
+				noise(scaled[0], scaled[1], n, blockAmount);
+			} else {
+				noise(scaled[0], scaled[1], scaled[Components - 1], n, blockAmount);
+			}
+			for (int j = 0; j < blockAmount; ++j) {
+				blockOut[j] += n[j] * octaveAmplitude;
+			}
+			octaveFrequency *= lacunarity;
+			octaveAmplitude *= persistence;
+		}
+	}
+}
+
+void Noise2D(const float* x, const float* y, float* out, int amount, int octaves, float persistence, float frequency, float amplitude) {
+	const float* coords[] = { x, y };
+	Noise<2>(coords, out, amount, octaves, persistence, 2.0f, frequency, amplitude);
+}
+
+void Noise3D(const float* x, const float* y, const float* z, float* out, int amount, int octaves, float persistence, float frequency, float amplitude) {
+	const float* coords[] = { x, y, z };
+	Noise<3>(coords, out, amount, octaves, persistence, 2.0f, frequency, amplitude);
+}
+
 int32_t intValueNoise(const glm::ivec3& pos, int32_t seed) {
 	constexpr int32_t xgen = 1619;
 	constexpr int32_t ygen = 31337;
@@ -48,6 +48,22 @@ extern float Noise3D(const glm::vec3& pos, int octaves = 1, float persistence =
  */
 extern float Noise4D(const glm::vec4& pos, int octaves = 1, float persistence = 1.0f, float frequency = 1.0f, float amplitude = 1.0f);
 
+/**
+ * @brief Batched version of Noise2D() that evaluates the noise for @c amount positions at once.
+ * The results are identical to calling Noise2D() for each position.
+ * @param[in] x,y the coordinates of the positions
+ * @param[out] out receives the @c amount noise values
+ */
+extern void Noise2D(const float* x, const float* y, float* out, int amount, int octaves = 1, float persistence = 1.0f, float frequency = 1.0f, float amplitude = 1.0f);
+
+/**
+ * @brief Batched version of Noise3D() that evaluates the noise for @c amount positions at once.
+ * The results are identical to calling Noise3D() for each position.
+ * @param[in] x,y,z the coordinates of the positions
+ * @param[out] out receives the @c amount noise values
+ */
+extern void Noise3D(const float* x, const float* y, const float* z, float* out, int amount, int octaves = 1, float persistence = 1.0f, float frequency = 1.0f, float amplitude = 1.0f);
+
 /**
  * @brief Fills the given target buffer with RGB or RGBA values for the noise (depending on the components).
  * @param[in] buffer pointer to the target buffer - must be of size @c width * height * 3
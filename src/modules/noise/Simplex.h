@@ -41,6 +41,19 @@
 //#define SIMPLEX_DERIVATIVES_RESCALE
 // This changes the luts types to integers instead of unsigned chars. It might be faster on some platforms
 //#define SIMPLEX_INTEGER_LUTS
+// This disables the SSE2 and AVX2 versions of the batched noise functions
+//#define SIMPLEX_NO_SIMD
+
+#ifndef SIMPLEX_NO_SIMD
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMPLEX_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(SIMPLEX_SSE2) && defined(__AVX2__)
+#define SIMPLEX_AVX2
+#include <immintrin.h>
+#endif
+#endif
 
 namespace noise {
 
@@ -53,6 +66,11 @@ inline float noise(const glm::vec3 &v);
 //! Returns a 4D simplex noise
 inline float noise(const glm::vec4 &v);
 
+//! Evaluates the 2D simplex noise for @c amount positions at once (SSE2 or AVX2 if available)
+inline void noise(const float* x, const float* y, float* out, int amount);
+//! Evaluates the 3D simplex noise for @c amount positions at once (SSE2 or AVX2 if available)
+inline void noise(const float* x, const float* y, const float* z, float* out, int amount);
+
 //! Returns a 1D simplex ridged noise
 inline float ridgedNoise(float x);
 //! Returns a 2D simplex ridged noise
@@ -621,6 +639,351 @@ float noise(const glm::vec3 &v) {
 	return 32.0f * (n0 + n1 + n2 + n3); // TODO: The scale factor is preliminary!
 }
 
+#ifdef SIMPLEX_SSE2
+namespace details {
+
+/*
+ * Lane types for the batched noise functions. The kernels below are written once against
+ * these wrappers and execute the same operations in the same order for each lane width.
+ * That way the SSE2 and the AVX2 versions produce identical results - the client and the
+ * server must generate the same world.
+ */
+struct Float4 {
+	__m128 v;
+	inline Float4(__m128 _v) : v(_v) {}
+	inline explicit Float4(float f) : v(_mm_set1_ps(f)) {}
+};
+
+struct Int4 {
+	__m128i v;
+	inline Int4(__m128i _v) : v(_v) {}
+	inline explicit Int4(int i) : v(_mm_set1_epi32(i)) {}
+};
+
+inline Float4 operator+(const Float4& a, const Float4& b) { return _mm_add_ps(a.v, b.v); }
+inline Float4 operator-(const Float4& a, const Float4& b) { return _mm_sub_ps(a.v, b.v); }
+inline Float4 operator*(const Float4& a, const Float4& b) { return _mm_mul_ps(a.v, b.v); }
+inline Float4 operator&(const Float4& a, const Float4& b) { return _mm_and_ps(a.v, b.v); }
+inline Float4 operator^(const Float4& a, const Float4& b) { return _mm_xor_ps(a.v, b.v); }
+inline Float4 operator>(const Float4& a, const Float4& b) { return _mm_cmpgt_ps(a.v, b.v); }
+inline Float4 operator>=(const Float4& a, const Float4& b) { return _mm_cmpge_ps(a.v, b.v); }
+inline Float4 select(const Float4& mask, const Float4& a, const Float4& b) { return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)); }
+inline Int4 operator+(const Int4& a, const Int4& b) { return _mm_add_epi32(a.v, b.v); }
+inline Int4 operator&(const Int4& a, const Int4& b) { return _mm_and_si128(a.v, b.v); }
+inline Int4 operator|(const Int4& a, const Int4& b) { return _mm_or_si128(a.v, b.v); }
+inline Int4 operator<(const Int4& a, const Int4& b) { return _mm_cmplt_epi32(a.v, b.v); }
+inline Int4 operator==(const Int4& a, const Int4& b) { return _mm_cmpeq_epi32(a.v, b.v); }
+inline Int4 operator~(const Int4& a) { return _mm_xor_si128(a.v, _mm_set1_epi32(-1)); }
+inline Int4 operator<<(const Int4& a, int bits) { return _mm_slli_epi32(a.v, bits); }
+inline Float4 toFloat(const Int4& a) { return _mm_cvtepi32_ps(a.v); }
+inline Float4 asFloat(const Int4& a) { return _mm_castsi128_ps(a.v); }
+inline Int4 asInt(const Float4& a) { return _mm_castps_si128(a.v); }
+// same as FASTFLOOR - including the off by one for values <= 0
+inline Int4 fastFloor(const Float4& a) { return _mm_add_epi32(_mm_cvttps_epi32(a.v), _mm_castps_si128(_mm_cmple_ps(a.v, _mm_setzero_ps()))); }
+// the scalar version applies the double skewing factors in double precision and rounds the result back to float
+inline Float4 mulDouble(const Float4& a, double c) {
+	const __m128d f = _mm_set1_pd(c);
+	const __m128d lo = _mm_mul_pd(_mm_cvtps_pd(a.v), f);
+	const __m128d hi = _mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(a.v, a.v)), f);
+	return _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi));
+}
+inline Float4 addDouble(const Float4& a, double c) {
+	const __m128d f = _mm_set1_pd(c);
+	const __m128d lo = _mm_add_pd(_mm_cvtps_pd(a.v), f);
+	const __m128d hi = _mm_add_pd(_mm_cvtps_pd(_mm_movehl_ps(a.v, a.v)), f);
+	return _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi));
+}
+
+struct SSE2 {
+	static constexpr int Lanes = 4;
+	typedef Float4 Float;
+	typedef Int4 Int;
+	static inline Float load(const float* p) { return _mm_loadu_ps(p); }
+	static inline void store(float* p, const Float& a) { _mm_storeu_ps(p, a.v); }
+	static inline Int loadInt(const int* p) { return _mm_loadu_si128((const __m128i*)p); }
+	static inline void storeInt(int* p, const Int& a) { _mm_storeu_si128((__m128i*)p, a.v); }
+};
+
+#ifdef SIMPLEX_AVX2
+struct Float8 {
+	__m256 v;
+	inline Float8(__m256 _v) : v(_v) {}
+	inline explicit Float8(float f) : v(_mm256_set1_ps(f)) {}
+};
+
+struct Int8 {
+	__m256i v;
+	inline Int8(__m256i _v) : v(_v) {}
+	inline explicit Int8(int i) : v(_mm256_set1_epi32(i)) {}
+};
+
+inline Float8 operator+(const Float8& a, const Float8& b) { return _mm256_add_ps(a.v, b.v); }
+inline Float8 operator-(const Float8& a, const Float8& b) { return _mm256_sub_ps(a.v, b.v); }
+inline Float8 operator*(const Float8& a, const Float8& b) { return _mm256_mul_ps(a.v, b.v); }
+inline Float8 operator&(const Float8& a, const Float8& b) { return _mm256_and_ps(a.v, b.v); }
+inline Float8 operator^(const Float8& a, const Float8& b) { return _mm256_xor_ps(a.v, b.v); }
+inline Float8 operator>(const Float8& a, const Float8& b) { return _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ); }
+inline Float8 operator>=(const Float8& a, const Float8& b) { return _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ); }
+inline Float8 select(const Float8& mask, const Float8& a, const Float8& b) { return _mm256_blendv_ps(b.v, a.v, mask.v); }
+inline Int8 operator+(const Int8& a, const Int8& b) { return _mm256_add_epi32(a.v, b.v); }
+inline Int8 operator&(const Int8& a, const Int8& b) { return _mm256_and_si256(a.v, b.v); }
+inline Int8 operator|(const Int8& a, const Int8& b) { return _mm256_or_si256(a.v, b.v); }
+inline Int8 operator<(const Int8& a, const Int8& b) { return _mm256_cmpgt_epi32(b.v, a.v); }
+inline Int8 operator==(const Int8& a, const Int8& b) { return _mm256_cmpeq_epi32(a.v, b.v); }
+inline Int8 operator~(const Int8& a) { return _mm256_xor_si256(a.v, _mm256_set1_epi32(-1)); }
+inline Int8 operator<<(const Int8& a, int bits) { return _mm256_slli_epi32(a.v, bits); }
+inline Float8 toFloat(const Int8& a) { return _mm256_cvtepi32_ps(a.v); }
+inline Float8 asFloat(const Int8& a) { return _mm256_castsi256_ps(a.v); }
+inline Int8 asInt(const Float8& a) { return _mm256_castps_si256(a.v); }
+inline Int8 fastFloor(const Float8& a) { return _mm256_add_epi32(_mm256_cvttps_epi32(a.v), _mm256_castps_si256(_mm256_cmp_ps(a.v, _mm256_setzero_ps(), _CMP_LE_OQ))); }
+inline Float8 mulDouble(const Float8& a, double c) {
+	const __m256d f = _mm256_set1_pd(c);
+	const __m256d lo = _mm256_mul_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(a.v)), f);
+	const __m256d hi = _mm256_mul_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(a.v, 1)), f);
+	return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(lo)), _mm256_cvtpd_ps(hi), 1);
+}
+inline Float8 addDouble(const Float8& a, double c) {
+	const __m256d f = _mm256_set1_pd(c);
+	const __m256d lo = _mm256_add_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(a.v)), f);
+	const __m256d hi = _mm256_add_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(a.v, 1)), f);
+	return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(lo)), _mm256_cvtpd_ps(hi), 1);
+}
+
+struct AVX2 {
+	static constexpr int Lanes = 8;
+	typedef Float8 Float;
+	typedef Int8 Int;
+	static inline Float load(const float* p) { return _mm256_loadu_ps(p); }
+	static inline void store(float* p, const Float& a) { _mm256_storeu_ps(p, a.v); }
+	static inline Int loadInt(const int* p) { return _mm256_loadu_si256((const __m256i*)p); }
+	static inline void storeInt(int* p, const Int& a) { _mm256_storeu_si256((__m256i*)p, a.v); }
+};
+#endif
+
+/*
+ * Batched versions of the grad() helpers. The sign of the gradient is applied by flipping the
+ * sign bit, which is the same as the negation in the scalar version.
+ */
+template<class Simd>
+inline typename Simd::Float gradBatch(const typename Simd::Int& hash, const typename Simd::Float& x, const typename Simd::Float& y) {
+	typedef typename Simd::Float Float;
+	typedef typename Simd::Int Int;
+	const Int h = hash & Int(7);
+	const Float lower = asFloat(h < Int(4));
+	const Float u = select(lower, x, y);
+	const Float v = select(lower, y, x);
+	return (u ^ asFloat((h & Int(1)) << 31)) + ((Float(2.0f) * v) ^ asFloat((h & Int(2)) << 30));
+}
+
+template<class Simd>
+inline typename Simd::Float gradBatch(const typename Simd::Int& hash, const typename Simd::Float& x, const typename Simd::Float& y, const typename Simd::Float& z) {
+	typedef typename Simd::Float Float;
+	typedef typename Simd::Int Int;
+	const Int h = hash & Int(15);
+	const Float u = select(asFloat(h < Int(8)), x, y);
+	const Float v = select(asFloat(h < Int(4)), y, select(asFloat((h == Int(12)) | (h == Int(14))), x, z));
+	return (u ^ asFloat((h & Int(1)) << 31)) + (v ^ asFloat((h & Int(2)) << 30));
+}
+
+template<class Simd>
+inline typename Simd::Float cornerBatch(const int* hash, const typename Simd::Float& x, const typename Simd::Float& y) {
+	typedef typename Simd::Float Float;
+	Float t = Float(0.5f) - x * x - y * y;
+	const Float inside = t >= Float(0.0f);
+	t = t * t;
+	return inside & (t * t * gradBatch<Simd>(Simd::loadInt(hash), x, y));
+}
+
+template<class Simd>
+inline typename Simd::Float cornerBatch(const int* hash, const typename Simd::Float& x, const typename Simd::Float& y, const typename Simd::Float& z) {
+	typedef typename Simd::Float Float;
+	Float t = Float(0.6f) - x * x - y * y - z * z;
+	const Float inside = t >= Float(0.0f);
+	t = t * t;
+	return inside & (t * t * gradBatch<Simd>(Simd::loadInt(hash), x, y, z));
+}
+
+/*
+ * The batched kernels follow the scalar implementation step by step - including the double
+ * precision skewing - and return bit identical results.
+ */
+template<class Simd>
+inline typename Simd::Float noiseBatch(const typename Simd::Float& x, const typename Simd::Float& y) {
+	typedef typename Simd::Float Float;
+	typedef typename Simd::Int Int;
+	constexpr int Lanes = Simd::Lanes;
+	const Float one(1.0f);
+	const Float s = mulDouble(x + y, F2);
+	const Int i = fastFloor(x + s);
+	const Int j = fastFloor(y + s);
+	const Float t = mulDouble(toFloat(i + j), G2);
+	const Float x0 = x - (toFloat(i) - t);
+	const Float y0 = y - (toFloat(j) - t);
+	const Float lowerTriangle = x0 > y0;
+	const Float i1 = lowerTriangle & one;
+	const Float j1 = one - i1;
+	const Float x1 = addDouble(x0 - i1, G2);
+	const Float y1 = addDouble(y0 - j1, G2);
+	const Float x2 = addDouble(x0 - one, 2.0f * G2);
+	const Float y2 = addDouble(y0 - one, 2.0f * G2);
+
+	// the permutation table lookups are done per lane
+	int ii[Lanes], jj[Lanes], o1[Lanes];
+	Simd::storeInt(ii, i & Int(0xff));
+	Simd::storeInt(jj, j & Int(0xff));
+	Simd::storeInt(o1, asInt(lowerTriangle) & Int(1));
+	int h0[Lanes], h1[Lanes], h2[Lanes];
+	for (int l = 0; l < Lanes; ++l) {
+		h0[l] = perm[ii[l] + perm[jj[l]]];
+		h1[l] = perm[ii[l] + o1[l] + perm[jj[l] + 1 - o1[l]]];
+		h2[l] = perm[ii[l] + 1 + perm[jj[l] + 1]];
+	}
+
+	const Float n0 = cornerBatch<Simd>(h0, x0, y0);
+	const Float n1 = cornerBatch<Simd>(h1, x1, y1);
+	const Float n2 = cornerBatch<Simd>(h2, x2, y2);
+	return Float(40.0f) * (n0 + n1 + n2);
+}
+
+template<class Simd>
+inline typename Simd::Float noiseBatch(const typename Simd::Float& x, const typename Simd::Float& y, const typename Simd::Float& z) {
+	typedef typename Simd::Float Float;
+	typedef typename Simd::Int Int;
+	constexpr int Lanes = Simd::Lanes;
+	const Float one(1.0f);
+	const Float s = mulDouble(x + y + z, F3);
+	const Int i = fastFloor(x + s);
+	const Int j = fastFloor(y + s);
+	const Int k = fastFloor(z + s);
+	const Float t = mulDouble(toFloat(i + j + k), G3);
+	const Float x0 = x - (toFloat(i) - t);
+	const Float y0 = y - (toFloat(j) - t);
+	const Float z0 = z - (toFloat(k) - t);
+
+	// branchless version of the simplex order selection
+	const Int xy = asInt(x0 >= y0);
+	const Int yz = asInt(y0 >= z0);
+	const Int xz = asInt(x0 >= z0);
+	const Int bit(1);
+	const Int i1 = xy & xz & bit;
+	const Int j1 = ~xy & yz & bit;
+	const Int k1 = ~xz & ~yz & bit;
+	const Int i2 = (xy | xz) & bit;
+	const Int j2 = (~xy | yz) & bit;
+	const Int k2 = ~(xz & yz) & bit;
+	const Float x1 = addDouble(x0 - toFloat(i1), G3);
+	const Float y1 = addDouble(y0 - toFloat(j1), G3);
+	const Float z1 = addDouble(z0 - toFloat(k1), G3);
+	const Float x2 = addDouble(x0 - toFloat(i2), 2.0f * G3);
+	const Float y2 = addDouble(y0 - toFloat(j2), 2.0f * G3);
+	const Float z2 = addDouble(z0 - toFloat(k2), 2.0f * G3);
+	const Float x3 = addDouble(x0 - one, 3.0f * G3);
+	const Float y3 = addDouble(y0 - one, 3.0f * G3);
+	const Float z3 = addDouble(z0 - one, 3.0f * G3);
+
+	// the permutation table lookups are done per lane
+	int ii[Lanes], jj[Lanes], kk[Lanes];
+	int oi1[Lanes], oj1[Lanes], ok1[Lanes], oi2[Lanes], oj2[Lanes], ok2[Lanes];
+	Simd::storeInt(ii, i & Int(0xff));
+	Simd::storeInt(jj, j & Int(0xff));
+	Simd::storeInt(kk, k & Int(0xff));
+	Simd::storeInt(oi1, i1);
+	Simd::storeInt(oj1, j1);
+	Simd::storeInt(ok1, k1);
+	Simd::storeInt(oi2, i2);
+	Simd::storeInt(oj2, j2);
+	Simd::storeInt(ok2, k2);
+	int h0[Lanes], h1[Lanes], h2[Lanes], h3[Lanes];
+	for (int l = 0; l < Lanes; ++l) {
+		h0[l] = perm[ii[l] + perm[jj[l] + perm[kk[l]]]];
+		h1[l] = perm[ii[l] + oi1[l] + perm[jj[l] + oj1[l] + perm[kk[l] + ok1[l]]]];
+		h2[l] = perm[ii[l] + oi2[l] + perm[jj[l] + oj2[l] + perm[kk[l] + ok2[l]]]];
+		h3[l] = perm[ii[l] + 1 + perm[jj[l] + 1 + perm[kk[l] + 1]]];
+	}
+
+	const Float n0 = cornerBatch<Simd>(h0, x0, y0, z0);
+	const Float n1 = cornerBatch<Simd>(h1, x1, y1, z1);
+	const Float n2 = cornerBatch<Simd>(h2, x2, y2, z2);
+	const Float n3 = cornerBatch<Simd>(h3, x3, y3, z3);
+	return Float(32.0f) * (n0 + n1 + n2 + n3);
+}
+
+template<class Simd>
+inline int noiseBatches(const float* x, const float* y, float* out, int offset, int amount) {
+	for (; offset + Simd::Lanes <= amount; offset += Simd::Lanes) {
+		Simd::store(out + offset, noiseBatch<Simd>(Simd::load(x + offset), Simd::load(y + offset)));
+	}
+	return offset;
+}
+
+template<class Simd>
+inline int noiseBatches(const float* x, const float* y, const float* z, float* out, int offset, int amount) {
+	for (; offset + Simd::Lanes <= amount; offset += Simd::Lanes) {
+		Simd::store(out + offset, noiseBatch<Simd>(Simd::load(x + offset), Simd::load(y + offset), Simd::load(z + offset)));
+	}
+	return offset;
+}
+
+}
+
+void noise(const float* x, const float* y, float* out, int amount) {
+	int i = 0;
+#ifdef SIMPLEX_AVX2
+	i = details::noiseBatches<details::AVX2>(x, y, out, i, amount);
+#endif
+	i = details::noiseBatches<details::SSE2>(x, y, out, i, amount);
+	if (i < amount) {
+		// pad the remaining positions to a full batch - the scalar version would give the same results, this keeps one code path
+		constexpr int Lanes = details::SSE2::Lanes;
+		float px[Lanes] = { 0.0f }, py[Lanes] = { 0.0f }, po[Lanes];
+		const int remaining = amount - i;
+		for (int l = 0; l < remaining; ++l) {
+			px[l] = x[i + l];
+			py[l] = y[i + l];
+		}
+		details::noiseBatches<details::SSE2>(px, py, po, 0, Lanes);
+		for (int l = 0; l < remaining; ++l) {
+			out[i + l] = po[l];
+		}
+	}
+}
+
+void noise(const float* x, const float* y, const float* z, float* out, int amount) {
+	int i = 0;
+#ifdef SIMPLEX_AVX2
+	i = details::noiseBatches<details::AVX2>(x, y, z, out, i, amount);
+#endif
+	i = details::noiseBatches<details::SSE2>(x, y, z, out, i, amount);
+	if (i < amount) {
+		// pad the remaining positions to a full batch - the scalar version would give the same results, this keeps one code path
+		constexpr int Lanes = details::SSE2::Lanes;
+		float px[Lanes] = { 0.0f }, py[Lanes] = { 0.0f }, pz[Lanes] = { 0.0f }, po[Lanes];
+		const int remaining = amount - i;
+		for (int l = 0; l < remaining; ++l) {
+			px[l] = x[i + l];
+			py[l] = y[i + l];
+			pz[l] = z[i + l];
+		}
+		details::noiseBatches<details::SSE2>(px, py, pz, po, 0, Lanes);
+		for (int l = 0; l < remaining; ++l) {
+			out[i + l] = po[l];
+		}
+	}
+}
+#else
+void noise(const float* x, const float* y, float* out, int amount) {
+	for (int i = 0; i < amount; ++i) {
+		out[i] = noise(glm::vec2(x[i], y[i]));
+	}
+}
+
+void noise(const float* x, const float* y, const float* z, float* out, int amount) {
+	for (int i = 0; i < amount; ++i) {
+		out[i] = noise(glm::vec3(x[i], y[i], z[i]));
+	}
+}
+#endif
+
 namespace details {
 static LutType sSimplexLut[64][4] = { { 0, 1, 2, 3 }, { 0, 1, 3, 2 }, { 0, 0, 0, 0 }, { 0, 2, 3, 1 }, { 0, 0, 0, 0 }, { 0, 0, 0, 0 }, { 0, 0, 0, 0 }, { 1, 2, 3,
 		0 }, { 0, 2, 1, 3 }, { 0, 0, 0, 0 }, { 0, 3, 1, 2 }, { 0, 3, 2, 1 }, { 0, 0, 0, 0 }, { 0, 0, 0, 0 }, { 0, 0, 0, 0 }, { 1, 3, 2, 0 }, { 0, 0, 0, 0 }, {
@@ -2271,5 +2634,7 @@ void seed(uint32_t s) {
 #undef G3
 #undef F4
 #undef G4
+#undef SIMPLEX_SSE2
+#undef SIMPLEX_AVX2
 
 }
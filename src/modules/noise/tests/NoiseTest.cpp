@@ -6,6 +6,7 @@
 #include "noise/Noise.h"
 #include "image/Image.h"
 #include "core/GLM.h"
+#include <vector>
 
 namespace noise {
 
@@ -69,4 +70,35 @@ TEST_F(NoiseTest, test2DNoiseColorMap) {
 	ASSERT_TRUE(image::Image::writePng("testNoiseColorMap.png", buffer, width, height, components));
 }
 
+TEST_F(NoiseTest, testBatchedNoise) {
+	// odd amount to also cover the padded remainder of the batches
+	const int amount = 1021;
+	std::vector<float> x(amount), y(amount), z(amount), out(amount);
+	for (int i = 0; i < amount; ++i) {
+		x[i] = (i % 37) * 0.731f - 13.0f;
+		y[i] = (i / 37) * 0.417f - 5.0f;
+		z[i] = (i % 11) * 1.53f - 7.0f;
+	}
+	// integer positions are on the borders of the simplex cells
+	x[0] = y[0] = z[0] = 0.0f;
+	x[1] = y[1] = z[1] = -1.0f;
+
+	noise::noise(x.data(), y.data(), out.data(), amount);
+	for (int i = 0; i < amount; ++i) {
+		ASSERT_EQ(noise::noise(glm::vec2(x[i], y[i])), out[i]) << "2d noise differs at index " << i;
+	}
+	noise::noise(x.data(), y.data(), z.data(), out.data(), amount);
+	for (int i = 0; i < amount; ++i) {
+		ASSERT_EQ(noise::noise(glm::vec3(x[i], y[i], z[i])), out[i]) << "3d noise differs at index " << i;
+	}
+	noise::Noise2D(x.data(), y.data(), out.data(), amount, 3, 0.3f, 0.01f, 0.5f);
+	for (int i = 0; i < amount; ++i) {
+		ASSERT_EQ(noise::Noise2D(glm::vec2(x[i], y[i]), 3, 0.3f, 0.01f, 0.5f), out[i]) << "2d fBm differs at index " << i;
+	}
+	noise::Noise3D(x.data(), y.data(), z.data(), out.data(), amount, 3, 0.3f, 0.05f, 0.1f);
+	for (int i = 0; i < amount; ++i) {
+		ASSERT_EQ(noise::Noise3D(glm::vec3(x[i], y[i], z[i]), 3, 0.3f, 0.05f, 0.1f), out[i]) << "3d fBm differs at index " << i;
+	}
+}
+
 }
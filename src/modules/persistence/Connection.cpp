@@ -89,6 +89,28 @@ void Connection::disconnect() {
 	_preparedStatements.clear();
 }
 
+bool Connection::isValid() const {
+	return _connection != nullptr && PQstatus(_connection) == CONNECTION_OK;
+}
+
+bool Connection::ping() {
+	if (!isValid()) {
+		return false;
+	}
+	PGresult* res = PQexec(_connection, "SELECT 1;");
+	const bool alive = PQresultStatus(res) == PGRES_TUPLES_OK;
+	PQclear(res);
+	if (!alive) {
+		Log::warn("Connection %p is broken: %s", _connection, PQerrorMessage(_connection));
+	}
+	return alive;
+}
+
+bool Connection::reconnect() {
+	disconnect();
+	return connect();
+}
+
 void Connection::close() {
 	core::Singleton<ConnectionPool>::getInstance().giveBack(this);
 }
@@ -16,6 +16,7 @@ namespace persistence {
 class Connection {
 	friend class ConnectionPool;
 	friend class Model;
+	friend class QueryWorker;
 private:
 	ConnectionType* _connection;
 	std::string _host;
@@ -24,6 +25,8 @@ private:
 	std::string _password;
 	uint16_t _port;
 	std::unordered_set<std::string> _preparedStatements;
+	// the millis of the last time the connection was given back to the pool
+	uint64_t _lastUsed = 0u;
 	Connection();
 
 	~Connection();
@@ -43,6 +46,20 @@ private:
 
 	bool connect();
 
+	/**
+	 * @return @c true if the connection was established and is not known to be broken
+	 */
+	bool isValid() const;
+	/**
+	 * @brief Sends a trivial query to check whether the server is still reachable - a broken connection
+	 * is only detected by libpq once it is used.
+	 */
+	bool ping();
+	/**
+	 * @brief Establishes the connection again - the prepared statements are lost.
+	 */
+	bool reconnect();
+
 public:
 	void close();
 
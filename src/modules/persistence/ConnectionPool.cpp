@@ -1,10 +1,16 @@
 #include "ConnectionPool.h"
+#include "QueryWorker.h"
 #include "core/Log.h"
 #include "core/Common.h"
 #include "core/GameConfig.h"
+#include <chrono>
 
 namespace persistence {
 
+static uint64_t millis() {
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 ConnectionPool::ConnectionPool() {
 }
 
@@ -15,6 +21,9 @@ ConnectionPool::~ConnectionPool() {
 int ConnectionPool::init() {
 	_min = core::Var::getSafe(cfg::DatabaseMinConnections)->intVal();
 	_max = core::Var::getSafe(cfg::DatabaseMaxConnections)->intVal();
+	_acquireTimeoutMillis = core::Var::get(cfg::DatabaseAcquireTimeout, "1000")->intVal();
+	_idleCheckMillis = (uint64_t)std::max(0, core::Var::get(cfg::DatabaseIdleCheck, "30000")->intVal());
+	const int workers = core::Var::get(cfg::DatabaseWorkers, "1")->intVal();
 
 	core_assert_always(_min <= _max);
 
@@ -25,14 +34,49 @@ int ConnectionPool::init() {
 
 	Log::debug("Connect to %s@%s to database %s", _dbUser->strVal().c_str(), _dbHost->strVal().c_str(), _dbName->strVal().c_str());
 
-	for (int i = 0; i < _min; ++i) {
-		addConnection();
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		for (int i = 0; i < _min; ++i) {
+			_connections.push(createConnection());
+			++_connectionAmount;
+		}
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(_queryMutex);
+		_stopWorkers = false;
+	}
+	std::vector<QueryWorker*> started;
+	for (int i = 0; i < workers; ++i) {
+		QueryWorker* worker = new QueryWorker(this, createConnection());
+		worker->start();
+		started.push_back(worker);
+	}
+	{
+		std::unique_lock<std::mutex> lock(_queryMutex);
+		_workers.insert(_workers.end(), started.begin(), started.end());
 	}
 
 	return _connectionAmount;
 }
 
 void ConnectionPool::shutdown() {
+	std::vector<QueryWorker*> workers;
+	{
+		// execAsync() and hasWorkers() read the workers from other threads - the queued queries are
+		// still executed, but no new ones are accepted
+		std::unique_lock<std::mutex> lock(_queryMutex);
+		_stopWorkers = true;
+		workers.swap(_workers);
+	}
+	_queryAvailable.notify_all();
+	// the workers join their threads - this must not happen with the lock held
+	for (QueryWorker* worker : workers) {
+		delete worker;
+	}
+	update();
+
+	std::unique_lock<std::mutex> lock(_mutex);
 	while (!_connections.empty()) {
 		Connection* c = _connections.front();
 		c->disconnect();
@@ -47,48 +91,148 @@ void ConnectionPool::shutdown() {
 	_dbPw = core::VarPtr();
 }
 
-Connection* ConnectionPool::addConnection() {
+Connection* ConnectionPool::createConnection() const {
 	Connection* c = new Connection();
 
 	c->changeDb(_dbName->strVal());
 	c->changeHost(_dbHost->strVal());
 	c->setLoginData(_dbUser->strVal(), _dbPw->strVal());
-
-	_connections.push(c);
-	++_connectionAmount;
 	return c;
 }
 
 void ConnectionPool::giveBack(Connection* c) {
-	_connections.push(c);
+	c->_lastUsed = millis();
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_connections.push(c);
+	}
+	_connectionAvailable.notify_one();
 }
 
-Connection* ConnectionPool::connection() {
-	if (_connections.empty()) {
-		if (_connectionAmount >= _max) {
-			Log::warn("Could not aquire pooled connection, max limit hit");
-			return nullptr;
-		}
-		Connection* newC = addConnection();
-		if (!newC->connect()) {
-			Log::error("Could not connect to database");
-			return nullptr;
+bool ConnectionPool::checkConnection(Connection* c) const {
+	if (c->isValid()) {
+		// libpq only notices a dropped connection once it is used
+		if (_idleCheckMillis == 0u || millis() - c->_lastUsed < _idleCheckMillis || c->ping()) {
+			return true;
 		}
 	}
-	Connection* c = _connections.front();
-	_connections.pop();
-	// TODO: hide postgres here - move into connection
-	if (PQstatus(c->connection()) == CONNECTION_OK) {
-		return c;
+	if (c->reconnect()) {
+		return true;
+	}
+	Log::error("Could not connect to database");
+	return false;
+}
+
+Connection* ConnectionPool::connection(int timeoutMillis) {
+	if (!_dbName) {
+		Log::error("Could not get a database connection - the connection pool is not initialized");
+		return nullptr;
+	}
+	if (timeoutMillis < 0) {
+		timeoutMillis = _acquireTimeoutMillis;
+	}
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMillis);
+	Connection* c = nullptr;
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		for (;;) {
+			if (!_connections.empty()) {
+				c = _connections.front();
+				_connections.pop();
+				break;
+			}
+			if (_connectionAmount < _max) {
+				c = createConnection();
+				++_connectionAmount;
+				break;
+			}
+			if (_connectionAvailable.wait_until(lock, deadline) == std::cv_status::timeout && _connections.empty()) {
+				Log::warn("Could not aquire pooled connection, max limit hit");
+				return nullptr;
+			}
+		}
 	}
 
-	if (c->connect()) {
+	// the connection is checked outside of the lock - this involves network round trips
+	if (checkConnection(c)) {
 		return c;
 	}
 
 	delete c;
-	--_connectionAmount;
-	return connection();
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		--_connectionAmount;
+	}
+	// another waiting thread might be able to create a new connection now
+	_connectionAvailable.notify_one();
+	return nullptr;
+}
+
+void ConnectionPool::execAsync(AsyncQuery&& query) {
+	{
+		std::unique_lock<std::mutex> lock(_queryMutex);
+		if (!_workers.empty()) {
+			_queries.push_back(std::move(query));
+			_queryAvailable.notify_one();
+			return;
+		}
+	}
+	Log::error("Could not execute query '%s' - there are no query workers", query.statement.c_str());
+	Model::State state(nullptr);
+	state.lastErrorMsg = "No query workers";
+	finishQuery(query, std::move(state));
+}
+
+bool ConnectionPool::popQuery(AsyncQuery& query) {
+	std::unique_lock<std::mutex> lock(_queryMutex);
+	_queryAvailable.wait(lock, [this] () {
+		return _stopWorkers || !_queries.empty();
+	});
+	if (_queries.empty()) {
+		return false;
+	}
+	query = std::move(_queries.front());
+	_queries.pop_front();
+	return true;
+}
+
+void ConnectionPool::finishQuery(AsyncQuery& query, Model::State&& state) {
+	if (query.promise) {
+		query.promise->set_value(std::move(state));
+		return;
+	}
+	if (!query.callback) {
+		return;
+	}
+	std::unique_lock<std::mutex> lock(_finishedMutex);
+	_finished.push_back(FinishedQuery{std::move(query.callback), std::move(state)});
+}
+
+int ConnectionPool::update() {
+	std::vector<FinishedQuery> finished;
+	{
+		std::unique_lock<std::mutex> lock(_finishedMutex);
+		finished.swap(_finished);
+	}
+	for (FinishedQuery& query : finished) {
+		query.callback(query.state);
+	}
+	return (int)finished.size();
+}
+
+bool ConnectionPool::stopRequested() {
+	std::unique_lock<std::mutex> lock(_queryMutex);
+	return _stopWorkers;
+}
+
+bool ConnectionPool::hasWorkers() {
+	std::unique_lock<std::mutex> lock(_queryMutex);
+	return !_workers.empty();
+}
+
+int ConnectionPool::pendingQueries() {
+	std::unique_lock<std::mutex> lock(_queryMutex);
+	return (int)_queries.size();
 }
 
 }
@@ -1,47 +1,131 @@
 #pragma once
 
 #include <queue>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
 #include "Connection.h"
 #include "ScopedConnection.h"
+#include "Model.h"
 #include "core/Var.h"
 #include "core/Singleton.h"
 
 namespace persistence {
 
+class QueryWorker;
+
 /**
- * One connection pool per thread
+ * @brief A query that is executed by one of the QueryWorker threads of the pool
+ */
+struct AsyncQuery {
+	/// the name of the prepared statement - empty for a plain query
+	std::string name;
+	std::string statement;
+	std::vector<std::string> params;
+	/// executed by ConnectionPool::update() once the query finished
+	Model::Callback callback;
+	/// fulfilled on the worker thread once the query finished
+	std::shared_ptr<std::promise<Model::State> > promise;
+	/// the query is sent again if the connection broke while it was executed - only set this if the
+	/// query has the same effect if it is executed twice
+	bool idempotent = false;
+};
+
+/**
+ * @brief Hands out the connections for the blocking queries and executes the asynchronous queries on
+ * worker threads with their own connections.
+ *
+ * @note The pool is thread safe - the callbacks of the asynchronous queries are executed by @c update().
  */
 class ConnectionPool {
 	friend class Connection;
+	friend class QueryWorker;
 	friend class core::Singleton<ConnectionPool>;
 protected:
 	int _min = -1;
 	int _max = -1;
 	int _connectionAmount = 0;
+	int _acquireTimeoutMillis = 0;
+	uint64_t _idleCheckMillis = 0u;
 	core::VarPtr _dbName;
 	core::VarPtr _dbHost;
 	core::VarPtr _dbUser;
 	core::VarPtr _dbPw;
 
 	std::queue<Connection*> _connections;
+	std::mutex _mutex;
+	std::condition_variable _connectionAvailable;
+
+	std::vector<QueryWorker*> _workers;
+	std::deque<AsyncQuery> _queries;
+	std::mutex _queryMutex;
+	std::condition_variable _queryAvailable;
+	bool _stopWorkers = false;
+
+	struct FinishedQuery {
+		Model::Callback callback;
+		Model::State state;
+	};
+	std::vector<FinishedQuery> _finished;
+	std::mutex _finishedMutex;
 
 	ConnectionPool();
 public:
 	~ConnectionPool();
 
 	int init();
+	/**
+	 * @note The queued asynchronous queries are executed and their callbacks are called before the pool is shut down
+	 */
 	void shutdown();
 
 	/**
-	 * @brief Gets one connection from the pool
+	 * @brief Gets one connection from the pool - if all connections are in use, this waits until one is
+	 * given back. The connection is checked (and reconnected) before it is handed out.
 	 * @note Make sure to call @c Connection::close() to give the connection back to the pool.
-	 * @return @c Connection object
+	 * @param timeoutMillis The milliseconds to wait for a connection - @c -1 to use @c cfg::DatabaseAcquireTimeout
+	 * @return @c Connection object or @c nullptr if no connection could be established in time
+	 */
+	Connection* connection(int timeoutMillis = -1);
+
+	/**
+	 * @brief Queues the query for one of the worker threads
+	 */
+	void execAsync(AsyncQuery&& query);
+
+	/**
+	 * @brief Executes the callbacks of the finished asynchronous queries - call this from the main loop
+	 * @return The amount of executed callbacks
 	 */
-	Connection* connection();
+	int update();
+
+	/**
+	 * @return @c false if execAsync() can't execute the queries - the pool is not initialized or has no workers
+	 */
+	bool hasWorkers();
+
+	/**
+	 * @return The amount of asynchronous queries that were not yet picked up by a worker
+	 */
+	int pendingQueries();
 
 private:
-	Connection* addConnection();
+	Connection* createConnection() const;
+	bool checkConnection(Connection* c) const;
 	void giveBack(Connection* c);
+
+	/**
+	 * @brief Blocks until there is a query to execute
+	 * @return @c false if the workers should stop - the queue is drained before
+	 */
+	bool popQuery(AsyncQuery& query);
+	/**
+	 * @return @c true if shutdown() was called
+	 */
+	bool stopRequested();
+	void finishQuery(AsyncQuery& query, Model::State&& state);
 };
 
 }
@@ -8,6 +8,7 @@
 #include "core/Log.h"
 #include "core/String.h"
 #include <algorithm>
+#include <ctime>
 
 namespace persistence {
 
@@ -35,7 +36,7 @@ Model::PreparedStatement Model::prepare(const std::string& name, const std::stri
 	return PreparedStatement(this, name, statement);
 }
 
-bool Model::checkLastResult(State& state, Connection* connection) const {
+bool Model::checkLastResult(State& state, Connection* connection) {
 	state.affectedRows = 0;
 	if (state.res == nullptr) {
 		Log::debug("Empty result");
@@ -84,6 +85,346 @@ bool Model::exec(const char* query) {
 	return fillModelValues(s);
 }
 
+void Model::execAsync(const std::string& query, const Callback& callback) {
+	Log::debug("async: %s", query.c_str());
+	AsyncQuery asyncQuery;
+	asyncQuery.statement = query;
+	asyncQuery.callback = callback;
+	core::Singleton<ConnectionPool>::getInstance().execAsync(std::move(asyncQuery));
+}
+
+Model::Row Model::row() const {
+	Row row;
+	row.reserve(_fields.size());
+	for (const Field& f : _fields) {
+		const uint8_t* source = _membersPointer + f.offset;
+		switch (f.type) {
+		case FieldType::STRING:
+		case FieldType::PASSWORD:
+			row.push_back(*(const std::string*)source);
+			break;
+		case FieldType::INT:
+			row.push_back(std::to_string(*(const int32_t*)source));
+			break;
+		case FieldType::LONG:
+			row.push_back(std::to_string(*(const int64_t*)source));
+			break;
+		case FieldType::TIMESTAMP: {
+			const Timestamp& timestamp = *(const Timestamp*)source;
+			if (timestamp.isNow()) {
+				row.push_back("now");
+				break;
+			}
+			const time_t seconds = (time_t)timestamp.time();
+			char buf[32];
+			std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", std::gmtime(&seconds));
+			row.push_back(buf);
+			break;
+		}
+		}
+	}
+	return row;
+}
+
+std::vector<int> Model::columns(bool autoincrement) const {
+	std::vector<int> columns;
+	for (size_t i = 0; i < _fields.size(); ++i) {
+		if (autoincrement || !_fields[i].isAutoincrement()) {
+			columns.push_back((int)i);
+		}
+	}
+	return columns;
+}
+
+size_t Model::batchRows(size_t columns) const {
+	// postgres doesn't allow more than 65535 parameters per statement
+	const size_t maxRows = MaxBatchRows;
+	return std::max((size_t)1u, std::min(maxRows, 65535u / std::max((size_t)1u, columns)));
+}
+
+std::string Model::insertStatement(const std::vector<Row>& rows, size_t first, size_t count, bool upsert, std::vector<std::string>& params) const {
+	const std::vector<int>& cols = columns(upsert);
+	std::string statement = "INSERT INTO " + _tableName + " (";
+	for (size_t i = 0; i < cols.size(); ++i) {
+		if (i > 0) {
+			statement += ", ";
+		}
+		statement += "\"" + _fields[cols[i]].name + "\"";
+	}
+	statement += ") VALUES ";
+	params.clear();
+	params.reserve(count * cols.size());
+	const size_t end = std::min(rows.size(), first + count);
+	for (size_t r = first; r < end; ++r) {
+		const Row& row = rows[r];
+		core_assert_msg(row.size() == _fields.size(), "The row doesn't match the fields of %s", _tableName.c_str());
+		statement += r > first ? ", (" : "(";
+		for (size_t i = 0; i < cols.size(); ++i) {
+			if (i > 0) {
+				statement += ", ";
+			}
+			params.push_back(row[cols[i]]);
+			statement += "$" + std::to_string(params.size());
+		}
+		statement += ")";
+	}
+	if (!upsert) {
+		return statement;
+	}
+	std::string conflict;
+	std::string update;
+	for (int i : cols) {
+		const Field& f = _fields[i];
+		const std::string name = "\"" + f.name + "\"";
+		if (f.isPrimaryKey()) {
+			conflict += conflict.empty() ? name : ", " + name;
+		} else {
+			update += update.empty() ? "" : ", ";
+			update += name + " = EXCLUDED." + name;
+		}
+	}
+	core_assert_msg(!conflict.empty(), "Upserts need a primary key in %s", _tableName.c_str());
+	statement += " ON CONFLICT (" + conflict + ") ";
+	if (update.empty()) {
+		statement += "DO NOTHING";
+	} else {
+		statement += "DO UPDATE SET " + update;
+	}
+	// the values of the autoincrement fields are written explicitly - the sequences must be moved past them,
+	// otherwise the next insert() would get one of these values. The sequence is never moved backwards.
+	std::string sequences;
+	std::string returning;
+	for (int i : cols) {
+		const Field& f = _fields[i];
+		if (!f.isAutoincrement()) {
+			continue;
+		}
+		const std::string name = "\"" + f.name + "\"";
+		const std::string sequence = "pg_get_serial_sequence('" + _tableName + "', '" + f.name + "')";
+		returning += returning.empty() ? name : ", " + name;
+		sequences += sequences.empty() ? "" : ", ";
+		sequences += "setval(" + sequence + ", GREATEST(nextval(" + sequence + "), (SELECT MAX(" + name + ") + 1 FROM upserted)), false)";
+	}
+	if (sequences.empty()) {
+		return statement;
+	}
+	return "WITH upserted AS (" + statement + " RETURNING " + returning + ") SELECT " + sequences;
+}
+
+std::string Model::primaryKey(const Row& row) const {
+	std::string key;
+	for (size_t i = 0; i < _fields.size(); ++i) {
+		if (!_fields[i].isPrimaryKey()) {
+			continue;
+		}
+		key += row[i];
+		// unit separator - not part of the values
+		key += '\x1f';
+	}
+	return key;
+}
+
+const std::vector<Model::Row>& Model::upsertableRows(const std::vector<Row>& rows, std::vector<Row>& buffer) const {
+	for (const Row& row : rows) {
+		core_assert_msg(row.size() == _fields.size(), "The row doesn't match the fields of %s", _tableName.c_str());
+		for (size_t i = 0; i < _fields.size(); ++i) {
+			const Field& f = _fields[i];
+			if (f.isPrimaryKey() && f.isAutoincrement() && (row[i].empty() || row[i] == "0")) {
+				Log::error("Could not upsert into %s - the row has no value for %s (use insertRows())", _tableName.c_str(), f.name.c_str());
+				buffer.clear();
+				return buffer;
+			}
+		}
+	}
+	// one statement must not update the same row twice - only the last values of a key are written
+	std::unordered_map<std::string, size_t> index;
+	index.reserve(rows.size());
+	for (size_t i = 0; i < rows.size(); ++i) {
+		index[primaryKey(rows[i])] = i;
+	}
+	if (index.size() == rows.size()) {
+		return rows;
+	}
+	buffer.clear();
+	buffer.reserve(index.size());
+	for (size_t i = 0; i < rows.size(); ++i) {
+		auto iter = index.find(primaryKey(rows[i]));
+		if (iter == index.end()) {
+			continue;
+		}
+		buffer.push_back(rows[iter->second]);
+		index.erase(iter);
+	}
+	return buffer;
+}
+
+bool Model::writeRows(const std::vector<Row>& allRows, bool upsert) const {
+	if (allRows.empty()) {
+		return true;
+	}
+	std::vector<Row> buffer;
+	const std::vector<Row>& rows = upsert ? upsertableRows(allRows, buffer) : allRows;
+	if (rows.empty()) {
+		return false;
+	}
+	ScopedConnection scoped(core::Singleton<ConnectionPool>::getInstance().connection());
+	if (!scoped) {
+		Log::error("Could not write %i rows into %s - could not acquire connection", (int)rows.size(), _tableName.c_str());
+		return false;
+	}
+	ConnectionType* conn = scoped.connection()->connection();
+	const size_t perStatement = batchRows(columns(upsert).size());
+	// the statements are sent over the same connection - so the transaction must not use begin()
+	const bool transaction = rows.size() > perStatement;
+	if (transaction) {
+		State state(PQexec(conn, "START TRANSACTION;"));
+		if (!checkLastResult(state, scoped)) {
+			return false;
+		}
+	}
+	std::vector<std::string> params;
+	std::vector<const char*> paramValues;
+	for (size_t first = 0; first < rows.size(); first += perStatement) {
+		const std::string& statement = insertStatement(rows, first, perStatement, upsert, params);
+		paramValues.resize(params.size());
+		for (size_t i = 0; i < params.size(); ++i) {
+			paramValues[i] = params[i].c_str();
+		}
+		State state(PQexecParams(conn, statement.c_str(), (int)params.size(), nullptr, paramValues.data(), nullptr, nullptr, 0));
+		if (!checkLastResult(state, scoped)) {
+			if (transaction) {
+				State rollback(PQexec(conn, "ROLLBACK;"));
+			}
+			return false;
+		}
+	}
+	if (transaction) {
+		State state(PQexec(conn, "COMMIT;"));
+		return checkLastResult(state, scoped);
+	}
+	return true;
+}
+
+bool Model::insertRows(const std::vector<Row>& rows) const {
+	return writeRows(rows, false);
+}
+
+bool Model::upsertRows(const std::vector<Row>& rows) const {
+	return writeRows(rows, true);
+}
+
+std::vector<std::future<Model::State> > Model::upsertRowsAsync(const std::vector<Row>& allRows) const {
+	std::vector<std::future<State> > futures;
+	std::vector<Row> buffer;
+	const std::vector<Row>& rows = upsertableRows(allRows, buffer);
+	const size_t perStatement = upsertStatementRows();
+	ConnectionPool& pool = core::Singleton<ConnectionPool>::getInstance();
+	for (size_t first = 0; first < rows.size(); first += perStatement) {
+		AsyncQuery query;
+		query.statement = insertStatement(rows, first, perStatement, true, query.params);
+		query.promise = std::make_shared<std::promise<State> >();
+		// the keys and the sequence values are explicit - executing a statement twice doesn't change the result
+		query.idempotent = true;
+		futures.push_back(query.promise->get_future());
+		pool.execAsync(std::move(query));
+	}
+	return futures;
+}
+
+size_t Model::upsertStatementRows() const {
+	return batchRows(columns(true).size());
+}
+
+static void appendCopyValue(std::string& buffer, const std::string& value) {
+	for (const char c : value) {
+		switch (c) {
+		case '\\':
+			buffer += "\\\\";
+			break;
+		case '\t':
+			buffer += "\\t";
+			break;
+		case '\n':
+			buffer += "\\n";
+			break;
+		case '\r':
+			buffer += "\\r";
+			break;
+		default:
+			buffer += c;
+			break;
+		}
+	}
+}
+
+bool Model::copyRows(const std::vector<Row>& rows) const {
+	if (rows.empty()) {
+		return true;
+	}
+	ScopedConnection scoped(core::Singleton<ConnectionPool>::getInstance().connection());
+	if (!scoped) {
+		Log::error("Could not copy %i rows into %s - could not acquire connection", (int)rows.size(), _tableName.c_str());
+		return false;
+	}
+	ConnectionType* conn = scoped.connection()->connection();
+	const std::vector<int>& cols = columns(false);
+	std::string copy = "COPY " + _tableName + " (";
+	for (size_t i = 0; i < cols.size(); ++i) {
+		if (i > 0) {
+			copy += ", ";
+		}
+		copy += "\"" + _fields[cols[i]].name + "\"";
+	}
+	copy += ") FROM STDIN;";
+	{
+		State state(PQexec(conn, copy.c_str()));
+		if (PQresultStatus(state.res) != PGRES_COPY_IN) {
+			checkLastResult(state, scoped);
+			Log::error("Could not start the copy into %s", _tableName.c_str());
+			return false;
+		}
+	}
+
+	// the rows are sent in chunks of this size
+	const size_t chunkSize = 64u * 1024u;
+	std::string buffer;
+	buffer.reserve(chunkSize + 1024u);
+	const char* error = nullptr;
+	for (const Row& row : rows) {
+		core_assert_msg(row.size() == _fields.size(), "The row doesn't match the fields of %s", _tableName.c_str());
+		for (size_t i = 0; i < cols.size(); ++i) {
+			if (i > 0) {
+				buffer += '\t';
+			}
+			appendCopyValue(buffer, row[cols[i]]);
+		}
+		buffer += '\n';
+		if (buffer.size() >= chunkSize) {
+			if (PQputCopyData(conn, buffer.data(), (int)buffer.size()) != 1) {
+				error = "Failed to send the copy data";
+				break;
+			}
+			buffer.clear();
+		}
+	}
+	if (error == nullptr && !buffer.empty() && PQputCopyData(conn, buffer.data(), (int)buffer.size()) != 1) {
+		error = "Failed to send the copy data";
+	}
+	// an error message aborts the copy
+	if (PQputCopyEnd(conn, error) != 1) {
+		Log::error("Could not finish the copy into %s: %s", _tableName.c_str(), PQerrorMessage(conn));
+		return false;
+	}
+	bool result = error == nullptr;
+	while (ResultType* res = PQgetResult(conn)) {
+		State state(res);
+		if (!checkLastResult(state, scoped)) {
+			result = false;
+		}
+	}
+	return result;
+}
+
 Model::Field Model::getField(const std::string& name) const {
 	for (const Field& field : _fields) {
 		if (field.name == name) {
@@ -183,6 +524,32 @@ Model::State Model::PreparedStatement::exec() {
 	return prepState;
 }
 
+std::future<Model::State> Model::PreparedStatement::execAsync() {
+	Log::debug("async prepared statement: '%s'", _statement.c_str());
+	AsyncQuery query;
+	query.name = _name;
+	query.statement = _statement;
+	for (const ParamEntry& param : _params) {
+		query.params.push_back(param.first);
+	}
+	query.promise = std::make_shared<std::promise<State> >();
+	std::future<State> future = query.promise->get_future();
+	core::Singleton<ConnectionPool>::getInstance().execAsync(std::move(query));
+	return future;
+}
+
+void Model::PreparedStatement::execAsync(const Callback& callback) {
+	Log::debug("async prepared statement: '%s'", _statement.c_str());
+	AsyncQuery query;
+	query.name = _name;
+	query.statement = _statement;
+	for (const ParamEntry& param : _params) {
+		query.params.push_back(param.first);
+	}
+	query.callback = callback;
+	core::Singleton<ConnectionPool>::getInstance().execAsync(std::move(query));
+}
+
 Model::State::State(ResultType* _res) :
 		res(_res) {
 }
@@ -9,6 +9,8 @@
 #include <cstddef>
 #include <unordered_map>
 #include <vector>
+#include <functional>
+#include <future>
 #include "core/Common.h"
 #include "Timestamp.h"
 #include "config.h"
@@ -85,13 +87,38 @@ public:
 		// false on error, true on success
 		bool result = false;
 	};
+	/**
+	 * @brief Receives the result of an asynchronous query - see ConnectionPool::update()
+	 */
+	typedef std::function<void(State&)> Callback;
+	/**
+	 * @brief The values of all fields of a model in the order of getFields() - in the text format of the database
+	 */
+	typedef std::vector<std::string> Row;
+	/**
+	 * @brief The max amount of rows of one multi row INSERT statement
+	 */
+	static constexpr size_t MaxBatchRows = 1000u;
 protected:
+	friend class QueryWorker;
 	Fields _fields;
 	const std::string _tableName;
 	uint8_t* _membersPointer;
 
 	Field getField(const std::string& name) const;
-	bool checkLastResult(State& state, Connection* connection) const;
+	static bool checkLastResult(State& state, Connection* connection);
+	/**
+	 * @return The indices of the fields that are written by the batched writes
+	 */
+	std::vector<int> columns(bool autoincrement) const;
+	size_t batchRows(size_t columns) const;
+	bool writeRows(const std::vector<Row>& rows, bool upsert) const;
+	/**
+	 * @brief Removes the rows with duplicated primary keys - the last row of a key wins.
+	 * @return The given rows if there are no duplicates, otherwise @c buffer. An empty list if one of the rows
+	 * has no value for an autoincrement primary key.
+	 */
+	const std::vector<Row>& upsertableRows(const std::vector<Row>& rows, std::vector<Row>& buffer) const;
 	bool fillModelValues(State& state);
 public:
 	Model(const std::string& tableName);
@@ -160,6 +187,16 @@ public:
 		}
 
 		State exec();
+		/**
+		 * @brief Executes the statement on one of the query worker threads of the ConnectionPool
+		 * @note The values of the model are not filled - the result is only available in the state
+		 */
+		std::future<State> execAsync();
+		/**
+		 * @param callback Receives the result on the thread that is calling ConnectionPool::update()
+		 * @note The values of the model are not filled - the result is only available in the state
+		 */
+		void execAsync(const Callback& callback);
 	};
 
 	template<class TYPE>
@@ -174,6 +211,58 @@ public:
 	bool exec(const std::string& query);
 
 	bool exec(const char* query);
+
+	/**
+	 * @return The values of the members of this instance - see insertRows(), upsertRows() and copyRows()
+	 */
+	Row row() const;
+
+	/**
+	 * @brief Inserts the rows with as few multi row INSERT statements as possible - the values of the
+	 * autoincrement fields are left to the database.
+	 * @note The statements are executed in one transaction.
+	 */
+	bool insertRows(const std::vector<Row>& rows) const;
+	/**
+	 * @brief Like insertRows() - but a row that already exists (same primary key) is updated with the
+	 * values of the given row. All fields including the primary keys are written.
+	 * @note The rows need values for the autoincrement primary keys - the sequences are moved past the written
+	 * values. If several rows have the same primary key, only the last one is written.
+	 */
+	bool upsertRows(const std::vector<Row>& rows) const;
+	/**
+	 * @brief Like upsertRows() - but the statements are executed on the query worker threads of the ConnectionPool
+	 * @note The statements might be executed in parallel by several workers - don't upsert the same keys again
+	 * before the futures are ready.
+	 * @return The futures of the queued statements
+	 */
+	std::vector<std::future<State> > upsertRowsAsync(const std::vector<Row>& rows) const;
+	/**
+	 * @return The max amount of rows of one statement of upsertRowsAsync() - the future at index @c n belongs
+	 * to the rows starting at @c n times this value
+	 */
+	size_t upsertStatementRows() const;
+	/**
+	 * @brief Bulk load with @c COPY @c FROM @c STDIN - the fastest way to insert a lot of new rows. There is
+	 * no conflict handling, one duplicated key fails the whole copy.
+	 */
+	bool copyRows(const std::vector<Row>& rows) const;
+	/**
+	 * @brief Builds the multi row INSERT statement for the rows @c [first,first+count)
+	 * @param upsert Adds the @c ON @c CONFLICT clause for the primary keys - see upsertRows()
+	 * @param[out] params The values for the placeholders of the statement
+	 */
+	std::string insertStatement(const std::vector<Row>& rows, size_t first, size_t count, bool upsert, std::vector<std::string>& params) const;
+	/**
+	 * @return The values of the primary key fields of the row as one string - rows with the same key have the same string
+	 */
+	std::string primaryKey(const Row& row) const;
+
+	/**
+	 * @brief Executes the query on one of the query worker threads of the ConnectionPool
+	 * @param callback Optional - receives the result on the thread that is calling ConnectionPool::update()
+	 */
+	void execAsync(const std::string& query, const Callback& callback = Callback());
 };
 
 inline bool Model::exec(const std::string& query) {
@@ -0,0 +1,213 @@
+/**
+ * @file
+ */
+
+#include "QueryWorker.h"
+#include "ConnectionPool.h"
+#include "core/Log.h"
+#include "core/Trace.h"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#ifdef _WIN32
+#include <winsock2.h>
+#define poll WSAPoll
+#else
+#include <poll.h>
+#endif
+
+namespace persistence {
+
+// the worker checks whether the pool is shut down in this interval while it waits for the database
+static constexpr int PollMillis = 100;
+// the time the running query gets to finish after the pool was shut down
+static constexpr int ShutdownGraceMillis = 5000;
+
+QueryWorker::QueryWorker(ConnectionPool* pool, Connection* connection) :
+		_pool(pool), _connection(connection) {
+}
+
+QueryWorker::~QueryWorker() {
+	join();
+	_connection->disconnect();
+	delete _connection;
+}
+
+void QueryWorker::start() {
+	_thread = std::thread(&QueryWorker::run, this);
+}
+
+void QueryWorker::join() {
+	if (_thread.joinable()) {
+		_thread.join();
+	}
+}
+
+void QueryWorker::run() {
+	core_trace_thread("QueryWorker");
+	AsyncQuery query;
+	while (_pool->popQuery(query)) {
+		core_trace_scoped(QueryWorkerExecute);
+		Model::State state = execute(query);
+		_pool->finishQuery(query, std::move(state));
+	}
+	Log::debug("Query worker stopped");
+}
+
+bool QueryWorker::ensureConnection() {
+	if (_connection->isValid()) {
+		return true;
+	}
+	if (!_connection->reconnect()) {
+		return false;
+	}
+	if (PQsetnonblocking(_connection->connection(), 1) != 0) {
+		Log::error("Could not switch the connection into the non-blocking mode: %s", PQerrorMessage(_connection->connection()));
+		_connection->disconnect();
+		return false;
+	}
+	return true;
+}
+
+bool QueryWorker::waitForSocket(bool write) {
+	const int socket = PQsocket(_connection->connection());
+	if (socket < 0) {
+		return false;
+	}
+	struct pollfd fd;
+	fd.fd = socket;
+	fd.events = POLLIN;
+	if (write) {
+		fd.events |= POLLOUT;
+	}
+	std::chrono::steady_clock::time_point stopped;
+	bool stopping = false;
+	for (;;) {
+		fd.revents = 0;
+		const int ready = poll(&fd, 1, PollMillis);
+		if (ready > 0) {
+			return true;
+		}
+		if (ready < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			Log::error("Could not wait for the database connection: %s", strerror(errno));
+			return false;
+		}
+		// a database that doesn't answer must not block the shutdown forever
+		if (!stopping) {
+			stopping = _pool->stopRequested();
+			stopped = std::chrono::steady_clock::now();
+			continue;
+		}
+		if (std::chrono::steady_clock::now() - stopped < std::chrono::milliseconds(ShutdownGraceMillis)) {
+			continue;
+		}
+		Log::warn("Cancel the running query - the connection pool is shut down");
+		char error[256];
+		PGcancel* cancel = PQgetCancel(_connection->connection());
+		if (cancel != nullptr) {
+			PQcancel(cancel, error, sizeof(error));
+			PQfreeCancel(cancel);
+		}
+		_connection->disconnect();
+		return false;
+	}
+}
+
+ResultType* QueryWorker::waitForResult() {
+	ConnectionType* conn = _connection->connection();
+	// the outgoing data might not fit into the socket buffer - the server might want to send
+	// data before it reads more, so the input must be consumed while waiting
+	for (;;) {
+		const int pending = PQflush(conn);
+		if (pending == 0) {
+			break;
+		}
+		if (pending < 0 || !waitForSocket(true) || !PQconsumeInput(conn)) {
+			return nullptr;
+		}
+	}
+	ResultType* last = nullptr;
+	for (;;) {
+		while (PQisBusy(conn)) {
+			if (!waitForSocket(false) || !PQconsumeInput(conn)) {
+				if (last != nullptr) {
+					PQclear(last);
+				}
+				return nullptr;
+			}
+		}
+		ResultType* res = PQgetResult(conn);
+		if (res == nullptr) {
+			break;
+		}
+		if (last != nullptr) {
+			PQclear(last);
+		}
+		last = res;
+	}
+	return last;
+}
+
+Model::State QueryWorker::execute(const AsyncQuery& query) {
+	// a broken connection is reconnected and the query is sent once more - but only if the query didn't reach
+	// the server yet or if it doesn't matter if it is executed twice
+	for (int attempt = 0; attempt < 2; ++attempt) {
+		if (!ensureConnection()) {
+			Model::State state(nullptr);
+			state.lastErrorMsg = "Could not connect to the database";
+			return state;
+		}
+		ConnectionType* conn = _connection->connection();
+		const bool prepared = !query.name.empty();
+		if (prepared && !_connection->hasPreparedStatement(query.name)) {
+			// preparing is bound to the connection - it can always be repeated
+			if (!PQsendPrepare(conn, query.name.c_str(), query.statement.c_str(), (int)query.params.size(), nullptr)) {
+				continue;
+			}
+			Model::State state(waitForResult());
+			if (!Model::checkLastResult(state, _connection)) {
+				if (_connection->isValid()) {
+					return state;
+				}
+				continue;
+			}
+			_connection->registerPreparedStatement(query.name);
+		}
+
+		const int size = (int)query.params.size();
+		std::vector<const char*> paramValues(size);
+		for (int i = 0; i < size; ++i) {
+			paramValues[i] = query.params[i].c_str();
+		}
+		int sent;
+		if (prepared) {
+			sent = PQsendQueryPrepared(conn, query.name.c_str(), size, paramValues.data(), nullptr, nullptr, 0);
+		} else {
+			sent = PQsendQueryParams(conn, query.statement.c_str(), size, nullptr, paramValues.data(), nullptr, nullptr, 0);
+		}
+		if (!sent) {
+			continue;
+		}
+		Model::State state(waitForResult());
+		if (Model::checkLastResult(state, _connection) || _connection->isValid()) {
+			return state;
+		}
+		// the connection broke after the query was sent - it might have been committed already
+		if (!query.idempotent) {
+			if (state.lastErrorMsg.empty()) {
+				state.lastErrorMsg = "The connection broke while the query was executed";
+			}
+			Log::error("Could not execute the query '%s': %s", query.statement.c_str(), state.lastErrorMsg.c_str());
+			return state;
+		}
+	}
+	Model::State state(nullptr);
+	state.lastErrorMsg = PQerrorMessage(_connection->connection());
+	Log::error("Could not execute the query '%s': %s", query.statement.c_str(), state.lastErrorMsg.c_str());
+	return state;
+}
+
+}
@@ -0,0 +1,56 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "Connection.h"
+#include "Model.h"
+#include <thread>
+
+namespace persistence {
+
+class ConnectionPool;
+struct AsyncQuery;
+
+/**
+ * @brief Thread with a dedicated connection that executes the asynchronous queries of the ConnectionPool.
+ *
+ * The connection is put into the libpq non-blocking mode - the worker sends the query and waits on the
+ * socket of the connection until the result arrived.
+ */
+class QueryWorker {
+private:
+	ConnectionPool* _pool;
+	Connection* _connection;
+	std::thread _thread;
+
+	void run();
+	bool ensureConnection();
+	Model::State execute(const AsyncQuery& query);
+	/**
+	 * @brief Flushes the sent query and collects the results.
+	 * @return The last result of the query or @c nullptr if the connection broke
+	 */
+	ResultType* waitForResult();
+	/**
+	 * @brief Waits until the socket of the connection is readable (or writable)
+	 * @return @c false on errors - or if the pool was shut down and the database didn't answer in time. The
+	 * running query is cancelled and the connection is closed then.
+	 */
+	bool waitForSocket(bool write);
+public:
+	/**
+	 * @note Takes the ownership of the connection
+	 */
+	QueryWorker(ConnectionPool* pool, Connection* connection);
+	~QueryWorker();
+
+	void start();
+	/**
+	 * @brief Waits until the thread ended - the pool must have stopped the workers before.
+	 */
+	void join();
+};
+
+}
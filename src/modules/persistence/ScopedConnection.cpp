@@ -3,7 +3,9 @@
 namespace persistence {
 
 ScopedConnection::~ScopedConnection() {
-	_c->close();
+	if (_c != nullptr) {
+		_c->close();
+	}
 }
 
 }
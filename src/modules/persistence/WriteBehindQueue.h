@@ -0,0 +1,201 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "Model.h"
+#include "ConnectionPool.h"
+#include "core/Common.h"
+#include "core/Log.h"
+#include "core/Singleton.h"
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace persistence {
+
+/**
+ * @brief Collects the writes of a model and upserts them all at once after a flush window.
+ *
+ * Repeated writes of the same primary key within the window are coalesced - only the last values are written.
+ * The rows are written with the multi row upserts of the query worker threads, so neither the write nor the
+ * flush are waiting for the database. A flush is only started once the statements of the previous flush are
+ * committed - the workers might execute statements in parallel, and the older values of a key must never
+ * overwrite the newer ones. Until then the writes are collected (and coalesced) further. The rows of a failed
+ * statement are queued again - unless they were written again in the meantime.
+ *
+ * @note The model must have a primary key - and values for its autoincrement primary keys. Not thread safe - use it
+ * from the main loop. Destroy the queue before the ConnectionPool is shut down - the remaining rows are written
+ * in the destructor.
+ */
+template<class MODEL>
+class WriteBehindQueue {
+private:
+	MODEL _model;
+	const uint64_t _flushMillis;
+	uint64_t _firstWrite = 0u;
+	uint64_t _now = 0u;
+	std::vector<Model::Row> _rows;
+	// maps the primary key values to the index in _rows
+	std::unordered_map<std::string, size_t> _index;
+	size_t _coalesced = 0u;
+	// the statements of the last flush that are not yet executed
+	std::vector<std::future<Model::State> > _inFlight;
+	// the rows of the last flush - see Model::upsertStatementRows() for the rows of a future
+	std::vector<Model::Row> _flushed;
+
+	bool inFlight() {
+		for (std::future<Model::State>& f : _inFlight) {
+			if (f.wait_for(std::chrono::milliseconds(0)) != std::future_status::ready) {
+				return true;
+			}
+		}
+		finishFlush();
+		return false;
+	}
+
+	/**
+	 * @brief Collects the results of the last flush and queues the rows of the failed statements again
+	 * @note Blocks until all statements are executed
+	 * @return @c false if one of the statements failed
+	 */
+	bool finishFlush() {
+		bool success = true;
+		const size_t perStatement = _model.upsertStatementRows();
+		for (size_t n = 0; n < _inFlight.size(); ++n) {
+			const Model::State& state = _inFlight[n].get();
+			if (state.result) {
+				continue;
+			}
+			success = false;
+			const size_t first = n * perStatement;
+			const size_t end = std::min(_flushed.size(), first + perStatement);
+			Log::error("Could not write %i rows into %s: %s", (int)(end - first), _model.getTableName().c_str(),
+					state.lastErrorMsg.c_str());
+			for (size_t r = first; r < end; ++r) {
+				requeue(std::move(_flushed[r]));
+			}
+		}
+		_inFlight.clear();
+		_flushed.clear();
+		return success;
+	}
+
+	/**
+	 * @brief Queues a row of a failed flush again - a newer write of the same key wins
+	 */
+	void requeue(Model::Row&& row) {
+		const std::string& k = _model.primaryKey(row);
+		if (_index.find(k) != _index.end()) {
+			return;
+		}
+		if (_rows.empty()) {
+			_firstWrite = _now;
+		}
+		_index.insert(std::make_pair(k, _rows.size()));
+		_rows.push_back(std::move(row));
+	}
+public:
+	/**
+	 * @param flushMillis The milliseconds the writes are collected before they are flushed by update()
+	 */
+	explicit WriteBehindQueue(uint64_t flushMillis) :
+			_flushMillis(flushMillis) {
+		const Model::Fields& fields = _model.getFields();
+		core_assert_msg(std::any_of(fields.begin(), fields.end(), [] (const Model::Field& f) { return f.isPrimaryKey(); }),
+				"The write behind queue needs a primary key in %s", _model.getTableName().c_str());
+	}
+
+	~WriteBehindQueue() {
+		wait();
+		if (!_rows.empty()) {
+			_model.upsertRows(_rows);
+		}
+	}
+
+	/**
+	 * @param now The current time in milliseconds
+	 */
+	void write(const MODEL& model, uint64_t now) {
+		write(model.row(), now);
+	}
+
+	void write(Model::Row&& row, uint64_t now) {
+		_now = now;
+		if (_rows.empty()) {
+			_firstWrite = now;
+		}
+		const std::string& k = _model.primaryKey(row);
+		auto i = _index.find(k);
+		if (i != _index.end()) {
+			_rows[i->second] = std::move(row);
+			++_coalesced;
+			return;
+		}
+		_index.insert(std::make_pair(k, _rows.size()));
+		_rows.push_back(std::move(row));
+	}
+
+	/**
+	 * @brief Flushes the rows if the oldest write is older than the flush window
+	 * @return @c true if the rows were flushed
+	 */
+	bool update(uint64_t now) {
+		_now = now;
+		if (_rows.empty() || now - _firstWrite < _flushMillis) {
+			return false;
+		}
+		return flush();
+	}
+
+	/**
+	 * @brief Queues the upserts of all collected rows for the query workers - if the ConnectionPool has no
+	 * workers, the rows are written synchronously.
+	 * @return @c false if nothing was flushed because the previous flush is still executed
+	 */
+	bool flush() {
+		if (_rows.empty()) {
+			return true;
+		}
+		if (inFlight()) {
+			return false;
+		}
+		if (core::Singleton<ConnectionPool>::getInstance().hasWorkers()) {
+			_inFlight = _model.upsertRowsAsync(_rows);
+			_flushed = std::move(_rows);
+		} else {
+			_model.upsertRows(_rows);
+		}
+		_rows.clear();
+		_index.clear();
+		return true;
+	}
+
+	/**
+	 * @brief Blocks until the statements of the last flush are executed
+	 * @return @c false if one of the statements failed - its rows are queued again
+	 */
+	bool wait() {
+		return finishFlush();
+	}
+
+	/**
+	 * @return The amount of rows that are waiting for the flush
+	 */
+	inline size_t size() const {
+		return _rows.size();
+	}
+
+	/**
+	 * @return The amount of writes that replaced the values of a row that was already waiting for the flush
+	 */
+	inline size_t coalesced() const {
+		return _coalesced;
+	}
+};
+
+}
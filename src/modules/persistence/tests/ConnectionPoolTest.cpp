@@ -4,6 +4,8 @@
 
 #include "core/tests/AbstractTest.h"
 #include "persistence/ConnectionPool.h"
+#include <thread>
+#include <chrono>
 
 namespace persistence {
 
@@ -17,6 +19,13 @@ public:
 		core::Var::get(cfg::DatabaseHost, "localhost");
 		core::Var::get(cfg::DatabaseUser, "engine");
 		core::Var::get(cfg::DatabasePassword, "engine");
+		core::Var::get(cfg::DatabaseWorkers, "1");
+	}
+
+	void TearDown() override {
+		// a failed assertion would leave the workers running
+		core::Singleton<ConnectionPool>::getInstance().shutdown();
+		core::AbstractTest::TearDown();
 	}
 };
 
@@ -34,4 +43,89 @@ TEST_F(ConnectionPoolTest, testConnectionPoolGetConnection) {
 	pool.shutdown();
 }
 
+TEST_F(ConnectionPoolTest, testConnectionPoolAcquireTimeout) {
+	ConnectionPool& pool = core::Singleton<ConnectionPool>::getInstance();
+	ASSERT_EQ(1, pool.init());
+	Connection* c1 = pool.connection();
+	ASSERT_NE(nullptr, c1);
+	Connection* c2 = pool.connection();
+	ASSERT_NE(nullptr, c2);
+	EXPECT_EQ(nullptr, pool.connection(10)) << "The max connections are in use";
+	c2->close();
+	Connection* c3 = pool.connection(10);
+	EXPECT_EQ(c2, c3) << "Expected to get the connection that was given back";
+	c1->close();
+	c3->close();
+	pool.shutdown();
+}
+
+TEST_F(ConnectionPoolTest, testConnectionPoolWaitForConnection) {
+	ConnectionPool& pool = core::Singleton<ConnectionPool>::getInstance();
+	ASSERT_EQ(1, pool.init());
+	Connection* c1 = pool.connection();
+	ASSERT_NE(nullptr, c1);
+	Connection* c2 = pool.connection();
+	ASSERT_NE(nullptr, c2);
+	std::thread thread([c2] () {
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		c2->close();
+	});
+	Connection* c3 = pool.connection(5000);
+	thread.join();
+	EXPECT_EQ(c2, c3) << "Expected to wait for the connection of the other thread";
+	c1->close();
+	if (c3 != nullptr) {
+		c3->close();
+	}
+	pool.shutdown();
+}
+
+TEST_F(ConnectionPoolTest, testExecAsyncFuture) {
+	ConnectionPool& pool = core::Singleton<ConnectionPool>::getInstance();
+	ASSERT_EQ(1, pool.init());
+	Model model("dummy");
+	std::future<Model::State> future = model.prepare("asyncfuture", "SELECT $1::int AS value;").add(42, Model::FieldType::INT).execAsync();
+	Model::State state = future.get();
+	ASSERT_TRUE(state.result) << state.lastErrorMsg;
+	ASSERT_EQ(1, state.affectedRows);
+	EXPECT_STREQ("42", PQgetvalue(state.res, 0, 0));
+	pool.shutdown();
+}
+
+TEST_F(ConnectionPoolTest, testExecAsyncCallback) {
+	ConnectionPool& pool = core::Singleton<ConnectionPool>::getInstance();
+	ASSERT_EQ(1, pool.init());
+	Model model("dummy");
+	int executed = 0;
+	bool result = false;
+	for (int i = 0; i < 10; ++i) {
+		model.prepare("asynccallback", "SELECT $1::int AS value;").add(i, Model::FieldType::INT).execAsync([&] (Model::State& state) {
+			++executed;
+			result = state.result;
+		});
+	}
+	EXPECT_EQ(0, executed) << "The callbacks must only be executed by the update";
+	for (int i = 0; i < 500 && executed < 10; ++i) {
+		pool.update();
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	EXPECT_EQ(10, executed);
+	EXPECT_TRUE(result);
+	pool.shutdown();
+}
+
+TEST_F(ConnectionPoolTest, testShutdownExecutesQueuedQueries) {
+	ConnectionPool& pool = core::Singleton<ConnectionPool>::getInstance();
+	ASSERT_EQ(1, pool.init());
+	Model model("dummy");
+	int executed = 0;
+	for (int i = 0; i < 10; ++i) {
+		model.execAsync("SELECT 1;", [&] (Model::State& state) {
+			++executed;
+		});
+	}
+	pool.shutdown();
+	EXPECT_EQ(10, executed);
+}
+
 }
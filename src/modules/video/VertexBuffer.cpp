@@ -130,6 +130,25 @@ bool VertexBuffer::update(int32_t idx, const void* data, size_t size) {
 	return true;
 }
 
+bool VertexBuffer::update(int32_t idx, size_t offset, const void* data, size_t size) {
+	if (!isValid(idx)) {
+		return false;
+	}
+	if (offset + size > _size[idx]) {
+		Log::error("Range %i:%i exceeds the buffer size %i", (int)offset, (int)size, (int)_size[idx]);
+		return false;
+	}
+
+	core_assert(video::boundVertexArray() == InvalidId);
+	const VertexBufferType type = _targets[idx];
+	const Id id = _handles[idx];
+	video::bindBuffer(type, id);
+	video::bufferSubData(type, offset, data, size);
+	video::unbindBuffer(type);
+
+	return true;
+}
+
 int32_t VertexBuffer::create(const void* data, size_t size, VertexBufferType target) {
 	// we already have a buffer
 	if (_handleIdx >= (int)SDL_arraysize(_handles)) {
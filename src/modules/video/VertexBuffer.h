@@ -72,6 +72,11 @@ public:
 	void unmapData(int32_t idx) const;
 
 	bool update(int32_t idx, const void* data, size_t size);
+	/**
+	 * @brief Updates a part of an already allocated buffer
+	 * @note The range [offset, offset + size) must be inside the current buffer size
+	 */
+	bool update(int32_t idx, size_t offset, const void* data, size_t size);
 
 	/**
 	 * @return -1 on error - otherwise the index [0,n) of the created buffer (not the Id)
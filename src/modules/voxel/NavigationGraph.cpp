@@ -0,0 +1,660 @@
+/**
+ * @file
+ */
+
+#include "NavigationGraph.h"
+#include "voxel/polyvox/AStarPathfinder.h"
+#include "core/Common.h"
+#include "core/Trace.h"
+#include <algorithm>
+#include <limits>
+#include <queue>
+#include <unordered_set>
+
+namespace voxel {
+
+namespace {
+
+/**
+ * @brief The volume type of the local searches - the walkable positions inside of a box
+ */
+struct WalkableBounds {
+	const NavigationGraph::WalkableFunc* walkable;
+	glm::ivec3 mins;
+	glm::ivec3 maxs;
+};
+
+bool isWalkableInBounds(const WalkableBounds* bounds, const glm::ivec3& pos) {
+	if (glm::any(glm::lessThan(pos, bounds->mins)) || glm::any(glm::greaterThan(pos, bounds->maxs))) {
+		return false;
+	}
+	return (*bounds->walkable)(pos);
+}
+
+inline int floorDiv(int a, int b) {
+	return a >= 0 ? a / b : (a - b + 1) / b;
+}
+
+inline float pathCosts(const std::vector<glm::ivec3>& path) {
+	float costs = 0.0f;
+	for (size_t i = 1; i < path.size(); ++i) {
+		costs += glm::length(glm::vec3(path[i] - path[i - 1]));
+	}
+	return costs;
+}
+
+}
+
+NavigationGraph::NavigationGraph(const WalkableFunc& walkable, int clusterSize, int minY, int maxY) :
+		_walkable(walkable), _clusterSize(clusterSize), _minY(minY), _maxY(maxY) {
+	core_assert(clusterSize > 1);
+	core_assert(minY <= maxY);
+}
+
+glm::ivec2 NavigationGraph::clusterPos(const glm::ivec3& pos) const {
+	return glm::ivec2(floorDiv(pos.x, _clusterSize), floorDiv(pos.z, _clusterSize));
+}
+
+glm::ivec3 NavigationGraph::clusterMins(const glm::ivec2& cluster) const {
+	return glm::ivec3(cluster.x * _clusterSize, _minY, cluster.y * _clusterSize);
+}
+
+glm::ivec3 NavigationGraph::clusterMaxs(const glm::ivec2& cluster) const {
+	return glm::ivec3(cluster.x * _clusterSize + _clusterSize - 1, _maxY, cluster.y * _clusterSize + _clusterSize - 1);
+}
+
+bool NavigationGraph::snap(glm::ivec3& pos) const {
+	static const int offsets[] = { 0, 1, -1, 2, -2 };
+	for (int offset : offsets) {
+		const glm::ivec3 p(pos.x, pos.y + offset, pos.z);
+		if (p.y < _minY || p.y > _maxY) {
+			continue;
+		}
+		if (_walkable(p)) {
+			pos = p;
+			return true;
+		}
+	}
+	return false;
+}
+
+float NavigationGraph::localPath(const glm::ivec3& start, const glm::ivec3& end, const glm::ivec3& mins, const glm::ivec3& maxs,
+		std::vector<glm::ivec3>* result, const std::atomic_bool* cancelled) const {
+	WalkableBounds bounds { &_walkable, mins, maxs };
+	std::vector<glm::ivec3> path;
+	std::vector<glm::ivec3>* out = result != nullptr ? result : &path;
+	const glm::ivec3 size = maxs - mins + 1;
+	const uint32_t maxNodes = (uint32_t)(size.x * size.z * 4);
+	AStarPathfinderParams<WalkableBounds> params(&bounds, start, end, out, 1.0f, maxNodes, TwentySixConnected, &isWalkableInBounds);
+	params.cancelled = cancelled;
+	AStarPathfinder<WalkableBounds> pathfinder(params);
+	if (!pathfinder.execute()) {
+		return -1.0f;
+	}
+	return pathCosts(*out);
+}
+
+int32_t NavigationGraph::addNode(const glm::ivec3& pos) {
+	int32_t index;
+	if (_freeNodes.empty()) {
+		index = (int32_t)_nodes.size();
+		_nodes.emplace_back();
+	} else {
+		index = _freeNodes.back();
+		_freeNodes.pop_back();
+	}
+	AbstractNode& node = _nodes[index];
+	node.position = pos;
+	node.cluster = clusterPos(pos);
+	node.edges.clear();
+	node.alive = true;
+	_clusters[node.cluster].nodes.push_back(index);
+	++_aliveNodes;
+	return index;
+}
+
+void NavigationGraph::removeNode(int32_t index) {
+	AbstractNode& node = _nodes[index];
+	core_assert(node.alive);
+	// the edges are symmetric - only the neighbours know this node
+	for (const Edge& edge : node.edges) {
+		std::vector<Edge>& edges = _nodes[edge.node].edges;
+		edges.erase(std::remove_if(edges.begin(), edges.end(), [index] (const Edge& e) {
+			return e.node == index;
+		}), edges.end());
+	}
+	node.edges.clear();
+	node.alive = false;
+	std::vector<int32_t>& clusterNodes = _clusters[node.cluster].nodes;
+	clusterNodes.erase(std::remove(clusterNodes.begin(), clusterNodes.end(), index), clusterNodes.end());
+	_freeNodes.push_back(index);
+	--_aliveNodes;
+}
+
+std::vector<NavigationGraph::Transition> NavigationGraph::scanBorder(const glm::ivec3& border) const {
+	// contiguous transitions over the border form one entrance
+	struct Entrance {
+		int lastT;
+		std::vector<Transition> transitions;
+	};
+	std::vector<Entrance> entrances;
+
+	const bool xAxis = border.z == 0;
+	const glm::ivec3 lowerMins = clusterMins(glm::ivec2(border.x, border.y));
+	const glm::ivec3 step = xAxis ? glm::ivec3(1, 0, 0) : glm::ivec3(0, 0, 1);
+	for (int t = 0; t < _clusterSize; ++t) {
+		glm::ivec3 column;
+		if (xAxis) {
+			column = glm::ivec3(lowerMins.x + _clusterSize - 1, 0, lowerMins.z + t);
+		} else {
+			column = glm::ivec3(lowerMins.x + t, 0, lowerMins.z + _clusterSize - 1);
+		}
+		for (int y = _minY; y <= _maxY; ++y) {
+			const glm::ivec3 from(column.x, y, column.z);
+			if (!_walkable(from)) {
+				continue;
+			}
+			static const int deltas[] = { 0, -1, 1 };
+			for (int dy : deltas) {
+				const glm::ivec3 to = from + step + glm::ivec3(0, dy, 0);
+				if (to.y < _minY || to.y > _maxY || !_walkable(to)) {
+					continue;
+				}
+				Entrance* entrance = nullptr;
+				for (Entrance& e : entrances) {
+					if (e.lastT == t - 1 && std::abs(e.transitions.back().from.y - y) <= 1) {
+						entrance = &e;
+						break;
+					}
+				}
+				if (entrance == nullptr) {
+					entrances.emplace_back();
+					entrance = &entrances.back();
+				}
+				entrance->lastT = t;
+				entrance->transitions.push_back(Transition { from, to });
+				break;
+			}
+		}
+	}
+
+	std::vector<Transition> transitions;
+	transitions.reserve(entrances.size());
+	for (const Entrance& entrance : entrances) {
+		transitions.push_back(entrance.transitions[entrance.transitions.size() / 2]);
+	}
+	return transitions;
+}
+
+void NavigationGraph::setBorder(const glm::ivec3& border, const std::vector<Transition>& transitions) {
+	std::vector<int32_t>& borderNodes = _borders[border];
+	for (int32_t node : borderNodes) {
+		removeNode(node);
+	}
+	borderNodes.clear();
+	for (const Transition& transition : transitions) {
+		const int32_t from = addNode(transition.from);
+		const int32_t to = addNode(transition.to);
+		const float cost = glm::length(glm::vec3(transition.to - transition.from));
+		_nodes[from].edges.push_back(Edge { to, cost });
+		_nodes[to].edges.push_back(Edge { from, cost });
+		borderNodes.push_back(from);
+		borderNodes.push_back(to);
+	}
+}
+
+std::vector<NavigationGraph::NodeRef> NavigationGraph::clusterNodes(const glm::ivec2& cluster) const {
+	std::vector<NodeRef> refs;
+	auto i = _clusters.find(cluster);
+	if (i == _clusters.end()) {
+		return refs;
+	}
+	refs.reserve(i->second.nodes.size());
+	for (int32_t node : i->second.nodes) {
+		refs.push_back(NodeRef { node, _nodes[node].position });
+	}
+	return refs;
+}
+
+bool NavigationGraph::isValid(const NodeRef& ref) const {
+	if (ref.node < 0 || ref.node >= (int32_t)_nodes.size()) {
+		return false;
+	}
+	const AbstractNode& node = _nodes[ref.node];
+	return node.alive && node.position == ref.position;
+}
+
+void NavigationGraph::buildClusters(const std::vector<glm::ivec2>& clusters) {
+	core_trace_scoped(NavigationGraphBuild);
+	static const glm::ivec2 neighbours[] = { glm::ivec2(1, 0), glm::ivec2(-1, 0), glm::ivec2(0, 1), glm::ivec2(0, -1) };
+	auto borderKey = [] (const glm::ivec2& pos, const glm::ivec2& dir) {
+		if (dir.x > 0) {
+			return glm::ivec3(pos.x, pos.y, 0);
+		}
+		if (dir.x < 0) {
+			return glm::ivec3(pos.x - 1, pos.y, 0);
+		}
+		if (dir.y > 0) {
+			return glm::ivec3(pos.x, pos.y, 1);
+		}
+		return glm::ivec3(pos.x, pos.y - 1, 1);
+	};
+
+	// the lock is only held to read and modify the graph - the voxel scans and searches are done without it,
+	// so the invalidations and the other searches are not blocked by a build
+	std::vector<std::pair<glm::ivec2, uint32_t> > build;
+	std::unordered_set<glm::ivec3, std::hash<glm::ivec3> > borders;
+	std::unordered_set<glm::ivec2, std::hash<glm::ivec2> > building;
+	std::unordered_set<glm::ivec2, std::hash<glm::ivec2> > connect;
+	uint32_t generation;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		generation = _generation;
+		for (const glm::ivec2& pos : clusters) {
+			Cluster& cluster = _clusters[pos];
+			if (cluster.built && !cluster.dirty) {
+				// another search was faster
+				continue;
+			}
+			if (!building.insert(pos).second) {
+				continue;
+			}
+			build.emplace_back(pos, cluster.version);
+			connect.insert(pos);
+			// the borders of a dirty cluster are scanned again - a new cluster only scans the borders that are unknown
+			for (const glm::ivec2& dir : neighbours) {
+				const glm::ivec3 border = borderKey(pos, dir);
+				if (!cluster.dirty && _borders.find(border) != _borders.end()) {
+					continue;
+				}
+				borders.insert(border);
+				// the built neighbours get new border nodes - a dirty neighbour might only be rebuilt by the next search
+				auto i = _clusters.find(pos + dir);
+				if (i != _clusters.end() && i->second.built) {
+					connect.insert(pos + dir);
+				}
+			}
+		}
+	}
+	if (build.empty()) {
+		return;
+	}
+
+	std::vector<std::pair<glm::ivec3, std::vector<Transition> > > scanned;
+	scanned.reserve(borders.size());
+	for (const glm::ivec3& border : borders) {
+		scanned.emplace_back(border, scanBorder(border));
+	}
+
+	std::vector<std::pair<glm::ivec2, std::vector<NodeRef> > > snapshots;
+	snapshots.reserve(connect.size());
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (generation != _generation) {
+			return;
+		}
+		for (const auto& border : scanned) {
+			setBorder(border.first, border.second);
+		}
+		for (const glm::ivec2& pos : connect) {
+			snapshots.emplace_back(pos, clusterNodes(pos));
+		}
+	}
+
+	// the costs of the paths between the nodes of a cluster
+	struct ClusterEdge {
+		size_t from;
+		size_t to;
+		float cost;
+	};
+	std::vector<std::vector<ClusterEdge> > clusterEdges(snapshots.size());
+	for (size_t c = 0; c < snapshots.size(); ++c) {
+		const glm::ivec3 mins = clusterMins(snapshots[c].first);
+		const glm::ivec3 maxs = clusterMaxs(snapshots[c].first);
+		const std::vector<NodeRef>& nodes = snapshots[c].second;
+		for (size_t i = 0; i < nodes.size(); ++i) {
+			for (size_t j = i + 1; j < nodes.size(); ++j) {
+				const float cost = localPath(nodes[i].position, nodes[j].position, mins, maxs, nullptr, nullptr);
+				if (cost >= 0.0f) {
+					clusterEdges[c].push_back(ClusterEdge { i, j, cost });
+				}
+			}
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (generation != _generation) {
+		return;
+	}
+	for (size_t c = 0; c < snapshots.size(); ++c) {
+		const glm::ivec2& pos = snapshots[c].first;
+		const std::vector<NodeRef>& snapshot = snapshots[c].second;
+		const std::vector<int32_t>& nodes = _clusters[pos].nodes;
+		// if the nodes were changed meanwhile, the search that changed them connects the cluster
+		bool unchanged = nodes.size() == snapshot.size();
+		for (size_t i = 0; unchanged && i < snapshot.size(); ++i) {
+			unchanged = nodes[i] == snapshot[i].node && isValid(snapshot[i]);
+		}
+		if (!unchanged) {
+			continue;
+		}
+		for (int32_t index : nodes) {
+			std::vector<Edge>& edges = _nodes[index].edges;
+			edges.erase(std::remove_if(edges.begin(), edges.end(), [&] (const Edge& e) {
+				return _nodes[e.node].cluster == pos;
+			}), edges.end());
+		}
+		for (const ClusterEdge& edge : clusterEdges[c]) {
+			const int32_t from = snapshot[edge.from].node;
+			const int32_t to = snapshot[edge.to].node;
+			_nodes[from].edges.push_back(Edge { to, edge.cost });
+			_nodes[to].edges.push_back(Edge { from, edge.cost });
+		}
+	}
+	for (const auto& entry : build) {
+		Cluster& cluster = _clusters[entry.first];
+		cluster.built = true;
+		++_builtClusters;
+		if (cluster.version == entry.second) {
+			cluster.dirty = false;
+		} else {
+			// the cluster was modified while it was built
+			cluster.dirty = true;
+			_dirtyClusters.push_back(entry.first);
+		}
+	}
+	// a dirty neighbour only got new border nodes - its other borders are scanned by its own build
+	for (const glm::ivec2& pos : connect) {
+		if (building.find(pos) != building.end()) {
+			continue;
+		}
+		auto i = _clusters.find(pos);
+		if (i != _clusters.end() && i->second.dirty) {
+			_dirtyClusters.push_back(pos);
+		}
+	}
+}
+
+void NavigationGraph::takeDirtyClusters(std::vector<glm::ivec2>& clusters) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	for (const glm::ivec2& pos : _dirtyClusters) {
+		if (_clusters[pos].dirty) {
+			clusters.push_back(pos);
+		}
+	}
+	_dirtyClusters.clear();
+}
+
+std::vector<NavigationGraph::Edge> NavigationGraph::endpointEdges(const glm::ivec3& pos, const std::vector<NodeRef>& nodes,
+		bool toNodes, const std::atomic_bool* cancelled) const {
+	const glm::ivec2 cluster = clusterPos(pos);
+	const glm::ivec3 mins = clusterMins(cluster);
+	const glm::ivec3 maxs = clusterMaxs(cluster);
+	std::vector<Edge> edges;
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		const float cost = toNodes ? localPath(pos, nodes[i].position, mins, maxs, nullptr, cancelled)
+				: localPath(nodes[i].position, pos, mins, maxs, nullptr, cancelled);
+		if (cost >= 0.0f) {
+			// the index into the given nodes
+			edges.push_back(Edge { (int32_t)i, cost });
+		}
+	}
+	return edges;
+}
+
+bool NavigationGraph::findAbstractPath(const glm::ivec3& start, const glm::ivec3& end, std::vector<glm::ivec3>& waypoints, const std::atomic_bool* cancelled) {
+	const glm::ivec2 startCluster = clusterPos(start);
+	const glm::ivec2 endCluster = clusterPos(end);
+	// the search doesn't leave this area - otherwise a search without a path would build the whole world
+	const glm::ivec2 distance = glm::abs(endCluster - startCluster);
+	const int margin = std::max(SearchMargin, std::max(distance.x, distance.y));
+	const glm::ivec2 areaMins = glm::min(startCluster, endCluster) - margin;
+	const glm::ivec2 areaMaxs = glm::max(startCluster, endCluster) + margin;
+
+	float directCost = -1.0f;
+	if (startCluster == endCluster) {
+		directCost = localPath(start, end, clusterMins(startCluster), clusterMaxs(startCluster), nullptr, cancelled);
+	}
+
+	std::vector<NodeRef> startNodes;
+	std::vector<NodeRef> endNodes;
+	std::vector<Edge> startEdges;
+	std::vector<Edge> endEdges;
+	std::vector<glm::ivec2> build { startCluster, endCluster };
+	// the clusters are built without holding the lock - if the search reaches a cluster that isn't built yet,
+	// it is aborted, the cluster is built and the search is started again
+	for (;;) {
+		if (cancelled != nullptr && *cancelled) {
+			return false;
+		}
+		takeDirtyClusters(build);
+		if (!build.empty()) {
+			buildClusters(build);
+			build.clear();
+		}
+
+		std::vector<NodeRef> nodes;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			nodes = clusterNodes(startCluster);
+		}
+		if (nodes != startNodes) {
+			startNodes = std::move(nodes);
+			startEdges = endpointEdges(start, startNodes, true, cancelled);
+		}
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			nodes = clusterNodes(endCluster);
+		}
+		if (nodes != endNodes) {
+			endNodes = std::move(nodes);
+			endEdges = endpointEdges(end, endNodes, false, cancelled);
+		}
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		// the search ids are the node indices shifted by the temporary start and end nodes
+		const int32_t startId = 0;
+		const int32_t endId = 1;
+		auto nodeId = [] (int32_t node) {
+			return node + 2;
+		};
+		auto nodeIndex = [] (int32_t id) {
+			return id - 2;
+		};
+
+		std::vector<Edge> startGraphEdges;
+		std::unordered_map<int32_t, float> endGraphEdges;
+		for (const Edge& edge : startEdges) {
+			const NodeRef& ref = startNodes[edge.node];
+			if (isValid(ref)) {
+				startGraphEdges.push_back(Edge { nodeId(ref.node), edge.cost });
+			}
+		}
+		for (const Edge& edge : endEdges) {
+			const NodeRef& ref = endNodes[edge.node];
+			if (isValid(ref)) {
+				endGraphEdges[nodeId(ref.node)] = edge.cost;
+			}
+		}
+		if (directCost >= 0.0f) {
+			startGraphEdges.push_back(Edge { endId, directCost });
+		}
+
+		auto position = [&] (int32_t id) -> const glm::ivec3& {
+			if (id == startId) {
+				return start;
+			}
+			if (id == endId) {
+				return end;
+			}
+			return _nodes[nodeIndex(id)].position;
+		};
+		auto heuristic = [&] (int32_t id) {
+			return glm::length(glm::vec3(end - position(id)));
+		};
+
+		const size_t size = _nodes.size() + 2;
+		std::vector<float> gVals(size, std::numeric_limits<float>::infinity());
+		std::vector<int32_t> parents(size, -1);
+		std::vector<bool> closed(size, false);
+
+		typedef std::pair<float, int32_t> OpenNode;
+		std::priority_queue<OpenNode, std::vector<OpenNode>, std::greater<OpenNode> > open;
+		gVals[startId] = 0.0f;
+		open.emplace(heuristic(startId), startId);
+
+		auto relax = [&] (int32_t from, int32_t to, float cost) {
+			const float g = gVals[from] + cost;
+			if (g >= gVals[to]) {
+				return;
+			}
+			gVals[to] = g;
+			parents[to] = from;
+			open.emplace(g + heuristic(to), to);
+		};
+
+		while (!open.empty()) {
+			const int32_t current = open.top().second;
+			open.pop();
+			if (current == endId) {
+				break;
+			}
+			if (closed[current]) {
+				continue;
+			}
+			closed[current] = true;
+			if (cancelled != nullptr && *cancelled) {
+				return false;
+			}
+			if (current == startId) {
+				for (const Edge& edge : startGraphEdges) {
+					relax(current, edge.node, edge.cost);
+				}
+				continue;
+			}
+			const glm::ivec2 cluster = _nodes[nodeIndex(current)].cluster;
+			if (glm::any(glm::lessThan(cluster, areaMins)) || glm::any(glm::greaterThan(cluster, areaMaxs))) {
+				continue;
+			}
+			if (!_clusters[cluster].built) {
+				build.push_back(cluster);
+				break;
+			}
+			for (const Edge& edge : _nodes[nodeIndex(current)].edges) {
+				relax(current, nodeId(edge.node), edge.cost);
+			}
+			auto i = endGraphEdges.find(current);
+			if (i != endGraphEdges.end()) {
+				relax(current, endId, i->second);
+			}
+		}
+		if (!build.empty()) {
+			continue;
+		}
+
+		if (parents[endId] == -1) {
+			return false;
+		}
+		waypoints.clear();
+		for (int32_t id = endId; id != -1; id = parents[id]) {
+			waypoints.push_back(position(id));
+		}
+		std::reverse(waypoints.begin(), waypoints.end());
+		return true;
+	}
+}
+
+bool NavigationGraph::findPath(const glm::ivec3& start, const glm::ivec3& end, std::vector<glm::ivec3>& result, const std::atomic_bool* cancelled) {
+	core_trace_scoped(NavigationGraphFindPath);
+	result.clear();
+	glm::ivec3 from = start;
+	glm::ivec3 to = end;
+	if (!snap(from) || !snap(to)) {
+		return false;
+	}
+	if (from == to) {
+		result.push_back(from);
+		return true;
+	}
+
+	// short paths don't need the abstract graph
+	const glm::ivec3 delta = glm::abs(to - from);
+	if (std::max(delta.x, delta.z) <= _clusterSize) {
+		const glm::ivec3 margin(_clusterSize / 2, 0, _clusterSize / 2);
+		const glm::ivec3 mins(glm::min(from, to).x, _minY, glm::min(from, to).z);
+		const glm::ivec3 maxs(glm::max(from, to).x, _maxY, glm::max(from, to).z);
+		if (localPath(from, to, mins - margin, maxs + margin, &result, cancelled) >= 0.0f) {
+			return true;
+		}
+	}
+
+	std::vector<glm::ivec3> waypoints;
+	if (!findAbstractPath(from, to, waypoints, cancelled)) {
+		return false;
+	}
+
+	result.clear();
+	std::vector<glm::ivec3> segment;
+	for (size_t i = 1; i < waypoints.size(); ++i) {
+		const glm::ivec2 a = clusterPos(waypoints[i - 1]);
+		const glm::ivec2 b = clusterPos(waypoints[i]);
+		const glm::ivec3 mins = glm::min(clusterMins(a), clusterMins(b));
+		const glm::ivec3 maxs = glm::max(clusterMaxs(a), clusterMaxs(b));
+		if (localPath(waypoints[i - 1], waypoints[i], mins, maxs, &segment, cancelled) < 0.0f) {
+			// the volume was changed since the graph was built
+			result.clear();
+			return false;
+		}
+		result.insert(result.end(), result.empty() ? segment.begin() : segment.begin() + 1, segment.end());
+	}
+	return true;
+}
+
+void NavigationGraph::invalidate(const glm::ivec3& mins, const glm::ivec3& maxs) {
+	// the clusters span the whole height - the voxel above a changed voxel is part of the same cluster
+	const glm::ivec2 clusterMins = clusterPos(mins);
+	const glm::ivec2 clusterMaxs = clusterPos(maxs);
+	std::lock_guard<std::mutex> lock(_mutex);
+	for (int z = clusterMins.y; z <= clusterMaxs.y; ++z) {
+		for (int x = clusterMins.x; x <= clusterMaxs.x; ++x) {
+			auto i = _clusters.find(glm::ivec2(x, z));
+			if (i == _clusters.end()) {
+				continue;
+			}
+			// a cluster that is built right now is marked dirty once the build is finished
+			++i->second.version;
+			if (i->second.built && !i->second.dirty) {
+				i->second.dirty = true;
+				_dirtyClusters.push_back(i->first);
+			}
+		}
+	}
+}
+
+void NavigationGraph::invalidate(const glm::ivec3& pos) {
+	invalidate(pos, pos);
+}
+
+void NavigationGraph::clear() {
+	std::lock_guard<std::mutex> lock(_mutex);
+	_nodes.clear();
+	_freeNodes.clear();
+	_clusters.clear();
+	_borders.clear();
+	_dirtyClusters.clear();
+	_aliveNodes = 0;
+	// the builds that are running right now are discarded
+	++_generation;
+}
+
+int NavigationGraph::nodes() const {
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _aliveNodes;
+}
+
+int NavigationGraph::builtClusters() const {
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _builtClusters;
+}
+
+}
@@ -0,0 +1,197 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/GLM.h"
+#include "voxel/polyvox/Voxel.h"
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace voxel {
+
+/**
+ * @return @c true if an npc can stand at the given position - an air voxel on top of a floor voxel.
+ * Water is no floor.
+ */
+template<class Volume>
+inline bool isWalkable(const Volume* volume, const glm::ivec3& pos) {
+	if (!isAir(volume->getVoxel(pos).getMaterial())) {
+		return false;
+	}
+	return isFloor(volume->getVoxel(glm::ivec3(pos.x, pos.y - 1, pos.z)).getMaterial());
+}
+
+/**
+ * @brief Hierarchical pathfinding (HPA*) over the walkable voxels of a volume
+ *
+ * The xz plane is split into square clusters that span the whole height. The walkable transitions
+ * over the border of two clusters are grouped into entrances, and the middle of each entrance becomes
+ * a pair of nodes of the abstract graph - one on each side. The nodes of a cluster are connected by
+ * the costs of the paths inside of the cluster.
+ *
+ * A long path is searched on the abstract graph first and each step is refined with the voxel A* search
+ * afterwards, so only the voxels close to the path are visited.
+ *
+ * The clusters are built lazily by the searches that need them. Changing the volume only marks the
+ * affected clusters as dirty - they are rebuilt by the next search that needs them.
+ *
+ * @note All public methods are thread safe. The lock is only held to read or modify the graph - the voxel searches
+ * and scans of the clusters are done without it.
+ */
+class NavigationGraph {
+public:
+	typedef std::function<bool(const glm::ivec3&)> WalkableFunc;
+
+	/**
+	 * @param walkable Must be thread safe if the graph is used from several threads
+	 * @param minY The lowest walkable y coordinate
+	 * @param maxY The highest walkable y coordinate
+	 */
+	NavigationGraph(const WalkableFunc& walkable, int clusterSize, int minY, int maxY);
+
+	/**
+	 * @param[out] result The voxel positions of the path including the start and the end position
+	 * @param[in] cancelled Optional flag to abort the search
+	 * @return @c true if a path was found
+	 * @note The start and the end position are moved up or down by up to two voxels to the closest walkable
+	 * position of their column if they are not walkable - the search fails if there is none in that range.
+	 */
+	bool findPath(const glm::ivec3& start, const glm::ivec3& end, std::vector<glm::ivec3>& result, const std::atomic_bool* cancelled = nullptr);
+
+	/**
+	 * @brief Marks the clusters that contain the given positions as dirty
+	 */
+	void invalidate(const glm::ivec3& mins, const glm::ivec3& maxs);
+	void invalidate(const glm::ivec3& pos);
+	/**
+	 * @brief Removes all clusters - e.g. if the whole volume was replaced
+	 */
+	void clear();
+
+	/**
+	 * @return The amount of nodes of the abstract graph
+	 */
+	int nodes() const;
+	/**
+	 * @return The amount of clusters that were built - including rebuilds
+	 */
+	int builtClusters() const;
+
+	inline int clusterSize() const {
+		return _clusterSize;
+	}
+
+private:
+	/// the minimal amount of clusters the abstract search may go beyond the clusters of the start and the end -
+	/// the area grows with the distance of the start and the end
+	static constexpr int SearchMargin = 4;
+
+	struct Edge {
+		int32_t node;
+		float cost;
+	};
+
+	struct AbstractNode {
+		glm::ivec3 position;
+		glm::ivec2 cluster;
+		std::vector<Edge> edges;
+		bool alive = true;
+	};
+
+	struct Cluster {
+		std::vector<int32_t> nodes;
+		// increased by every invalidation - a build that overlaps with an invalidation leaves the cluster dirty
+		uint32_t version = 0u;
+		bool built = false;
+		bool dirty = false;
+	};
+
+	/**
+	 * @brief The walkable step over a cluster border that represents one entrance
+	 */
+	struct Transition {
+		glm::ivec3 from;
+		glm::ivec3 to;
+	};
+
+	/**
+	 * @brief A node of the abstract graph as it was seen while the lock was held
+	 */
+	struct NodeRef {
+		int32_t node;
+		glm::ivec3 position;
+
+		inline bool operator==(const NodeRef& other) const {
+			return node == other.node && position == other.position;
+		}
+		inline bool operator!=(const NodeRef& other) const {
+			return !(*this == other);
+		}
+	};
+
+	WalkableFunc _walkable;
+	const int _clusterSize;
+	const int _minY;
+	const int _maxY;
+
+	std::vector<AbstractNode> _nodes;
+	std::vector<int32_t> _freeNodes;
+	int _aliveNodes = 0;
+	int _builtClusters = 0;
+	// increased by clear() - the running builds are discarded
+	uint32_t _generation = 0u;
+	std::unordered_map<glm::ivec2, Cluster, std::hash<glm::ivec2> > _clusters;
+	// the nodes of the border between a cluster and its positive x (z = 0) or positive z (z = 1) neighbour
+	std::unordered_map<glm::ivec3, std::vector<int32_t>, std::hash<glm::ivec3> > _borders;
+	std::vector<glm::ivec2> _dirtyClusters;
+	mutable std::mutex _mutex;
+
+	glm::ivec2 clusterPos(const glm::ivec3& pos) const;
+	glm::ivec3 clusterMins(const glm::ivec2& cluster) const;
+	glm::ivec3 clusterMaxs(const glm::ivec2& cluster) const;
+	bool snap(glm::ivec3& pos) const;
+
+	/**
+	 * @brief Voxel A* search that doesn't leave the given bounds
+	 * @return The path costs or a negative value if no path was found
+	 */
+	float localPath(const glm::ivec3& start, const glm::ivec3& end, const glm::ivec3& mins, const glm::ivec3& maxs,
+			std::vector<glm::ivec3>* result, const std::atomic_bool* cancelled) const;
+
+	// the following methods need the lock
+	int32_t addNode(const glm::ivec3& pos);
+	void removeNode(int32_t node);
+	/**
+	 * @brief Replaces the nodes of the given border by the nodes of the given transitions
+	 */
+	void setBorder(const glm::ivec3& border, const std::vector<Transition>& transitions);
+	std::vector<NodeRef> clusterNodes(const glm::ivec2& cluster) const;
+	/**
+	 * @return @c false if the node was removed or replaced since the reference was taken
+	 */
+	bool isValid(const NodeRef& ref) const;
+	void takeDirtyClusters(std::vector<glm::ivec2>& clusters);
+
+	// the following methods must be called without the lock
+	/**
+	 * @return The transitions of the entrances of the given border - only the volume is read
+	 */
+	std::vector<Transition> scanBorder(const glm::ivec3& border) const;
+	/**
+	 * @brief Scans the unknown borders of the given clusters (all borders of a dirty cluster) and connects the nodes
+	 */
+	void buildClusters(const std::vector<glm::ivec2>& clusters);
+	/**
+	 * @return The costs from (or to) the given position to the given nodes of its cluster - the node of the
+	 * edges is the index into @c nodes
+	 */
+	std::vector<Edge> endpointEdges(const glm::ivec3& pos, const std::vector<NodeRef>& nodes, bool toNodes, const std::atomic_bool* cancelled) const;
+	bool findAbstractPath(const glm::ivec3& start, const glm::ivec3& end, std::vector<glm::ivec3>& waypoints, const std::atomic_bool* cancelled);
+};
+
+}
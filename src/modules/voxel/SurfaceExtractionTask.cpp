@@ -3,7 +3,7 @@
 #include "OctreeNode.h"
 #include "core/App.h"
 #include "polyvox/Region.h"
-#include "polyvox/CubicSurfaceExtractor.h"
+#include "polyvox/SurfaceExtractor.h"
 #include "polyvox/RawVolume.h"
 #include "polyvox/VolumeRescaler.h"
 #include "IsQuadNeeded.h"
@@ -14,17 +14,8 @@
 
 namespace voxel {
 
-// Eliminate this
-static inline void scaleVertices(Mesh* mesh, uint32_t amount) {
-	core_trace_scoped(ScaleVertices);
-	for (uint32_t ct = 0; ct < mesh->getNoOfVertices(); ct++) {
-		VoxelVertex& vertex = const_cast<VoxelVertex&>(mesh->getVertex(ct));
-		vertex.position *= amount;
-	}
-}
-
-SurfaceExtractionTask::SurfaceExtractionTask(OctreeNode* octreeNode, PagedVolume* polyVoxVolume) :
-		_node(octreeNode), _volume(polyVoxVolume) {
+SurfaceExtractionTask::SurfaceExtractionTask(OctreeNode* octreeNode, PagedVolume* polyVoxVolume, SurfaceExtractor extractor) :
+		_node(octreeNode), _volume(polyVoxVolume), _extractor(extractor) {
 	const voxel::Region& region = octreeNode->region();
 	Log::debug("Extract volume data for region mins(%i:%i:%i), maxs(%i:%i:%i)",
 			region.getLowerX(), region.getLowerY(), region.getLowerZ(),
@@ -45,11 +36,13 @@ void SurfaceExtractionTask::process() {
 	Mesh* meshWater = _meshWater.get();
 	Mesh* mesh = _mesh.get();
 
+	// the meshes of the downscaled volumes keep their positions - the renderer has to apply the
+	// scale factor together with the mesh offset
 	const uint32_t downScaleFactor = 0x0001 << _node->height();
 
 	if (downScaleFactor == 1) {
-		extractCubicMesh(_volume, _node->region(), mesh, IsQuadNeeded());
-		extractCubicMesh(_volume, _node->region(), meshWater, IsWaterQuadNeeded());
+		extractSurface(_extractor, _volume, _node->region(), mesh, IsQuadNeeded());
+		extractSurface(_extractor, _volume, _node->region(), meshWater, IsWaterQuadNeeded());
 	} else if (downScaleFactor == 2) {
 		Region srcRegion = _node->region();
 		srcRegion.grow(2);
@@ -68,11 +61,8 @@ void SurfaceExtractionTask::process() {
 
 		dstRegion.shrink(1);
 
-		extractCubicMesh(&resampledVolume, dstRegion, mesh, IsQuadNeeded());
-		extractCubicMesh(&resampledVolume, dstRegion, meshWater, IsWaterQuadNeeded());
-
-		scaleVertices(mesh, downScaleFactor);
-		scaleVertices(meshWater, downScaleFactor);
+		extractSurface(_extractor, &resampledVolume, dstRegion, mesh, IsQuadNeeded());
+		extractSurface(_extractor, &resampledVolume, dstRegion, meshWater, IsWaterQuadNeeded());
 	} else if (downScaleFactor == 4) {
 		Region srcRegion = _node->region();
 		srcRegion.grow(4);
@@ -103,11 +93,8 @@ void SurfaceExtractionTask::process() {
 
 		dstRegion2.shrink(1);
 
-		extractCubicMesh(&resampledVolume2, dstRegion2, mesh, IsQuadNeeded());
-		extractCubicMesh(&resampledVolume2, dstRegion2, meshWater, IsWaterQuadNeeded());
-
-		scaleVertices(mesh, downScaleFactor);
-		scaleVertices(meshWater, downScaleFactor);
+		extractSurface(_extractor, &resampledVolume2, dstRegion2, mesh, IsQuadNeeded());
+		extractSurface(_extractor, &resampledVolume2, dstRegion2, meshWater, IsWaterQuadNeeded());
 	}
 
 	_node->_octree->_finishedExtractionTasks.push(this);
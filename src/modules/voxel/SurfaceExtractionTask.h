@@ -1,17 +1,17 @@
 #pragma once
 
 #include "voxel/polyvox/PagedVolume.h"
+#include "voxel/polyvox/SurfaceExtractor.h"
 #include <memory>
 #include <limits>
 
 namespace voxel {
 
 class OctreeNode;
-class Mesh;
 
 class SurfaceExtractionTask {
 public:
-	SurfaceExtractionTask(OctreeNode* node, PagedVolume* volume);
+	SurfaceExtractionTask(OctreeNode* node, PagedVolume* volume, SurfaceExtractor extractor = SurfaceExtractor::Cubic);
 	~SurfaceExtractionTask();
 
 	// Extract the surface
@@ -21,6 +21,7 @@ public:
 	int _priority = 0;
 	OctreeNode* _node;
 	PagedVolume* _volume;
+	SurfaceExtractor _extractor;
 	std::shared_ptr<Mesh> _mesh;
 	std::shared_ptr<Mesh> _meshWater;
 	long _processingStartedTimestamp = std::numeric_limits<long>::max();
@@ -10,19 +10,21 @@
 #include "io/File.h"
 #include "core/Random.h"
 #include "core/Concurrency.h"
-#include "voxel/polyvox/AStarPathfinder.h"
-#include "voxel/polyvox/CubicSurfaceExtractor.h"
+#include "voxel/polyvox/SurfaceExtractor.h"
 #include "voxel/polyvox/PagedVolumeWrapper.h"
 #include "voxel/polyvox/Voxel.h"
 #include "voxel/generator/WorldGenerator.h"
 #include "voxel/Constants.h"
 #include "voxel/IsQuadNeeded.h"
 #include "voxel/Spiral.h"
+#include <algorithm>
+#include <limits>
 
 namespace voxel {
 
 World::World() :
-		_threadPool(core::halfcpus(), "World"), _random(_seed) {
+		_threadPool(core::halfcpus(), "World"), _random(_seed), _chunkThreadPool(core::halfcpus(), "WorldPager"),
+		_navigation([this] (const glm::ivec3& pos) { return isWalkable(_volumeData, pos); }, NavigationClusterSize, 1, MAX_HEIGHT - 1) {
 }
 
 World::~World() {
@@ -62,11 +64,38 @@ bool World::scheduleMeshExtraction(const glm::ivec3& p) {
 	Log::trace("mesh extraction for %i:%i:%i (%i:%i:%i)", p.x, p.y, p.z, pos.x, pos.y, pos.z);
 	_meshesExtracted.insert(pos);
 
+	// the extraction also looks at the neighbours of the region - the chunks are generated by the chunk threads
+	std::vector<std::shared_future<void> > chunkFutures;
+	{
+		const Region& region = getMeshRegion(pos);
+		const glm::ivec3& mins = getChunkPos(region.getLowerCorner() - 1);
+		const glm::ivec3& maxs = getChunkPos(region.getUpperCorner() + 1);
+		const int chunkSize = getChunkSize();
+		core::ScopedWriteLock lock(_chunkRequestLock);
+		for (int y = std::max(0, mins.y); y <= maxs.y; ++y) {
+			for (int z = mins.z; z <= maxs.z; ++z) {
+				for (int x = mins.x; x <= maxs.x; ++x) {
+					const glm::ivec3 chunkPos(x, y, z);
+					if (_volumeData->hasChunk(chunkPos * chunkSize)) {
+						continue;
+					}
+					chunkFutures.push_back(queueChunk(chunkPos, true));
+				}
+			}
+		}
+	}
+
 	_futures.push_back(_threadPool.enqueue([=] () {
 		if (_cancelThreads) {
 			return;
 		}
 		core_trace_scoped(MeshExtraction);
+		for (const std::shared_future<void>& chunkFuture : chunkFutures) {
+			chunkFuture.wait();
+		}
+		if (_cancelThreads) {
+			return;
+		}
 		const Region &region = getMeshRegion(pos);
 
 		// these number are made up mostly by try-and-error - we need to revisit them from time to time to prevent extra mem allocs
@@ -79,11 +108,16 @@ bool World::scheduleMeshExtraction(const glm::ivec3& p) {
 		if (_cancelThreads) {
 			return;
 		}
-		extractCubicMesh(_volumeData, region, &data.opaqueMesh, IsQuadNeeded());
+		const SurfaceExtractor extractor = _greedyMeshing->boolVal() ? SurfaceExtractor::BinaryGreedy : SurfaceExtractor::Cubic;
+		if (!extractSurfaceSegments(extractor, _volumeData, region, &data.opaqueMesh, IsQuadNeeded())) {
+			Log::error("Could not extract the opaque mesh at %i:%i:%i", pos.x, pos.y, pos.z);
+		}
 		if (_cancelThreads) {
 			return;
 		}
-		extractCubicMesh(_volumeData, region, &data.waterMesh, IsWaterQuadNeeded());
+		if (!extractSurfaceSegments(extractor, _volumeData, region, &data.waterMesh, IsWaterQuadNeeded())) {
+			Log::error("Could not extract the water mesh at %i:%i:%i", pos.x, pos.y, pos.z);
+		}
 		if (_cancelThreads) {
 			return;
 		}
@@ -107,6 +141,7 @@ Region World::getRegion(const glm::ivec3& pos, int size) const {
 
 void World::setVoxel(const glm::ivec3& pos, const voxel::Voxel& voxel) {
 	_volumeData->setVoxel(pos, voxel);
+	_navigation.invalidate(pos);
 }
 
 bool World::allowReExtraction(const glm::ivec3& pos) {
@@ -114,20 +149,194 @@ bool World::allowReExtraction(const glm::ivec3& pos) {
 	return _meshesExtracted.erase(gridPos) != 0;
 }
 
-bool World::findPath(const glm::ivec3& start, const glm::ivec3& end,
-		std::list<glm::ivec3>& listResult) {
+bool World::findPath(const glm::ivec3& start, const glm::ivec3& end, std::vector<glm::ivec3>& result, const std::atomic_bool* cancelled) {
 	core_trace_scoped(FindPath);
-	static auto f = [] (const voxel::PagedVolume* volData, const glm::ivec3& v3dPos) {
-		const voxel::Voxel& voxel = volData->getVoxel(v3dPos);
-		return isBlocked(voxel.getMaterial());
-	};
-
-	const AStarPathfinderParams<voxel::PagedVolume> params(_volumeData, start, end, &listResult, 1.0f, 10000,
-			TwentySixConnected, std::bind(f, std::placeholders::_1, std::placeholders::_2));
-	AStarPathfinder<voxel::PagedVolume> pf(params);
-	// TODO: move into threadpool
-	pf.execute();
-	return true;
+	return _navigation.findPath(start, end, result, cancelled);
+}
+
+PathRequestPtr World::findPathAsync(const glm::ivec3& start, const glm::ivec3& end) {
+	const PathRequestPtr request = std::make_shared<PathRequest>(start, end, _pathRequestId++);
+	_pathRequests.push(request);
+	return request;
+}
+
+void World::schedulePathRequests() {
+	const int budget = _pathBudget->intVal();
+	int started = 0;
+	PathRequestPtr request;
+	while (started < budget && _pathRequests.pop(request)) {
+		if (request->_cancelled) {
+			request->_state = PathRequest::State::Cancelled;
+			continue;
+		}
+		++started;
+		++_pathJobs;
+		_threadPool.enqueue([this, request] () {
+			if (request->_cancelled || _cancelThreads) {
+				request->_state = PathRequest::State::Cancelled;
+				finishJob(_pathJobs);
+				return;
+			}
+			request->_state = PathRequest::State::Running;
+			const bool found = findPath(request->_start, request->_end, request->_path, &request->_cancelled);
+			if (found) {
+				request->_state = PathRequest::State::Found;
+			} else if (request->_cancelled) {
+				request->_state = PathRequest::State::Cancelled;
+			} else {
+				request->_state = PathRequest::State::Failed;
+			}
+			finishJob(_pathJobs);
+		});
+	}
+}
+
+void World::cancelPathRequests() {
+	PathRequestPtr request;
+	while (_pathRequests.pop(request)) {
+		request->_cancelled = true;
+		request->_state = PathRequest::State::Cancelled;
+	}
+}
+
+std::shared_future<void> World::prefetchChunk(const glm::ivec3& pos) {
+	const glm::ivec3& chunkPos = getChunkPos(pos);
+	core::ScopedWriteLock lock(_chunkRequestLock);
+	return queueChunk(chunkPos, true);
+}
+
+void World::prefetchChunks(const glm::ivec3& pos, int radius, int64_t viewer) {
+	const glm::ivec3& center = getChunkPos(pos);
+	const int maxChunkY = (MAX_HEIGHT - 1) / getChunkSize();
+	core::ScopedWriteLock lock(_chunkRequestLock);
+	_prefetchAreas[viewer] = PrefetchArea{glm::ivec3(center.x, 0, center.z), radius};
+	updatePendingChunks();
+	for (int z = -radius; z <= radius; ++z) {
+		for (int x = -radius; x <= radius; ++x) {
+			if (x * x + z * z > radius * radius) {
+				continue;
+			}
+			for (int y = 0; y <= maxChunkY; ++y) {
+				queueChunk(glm::ivec3(center.x + x, y, center.z + z), false);
+			}
+		}
+	}
+}
+
+void World::removeViewer(int64_t viewer) {
+	core::ScopedWriteLock lock(_chunkRequestLock);
+	if (_prefetchAreas.erase(viewer) > 0) {
+		updatePendingChunks();
+	}
+}
+
+int World::chunkPriority(const glm::ivec3& chunkPos, bool& inArea) const {
+	int priority = std::numeric_limits<int>::max();
+	inArea = false;
+	for (const auto& e : _prefetchAreas) {
+		const PrefetchArea& area = e.second;
+		const int dx = chunkPos.x - area.center.x;
+		const int dz = chunkPos.z - area.center.z;
+		const int distance = dx * dx + dz * dz;
+		priority = std::min(priority, distance);
+		if (distance <= area.radius * area.radius) {
+			inArea = true;
+		}
+	}
+	return priority;
+}
+
+void World::updatePendingChunks() {
+	for (size_t i = 0; i < _pendingChunks.size();) {
+		auto request = _chunkRequests.find(_pendingChunks[i]);
+		core_assert(request != _chunkRequests.end());
+		bool inArea;
+		request->second.priority = chunkPriority(_pendingChunks[i], inArea);
+		if (inArea || request->second.pinned) {
+			++i;
+			continue;
+		}
+		// nobody waits for the future of an unpinned request. The job that was queued for it finds one
+		// pending chunk less and returns without doing anything.
+		_chunkRequests.erase(request);
+		_pendingChunks[i] = _pendingChunks.back();
+		_pendingChunks.pop_back();
+	}
+}
+
+std::shared_future<void> World::queueChunk(const glm::ivec3& chunkPos, bool pinned) {
+	auto i = _chunkRequests.find(chunkPos);
+	if (i != _chunkRequests.end()) {
+		i->second.pinned |= pinned;
+		return i->second.future;
+	}
+	if (_volumeData->hasChunk(chunkPos * getChunkSize())) {
+		std::promise<void> promise;
+		promise.set_value();
+		return promise.get_future().share();
+	}
+	ChunkRequest& request = _chunkRequests[chunkPos];
+	request.future = request.promise.get_future().share();
+	request.pinned = pinned;
+	bool inArea;
+	request.priority = chunkPriority(chunkPos, inArea);
+	_pendingChunks.push_back(chunkPos);
+	++_chunkJobs;
+	// the job doesn't know which chunk it will generate - the one with the highest priority is picked when it is executed
+	_chunkThreadPool.enqueue([this] () {
+		generateNextChunk();
+	});
+	return request.future;
+}
+
+void World::generateNextChunk() {
+	glm::ivec3 chunkPos(glm::uninitialize);
+	bool dropped = false;
+	{
+		core::ScopedWriteLock lock(_chunkRequestLock);
+		if (_pendingChunks.empty()) {
+			dropped = true;
+		} else {
+			auto priority = [this] (const glm::ivec3& p) {
+				const ChunkRequest& request = _chunkRequests.find(p)->second;
+				return std::make_pair(!request.pinned, request.priority);
+			};
+			auto next = std::min_element(_pendingChunks.begin(), _pendingChunks.end(), [&] (const glm::ivec3& lhs, const glm::ivec3& rhs) {
+				return priority(lhs) < priority(rhs);
+			});
+			chunkPos = *next;
+			*next = _pendingChunks.back();
+			_pendingChunks.pop_back();
+		}
+	}
+	if (dropped) {
+		// the chunk of this job was dropped
+		finishJob(_chunkJobs);
+		return;
+	}
+	if (!_cancelThreads) {
+		core_trace_scoped(GenerateChunk);
+		_volumeData->getChunk(chunkPos * getChunkSize());
+		const Region& region = getChunkRegion(chunkPos * getChunkSize());
+		_navigation.invalidate(region.getLowerCorner(), region.getUpperCorner());
+	}
+	{
+		core::ScopedWriteLock lock(_chunkRequestLock);
+		auto i = _chunkRequests.find(chunkPos);
+		core_assert(i != _chunkRequests.end());
+		i->second.promise.set_value();
+		_chunkRequests.erase(i);
+	}
+	finishJob(_chunkJobs);
+}
+
+void World::finishJob(std::atomic_int& jobs) {
+	if (--jobs > 0) {
+		return;
+	}
+	// lock to not miss a waiter that checked the counters, but didn't wait yet
+	std::lock_guard<std::mutex> lock(_jobsMutex);
+	_jobsCondition.notify_all();
 }
 
 bool World::init(const std::string& luaParameters, const std::string& luaBiomes, uint32_t volumeMemoryMegaBytes, uint16_t chunkSideLength) {
@@ -138,6 +347,8 @@ bool World::init(const std::string& luaParameters, const std::string& luaBiomes,
 		return false;
 	}
 	_meshSize = core::Var::getSafe(cfg::VoxelMeshSize);
+	_greedyMeshing = core::Var::get(cfg::VoxelGreedyMeshing, "false");
+	_pathBudget = core::Var::get(cfg::VoxelPathBudget, "8");
 	_volumeData = new PagedVolume(&_pager, volumeMemoryMegaBytes * 1024 * 1024, chunkSideLength);
 
 	_pager.init(_volumeData, &_biomeManager, &_ctx);
@@ -152,8 +363,16 @@ bool World::init(const std::string& luaParameters, const std::string& luaBiomes,
 
 void World::shutdown() {
 	_cancelThreads = true;
-	while (!_futures.empty()) {
-		cleanupFutures();
+	cancelPathRequests();
+	for (std::future<void>& future : _futures) {
+		future.wait();
+	}
+	_futures.clear();
+	{
+		std::unique_lock<std::mutex> lock(_jobsMutex);
+		_jobsCondition.wait(lock, [this] () {
+			return _chunkJobs == 0 && _pathJobs == 0;
+		});
 	}
 	_meshesExtracted.clear();
 	_meshQueue.clear();
@@ -181,7 +400,8 @@ void World::onFrame(long dt) {
 	core_trace_scoped(WorldOnFrame);
 	cleanupFutures();
 	if (_cancelThreads) {
-		if (!_futures.empty()) {
+		cancelPathRequests();
+		if (!_futures.empty() || _chunkJobs > 0 || _pathJobs > 0) {
 			return;
 		}
 		_volumeData->flushAll();
@@ -189,9 +409,12 @@ void World::onFrame(long dt) {
 		_meshesExtracted.clear();
 		_meshQueue.clear();
 		_meshQueue.abortWait();
+		_navigation.clear();
 		Log::info("reset the world");
 		_cancelThreads = false;
+		return;
 	}
+	schedulePathRequests();
 }
 
 bool World::isReset() const {
@@ -204,6 +427,19 @@ void World::stats(int& meshes, int& extracted, int& pending) const {
 	meshes = _meshQueue.size();
 }
 
+void World::stats(WorldStats& stats) const {
+	this->stats(stats.meshes, stats.extracted, stats.pending);
+	{
+		core::ScopedReadLock lock(_chunkRequestLock);
+		stats.pendingChunks = (int)_pendingChunks.size();
+	}
+	stats.generatedChunks = _pager.generatedChunks();
+	stats.terrainMillis = _pager.stageMillis(GenerationStage::Terrain);
+	stats.cloudsMillis = _pager.stageMillis(GenerationStage::Clouds);
+	stats.treesMillis = _pager.stageMillis(GenerationStage::Trees);
+	stats.buildingsMillis = _pager.stageMillis(GenerationStage::Buildings);
+}
+
 bool World::raycast(const glm::vec3& start, const glm::vec3& direction, float maxDistance, glm::ivec3& hit, Voxel& voxel) const {
 	const bool result = raycast(start, direction, maxDistance, [&] (const PagedVolume::Sampler& sampler) {
 		voxel = sampler.getVoxel();
@@ -13,21 +13,32 @@
 #include <memory>
 #include <vector>
 #include <atomic>
-#include <list>
 
 #include "WorldPager.h"
 #include "WorldContext.h"
 #include "io/Filesystem.h"
 #include "BiomeManager.h"
+#include "NavigationGraph.h"
 #include "core/ConcurrentQueue.h"
 #include "core/ThreadPool.h"
+#include "core/ReadWriteLock.h"
 #include "core/Var.h"
 #include "core/Random.h"
 #include "core/Log.h"
 #include <unordered_set>
+#include <unordered_map>
+#include <future>
+#include <mutex>
+#include <condition_variable>
 
 namespace voxel {
 
+/**
+ * @brief The meshes of one world chunk. A chunk mesh uses 16 bit indices - if it exceeds them, it is
+ * split into several segments.
+ * @sa ChunkMesh
+ * @sa extractSurfaceSegments()
+ */
 struct ChunkMeshes {
 	static constexpr bool MAY_GET_RESIZED = true;
 	ChunkMeshes(int opaqueVertices, int opaqueIndices, int waterVertices, int waterIndices) :
@@ -38,8 +49,8 @@ struct ChunkMeshes {
 		return opaqueMesh.getOffset();
 	}
 
-	Mesh opaqueMesh;
-	Mesh waterMesh;
+	ChunkMesh opaqueMesh;
+	ChunkMesh waterMesh;
 
 	inline bool operator<(const ChunkMeshes& rhs) const {
 		return glm::all(glm::lessThan(translation(), rhs.translation()));
@@ -48,6 +59,91 @@ struct ChunkMeshes {
 
 typedef std::unordered_set<glm::ivec3, std::hash<glm::ivec3> > PositionSet;
 
+/**
+ * @brief Statistics of the mesh extraction and the chunk generation of the world
+ * @sa World::stats()
+ */
+struct WorldStats {
+	int meshes = 0;
+	int extracted = 0;
+	int pending = 0;
+	// chunks that are queued for the asynchronous generation
+	int pendingChunks = 0;
+	int generatedChunks = 0;
+	// accumulated milliseconds of the generation stages over all generated chunks
+	double terrainMillis = 0.0;
+	double cloudsMillis = 0.0;
+	double treesMillis = 0.0;
+	double buildingsMillis = 0.0;
+};
+
+/**
+ * @brief A path search that is executed by the world threads
+ * @sa World::findPathAsync()
+ */
+class PathRequest {
+public:
+	enum class State : uint8_t {
+		Queued,
+		Running,
+		Found,
+		Failed,
+		Cancelled
+	};
+
+	PathRequest(const glm::ivec3& start, const glm::ivec3& end, uint64_t id) :
+			_start(start), _end(end), _id(id) {
+	}
+
+	inline State state() const {
+		return _state;
+	}
+
+	/**
+	 * @return @c true if the search finished, failed or was cancelled
+	 */
+	inline bool done() const {
+		const State state = _state;
+		return state != State::Queued && state != State::Running;
+	}
+
+	/**
+	 * @brief Aborts the search - a running search stops at the next node it visits.
+	 */
+	inline void cancel() {
+		_cancelled = true;
+	}
+
+	/**
+	 * @note Only valid if the state is State::Found
+	 */
+	inline const std::vector<glm::ivec3>& path() const {
+		return _path;
+	}
+
+	inline const glm::ivec3& start() const {
+		return _start;
+	}
+
+	inline const glm::ivec3& end() const {
+		return _end;
+	}
+
+	inline uint64_t id() const {
+		return _id;
+	}
+private:
+	friend class World;
+	const glm::ivec3 _start;
+	const glm::ivec3 _end;
+	const uint64_t _id;
+	std::atomic<State> _state { State::Queued };
+	std::atomic_bool _cancelled { false };
+	std::vector<glm::ivec3> _path;
+};
+
+typedef std::shared_ptr<PathRequest> PathRequestPtr;
+
 class World {
 public:
 	enum Result {
@@ -92,22 +188,54 @@ public:
 	void reset();
 	bool isReset() const;
 
-	bool findPath(const glm::ivec3& start, const glm::ivec3& end, std::list<glm::ivec3>& listResult);
+	/**
+	 * @brief Searches a path over the walkable surface - see NavigationGraph
+	 * @param[out] result The positions of the path including the start and the end position
+	 * @param[in] cancelled Optional flag to abort the search
+	 * @return @c true if a path was found
+	 */
+	bool findPath(const glm::ivec3& start, const glm::ivec3& end, std::vector<glm::ivec3>& result, const std::atomic_bool* cancelled = nullptr);
+	/**
+	 * @brief Queues a path search for the world threads. The searches are started in @c onFrame() - at most
+	 * @c cfg::VoxelPathBudget per frame.
+	 * @return The request to poll the state and the path from. The search can be aborted with PathRequest::cancel().
+	 */
+	PathRequestPtr findPathAsync(const glm::ivec3& start, const glm::ivec3& end);
 
+	/**
+	 * @return The y coordinate of the highest voxel at or below the given position that matches the given check
+	 * or @c NO_FLOOR_FOUND.
+	 * @note The column heightmaps of the chunks are used to skip the air (and the water if the check doesn't
+	 * match it) - the voxels are only visited below a highest voxel that doesn't match, e.g. for overhangs or caves.
+	 */
 	template<typename VoxelTypeChecker>
-	int findFloor(int x, int z, VoxelTypeChecker&& check) const {
-		const glm::vec3 start = glm::vec3(x, MAX_HEIGHT, z);
-		const glm::vec3& direction = glm::down;
-		const float distance = (float)MAX_HEIGHT;
-		int y = NO_FLOOR_FOUND;
-		raycast(start, direction, distance, [&] (const PagedVolume::Sampler& sampler) {
-			if (check(sampler.getVoxel().getMaterial())) {
-				y = sampler.getPosition().y;
-				return false;
+	int findFloorBelow(const glm::ivec3& pos, VoxelTypeChecker&& check) const {
+		if (check(VoxelType::Air)) {
+			return pos.y >= 0 ? std::min(pos.y, MAX_HEIGHT) : NO_FLOOR_FOUND;
+		}
+		const bool water = check(VoxelType::Water);
+		int y = std::min(pos.y, MAX_HEIGHT);
+		while (y >= 0) {
+			const PagedVolume::ChunkPtr chunk = _volumeData->getChunk(glm::ivec3(pos.x, y, pos.z));
+			const glm::ivec3 mins = chunk->getRegion().getLowerCorner();
+			const uint32_t x = pos.x - mins.x;
+			const uint32_t z = pos.z - mins.z;
+			const PagedVolume::Chunk::ColumnHeight column = chunk->getColumnHeight(x, z);
+			// everything above this voxel is air or water
+			const int highest = water ? column.top : column.ground;
+			for (int chunkY = std::min(y - mins.y, highest); chunkY >= 0; --chunkY) {
+				if (check(chunk->getVoxel(x, chunkY, z).getMaterial())) {
+					return mins.y + chunkY;
+				}
 			}
-			return true;
-		});
-		return y;
+			y = mins.y - 1;
+		}
+		return NO_FLOOR_FOUND;
+	}
+
+	template<typename VoxelTypeChecker>
+	inline int findFloor(int x, int z, VoxelTypeChecker&& check) const {
+		return findFloorBelow(glm::ivec3(x, MAX_HEIGHT, z), std::forward<VoxelTypeChecker>(check));
 	}
 
 	VoxelType getMaterial(int x, int y, int z) const;
@@ -152,6 +280,32 @@ public:
 	}
 
 	void stats(int& meshes, int& extracted, int& pending) const;
+	void stats(WorldStats& stats) const;
+
+	/**
+	 * @brief Queues the asynchronous generation of the chunk that contains the given world position.
+	 * @return A future that is ready as soon as the chunk is paged in. Callers can either wait for it or skip
+	 * the chunk as long as the future isn't ready.
+	 */
+	std::shared_future<void> prefetchChunk(const glm::ivec3& pos);
+	/**
+	 * @brief Queues the asynchronous generation of all chunks in the given radius around the given world position.
+	 * @param[in] radius The radius in chunks
+	 * @param[in] viewer Identifies the caller (e.g. the entity id of a user) - every viewer has its own prefetch area
+	 * @note The queued chunks are generated in the order of their distance to the closest viewer. Chunks that were
+	 * only queued by this function and are no longer in the area of any viewer are dropped.
+	 * @sa removeViewer()
+	 */
+	void prefetchChunks(const glm::ivec3& pos, int radius, int64_t viewer = 0);
+	/**
+	 * @brief Removes the prefetch area of the given viewer and drops the queued chunks that no other viewer needs.
+	 * @sa prefetchChunks()
+	 */
+	void removeViewer(int64_t viewer);
+	/**
+	 * @return @c true if the chunk that contains the given world position is available without generating it.
+	 */
+	bool isChunkReady(const glm::ivec3& pos) const;
 
 	/**
 	 * @brief If you don't need an extracted mesh anymore, make sure to allow the reextraction at a later time.
@@ -195,7 +349,52 @@ public:
 	int getMeshSize() const;
 
 private:
+	struct ChunkRequest {
+		std::promise<void> promise;
+		std::shared_future<void> future;
+		// squared distance in chunks to the closest viewer - the lowest value is generated first
+		int priority = 0;
+		// someone might wait for the future - such a request is generated first and never dropped
+		bool pinned = false;
+	};
+
+	struct PrefetchArea {
+		glm::ivec3 center;
+		int radius;
+	};
+
 	void cleanupFutures();
+	/**
+	 * @brief Hands the queued path searches over to the thread pool
+	 */
+	void schedulePathRequests();
+	void cancelPathRequests();
+	/**
+	 * @note Must be called with the chunk request lock held.
+	 * @param[in] chunkPos The chunk position (not the world position)
+	 * @param[in] pinned @c true if the caller waits for the returned future
+	 */
+	std::shared_future<void> queueChunk(const glm::ivec3& chunkPos, bool pinned);
+	/**
+	 * @brief Computes the squared distance of the given chunk to the closest viewer
+	 * @param[out] inArea @c true if the chunk is inside of the prefetch area of any viewer
+	 * @note Must be called with the chunk request lock held.
+	 */
+	int chunkPriority(const glm::ivec3& chunkPos, bool& inArea) const;
+	/**
+	 * @brief Updates the priorities of the pending chunks after the viewers changed and drops the unpinned chunks
+	 * that are outside of every prefetch area.
+	 * @note Must be called with the chunk request lock held.
+	 */
+	void updatePendingChunks();
+	/**
+	 * @brief Executed by the chunk generation threads - generates the queued chunk with the highest priority.
+	 */
+	void generateNextChunk();
+	/**
+	 * @brief Decrements the given job counter and wakes up shutdown() if it reached zero
+	 */
+	void finishJob(std::atomic_int& jobs);
 	Region getChunkRegion(const glm::ivec3& pos) const;
 	Region getMeshRegion(const glm::ivec3& pos) const;
 	Region getRegion(const glm::ivec3& pos, int size) const;
@@ -213,9 +412,35 @@ private:
 	// fast lookup for positions that are already extracted and available in the _meshData vector
 	PositionSet _meshesExtracted;
 	core::VarPtr _meshSize;
+	core::VarPtr _greedyMeshing;
 	core::Random _random;
 	std::vector<std::future<void> > _futures;
 	std::atomic_bool _cancelThreads { false };
+
+	// The chunks are generated by their own threads - the mesh extraction threads only wait for them.
+	core::ThreadPool _chunkThreadPool;
+	mutable core::ReadWriteLock _chunkRequestLock {"chunkrequests"};
+	std::unordered_map<glm::ivec3, ChunkRequest, std::hash<glm::ivec3> > _chunkRequests;
+	std::vector<glm::ivec3> _pendingChunks;
+	std::unordered_map<int64_t, PrefetchArea> _prefetchAreas;
+	std::atomic_int _chunkJobs { 0 };
+	// signaled when the chunk or path jobs are done
+	std::mutex _jobsMutex;
+	std::condition_variable _jobsCondition;
+
+	struct PathRequestOrder {
+		inline bool operator()(const PathRequestPtr& lhs, const PathRequestPtr& rhs) const {
+			// the oldest request is the first in the queue
+			return lhs->id() > rhs->id();
+		}
+	};
+	core::ConcurrentQueue<PathRequestPtr, PathRequestOrder> _pathRequests;
+	std::atomic<uint64_t> _pathRequestId { 0u };
+	std::atomic_int _pathJobs { 0 };
+	core::VarPtr _pathBudget;
+
+	static constexpr int NavigationClusterSize = 32;
+	NavigationGraph _navigation;
 };
 
 inline Region World::getChunkRegion(const glm::ivec3& pos) const {
@@ -228,6 +453,10 @@ inline Region World::getMeshRegion(const glm::ivec3& pos) const {
 	return getRegion(pos, size);
 }
 
+inline bool World::isChunkReady(const glm::ivec3& pos) const {
+	return _volumeData->hasChunk(pos);
+}
+
 inline int World::getChunkSize() const {
 	return _volumeData->getChunkSideLength();
 }
@@ -6,11 +6,34 @@
 #include "voxel/WorldContext.h"
 #include "voxel/generator/WorldGenerator.h"
 #include "voxel/polyvox/PagedVolumeWrapper.h"
+#include <chrono>
 
 #define PERSIST 1
 
 namespace voxel {
 
+namespace {
+
+/**
+ * @brief Adds the lifetime of the object to the given counter
+ */
+class ScopedStageTimer {
+private:
+	std::atomic<uint64_t>& _micros;
+	const std::chrono::high_resolution_clock::time_point _start;
+public:
+	ScopedStageTimer(std::atomic<uint64_t>& micros) :
+			_micros(micros), _start(std::chrono::high_resolution_clock::now()) {
+	}
+
+	~ScopedStageTimer() {
+		const auto end = std::chrono::high_resolution_clock::now();
+		_micros += std::chrono::duration_cast<std::chrono::microseconds>(end - _start).count();
+	}
+};
+
+}
+
 void WorldPager::erase(const Region& region) {
 #if PERSIST
 	_worldPersister.erase(region, _seed);
@@ -73,27 +96,40 @@ void WorldPager::shutdown() {
 	_ctx = nullptr;
 }
 
+double WorldPager::stageMillis(GenerationStage stage) const {
+	return _stageMicros[std::enum_value(stage)] / 1000.0;
+}
+
+int WorldPager::generatedChunks() const {
+	return _generatedChunks;
+}
+
 void WorldPager::create(PagedVolume::PagerContext& ctx) {
 	PagedVolumeWrapper wrapper(_volumeData, ctx.chunk, ctx.region);
 	core_trace_scoped(CreateWorld);
 	voxel::world::WorldGenerator gen(*_biomeManager, _seed);
 	{
 		core_trace_scoped(World);
+		ScopedStageTimer timer(_stageMicros[std::enum_value(GenerationStage::Terrain)]);
 		gen.createWorld(*_ctx, wrapper, _noiseSeedOffset.x, _noiseSeedOffset.y);
 	}
 	if ((_createFlags & voxel::world::WORLDGEN_CLOUDS) != 0) {
 		core_trace_scoped(Clouds);
+		ScopedStageTimer timer(_stageMicros[std::enum_value(GenerationStage::Clouds)]);
 		voxel::cloud::CloudContext ctx;
 		gen.createClouds(wrapper, ctx);
 	}
 	if ((_createFlags & voxel::world::WORLDGEN_TREES) != 0) {
 		core_trace_scoped(Trees);
+		ScopedStageTimer timer(_stageMicros[std::enum_value(GenerationStage::Trees)]);
 		gen.createTrees(wrapper);
 	}
 	{
 		core_trace_scoped(Buildings);
+		ScopedStageTimer timer(_stageMicros[std::enum_value(GenerationStage::Buildings)]);
 		gen.createBuildings(wrapper);
 	}
+	++_generatedChunks;
 }
 
 }
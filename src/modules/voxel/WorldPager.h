@@ -5,6 +5,9 @@
 
 #include "voxel/polyvox/PagedVolume.h"
 #include "voxel/WorldPersister.h"
+#include "core/Common.h"
+#include <array>
+#include <atomic>
 
 namespace voxel {
 
@@ -12,6 +15,13 @@ class BiomeManager;
 struct WorldContext;
 class PagedVolumeWrapper;
 
+/**
+ * @brief The stages of the world generation that are measured by the @c WorldPager
+ */
+enum class GenerationStage {
+	Terrain, Clouds, Trees, Buildings, Max
+};
+
 /**
  * @brief Pager implementation for PagedVolume.
  */
@@ -27,6 +37,10 @@ private:
 	BiomeManager* _biomeManager = nullptr;
 	WorldContext* _ctx = nullptr;
 
+	// accumulated microseconds of all generated chunks per stage
+	std::array<std::atomic<uint64_t>, std::enum_value(GenerationStage::Max)> _stageMicros {};
+	std::atomic_int _generatedChunks { 0 };
+
 	// don't access the volume in anything that is called here
 	void create(PagedVolume::PagerContext& ctx);
 
@@ -70,6 +84,15 @@ public:
 	 */
 	bool pageIn(PagedVolume::PagerContext& ctx) override;
 	void pageOut(PagedVolume::Chunk* chunk) override;
+
+	/**
+	 * @return The accumulated time in milliseconds the given stage took for all chunks that were generated by this pager
+	 */
+	double stageMillis(GenerationStage stage) const;
+	/**
+	 * @return The amount of chunks that were generated - loaded chunks are not counted
+	 */
+	int generatedChunks() const;
 };
 
 }
@@ -0,0 +1,91 @@
+/**
+ * @file
+ */
+
+#include "voxel/tests/AbstractVoxelTest.h"
+#include "core/tests/Benchmark.h"
+#include "voxel/generator/WorldGenerator.h"
+#include "voxel/polyvox/AStarPathfinder.h"
+#include "voxel/polyvox/RawVolumeWrapper.h"
+#include "voxel/BiomeManager.h"
+#include <string>
+
+namespace voxel {
+
+class AStarPathfinderBenchmark: public AbstractVoxelTest {
+protected:
+	BiomeManager _biomeManager;
+	WorldContext _worldCtx;
+	// long enough for the 256 voxel paths
+	const Region _region { glm::ivec3(0), glm::ivec3(287, MAX_TERRAIN_HEIGHT - 1, 63) };
+	RawVolume* _volume = nullptr;
+
+	// walk on the surface - an air voxel with ground at most two voxels below
+	static bool isWalkable(const RawVolume* volume, const glm::ivec3& pos) {
+		const Region& region = volume->getRegion();
+		if (!region.containsPoint(pos) || pos.y < 2) {
+			return false;
+		}
+		if (isBlocked(volume->getVoxel(pos).getMaterial())) {
+			return false;
+		}
+		return isBlocked(volume->getVoxel(pos.x, pos.y - 1, pos.z).getMaterial())
+				|| isBlocked(volume->getVoxel(pos.x, pos.y - 2, pos.z).getMaterial());
+	}
+
+	glm::ivec3 surface(int x, int z) const {
+		for (int y = _region.getUpperY(); y > 0; --y) {
+			if (isBlocked(_volume->getVoxel(x, y - 1, z).getMaterial())) {
+				return glm::ivec3(x, y, z);
+			}
+		}
+		return glm::ivec3(x, 0, z);
+	}
+
+	void benchmarkPath(int length) {
+		const int z = _region.getCentreZ();
+		const glm::ivec3 start = surface(16, z);
+		const glm::ivec3 end = surface(16 + length, z);
+		std::vector<glm::ivec3> path;
+		AStarPathfinderParams<RawVolume> params(_volume, start, end, &path, 1.0f, 1000000, TwentySixConnected, &isWalkable);
+		AStarPathfinder<RawVolume> pathfinder(params);
+		bool found = false;
+		const std::string name = "findPath" + std::to_string(length);
+		core::measure(name.c_str(), 10, [&] () {
+			found = pathfinder.execute();
+		});
+		std::printf("[ BENCHMARK] %s: found: %s, path length: %i\n", name.c_str(), found ? "true" : "false", (int)path.size());
+	}
+
+public:
+	void SetUp() override {
+		AbstractVoxelTest::SetUp();
+		const io::FilesystemPtr& filesystem = _testApp->filesystem();
+		ASSERT_TRUE(_biomeManager.init(filesystem->load("biomes.lua")));
+		ASSERT_TRUE(_worldCtx.load(filesystem->load("world.lua")));
+		world::WorldGenerator generator(_biomeManager, _seed);
+		_volume = new RawVolume(_region);
+		RawVolumeWrapper wrapper(_volume);
+		generator.createWorld(_worldCtx, wrapper, 0, 0);
+	}
+
+	void TearDown() override {
+		delete _volume;
+		_volume = nullptr;
+		AbstractVoxelTest::TearDown();
+	}
+};
+
+TEST_F(AStarPathfinderBenchmark, benchmarkFindPath16) {
+	benchmarkPath(16);
+}
+
+TEST_F(AStarPathfinderBenchmark, benchmarkFindPath64) {
+	benchmarkPath(64);
+}
+
+TEST_F(AStarPathfinderBenchmark, benchmarkFindPath256) {
+	benchmarkPath(256);
+}
+
+}
@@ -0,0 +1,74 @@
+/**
+ * @file
+ */
+
+#include "voxel/tests/AbstractVoxelTest.h"
+#include "core/tests/Benchmark.h"
+#include "voxel/polyvox/CubicSurfaceExtractor.h"
+#include "voxel/polyvox/BinaryGreedyMeshExtractor.h"
+#include "voxel/IsQuadNeeded.h"
+
+namespace voxel {
+
+class CubicSurfaceExtractorBenchmark: public AbstractVoxelTest {
+};
+
+TEST_F(CubicSurfaceExtractorBenchmark, benchmarkExtractCubicMesh) {
+	Mesh mesh(128, 128, true);
+	// the region spans several chunks to also measure the chunk lookups at the borders
+	const Region region(glm::ivec3(-32), glm::ivec3(95));
+	core::measure("extractCubicMesh", 10, [&] () {
+		mesh.clear();
+		extractCubicMesh(&_volData, region, &mesh, IsQuadNeeded());
+	});
+	EXPECT_GT(mesh.getNoOfIndices(), 0u);
+}
+
+TEST_F(CubicSurfaceExtractorBenchmark, benchmarkExtractBinaryGreedyMesh) {
+	Mesh mesh(128, 128, true);
+	const Region region(glm::ivec3(-32), glm::ivec3(95));
+	core::measure("extractBinaryGreedyMesh", 10, [&] () {
+		mesh.clear();
+		extractBinaryGreedyMesh(&_volData, region, &mesh, IsQuadNeeded());
+	});
+	EXPECT_GT(mesh.getNoOfIndices(), 0u);
+}
+
+TEST_F(CubicSurfaceExtractorBenchmark, benchmarkSamplerPeek) {
+	const Region region(glm::ivec3(-32), glm::ivec3(95));
+	int solid = 0;
+	core::measure("samplerPeek", 10, [&] () {
+		PagedVolume::Sampler sampler(&_volData);
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				sampler.setPosition(region.getLowerX(), y, z);
+				for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					if (!isAir(sampler.peekVoxel1px0py0pz().getMaterial())) {
+						++solid;
+					}
+					sampler.movePositiveX();
+				}
+			}
+		}
+	});
+	EXPECT_GT(solid, 0);
+}
+
+TEST_F(CubicSurfaceExtractorBenchmark, benchmarkVolumeGetVoxel) {
+	const Region region(glm::ivec3(-32), glm::ivec3(95));
+	int solid = 0;
+	core::measure("volumeGetVoxel", 10, [&] () {
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					if (!isAir(_volData.getVoxel(x, y, z).getMaterial())) {
+						++solid;
+					}
+				}
+			}
+		}
+	});
+	EXPECT_GT(solid, 0);
+}
+
+}
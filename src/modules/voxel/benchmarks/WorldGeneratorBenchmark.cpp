@@ -0,0 +1,100 @@
+/**
+ * @file
+ */
+
+#include "voxel/tests/AbstractVoxelTest.h"
+#include "core/tests/Benchmark.h"
+#include "voxel/generator/WorldGenerator.h"
+#include "voxel/polyvox/RawVolumeWrapper.h"
+#include "voxel/BiomeManager.h"
+#include "noise/Noise.h"
+
+namespace voxel {
+
+class WorldGeneratorBenchmark: public AbstractVoxelTest {
+protected:
+	BiomeManager _biomeManager;
+	WorldContext _worldCtx;
+	// one chunk with the full terrain height
+	const Region _region { glm::ivec3(0), glm::ivec3(63, MAX_TERRAIN_HEIGHT - 1, 63) };
+
+	int fillVoxelsScalar(const world::WorldGenerator& generator, int x, int lowerY, int z, Voxel* voxels, int noiseSeedOffsetX, int noiseSeedOffsetZ, int maxHeight) const {
+		const glm::vec2 noisePos2d(noiseSeedOffsetX + x, noiseSeedOffsetZ + z);
+		const float n = generator.getHeight(noisePos2d, _worldCtx);
+		const int ni = generator.getTerrainHeight(x, lowerY, z, n, maxHeight);
+		if (ni < lowerY) {
+			return 0;
+		}
+		float caveNoise[MAX_TERRAIN_HEIGHT];
+		for (int y = ni - 1; y >= lowerY + 1; --y) {
+			const glm::vec3 noisePos3d(noisePos2d.x, y, noisePos2d.y);
+			caveNoise[y] = ::noise::Noise3D(noisePos3d, _worldCtx.caveNoiseOctaves, _worldCtx.caveNoisePersistence,
+					_worldCtx.caveNoiseFrequency, _worldCtx.caveNoiseAmplitude);
+		}
+		return generator.fillVoxels(x, lowerY, z, _worldCtx, voxels, n, ni, caveNoise);
+	}
+
+	/**
+	 * @brief Reference implementation of WorldGenerator::createWorld() that evaluates the noise for each voxel separately
+	 */
+	template<class Volume>
+	void createWorldScalar(const world::WorldGenerator& generator, Volume& volume, int noiseSeedOffsetX, int noiseSeedOffsetZ) const {
+		const Region& region = volume.getRegion();
+		const int width = region.getWidthInVoxels();
+		const int depth = region.getDepthInVoxels();
+		const int lowerX = region.getLowerX();
+		const int lowerY = region.getLowerY();
+		const int lowerZ = region.getLowerZ();
+		Voxel voxels[MAX_TERRAIN_HEIGHT];
+
+		const int size = 2;
+		for (int z = lowerZ; z < lowerZ + depth; z += size) {
+			for (int x = lowerX; x < lowerX + width; x += size) {
+				const int ni = fillVoxelsScalar(generator, x, lowerY, z, voxels, noiseSeedOffsetX, noiseSeedOffsetZ, MAX_TERRAIN_HEIGHT - 1);
+				volume.setVoxels(x, lowerY, z, size, size, voxels, ni);
+			}
+		}
+	}
+
+public:
+	void SetUp() override {
+		AbstractVoxelTest::SetUp();
+		const io::FilesystemPtr& filesystem = _testApp->filesystem();
+		ASSERT_TRUE(_biomeManager.init(filesystem->load("biomes.lua")));
+		ASSERT_TRUE(_worldCtx.load(filesystem->load("world.lua")));
+	}
+};
+
+TEST_F(WorldGeneratorBenchmark, benchmarkCreateWorld) {
+	world::WorldGenerator generator(_biomeManager, _seed);
+	RawVolume scalarVolume(_region);
+	RawVolume batchedVolume(_region);
+	RawVolumeWrapper scalarWrapper(&scalarVolume);
+	RawVolumeWrapper batchedWrapper(&batchedVolume);
+	int offset = 0;
+	core::measure("createWorldScalar", 10, [&] () {
+		createWorldScalar(generator, scalarWrapper, offset, offset);
+	});
+	core::measure("createWorld", 10, [&] () {
+		generator.createWorld(_worldCtx, batchedWrapper, offset, offset);
+	});
+
+	for (offset = 0; offset < 4096; offset += 1024) {
+		scalarVolume.clear();
+		batchedVolume.clear();
+		createWorldScalar(generator, scalarWrapper, offset, offset);
+		generator.createWorld(_worldCtx, batchedWrapper, offset, offset);
+		for (int z = _region.getLowerZ(); z <= _region.getUpperZ(); ++z) {
+			for (int y = _region.getLowerY(); y <= _region.getUpperY(); ++y) {
+				for (int x = _region.getLowerX(); x <= _region.getUpperX(); ++x) {
+					const Voxel& expected = scalarVolume.getVoxel(x, y, z);
+					const Voxel& voxel = batchedVolume.getVoxel(x, y, z);
+					ASSERT_TRUE(expected.isSame(voxel)) << "Batched noise differs at " << x << ":" << y << ":" << z
+							<< " with noise offset " << offset << " - expected " << expected << " but got " << voxel;
+				}
+			}
+		}
+	}
+}
+
+}
@@ -150,6 +150,7 @@ int VoxelFont::render(const char* string, std::vector<glm::vec4>& pos, std::vect
 
 int VoxelFont::render(const char* string, std::vector<voxel::VoxelVertex>& vertices, std::vector<uint32_t>& indices) {
 	return render(string, vertices, indices, [] (const voxel::VoxelVertex& vertex, std::vector<voxel::VoxelVertex>& vertices, int x, int y) {
+		core_assert_msg(vertex.position.x + x <= 255 && vertex.position.y + y <= 255, "The string exceeds the vertex data type");
 		voxel::VoxelVertex copy = vertex;
 		copy.position.x += x;
 		copy.position.y += y;
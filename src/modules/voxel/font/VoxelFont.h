@@ -103,6 +103,9 @@ public:
 	void shutdown();
 
 	int render(const char* string, std::vector<glm::vec4>& pos, std::vector<uint32_t>& indices);
+	/**
+	 * @note The vertex positions are limited to 0-255 - use the @c glm::vec4 version for larger strings
+	 */
 	int render(const char* string, std::vector<voxel::VoxelVertex>& vertices, std::vector<uint32_t>& indices);
 };
 
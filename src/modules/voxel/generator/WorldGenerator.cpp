@@ -1,5 +1,6 @@
 #include "WorldGenerator.h"
 #include "noise/Noise.h"
+#include <vector>
 
 namespace voxel {
 namespace world {
@@ -20,26 +21,56 @@ float WorldGenerator::getHeight(const glm::vec2& noisePos2d, const WorldContext&
 	return n;
 }
 
-int WorldGenerator::fillVoxels(int x, int lowerY, int z, const WorldContext& worldCtx, Voxel* voxels, int noiseSeedOffsetX, int noiseSeedOffsetZ, int maxHeight) const {
-	const glm::vec2 noisePos2d(noiseSeedOffsetX + x, noiseSeedOffsetZ + z);
-	const float n = getHeight(noisePos2d, worldCtx);
+void WorldGenerator::getHeights(const float* noiseX, const float* noiseZ, float* heights, int amount, const WorldContext& worldCtx) const {
+	std::vector<float> mountainNoise(amount);
+	::noise::Noise2D(noiseX, noiseZ, heights, amount, worldCtx.landscapeNoiseOctaves,
+			worldCtx.landscapeNoisePersistence, worldCtx.landscapeNoiseFrequency, worldCtx.landscapeNoiseAmplitude);
+	::noise::Noise2D(noiseX, noiseZ, mountainNoise.data(), amount, worldCtx.mountainNoiseOctaves,
+			worldCtx.mountainNoisePersistence, worldCtx.mountainNoiseFrequency, worldCtx.mountainNoiseAmplitude);
+	for (int i = 0; i < amount; ++i) {
+		const float noiseNormalized = ::noise::norm(heights[i]);
+		const float mountainNoiseNormalized = ::noise::norm(mountainNoise[i]);
+		const float mountainMultiplier = mountainNoiseNormalized * (mountainNoiseNormalized + 0.5f);
+		heights[i] = glm::clamp(noiseNormalized * mountainMultiplier, 0.0f, 1.0f);
+	}
+}
+
+int WorldGenerator::getTerrainHeight(int x, int lowerY, int z, float n, int maxHeight) const {
 	const glm::ivec3 noisePos3d(x, lowerY, z);
 	const float cityMultiplier = _biomeManager.getCityMultiplier(noisePos3d);
-	const int ni = n * cityMultiplier * maxHeight;
+	return n * cityMultiplier * maxHeight;
+}
+
+int WorldGenerator::fillVoxels(int x, int lowerY, int z, const WorldContext& worldCtx, Voxel* voxels, const glm::vec2& noisePos2d, float n, int maxHeight) const {
+	const int ni = getTerrainHeight(x, lowerY, z, n, maxHeight);
 	if (ni < lowerY) {
 		return 0;
 	}
+	float caveNoise[MAX_TERRAIN_HEIGHT];
+	const int amount = ni - 1 - lowerY;
+	if (amount > 0) {
+		float noiseX[MAX_TERRAIN_HEIGHT];
+		float noiseY[MAX_TERRAIN_HEIGHT];
+		float noiseZ[MAX_TERRAIN_HEIGHT];
+		for (int i = 0; i < amount; ++i) {
+			noiseX[i] = noisePos2d.x;
+			noiseY[i] = lowerY + 1 + i;
+			noiseZ[i] = noisePos2d.y;
+		}
+		::noise::Noise3D(noiseX, noiseY, noiseZ, &caveNoise[lowerY + 1], amount, worldCtx.caveNoiseOctaves,
+				worldCtx.caveNoisePersistence, worldCtx.caveNoiseFrequency, worldCtx.caveNoiseAmplitude);
+	}
+	return fillVoxels(x, lowerY, z, worldCtx, voxels, n, ni, caveNoise);
+}
 
+int WorldGenerator::fillVoxels(int x, int lowerY, int z, const WorldContext& worldCtx, Voxel* voxels, float n, int ni, const float* caveNoise) const {
 	const Voxel& water = createColorVoxel(VoxelType::Water, _seed);
 	const Voxel& dirt = createColorVoxel(VoxelType::Dirt, _seed);
 	static constexpr Voxel air;
 
 	voxels[0] = dirt;
 	for (int y = ni - 1; y >= lowerY + 1; --y) {
-		const glm::vec3 noisePos3d(noisePos2d.x, y, noisePos2d.y);
-		const float noiseVal = ::noise::norm(
-				::noise::Noise3D(noisePos3d, worldCtx.caveNoiseOctaves, worldCtx.caveNoisePersistence,
-						worldCtx.caveNoiseFrequency, worldCtx.caveNoiseAmplitude));
+		const float noiseVal = ::noise::norm(caveNoise[y]);
 		const float finalDensity = n + noiseVal;
 		if (finalDensity > worldCtx.caveDensityThreshold) {
 			const bool cave = y < ni - 1;
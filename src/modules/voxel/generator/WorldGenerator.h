@@ -13,8 +13,12 @@
 #include "voxel/Constants.h"
 #include "voxel/WorldContext.h"
 #include "voxel/MaterialColor.h"
+#include <vector>
 
 namespace voxel {
+
+class WorldGeneratorBenchmark;
+
 namespace world {
 
 constexpr int WORLDGEN_TREES = 1 << 0;
@@ -25,12 +29,25 @@ constexpr int WORLDGEN_SERVER = WORLDGEN_TREES;
 
 class WorldGenerator {
 private:
+	// compares the batched noise passes with a scalar reference implementation
+	friend class ::voxel::WorldGeneratorBenchmark;
+
 	BiomeManager& _biomeManager;
 	long _seed;
 	core::Random _random;
 
-	int fillVoxels(int x, int y, int z, const WorldContext& worldCtx, Voxel* voxels, int noiseSeedOffsetX, int noiseSeedOffsetZ, int maxHeight) const;
+	/**
+	 * @brief Evaluates the cave noise for the whole column in one batched noise pass
+	 * @param[in] n The height factor of the column as returned by getHeights()
+	 */
+	int fillVoxels(int x, int y, int z, const WorldContext& worldCtx, Voxel* voxels, const glm::vec2& noisePos2d, float n, int maxHeight) const;
+	int fillVoxels(int x, int y, int z, const WorldContext& worldCtx, Voxel* voxels, float n, int ni, const float* caveNoise) const;
+	int getTerrainHeight(int x, int y, int z, float n, int maxHeight) const;
 	float getHeight(const glm::vec2& noisePos2d, const WorldContext& worldCtx) const;
+	/**
+	 * @brief Batched version of getHeight() for @c amount columns
+	 */
+	void getHeights(const float* noiseX, const float* noiseZ, float* heights, int amount, const WorldContext& worldCtx) const;
 public:
 	WorldGenerator(BiomeManager& biomeManager, long seed = 0);
 
@@ -73,9 +90,26 @@ public:
 		const int size = 2;
 		core_assert(depth % size == 0);
 		core_assert(width % size == 0);
+
+		// the height of all columns is calculated in one batched noise pass
+		const int columns = (width / size) * (depth / size);
+		std::vector<float> noiseX(columns);
+		std::vector<float> noiseZ(columns);
+		std::vector<float> heights(columns);
+		int column = 0;
+		for (int z = lowerZ; z < lowerZ + depth; z += size) {
+			for (int x = lowerX; x < lowerX + width; x += size, ++column) {
+				noiseX[column] = noiseSeedOffsetX + x;
+				noiseZ[column] = noiseSeedOffsetZ + z;
+			}
+		}
+		getHeights(noiseX.data(), noiseZ.data(), heights.data(), columns, worldCtx);
+
+		column = 0;
 		for (int z = lowerZ; z < lowerZ + depth; z += size) {
-			for (int x = lowerX; x < lowerX + width; x += size) {
-				const int ni = fillVoxels(x, lowerY, z, worldCtx, voxels, noiseSeedOffsetX, noiseSeedOffsetZ, MAX_TERRAIN_HEIGHT - 1);
+			for (int x = lowerX; x < lowerX + width; x += size, ++column) {
+				const glm::vec2 noisePos2d(noiseX[column], noiseZ[column]);
+				const int ni = fillVoxels(x, lowerY, z, worldCtx, voxels, noisePos2d, heights[column], MAX_TERRAIN_HEIGHT - 1);
 				volume.setVoxels(x, lowerY, z, size, size, voxels, ni);
 			}
 		}
@@ -9,31 +9,55 @@
 
 namespace voxel {
 
-static bool doExport(Assimp::Exporter& exporter, const Mesh* mesh, const char *exporterId, const char *filename) {
+static bool doExport(Assimp::Exporter& exporter, const std::vector<const Mesh*>& meshes, const char *exporterId, const char *filename) {
 	aiScene aiscene;
 	aiMesh aimesh;
 	aiNode airootnode;
 	aiMaterial aimaterial;
 
-	aimesh.mNumVertices = mesh->getNoOfVertices();
+	size_t numVertices = 0u;
+	size_t numIndices = 0u;
+	for (const Mesh* mesh : meshes) {
+		numVertices += mesh->getNoOfVertices();
+		numIndices += mesh->getNoOfIndices();
+	}
+	core_assert(numIndices % 3 == 0);
+
+	aimesh.mNumVertices = numVertices;
 	aiVector3D* vertices = new aiVector3D[aimesh.mNumVertices];
-	const voxel::VoxelVertex* voxels = mesh->getRawVertexData();
-	for (size_t i = 0; i < aimesh.mNumVertices; ++i) {
-		const voxel::VoxelVertex& v = voxels[i];
-		vertices[i] = aiVector3D(v.position.x, v.position.y, v.position.z);
+	aiColor4D* colors = new aiColor4D[aimesh.mNumVertices];
+	unsigned int* indices = new unsigned int[numIndices];
+	const MaterialColorArray& colorArray = getMaterialColors();
+	unsigned int vertexOffset = 0u;
+	unsigned int indexOffset = 0u;
+	for (const Mesh* mesh : meshes) {
+		const voxel::VoxelVertex* voxels = mesh->getRawVertexData();
+		const glm::ivec3& offset = mesh->getOffset();
+		const size_t meshVertices = mesh->getNoOfVertices();
+		for (size_t i = 0; i < meshVertices; ++i) {
+			const voxel::VoxelVertex& v = voxels[i];
+			const glm::ivec3 pos = glm::ivec3(v.position) + offset;
+			vertices[vertexOffset + i] = aiVector3D(pos.x, pos.y, pos.z);
+			const glm::vec4& c = colorArray[v.colorIndex];
+			colors[vertexOffset + i] = aiColor4D(c.r, c.g, c.b, c.a);
+		}
+		const IndexType* rawIndexData = mesh->getRawIndexData();
+		const size_t meshIndices = mesh->getNoOfIndices();
+		for (size_t i = 0; i < meshIndices; ++i) {
+			indices[indexOffset + i] = rawIndexData[i] + vertexOffset;
+		}
+		vertexOffset += meshVertices;
+		indexOffset += meshIndices;
 	}
 	aimesh.mName = "";
 	aimesh.mVertices = vertices;
 
-	unsigned int* rawIndexData = const_cast<unsigned int*>(mesh->getRawIndexData());
-	const unsigned int numIndices = (unsigned int)mesh->getNoOfIndices();
 	aimesh.mNumFaces = numIndices / 3;
 	aiFace* aifaces = aimesh.mFaces = new aiFace[aimesh.mNumFaces];
-	core_assert(numIndices % 3 == 0);
-	for (unsigned int i = 0, faceindex = 0; i < numIndices; i += 3, rawIndexData += 3, ++faceindex) {
+	for (unsigned int faceindex = 0; faceindex < aimesh.mNumFaces; ++faceindex) {
 		aiFace& aiface = aifaces[faceindex];
 		aiface.mNumIndices = 3;
-		aiface.mIndices = rawIndexData;
+		aiface.mIndices = &indices[faceindex * 3];
 	}
 
 	aiscene.mNumMaterials = 1;
@@ -44,13 +68,6 @@ static bool doExport(Assimp::Exporter& exporter, const Mesh* mesh, const char *e
 	aiscene.mMeshes = aimeshes;
 	aiscene.mNumMeshes = 1;
 
-	const MaterialColorArray& colorArray = getMaterialColors();
-	aiColor4D* colors = new aiColor4D[aimesh.mNumVertices];
-	for (unsigned int i = 0; i < aimesh.mNumVertices; ++i) {
-		const voxel::VoxelVertex& v = voxels[i];
-		const glm::vec4& c = colorArray[v.colorIndex];
-		colors[i] = aiColor4D(c.r, c.g, c.b, c.a);
-	}
 	aimesh.mColors[0] = colors;
 
 	airootnode.mName = "<DummyRootNode>";
@@ -79,6 +96,7 @@ static bool doExport(Assimp::Exporter& exporter, const Mesh* mesh, const char *e
 
 	delete[] vertices;
 	delete[] colors;
+	delete[] indices;
 	delete[] aifaces;
 
 	aiFreeScene(exportScene);
@@ -86,7 +104,7 @@ static bool doExport(Assimp::Exporter& exporter, const Mesh* mesh, const char *e
 	return ret == aiReturn_SUCCESS;
 }
 
-bool exportMesh(const Mesh* mesh, const char *filename) {
+static bool exportMeshes(const std::vector<const Mesh*>& meshes, const char *filename) {
 	const char* ext = SDL_strrchr(filename, '.');
 	if (ext == nullptr) {
 		Log::error("Could not determine the target format - no file extension was provided");
@@ -98,7 +116,13 @@ bool exportMesh(const Mesh* mesh, const char *filename) {
 		return false;
 	}
 
-	if (mesh->getNoOfVertices() == 0 || mesh->getNoOfIndices() == 0) {
+	std::vector<const Mesh*> nonEmpty;
+	for (const Mesh* mesh : meshes) {
+		if (!mesh->isEmpty()) {
+			nonEmpty.push_back(mesh);
+		}
+	}
+	if (nonEmpty.empty()) {
 		Log::error("Nothing to export - the voxel mesh is empty");
 		return false;
 	}
@@ -110,7 +134,7 @@ bool exportMesh(const Mesh* mesh, const char *filename) {
 		const aiExportFormatDesc* desc = exporter.GetExportFormatDescription(i);
 		if (!strcmp(ext, desc->fileExtension)) {
 			Log::debug("Export %s to %s (%s)", ext, desc->id, desc->description);
-			return doExport(exporter, mesh, desc->id, filename);
+			return doExport(exporter, nonEmpty, desc->id, filename);
 		} else {
 			Log::debug("Don't export %s to %s (%s, '%s')", ext, desc->id, desc->description, desc->fileExtension);
 		}
@@ -119,4 +143,12 @@ bool exportMesh(const Mesh* mesh, const char *filename) {
 	return false;
 }
 
+bool exportMesh(const Mesh* mesh, const char *filename) {
+	return exportMeshes(std::vector<const Mesh*>{mesh}, filename);
+}
+
+bool exportMesh(const std::vector<Mesh*>& meshes, const char *filename) {
+	return exportMeshes(std::vector<const Mesh*>(meshes.begin(), meshes.end()), filename);
+}
+
 }
@@ -5,5 +5,9 @@
 namespace voxel {
 
 extern bool exportMesh(const Mesh* mesh, const char *filename);
+/**
+ * @brief Exports the given meshes into one mesh - the vertex positions are moved by the offset of their mesh
+ */
+extern bool exportMesh(const std::vector<Mesh*>& meshes, const char *filename);
 
 }
@@ -8,8 +8,10 @@
 #include "core/Common.h"
 #include "core/GLM.h"
 
+#include <algorithm>
+#include <atomic>
 #include <functional>
-#include <list>
+#include <vector>
 
 namespace voxel {
 
@@ -26,7 +28,7 @@ bool aStarDefaultVoxelValidator(const VolumeType* volData, const glm::ivec3& v3d
  * This structure stores the AStarPathfinder%s configuration options, because this
  * is simpler than providing a large number of get/set properties within the
  * AStarPathfinder itself. In order to create an instance of this structure you
- * must provide at least a volume, a start and end point, and a list to store
+ * must provide at least a volume, a start and end point, and a vector to store
  * the result. All the other option have sensible default values which can
  * optionally be changed for more precise control over the pathfinder's behaviour.
  *
@@ -35,11 +37,11 @@ bool aStarDefaultVoxelValidator(const VolumeType* volData, const glm::ivec3& v3d
 template<typename VolumeType>
 struct AStarPathfinderParams {
 public:
-	AStarPathfinderParams(VolumeType* volData, const glm::ivec3& v3dStart, const glm::ivec3& v3dEnd, std::list<glm::ivec3>* listResult, float fHBias = 1.0,
+	AStarPathfinderParams(VolumeType* volData, const glm::ivec3& v3dStart, const glm::ivec3& v3dEnd, std::vector<glm::ivec3>* vecResult, float fHBias = 1.0,
 			uint32_t uMaxNoOfNodes = 10000, Connectivity requiredConnectivity = TwentySixConnected,
 			std::function<bool(const VolumeType*, const glm::ivec3&)> funcIsVoxelValidForPath = &aStarDefaultVoxelValidator, std::function<void(float)> funcProgressCallback =
 					nullptr) :
-			volume(volData), start(v3dStart), end(v3dEnd), result(listResult), connectivity(requiredConnectivity), hBias(fHBias), maxNumberOfNodes(uMaxNoOfNodes), isVoxelValidForPath(
+			volume(volData), start(v3dStart), end(v3dEnd), result(vecResult), connectivity(requiredConnectivity), hBias(fHBias), maxNumberOfNodes(uMaxNoOfNodes), isVoxelValidForPath(
 					funcIsVoxelValidForPath), progressCallback(funcProgressCallback) {
 	}
 
@@ -53,8 +55,8 @@ public:
 	glm::ivec3 end;
 
 	/// The resulting path will be stored as a series of points in
-	/// this list. Any existing contents will be cleared.
-	std::list<glm::ivec3>* result;
+	/// this vector. Any existing contents will be cleared.
+	std::vector<glm::ivec3>* result;
 
 	/// The AStarPathfinder performs its search by examining the neighbours
 	/// of each voxel it encounters. This property controls the meaning of
@@ -91,6 +93,10 @@ public:
 	/// end node. This progress value is guaranteed to never decrease, but it may stop increasing
 	/// for short periods of time. It may even stop increasing altogether if a path cannot be found.
 	std::function<void(float)> progressCallback;
+
+	/// If this flag is set while the search is running, the search is aborted and
+	/// AStarPathfinder::execute() returns false.
+	const std::atomic_bool* cancelled = nullptr;
 };
 
 /**
@@ -112,9 +118,13 @@ public:
  * in the documentation for that class.
  *
  * Next you call the execute() function and wait for it to return. If a path is
- * found then this is stored in the list which was set as the 'result' field of
+ * found then this is stored in the vector which was set as the 'result' field of
  * the AStarPathfinderParams.
  *
+ * The nodes and the open list live in a thread local AStarArena, so the memory of
+ * one search is reused by the next search on the same thread. The open list is an
+ * indexed binary heap, the closed state is a flag of the node.
+ *
  * @sa AStarPathfinderParams
  */
 template<typename VolumeType>
@@ -133,13 +143,12 @@ private:
 	float computeH(const glm::ivec3& a, const glm::ivec3& b);
 	uint32_t hash(uint32_t a);
 
-	// Node containers
-	AllNodesContainer _allNodes;
-	OpenNodesContainer _openNodes;
-	ClosedNodesContainer _closedNodes;
+	// Node containers of the thread local arena
+	NodePool* _nodes = nullptr;
+	OpenNodesContainer* _openNodes = nullptr;
 
-	// The current node
-	AllNodesContainer::iterator _current;
+	// The index of the current node
+	int32_t _current = -1;
 
 	float _progress = 0.0f;
 
@@ -202,118 +211,100 @@ AStarPathfinder<VolumeType>::AStarPathfinder(const AStarPathfinderParams<VolumeT
 
 template<typename VolumeType>
 bool AStarPathfinder<VolumeType>::execute() {
-	//Clear any existing nodes
-	_allNodes.clear();
-	_openNodes.clear();
-	_closedNodes.clear();
+	AStarArena& arena = AStarArena::get();
+	_nodes = &arena.nodes;
+	_openNodes = &arena.open;
+	_nodes->clear();
+	_openNodes->clear(_nodes);
 
 	//Clear the result
 	_params.result->clear();
 
-	//Iterators to start and end node.
-	AllNodesContainer::iterator startNode = _allNodes.insert(Node(_params.start.x, _params.start.y, _params.start.z)).first;
-	AllNodesContainer::iterator endNode = _allNodes.insert(Node(_params.end.x, _params.end.y, _params.end.z)).first;
-
-	//Regarding the const_cast - normally you should not modify an object which is in an sdt::set.
-	//The reason is that objects in a set are stored sorted in a tree so they can be accessed quickly,
-	//and changing the object directly can break the sorting. However, in our case we have provided a
-	//custom sort operator for the set which we know only uses the position to sort. Hence we can safely
-	//modify other properties of the object while it is in the set.
-	Node* tempStart = const_cast<Node*>(&(*startNode));
-	tempStart->gVal = 0;
-	tempStart->hVal = computeH(startNode->position, endNode->position);
+	if (_params.start == _params.end) {
+		_params.result->push_back(_params.start);
+		return true;
+	}
 
-	Node* tempEnd = const_cast<Node*>(&(*endNode));
-	tempEnd->hVal = 0.0f;
+	bool inserted;
+	const int32_t startNode = _nodes->insert(_params.start, inserted);
+	Node& start = (*_nodes)[startNode];
+	start.gVal = 0.0f;
+	start.hVal = computeH(_params.start, _params.end);
+	// the end node has no estimated distance - it's reached once it is the first node of the open list
+	const int32_t endNode = _nodes->insert(_params.end, inserted);
 
-	_openNodes.insert(startNode);
+	_openNodes->insert(startNode);
 
-	float fDistStartToEnd = (endNode->position - startNode->position).length();
+	const float fDistStartToEnd = glm::length(glm::vec3(_params.end - _params.start));
 	_progress = 0.0f;
 	if (_params.progressCallback) {
 		_params.progressCallback(_progress);
 	}
 
-	while (!_openNodes.empty() && _openNodes.getFirst() != endNode) {
+	//The distance from one cell to another connected by face, edge, or corner.
+	const float fFaceCost = 1.0f;
+	const float fEdgeCost = glm::root_two<float>();
+	const float fCornerCost = glm::root_three<float>();
+
+	while (!_openNodes->empty() && _openNodes->getFirst() != endNode) {
+		if (_params.cancelled != nullptr && *_params.cancelled) {
+			return false;
+		}
 		//Move the first node from open to closed.
-		_current = _openNodes.getFirst();
-		_openNodes.removeFirst();
-		_closedNodes.insert(_current);
+		_current = _openNodes->getFirst();
+		_openNodes->removeFirst();
+		(*_nodes)[_current].closed = true;
+		// the node references are invalidated by adding neighbours - keep a copy
+		const glm::ivec3 currentPos = (*_nodes)[_current].position;
+		const float currentGVal = (*_nodes)[_current].gVal;
 
 		//Update the user on our progress
 		if (_params.progressCallback) {
 			const float fMinProgresIncreament = 0.001f;
-			float fDistCurrentToEnd = (endNode->position - _current->position).length();
-			float fDistNormalised = fDistCurrentToEnd / fDistStartToEnd;
-			float fProgress = 1.0f - fDistNormalised;
+			const float fDistCurrentToEnd = glm::length(glm::vec3(_params.end - currentPos));
+			const float fDistNormalised = fDistCurrentToEnd / fDistStartToEnd;
+			const float fProgress = 1.0f - fDistNormalised;
 			if (fProgress >= _progress + fMinProgresIncreament) {
 				_progress = fProgress;
 				_params.progressCallback(_progress);
 			}
 		}
 
-		//The distance from one cell to another connected by face, edge, or corner.
-		const float fFaceCost = 1.0f;
-		const float fEdgeCost = glm::root_two<float>();
-		const float fCornerCost = glm::root_three<float>();
-
 		//Process the neighbours. Note the deliberate lack of 'break'
 		//statements, larger connectivities include smaller ones.
 		switch (_params.connectivity) {
 		case TwentySixConnected:
-			processNeighbour(_current->position + arrayPathfinderCorners[0], _current->gVal + fCornerCost);
-			processNeighbour(_current->position + arrayPathfinderCorners[1], _current->gVal + fCornerCost);
-			processNeighbour(_current->position + arrayPathfinderCorners[2], _current->gVal + fCornerCost);
-			processNeighbour(_current->position + arrayPathfinderCorners[3], _current->gVal + fCornerCost);
-			processNeighbour(_current->position + arrayPathfinderCorners[4], _current->gVal + fCornerCost);
-			processNeighbour(_current->position + arrayPathfinderCorners[5], _current->gVal + fCornerCost);
-			processNeighbour(_current->position + arrayPathfinderCorners[6], _current->gVal + fCornerCost);
-			processNeighbour(_current->position + arrayPathfinderCorners[7], _current->gVal + fCornerCost);
-
+			for (const glm::ivec3& corner : arrayPathfinderCorners) {
+				processNeighbour(currentPos + corner, currentGVal + fCornerCost);
+			}
+			/* fallthrough */
 		case EighteenConnected:
-			processNeighbour(_current->position + arrayPathfinderEdges[0], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + arrayPathfinderEdges[1], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + arrayPathfinderEdges[2], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + arrayPathfinderEdges[3], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + arrayPathfinderEdges[4], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + arrayPathfinderEdges[5], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + arrayPathfinderEdges[6], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + arrayPathfinderEdges[7], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + arrayPathfinderEdges[8], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + arrayPathfinderEdges[9], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + arrayPathfinderEdges[10], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + arrayPathfinderEdges[11], _current->gVal + fEdgeCost);
-
+			for (const glm::ivec3& edge : arrayPathfinderEdges) {
+				processNeighbour(currentPos + edge, currentGVal + fEdgeCost);
+			}
+			/* fallthrough */
 		case SixConnected:
-			processNeighbour(_current->position + arrayPathfinderFaces[0], _current->gVal + fFaceCost);
-			processNeighbour(_current->position + arrayPathfinderFaces[1], _current->gVal + fFaceCost);
-			processNeighbour(_current->position + arrayPathfinderFaces[2], _current->gVal + fFaceCost);
-			processNeighbour(_current->position + arrayPathfinderFaces[3], _current->gVal + fFaceCost);
-			processNeighbour(_current->position + arrayPathfinderFaces[4], _current->gVal + fFaceCost);
-			processNeighbour(_current->position + arrayPathfinderFaces[5], _current->gVal + fFaceCost);
+			for (const glm::ivec3& face : arrayPathfinderFaces) {
+				processNeighbour(currentPos + face, currentGVal + fFaceCost);
+			}
 		}
 
-		if (_allNodes.size() > _params.maxNumberOfNodes) {
+		if (_nodes->size() > _params.maxNumberOfNodes) {
 			//We've reached the specified maximum number
 			//of nodes. Just give up on the search.
 			break;
 		}
 	}
 
-	if (_openNodes.empty() || _openNodes.getFirst() != endNode) {
+	if (_openNodes->empty() || _openNodes->getFirst() != endNode) {
 		//In this case we failed to find a valid path.
 		return false;
 	}
-	//Regarding the const_cast - normally you should not modify an object which is in an sdt::set.
-	//The reason is that objects in a set are stored sorted in a tree so they can be accessed quickly,
-	//and changing the object directly can break the sorting. However, in our case we have provided a
-	//custom sort operator for the set which we know only uses the position to sort. Hence we can safely
-	//modify other properties of the object while it is in the set.
-	Node* n = const_cast<Node*>(&(*endNode));
-	while (n != 0) {
-		_params.result->push_front(n->position);
-		n = n->parent;
+
+	for (int32_t n = endNode; n != -1; n = (*_nodes)[n].parent) {
+		_params.result->push_back((*_nodes)[n].position);
 	}
+	std::reverse(_params.result->begin(), _params.result->end());
 
 	if (_params.progressCallback) {
 		_params.progressCallback(1.0f);
@@ -324,51 +315,32 @@ bool AStarPathfinder<VolumeType>::execute() {
 
 template<typename VolumeType>
 void AStarPathfinder<VolumeType>::processNeighbour(const glm::ivec3& neighbourPos, float neighbourGVal) {
-	bool bIsVoxelValidForPath = _params.isVoxelValidForPath(_params.volume, neighbourPos);
+	const bool bIsVoxelValidForPath = _params.isVoxelValidForPath(_params.volume, neighbourPos);
 	if (!bIsVoxelValidForPath) {
 		return;
 	}
 
-	float cost = neighbourGVal;
-
-	std::pair<AllNodesContainer::iterator, bool> insertResult = _allNodes.insert(Node(neighbourPos.x, neighbourPos.y, neighbourPos.z));
-	AllNodesContainer::iterator neighbour = insertResult.first;
+	const float cost = neighbourGVal;
 
-	if (insertResult.second) {
+	bool inserted;
+	const int32_t neighbourIndex = _nodes->insert(neighbourPos, inserted);
+	Node& neighbour = (*_nodes)[neighbourIndex];
+	if (inserted) {
 		//New node, compute h.
-		Node* tempNeighbour = const_cast<Node*>(&(*neighbour));
-		tempNeighbour->hVal = computeH(neighbour->position, _params.end);
-	}
-
-	OpenNodesContainer::iterator openIter = _openNodes.find(neighbour);
-	if (openIter != _openNodes.end()) {
-		if (cost < neighbour->gVal) {
-			_openNodes.remove(openIter);
-			openIter = _openNodes.end();
-		}
-	}
-
-	//TODO - Nodes could keep track of if they are in open or closed? And a pointer to where they are?
-	ClosedNodesContainer::iterator closedIter = _closedNodes.find(neighbour);
-	if (closedIter != _closedNodes.end()) {
-		if (cost < neighbour->gVal) {
-			//Probably shouldn't happen?
-			_closedNodes.remove(closedIter);
-			closedIter = _closedNodes.end();
-		}
+		neighbour.hVal = computeH(neighbourPos, _params.end);
+	} else if (cost >= neighbour.gVal) {
+		return;
 	}
 
-	if (openIter == _openNodes.end() && closedIter == _closedNodes.end()) {
-		//Regarding the const_cast - normally you should not modify an object which is in an sdt::set.
-		//The reason is that objects in a set are stored sorted in a tree so they can be accessed quickly,
-		//and changing the object directly can break the sorting. However, in our case we have provided a
-		//custom sort operator for the set which we know only uses the position to sort. Hence we can safely
-		//modify other properties of the object while it is in the set.
-		Node* temp = const_cast<Node*>(&(*neighbour));
-		temp->gVal = cost;
-		_openNodes.insert(neighbour);
-		temp->parent = const_cast<Node*>(&(*_current));
+	neighbour.gVal = cost;
+	neighbour.parent = _current;
+	if (neighbour.heapIndex != -1) {
+		_openNodes->update(neighbourIndex);
+		return;
 	}
+	// a closed node is reopened if a cheaper way to it was found
+	neighbour.closed = false;
+	_openNodes->insert(neighbourIndex);
 }
 
 template<typename VolumeType>
@@ -427,12 +399,6 @@ float AStarPathfinder<VolumeType>::computeH(const glm::ivec3& a, const glm::ivec
 		core_assert_msg(false, "Connectivity parameter has an unrecognized value.");
 	}
 
-	//Sanity checks in debug mode. These can come out eventually, but I
-	//want to make sure that the heuristics I've come up with make sense.
-	core_assert_msg((a - b).length() > TwentySixConnectedCost(a, b), "A* heuristic error.");
-	core_assert_msg(TwentySixConnectedCost(a, b) > EighteenConnectedCost(a, b), "A* heuristic error.");
-	core_assert_msg(EighteenConnectedCost(a, b) > SixConnectedCost(a, b), "A* heuristic error.");
-
 	//Apply the bias to the computed h value;
 	hVal *= _params.hBias;
 
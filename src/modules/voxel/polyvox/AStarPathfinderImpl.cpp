@@ -0,0 +1,130 @@
+/**
+ * @file
+ */
+
+#include "AStarPathfinderImpl.h"
+#include <algorithm>
+
+namespace voxel {
+
+static constexpr uint32_t MinSlots = 1024u;
+
+void NodePool::clear() {
+	_nodes.clear();
+	if (_slots.empty()) {
+		_slots.resize(MinSlots);
+		_mask = MinSlots - 1u;
+	}
+	std::fill(_slots.begin(), _slots.end(), -1);
+}
+
+void NodePool::grow() {
+	const size_t slots = _slots.size() * 2u;
+	_slots.assign(slots, -1);
+	_mask = (uint32_t)slots - 1u;
+	for (size_t i = 0; i < _nodes.size(); ++i) {
+		uint32_t slot = hash(_nodes[i].position) & _mask;
+		while (_slots[slot] != -1) {
+			slot = (slot + 1u) & _mask;
+		}
+		_slots[slot] = (int32_t)i;
+	}
+}
+
+int32_t NodePool::insert(const glm::ivec3& pos, bool& inserted) {
+	core_assert_msg(!_slots.empty(), "The pool must be cleared before it is used");
+	uint32_t slot = hash(pos) & _mask;
+	for (;;) {
+		const int32_t index = _slots[slot];
+		if (index == -1) {
+			break;
+		}
+		if (_nodes[index].position == pos) {
+			inserted = false;
+			return index;
+		}
+		slot = (slot + 1u) & _mask;
+	}
+	const int32_t index = (int32_t)_nodes.size();
+	_nodes.emplace_back(pos);
+	inserted = true;
+	// keep the load factor below 0.5 to keep the probe sequences short
+	if (_nodes.size() * 2u > _slots.size()) {
+		grow();
+	} else {
+		_slots[slot] = index;
+	}
+	return index;
+}
+
+void OpenNodesContainer::clear(NodePool* pool) {
+	_heap.clear();
+	_pool = pool;
+}
+
+void OpenNodesContainer::swap(int32_t a, int32_t b) {
+	std::swap(_heap[a], _heap[b]);
+	(*_pool)[_heap[a]].heapIndex = a;
+	(*_pool)[_heap[b]].heapIndex = b;
+}
+
+void OpenNodesContainer::siftUp(int32_t pos) {
+	while (pos > 0) {
+		const int32_t parent = (pos - 1) / 2;
+		if (!less(pos, parent)) {
+			break;
+		}
+		swap(pos, parent);
+		pos = parent;
+	}
+}
+
+void OpenNodesContainer::siftDown(int32_t pos) {
+	const int32_t size = (int32_t)_heap.size();
+	for (;;) {
+		const int32_t left = pos * 2 + 1;
+		if (left >= size) {
+			break;
+		}
+		const int32_t right = left + 1;
+		const int32_t smallest = right < size && less(right, left) ? right : left;
+		if (!less(smallest, pos)) {
+			break;
+		}
+		swap(pos, smallest);
+		pos = smallest;
+	}
+}
+
+void OpenNodesContainer::insert(int32_t node) {
+	const int32_t pos = (int32_t)_heap.size();
+	_heap.push_back(node);
+	(*_pool)[node].heapIndex = pos;
+	siftUp(pos);
+}
+
+void OpenNodesContainer::removeFirst() {
+	core_assert(!_heap.empty());
+	(*_pool)[_heap[0]].heapIndex = -1;
+	const int32_t last = _heap.back();
+	_heap.pop_back();
+	if (_heap.empty()) {
+		return;
+	}
+	_heap[0] = last;
+	(*_pool)[last].heapIndex = 0;
+	siftDown(0);
+}
+
+void OpenNodesContainer::update(int32_t node) {
+	const int32_t pos = (*_pool)[node].heapIndex;
+	core_assert(pos >= 0 && pos < (int32_t)_heap.size());
+	siftUp(pos);
+}
+
+AStarArena& AStarArena::get() {
+	static thread_local AStarArena arena;
+	return arena;
+}
+
+}
@@ -5,17 +5,13 @@
 #pragma once
 
 #include "core/Common.h"
+#include "core/GLM.h"
 
-#include <algorithm>
 #include <limits> //For numeric_limits
-#include <set>
 #include <vector>
 
 namespace voxel {
 
-class OpenNodesContainer;
-class ClosedNodesContainer;
-
 /// The Connectivity of a voxel determines how many neighbours it has.
 enum Connectivity {
 	/// Each voxel has six neighbours, which are those sharing a face.
@@ -26,138 +22,112 @@ enum Connectivity {
 	TwentySixConnected
 };
 
+/**
+ * @brief A node of the search. The nodes reference each other by their index in the NodePool.
+ */
 struct Node {
-	Node(int x, int y, int z) :
-			// Initialise with NaNs so that we will know if we forget to set these properly.
-			gVal(std::numeric_limits<float>::quiet_NaN()), hVal(std::numeric_limits<float>::quiet_NaN()), parent(nullptr) {
-		position = {x, y, z};
-	}
-
-	bool operator==(const Node& rhs) const {
-		return position == rhs.position;
-	}
-
-	bool operator<(const Node& rhs) const {
-		if (position.x < rhs.position.x)
-			return true;
-		if (rhs.position.x < position.x)
-			return false;
-
-		if (position.y < rhs.position.y)
-			return true;
-		if (rhs.position.y < position.y)
-			return false;
-
-		if (position.z < rhs.position.z)
-			return true;
-		if (rhs.position.z < position.z)
-			return false;
-
-		return false;
+	Node(const glm::ivec3& pos) :
+			position(pos), gVal(std::numeric_limits<float>::infinity()), hVal(0.0f) {
 	}
 
 	glm::ivec3 position;
 	float gVal;
 	float hVal;
-	Node* parent;
+	/// index of the node we came from - @c -1 for the start node
+	int32_t parent = -1;
+	/// position in the OpenNodesContainer - @c -1 if the node isn't part of the open list
+	int32_t heapIndex = -1;
+	bool closed = false;
 
 	inline float f() const {
 		return gVal + hVal;
 	}
 };
 
-typedef std::set<Node> AllNodesContainer;
-
-class AllNodesContainerIteratorComparator {
-public:
-	bool operator()(const AllNodesContainer::iterator& lhs, const AllNodesContainer::iterator& rhs) const {
-		return (&(*lhs)) < (&(*rhs));
-	}
-};
+/**
+ * @brief All nodes of one search in one flat array, the positions are mapped to the node indices with an
+ * open addressing hash table.
+ *
+ * @note The memory is not released on @c clear() - the pool is meant to be reused for the next search.
+ */
+class NodePool {
+private:
+	std::vector<Node> _nodes;
+	/// node indices or @c -1 for an empty slot
+	std::vector<int32_t> _slots;
+	uint32_t _mask = 0u;
 
-class NodeSort {
-public:
-	bool operator()(const AllNodesContainer::iterator& lhs, const AllNodesContainer::iterator& rhs) const {
-		return lhs->f() > rhs->f();
+	static inline uint32_t hash(const glm::ivec3& pos) {
+		return ((uint32_t)pos.x * 73856093u) ^ ((uint32_t)pos.y * 19349663u) ^ ((uint32_t)pos.z * 83492791u);
 	}
-};
-
-class OpenNodesContainer {
-public:
-	typedef std::vector<AllNodesContainer::iterator>::iterator iterator;
 
+	void grow();
 public:
-	inline void clear() {
-		open.clear();
-	}
-
-	inline bool empty() const {
-		return open.empty();
-	}
-
-	void insert(AllNodesContainer::iterator node) {
-		open.push_back(node);
-		push_heap(open.begin(), open.end(), NodeSort());
-	}
-
-	inline AllNodesContainer::iterator getFirst() {
-		return open[0];
-	}
+	void clear();
 
-	void removeFirst() {
-		pop_heap(open.begin(), open.end(), NodeSort());
-		open.pop_back();
-	}
-
-	void remove(iterator iterToRemove) {
-		open.erase(iterToRemove);
-		make_heap(open.begin(), open.end(), NodeSort());
-	}
+	/**
+	 * @return The index of the node with the given position - a new node is added if there is none yet.
+	 * @param[out] inserted @c true if the node was added
+	 * @note Adding a node invalidates the references to the other nodes
+	 */
+	int32_t insert(const glm::ivec3& pos, bool& inserted);
 
-	inline iterator begin() {
-		return open.begin();
+	inline Node& operator[](int32_t index) {
+		return _nodes[index];
 	}
 
-	inline iterator end() {
-		return open.end();
+	inline const Node& operator[](int32_t index) const {
+		return _nodes[index];
 	}
 
-	iterator find(AllNodesContainer::iterator node) {
-		std::vector<AllNodesContainer::iterator>::iterator openIter = std::find(open.begin(), open.end(), node);
-		return openIter;
+	inline size_t size() const {
+		return _nodes.size();
 	}
+};
 
+/**
+ * @brief Binary min heap of node indices sorted by Node::f(). Every node knows its heap position, so the
+ * position of a node whose costs decreased can be updated without searching it.
+ */
+class OpenNodesContainer {
 private:
-	std::vector<AllNodesContainer::iterator> open;
-};
+	std::vector<int32_t> _heap;
+	NodePool* _pool = nullptr;
 
-class ClosedNodesContainer {
-public:
-	typedef std::set<AllNodesContainer::iterator, AllNodesContainerIteratorComparator>::iterator iterator;
+	inline bool less(int32_t lhs, int32_t rhs) const {
+		return (*_pool)[_heap[lhs]].f() < (*_pool)[_heap[rhs]].f();
+	}
 
+	void swap(int32_t a, int32_t b);
+	void siftUp(int32_t pos);
+	void siftDown(int32_t pos);
 public:
-	inline void clear() {
-		closed.clear();
-	}
+	void clear(NodePool* pool);
 
-	inline void insert(AllNodesContainer::iterator node) {
-		closed.insert(node);
+	inline bool empty() const {
+		return _heap.empty();
 	}
 
-	inline void remove(iterator iterToRemove) {
-		closed.erase(iterToRemove);
+	inline int32_t getFirst() const {
+		return _heap[0];
 	}
 
-	inline iterator end() {
-		return closed.end();
-	}
+	void insert(int32_t node);
+	void removeFirst();
+	/**
+	 * @brief Restores the heap order after the costs of the given node were decreased
+	 */
+	void update(int32_t node);
+};
 
-	inline iterator find(AllNodesContainer::iterator node) {
-		return closed.find(node);
-	}
+/**
+ * @brief The memory of the pathfinder - there is one instance per thread that is reused for every search.
+ */
+struct AStarArena {
+	NodePool nodes;
+	OpenNodesContainer open;
 
-private:
-	std::set<AllNodesContainer::iterator, AllNodesContainerIteratorComparator> closed;
+	static AStarArena& get();
 };
 
 }
@@ -0,0 +1,380 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "CubicSurfaceExtractor.h"
+#include "Mesh.h"
+#include "Voxel.h"
+#include "VoxelVertex.h"
+#include "Region.h"
+#include "core/Trace.h"
+#include "core/Common.h"
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+namespace voxel {
+
+namespace greedy {
+
+/**
+ * @brief The volume is processed in blocks of this size. Together with the border voxels on
+ * both sides a row of voxels fits into a 64 bit mask.
+ */
+constexpr int BlockSize = 62;
+constexpr int MaskBits = 64;
+constexpr int VoxelTypes = std::enum_value(VoxelType::Max);
+
+inline int countTrailingZeros(uint64_t v) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, v);
+	return (int)index;
+#else
+	return __builtin_ctzll(v);
+#endif
+}
+
+/**
+ * @brief A set of voxel types whose occupancy masks are needed along the given axis.
+ * The bits of the columns are the voxel positions along the axis.
+ */
+struct MaskType {
+	uint32_t types;
+	int axis;
+};
+
+/**
+ * @brief Quads of a face are needed for all back voxels of @c back that are next to a
+ * front voxel of @c front. The indices point into the list of MaskType entries.
+ */
+struct FaceClass {
+	int back;
+	int front;
+};
+
+inline uint8_t vertexAmbientOcclusion(bool side1, bool side2, bool corner) {
+	if (side1 && side2) {
+		return 0;
+	}
+	return 3 - (side1 + side2 + corner);
+}
+
+inline bool isAmbientOcclusionBlocker(VoxelType type) {
+	return !isAir(type) && !isWater(type);
+}
+
+/**
+ * @brief Derives the needed occupancy masks from the given IsQuadNeeded functor. The back voxel types
+ * of a face are grouped by their set of front voxel types, which gives a small number of mask pairs
+ * that reproduce the functor with bit operations.
+ * @return @c false if there are too many different masks to handle them in 64 bits
+ */
+template<typename IsQuadNeeded>
+bool buildFaceClasses(IsQuadNeeded& isQuadNeeded, std::vector<MaskType>& masks, std::vector<FaceClass> (&classes)[NoOfFaces], uint64_t (&typeMasks)[VoxelTypes], int& ambientOcclusionMask) {
+	auto maskIndex = [&] (uint32_t types, int axis) {
+		for (size_t i = 0; i < masks.size(); ++i) {
+			if (masks[i].types == types && masks[i].axis == axis) {
+				return (int)i;
+			}
+		}
+		masks.push_back(MaskType{types, axis});
+		return (int)masks.size() - 1;
+	};
+
+	uint32_t blockerTypes = 0u;
+	for (int type = 0; type < VoxelTypes; ++type) {
+		if (isAmbientOcclusionBlocker((VoxelType)type)) {
+			blockerTypes |= 1u << type;
+		}
+	}
+	ambientOcclusionMask = maskIndex(blockerTypes, 0);
+
+	for (int face = 0; face < NoOfFaces; ++face) {
+		const int axis = face % 3;
+		uint32_t frontTypesPerBack[VoxelTypes];
+		for (int back = 0; back < VoxelTypes; ++back) {
+			frontTypesPerBack[back] = 0u;
+			for (int front = 0; front < VoxelTypes; ++front) {
+				if (isQuadNeeded((VoxelType)back, (VoxelType)front, (FaceNames)face)) {
+					frontTypesPerBack[back] |= 1u << front;
+				}
+			}
+		}
+		uint32_t handled = 0u;
+		for (int back = 0; back < VoxelTypes; ++back) {
+			if (frontTypesPerBack[back] == 0u || (handled & (1u << back)) != 0u) {
+				continue;
+			}
+			uint32_t backTypes = 0u;
+			for (int other = back; other < VoxelTypes; ++other) {
+				if (frontTypesPerBack[other] == frontTypesPerBack[back]) {
+					backTypes |= 1u << other;
+				}
+			}
+			handled |= backTypes;
+			classes[face].push_back(FaceClass{maskIndex(backTypes, axis), maskIndex(frontTypesPerBack[back], axis)});
+		}
+	}
+
+	if (masks.size() > (size_t)MaskBits) {
+		return false;
+	}
+	for (int type = 0; type < VoxelTypes; ++type) {
+		typeMasks[type] = 0u;
+		for (size_t i = 0; i < masks.size(); ++i) {
+			if ((masks[i].types & (1u << type)) != 0u) {
+				typeMasks[type] |= (uint64_t)1 << i;
+			}
+		}
+	}
+	return true;
+}
+
+}
+
+/**
+ * @brief Alternative to extractCubicMesh() that produces the same faces (with the same ambient occlusion
+ * and the same region ownership rules) but uses occupancy bit masks instead of sampling the neighbours
+ * of every voxel.
+ *
+ * The region is processed in blocks of up to greedy::BlockSize voxels per axis. For every block the
+ * voxels (including a border of one voxel) are converted into 64 bit columns along each axis. The faces
+ * are culled by combining neighbouring bits of these columns, the ambient occlusion is looked up in the
+ * columns, too. The visible faces of each slice are then greedily merged into quads in one pass - only
+ * faces with the same voxel and the same ambient occlusion values are merged. The quads are written
+ * directly into the given mesh.
+ *
+ * @param mergeQuads If this is @c false, every face ends up as its own quad
+ * @note Quads are not merged across block borders.
+ * @sa extractCubicMesh()
+ */
+template<typename VolumeType, typename MeshType, typename IsQuadNeeded>
+void extractBinaryGreedyMesh(VolumeType* volData, const Region& region, MeshType* result, IsQuadNeeded isQuadNeeded, bool mergeQuads = true) {
+	core_trace_scoped(ExtractBinaryGreedyMesh);
+	using namespace greedy;
+
+	std::vector<MaskType> masks;
+	std::vector<FaceClass> classes[NoOfFaces];
+	uint64_t typeMasks[VoxelTypes];
+	int ambientOcclusionMask;
+	if (!buildFaceClasses(isQuadNeeded, masks, classes, typeMasks, ambientOcclusionMask)) {
+		extractCubicMesh(volData, region, result, isQuadNeeded, mergeQuads);
+		return;
+	}
+
+	result->clear();
+	const glm::ivec3& offset = region.getLowerCorner();
+	result->setOffset(offset);
+
+	const int maskCount = (int)masks.size();
+	// columns of each mask, indexed by the coordinates of the other two axes
+	std::vector<uint64_t> columns(maskCount * MaskBits * MaskBits);
+	// the visible faces of each slice of the current face direction
+	std::vector<uint64_t> slices(MaskBits * MaskBits);
+	std::vector<uint32_t> keys(MaskBits * MaskBits);
+	std::vector<Voxel> voxels(MaskBits * MaskBits * MaskBits);
+	typename VolumeType::Sampler volumeSampler(volData);
+
+	const glm::ivec3 regionSize(region.getWidthInVoxels(), region.getHeightInVoxels(), region.getDepthInVoxels());
+	glm::ivec3 blockPos;
+	for (blockPos.z = 0; blockPos.z < regionSize.z; blockPos.z += BlockSize) {
+	for (blockPos.y = 0; blockPos.y < regionSize.y; blockPos.y += BlockSize) {
+	for (blockPos.x = 0; blockPos.x < regionSize.x; blockPos.x += BlockSize) {
+		const glm::ivec3 blockSize = glm::min(regionSize - blockPos, glm::ivec3(BlockSize));
+		const glm::ivec3 padded = blockSize + 2;
+		// the world position of the padded voxel at (0,0,0)
+		const glm::ivec3 origin = offset + blockPos - 1;
+
+		{
+			core_trace_scoped(BuildMasks);
+			std::fill(columns.begin(), columns.end(), 0u);
+			int index = 0;
+			for (int z = 0; z < padded.z; ++z) {
+				for (int y = 0; y < padded.y; ++y) {
+					volumeSampler.setPosition(origin.x, origin.y + y, origin.z + z);
+					for (int x = 0; x < padded.x; ++x, ++index) {
+						const Voxel& voxel = volumeSampler.getVoxel();
+						voxels[index] = voxel;
+						uint64_t typeMask = typeMasks[std::enum_value(voxel.getMaterial())];
+						while (typeMask != 0u) {
+							const int mask = countTrailingZeros(typeMask);
+							typeMask &= typeMask - 1;
+							uint64_t* maskColumns = &columns[mask * MaskBits * MaskBits];
+							switch (masks[mask].axis) {
+							case 0:
+								maskColumns[z * MaskBits + y] |= (uint64_t)1 << x;
+								break;
+							case 1:
+								maskColumns[x * MaskBits + z] |= (uint64_t)1 << y;
+								break;
+							default:
+								maskColumns[y * MaskBits + x] |= (uint64_t)1 << z;
+								break;
+							}
+						}
+						volumeSampler.movePositiveX();
+					}
+				}
+			}
+		}
+
+		const uint64_t* occlusionColumns = &columns[ambientOcclusionMask * MaskBits * MaskBits];
+		auto isOccluder = [occlusionColumns] (const glm::ivec3& p) {
+			return (occlusionColumns[p.z * MaskBits + p.y] >> p.x) & 1u;
+		};
+		auto getVoxel = [&voxels, &padded] (const glm::ivec3& p) -> const Voxel& {
+			return voxels[p.x + p.y * padded.x + p.z * padded.x * padded.y];
+		};
+
+		for (int face = 0; face < NoOfFaces; ++face) {
+			if (classes[face].empty()) {
+				continue;
+			}
+			core_trace_scoped(ExtractFace);
+			const int axis = face % 3;
+			const int axisU = (axis + 1) % 3;
+			const int axisV = (axis + 2) % 3;
+			const bool positive = face == PositiveX || face == PositiveY || face == PositiveZ;
+			const int sizeA = blockSize[axis];
+			const int sizeU = blockSize[axisU];
+			const int sizeV = blockSize[axisV];
+			// positive faces belong to the back voxel in front of the block (they are on the lower
+			// border of the region) - negative faces to the back voxels in the block itself. This
+			// is the same ownership that the cubic extractor uses.
+			const uint64_t validMask = positive ? ((uint64_t)1 << sizeA) - 1u : (((uint64_t)1 << sizeA) - 1u) << 1;
+
+			// cull the faces and transpose them into per slice masks
+			std::fill(slices.begin(), slices.end(), 0u);
+			uint64_t usedSlices = 0u;
+			for (const FaceClass& faceClass : classes[face]) {
+				const uint64_t* backColumns = &columns[faceClass.back * MaskBits * MaskBits];
+				const uint64_t* frontColumns = &columns[faceClass.front * MaskBits * MaskBits];
+				for (int v = 1; v <= sizeV; ++v) {
+					for (int u = 1; u <= sizeU; ++u) {
+						const int column = v * MaskBits + u;
+						const uint64_t front = positive ? frontColumns[column] >> 1 : frontColumns[column] << 1;
+						uint64_t faces = backColumns[column] & front & validMask;
+						usedSlices |= faces;
+						while (faces != 0u) {
+							const int slice = countTrailingZeros(faces);
+							faces &= faces - 1;
+							slices[slice * MaskBits + v] |= (uint64_t)1 << u;
+						}
+					}
+				}
+			}
+
+			while (usedSlices != 0u) {
+				const int slice = countTrailingZeros(usedSlices);
+				usedSlices &= usedSlices - 1;
+				uint64_t* rows = &slices[slice * MaskBits];
+
+				// the key of a face is the voxel and the ambient occlusion values of the four corners
+				for (int v = 1; v <= sizeV; ++v) {
+					uint64_t row = rows[v];
+					while (row != 0u) {
+						const int u = countTrailingZeros(row);
+						row &= row - 1;
+						glm::ivec3 back;
+						back[axis] = slice;
+						back[axisU] = u;
+						back[axisV] = v;
+						glm::ivec3 front = back;
+						front[axis] += positive ? 1 : -1;
+						const Voxel& voxel = getVoxel(back);
+						uint32_t key = ((uint32_t)std::enum_value(voxel.getMaterial()) << 16) | ((uint32_t)voxel.getColor() << 8);
+						for (int corner = 0; corner < 4; ++corner) {
+							glm::ivec3 side1 = front;
+							glm::ivec3 side2 = front;
+							side1[axisU] += (corner & 1) ? 1 : -1;
+							side2[axisV] += (corner & 2) ? 1 : -1;
+							glm::ivec3 diagonal = side1;
+							diagonal[axisV] = side2[axisV];
+							key |= (uint32_t)vertexAmbientOcclusion(isOccluder(side1), isOccluder(side2), isOccluder(diagonal)) << (corner * 2);
+						}
+						keys[v * MaskBits + u] = key;
+					}
+				}
+
+				for (int v = 1; v <= sizeV; ++v) {
+					while (rows[v] != 0u) {
+						const int u = countTrailingZeros(rows[v]);
+						const uint32_t key = keys[v * MaskBits + u];
+						int width = 1;
+						int height = 1;
+						if (mergeQuads) {
+							while (u + width <= sizeU && ((rows[v] >> (u + width)) & 1u) && keys[v * MaskBits + u + width] == key) {
+								++width;
+							}
+						}
+						const uint64_t run = (((uint64_t)1 << width) - 1u) << u;
+						if (mergeQuads) {
+							for (; v + height <= sizeV; ++height) {
+								const int nextRow = v + height;
+								if ((rows[nextRow] & run) != run) {
+									break;
+								}
+								bool sameKeys = true;
+								for (int i = u; i < u + width; ++i) {
+									if (keys[nextRow * MaskBits + i] != key) {
+										sameKeys = false;
+										break;
+									}
+								}
+								if (!sameKeys) {
+									break;
+								}
+							}
+						}
+						for (int i = v; i < v + height; ++i) {
+							rows[i] &= ~run;
+						}
+
+						// corners in the order (u, v) = (0,0), (1,0), (0,1), (1,1)
+						glm::ivec3 quadPos;
+						quadPos[axis] = slice + (positive ? 1 : 0);
+						quadPos[axisU] = u;
+						quadPos[axisV] = v;
+						const glm::ivec3 regionPos = quadPos + blockPos - 1;
+						typename MeshType::IndexType indices[4];
+						uint8_t ambientOcclusion[4];
+						for (int corner = 0; corner < 4; ++corner) {
+							glm::ivec3 position = regionPos;
+							position[axisU] += (corner & 1) ? width : 0;
+							position[axisV] += (corner & 2) ? height : 0;
+							core_assert_msg(glm::all(glm::lessThanEqual(position, glm::ivec3(255))), "Vertex position exceeds the vertex data type");
+							VoxelVertex vertex;
+							vertex.position = glm::u8vec3(position);
+							vertex.ambientOcclusion = ambientOcclusion[corner] = (key >> (corner * 2)) & 3u;
+							vertex.colorIndex = (key >> 8) & 0xff;
+							vertex.material = (VoxelType)(key >> 16);
+							indices[corner] = result->addVertex(vertex);
+						}
+
+						// same vertex order as the cubic extractor uses
+						const int order[2][4] = { { 0, 2, 3, 1 }, { 0, 1, 3, 2 } };
+						const int* o = order[positive ? 1 : 0];
+						const typename MeshType::IndexType i0 = indices[o[0]];
+						const typename MeshType::IndexType i1 = indices[o[1]];
+						const typename MeshType::IndexType i2 = indices[o[2]];
+						const typename MeshType::IndexType i3 = indices[o[3]];
+						if (ambientOcclusion[o[3]] + ambientOcclusion[o[1]] > ambientOcclusion[o[0]] + ambientOcclusion[o[2]]) {
+							result->addTriangle(i1, i2, i3);
+							result->addTriangle(i1, i3, i0);
+						} else {
+							result->addTriangle(i0, i1, i2);
+							result->addTriangle(i0, i2, i3);
+						}
+					}
+				}
+			}
+		}
+	}
+	}
+	}
+}
+
+}
@@ -11,7 +11,8 @@ SDL_FORCE_INLINE bool isSameVertex(const VoxelVertex& v1, const VoxelVertex& v2)
 	return v1.colorIndex == v2.colorIndex && v1.ambientOcclusion == v2.ambientOcclusion;
 }
 
-static bool mergeQuads(Quad& q1, Quad& q2, Mesh* meshCurrent) {
+template<typename MeshType>
+static bool mergeQuads(Quad& q1, Quad& q2, MeshType* meshCurrent) {
 	const VoxelVertex& v11 = meshCurrent->getVertex(q1.vertices[0]);
 	const VoxelVertex& v21 = meshCurrent->getVertex(q2.vertices[0]);
 	if (!isSameVertex(v11, v21)) {
@@ -57,7 +58,8 @@ static bool mergeQuads(Quad& q1, Quad& q2, Mesh* meshCurrent) {
 	return false;
 }
 
-bool performQuadMerging(QuadList& quads, Mesh* meshCurrent) {
+template<typename MeshType>
+bool performQuadMerging(QuadList& quads, MeshType* meshCurrent) {
 	bool didMerge = false;
 	for (QuadList::iterator outerIter = quads.begin(); outerIter != quads.end(); ++outerIter) {
 		QuadList::iterator innerIter = outerIter;
@@ -91,8 +93,9 @@ SDL_FORCE_INLINE uint8_t vertexAmbientOcclusion(bool side1, bool side2, bool cor
 	return 3 - (side1 + side2 + corner);
 }
 
+template<typename MeshType>
 IndexType addVertex(bool reuseVertices, uint32_t uX, uint32_t uY, uint32_t uZ, const Voxel& materialIn, Array& existingVertices,
-		Mesh* meshCurrent, const VoxelType face1, const VoxelType face2, const VoxelType corner, const glm::ivec3& offset) {
+		MeshType* meshCurrent, const VoxelType face1, const VoxelType face2, const VoxelType corner) {
 	const uint8_t ambientOcclusion = vertexAmbientOcclusion(
 		!isAir(face1) && !isWater(face1),
 		!isAir(face2) && !isWater(face2),
@@ -105,8 +108,9 @@ IndexType addVertex(bool reuseVertices, uint32_t uX, uint32_t uY, uint32_t uZ, c
 			// No vertices matched and we've now hit an empty space. Fill it by creating a vertex.
 			// The 0.5f offset is because vertices set between voxels in order to build cubes around them.
 			// see raycastWithEndpoints for this offset, too
+			core_assert_msg(uX <= 255u && uY <= 255u && uZ <= 255u, "Vertex position %u:%u:%u exceeds the vertex data type", uX, uY, uZ);
 			VoxelVertex vertex;
-			vertex.position = glm::ivec3(uX, uY, uZ) + offset;
+			vertex.position = glm::u8vec3(uX, uY, uZ);
 			vertex.colorIndex = materialIn.getColor();
 			vertex.material = materialIn.getMaterial();
 			vertex.ambientOcclusion = ambientOcclusion;
@@ -130,4 +134,11 @@ IndexType addVertex(bool reuseVertices, uint32_t uX, uint32_t uY, uint32_t uZ, c
 	return 0; //Should never happen.
 }
 
+template bool performQuadMerging<Mesh>(QuadList& quads, Mesh* meshCurrent);
+template bool performQuadMerging<ChunkMesh>(QuadList& quads, ChunkMesh* meshCurrent);
+template IndexType addVertex<Mesh>(bool reuseVertices, uint32_t uX, uint32_t uY, uint32_t uZ, const Voxel& materialIn, Array& existingVertices,
+		Mesh* meshCurrent, const VoxelType face1, const VoxelType face2, const VoxelType corner);
+template IndexType addVertex<ChunkMesh>(bool reuseVertices, uint32_t uX, uint32_t uY, uint32_t uZ, const Voxel& materialIn, Array& existingVertices,
+		ChunkMesh* meshCurrent, const VoxelType face1, const VoxelType face2, const VoxelType corner);
+
 }
@@ -106,10 +106,23 @@ typedef std::vector<QuadList> QuadListVector;
  * @section Surface extraction
  */
 
-extern bool performQuadMerging(QuadList& quads, Mesh* meshCurrent);
+template<typename MeshType>
+bool performQuadMerging(QuadList& quads, MeshType* meshCurrent);
 
-extern IndexType addVertex(bool reuseVertices, uint32_t uX, uint32_t uY, uint32_t uZ, const Voxel& materialIn, Array& existingVertices,
-		Mesh* meshCurrent, const VoxelType face1, const VoxelType face2, const VoxelType corner, const glm::ivec3& offset);
+/**
+ * @return The index of the vertex in the given mesh. The quads keep the widest index type, the conversion into
+ * the index type of the mesh happens when the triangles are added.
+ */
+template<typename MeshType>
+IndexType addVertex(bool reuseVertices, uint32_t uX, uint32_t uY, uint32_t uZ, const Voxel& materialIn, Array& existingVertices,
+		MeshType* meshCurrent, const VoxelType face1, const VoxelType face2, const VoxelType corner);
+
+extern template bool performQuadMerging<Mesh>(QuadList& quads, Mesh* meshCurrent);
+extern template bool performQuadMerging<ChunkMesh>(QuadList& quads, ChunkMesh* meshCurrent);
+extern template IndexType addVertex<Mesh>(bool reuseVertices, uint32_t uX, uint32_t uY, uint32_t uZ, const Voxel& materialIn, Array& existingVertices,
+		Mesh* meshCurrent, const VoxelType face1, const VoxelType face2, const VoxelType corner);
+extern template IndexType addVertex<ChunkMesh>(bool reuseVertices, uint32_t uX, uint32_t uY, uint32_t uZ, const Voxel& materialIn, Array& existingVertices,
+		ChunkMesh* meshCurrent, const VoxelType face1, const VoxelType face2, const VoxelType corner);
 
 /**
  * @note Notice that the ambient occlusion is different for the vertices on the side than it is for the
@@ -210,8 +223,8 @@ static inline bool isQuadFlipped(const VoxelVertex& v00, const VoxelVertex& v01,
  *    2. The user-provided mesh could have a different index type (e.g. 16-bit indices) to reduce memory usage.
  *    3. The user could provide a custom mesh class, e.g a thin wrapper around an openGL VBO to allow direct writing into this structure.
  */
-template<typename VolumeType, typename IsQuadNeeded>
-void extractCubicMesh(VolumeType* volData, const Region& region, Mesh* result, IsQuadNeeded isQuadNeeded, bool mergeQuads = true, bool reuseVertices = true) {
+template<typename VolumeType, typename MeshType, typename IsQuadNeeded>
+void extractCubicMesh(VolumeType* volData, const Region& region, MeshType* result, IsQuadNeeded isQuadNeeded, bool mergeQuads = true, bool reuseVertices = true) {
 	core_trace_scoped(ExtractCubicMesh);
 
 	result->clear();
@@ -302,13 +315,13 @@ void extractCubicMesh(VolumeType* volData, const Region& region, Mesh* result, I
 				// X [A] LEFT
 				if (isQuadNeeded(voxelCurrentMaterial, voxelLeftMaterial, NegativeX)) {
 					const IndexType v_0_1 = addVertex(reuseVertices, regX, regY,     regZ,     voxelCurrent, previousSliceVertices, result,
-							voxelLeftBeforeMaterial, voxelBelowLeftMaterial, voxelBelowLeftBeforeMaterial, offset);
+							voxelLeftBeforeMaterial, voxelBelowLeftMaterial, voxelBelowLeftBeforeMaterial);
 					const IndexType v_1_4 = addVertex(reuseVertices, regX, regY,     regZ + 1, voxelCurrent, currentSliceVertices,  result,
-							voxelBelowLeftMaterial, voxelLeftBehindMaterial, voxelBelowLeftBehindMaterial, offset);
+							voxelBelowLeftMaterial, voxelLeftBehindMaterial, voxelBelowLeftBehindMaterial);
 					const IndexType v_2_8 = addVertex(reuseVertices, regX, regY + 1, regZ + 1, voxelCurrent, currentSliceVertices,  result,
-							voxelLeftBehindMaterial, voxelAboveLeftMaterial, voxelAboveLeftBehindMaterial, offset);
+							voxelLeftBehindMaterial, voxelAboveLeftMaterial, voxelAboveLeftBehindMaterial);
 					const IndexType v_3_5 = addVertex(reuseVertices, regX, regY + 1, regZ,     voxelCurrent, previousSliceVertices, result,
-							voxelAboveLeftMaterial, voxelLeftBeforeMaterial, voxelAboveLeftBeforeMaterial, offset);
+							voxelAboveLeftMaterial, voxelLeftBeforeMaterial, voxelAboveLeftBeforeMaterial);
 					vecQuads[NegativeX][regX].emplace_back(v_0_1, v_1_4, v_2_8, v_3_5);
 				}
 
@@ -328,13 +341,13 @@ void extractCubicMesh(VolumeType* volData, const Region& region, Mesh* result, I
 					const VoxelType _voxelBelowRightBehind = volumeSampler.peekVoxel1px1ny1pz().getMaterial();
 
 					const IndexType v_0_2 = addVertex(reuseVertices, regX, regY,     regZ,     voxelLeft, previousSliceVertices, result,
-							_voxelBelowRight, _voxelRightBefore, _voxelBelowRightBefore, offset);
+							_voxelBelowRight, _voxelRightBefore, _voxelBelowRightBefore);
 					const IndexType v_1_3 = addVertex(reuseVertices, regX, regY,     regZ + 1, voxelLeft, currentSliceVertices,  result,
-							_voxelBelowRight, _voxelRightBehind, _voxelBelowRightBehind, offset);
+							_voxelBelowRight, _voxelRightBehind, _voxelBelowRightBehind);
 					const IndexType v_2_7 = addVertex(reuseVertices, regX, regY + 1, regZ + 1, voxelLeft, currentSliceVertices,  result,
-							_voxelAboveRight, _voxelRightBehind, _voxelAboveRightBehind, offset);
+							_voxelAboveRight, _voxelRightBehind, _voxelAboveRightBehind);
 					const IndexType v_3_6 = addVertex(reuseVertices, regX, regY + 1, regZ,     voxelLeft, previousSliceVertices, result,
-							_voxelAboveRight, _voxelRightBefore, _voxelAboveRightBefore, offset);
+							_voxelAboveRight, _voxelRightBefore, _voxelAboveRightBefore);
 					vecQuads[PositiveX][regX].emplace_back(v_0_2, v_3_6, v_2_7, v_1_3);
 
 					volumeSampler.movePositiveX();
@@ -352,13 +365,13 @@ void extractCubicMesh(VolumeType* volData, const Region& region, Mesh* result, I
 					const VoxelType voxelBelowBehindMaterial      = voxelBelowBehind.getMaterial();
 					const VoxelType voxelBelowRightBehindMaterial = voxelBelowRightBehind.getMaterial();
 					const IndexType v_0_1 = addVertex(reuseVertices, regX,     regY, regZ,     voxelCurrent, previousSliceVertices, result,
-							voxelBelowBeforeMaterial, voxelBelowLeftMaterial, voxelBelowLeftBeforeMaterial, offset);
+							voxelBelowBeforeMaterial, voxelBelowLeftMaterial, voxelBelowLeftBeforeMaterial);
 					const IndexType v_1_2 = addVertex(reuseVertices, regX + 1, regY, regZ,     voxelCurrent, previousSliceVertices, result,
-							voxelBelowRightMaterial, voxelBelowBeforeMaterial, voxelBelowRightBeforeMaterial, offset);
+							voxelBelowRightMaterial, voxelBelowBeforeMaterial, voxelBelowRightBeforeMaterial);
 					const IndexType v_2_3 = addVertex(reuseVertices, regX + 1, regY, regZ + 1, voxelCurrent, currentSliceVertices,  result,
-							voxelBelowBehindMaterial, voxelBelowRightMaterial, voxelBelowRightBehindMaterial, offset);
+							voxelBelowBehindMaterial, voxelBelowRightMaterial, voxelBelowRightBehindMaterial);
 					const IndexType v_3_4 = addVertex(reuseVertices, regX,     regY, regZ + 1, voxelCurrent, currentSliceVertices,  result,
-							voxelBelowLeftMaterial, voxelBelowBehindMaterial, voxelBelowLeftBehindMaterial, offset);
+							voxelBelowLeftMaterial, voxelBelowBehindMaterial, voxelBelowLeftBehindMaterial);
 					vecQuads[NegativeY][regY].emplace_back(v_0_1, v_1_2, v_2_3, v_3_4);
 				}
 
@@ -376,13 +389,13 @@ void extractCubicMesh(VolumeType* volData, const Region& region, Mesh* result, I
 					const VoxelType _voxelAboveRightBehind = volumeSampler.peekVoxel1px1py1pz().getMaterial();
 
 					const IndexType v_0_5 = addVertex(reuseVertices, regX,     regY, regZ,     voxelBelow, previousSliceVertices, result,
-							_voxelAboveBefore, _voxelAboveLeft, _voxelAboveLeftBefore, offset);
+							_voxelAboveBefore, _voxelAboveLeft, _voxelAboveLeftBefore);
 					const IndexType v_1_6 = addVertex(reuseVertices, regX + 1, regY, regZ,     voxelBelow, previousSliceVertices, result,
-							_voxelAboveRight, _voxelAboveBefore, _voxelAboveRightBefore, offset);
+							_voxelAboveRight, _voxelAboveBefore, _voxelAboveRightBefore);
 					const IndexType v_2_7 = addVertex(reuseVertices, regX + 1, regY, regZ + 1, voxelBelow, currentSliceVertices,  result,
-							_voxelAboveBehind, _voxelAboveRight, _voxelAboveRightBehind, offset);
+							_voxelAboveBehind, _voxelAboveRight, _voxelAboveRightBehind);
 					const IndexType v_3_8 = addVertex(reuseVertices, regX,     regY, regZ + 1, voxelBelow, currentSliceVertices,  result,
-							_voxelAboveLeft, _voxelAboveBehind, _voxelAboveLeftBehind, offset);
+							_voxelAboveLeft, _voxelAboveBehind, _voxelAboveLeftBehind);
 					vecQuads[PositiveY][regY].emplace_back(v_0_5, v_3_8, v_2_7, v_1_6);
 
 					volumeSampler.movePositiveY();
@@ -397,13 +410,13 @@ void extractCubicMesh(VolumeType* volData, const Region& region, Mesh* result, I
 					const VoxelType voxelBelowRightBeforeMaterial = voxelBelowRightBefore.getMaterial();
 
 					const IndexType v_0_1 = addVertex(reuseVertices, regX,     regY,     regZ, voxelCurrent, previousSliceVertices, result,
-							voxelBelowBeforeMaterial, voxelLeftBeforeMaterial, voxelBelowLeftBeforeMaterial, offset); //1
+							voxelBelowBeforeMaterial, voxelLeftBeforeMaterial, voxelBelowLeftBeforeMaterial); //1
 					const IndexType v_1_5 = addVertex(reuseVertices, regX,     regY + 1, regZ, voxelCurrent, previousSliceVertices, result,
-							voxelAboveBeforeMaterial, voxelLeftBeforeMaterial, voxelAboveLeftBeforeMaterial, offset); //5
+							voxelAboveBeforeMaterial, voxelLeftBeforeMaterial, voxelAboveLeftBeforeMaterial); //5
 					const IndexType v_2_6 = addVertex(reuseVertices, regX + 1, regY + 1, regZ, voxelCurrent, previousSliceVertices, result,
-							voxelAboveBeforeMaterial, voxelRightBeforeMaterial, voxelAboveRightBeforeMaterial, offset); //6
+							voxelAboveBeforeMaterial, voxelRightBeforeMaterial, voxelAboveRightBeforeMaterial); //6
 					const IndexType v_3_2 = addVertex(reuseVertices, regX + 1, regY,     regZ, voxelCurrent, previousSliceVertices, result,
-							voxelBelowBeforeMaterial, voxelRightBeforeMaterial, voxelBelowRightBeforeMaterial, offset); //2
+							voxelBelowBeforeMaterial, voxelRightBeforeMaterial, voxelBelowRightBeforeMaterial); //2
 					vecQuads[NegativeZ][regZ].emplace_back(v_0_1, v_1_5, v_2_6, v_3_2);
 				}
 
@@ -423,13 +436,13 @@ void extractCubicMesh(VolumeType* volData, const Region& region, Mesh* result, I
 					const VoxelType _voxelBelowRightBehind = volumeSampler.peekVoxel1px1ny1pz().getMaterial();
 
 					const IndexType v_0_4 = addVertex(reuseVertices, regX,     regY,     regZ, voxelBefore, previousSliceVertices, result,
-							_voxelBelowBehind, _voxelLeftBehind, _voxelBelowLeftBehind, offset); //4
+							_voxelBelowBehind, _voxelLeftBehind, _voxelBelowLeftBehind); //4
 					const IndexType v_1_8 = addVertex(reuseVertices, regX,     regY + 1, regZ, voxelBefore, previousSliceVertices, result,
-							_voxelAboveBehind, _voxelLeftBehind, _voxelAboveLeftBehind, offset); //8
+							_voxelAboveBehind, _voxelLeftBehind, _voxelAboveLeftBehind); //8
 					const IndexType v_2_7 = addVertex(reuseVertices, regX + 1, regY + 1, regZ, voxelBefore, previousSliceVertices, result,
-							_voxelAboveBehind, _voxelRightBehind, _voxelAboveRightBehind, offset); //7
+							_voxelAboveBehind, _voxelRightBehind, _voxelAboveRightBehind); //7
 					const IndexType v_3_3 = addVertex(reuseVertices, regX + 1, regY,     regZ, voxelBefore, previousSliceVertices, result,
-							_voxelBelowBehind, _voxelRightBehind, _voxelBelowRightBehind, offset); //3
+							_voxelBelowBehind, _voxelRightBehind, _voxelBelowRightBehind); //3
 					vecQuads[PositiveZ][regZ].emplace_back(v_0_4, v_3_3, v_2_7, v_1_8);
 
 					volumeSampler.movePositiveZ();
@@ -456,10 +469,10 @@ void extractCubicMesh(VolumeType* volData, const Region& region, Mesh* result, I
 				}
 
 				for (const Quad& quad : listQuads) {
-					const IndexType i0 = quad.vertices[0];
-					const IndexType i1 = quad.vertices[1];
-					const IndexType i2 = quad.vertices[2];
-					const IndexType i3 = quad.vertices[3];
+					const typename MeshType::IndexType i0 = quad.vertices[0];
+					const typename MeshType::IndexType i1 = quad.vertices[1];
+					const typename MeshType::IndexType i2 = quad.vertices[2];
+					const typename MeshType::IndexType i3 = quad.vertices[3];
 					const VoxelVertex& v00 = result->getVertex(i3);
 					const VoxelVertex& v01 = result->getVertex(i0);
 					const VoxelVertex& v10 = result->getVertex(i2);
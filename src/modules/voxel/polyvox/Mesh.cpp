@@ -5,11 +5,13 @@
 #include "Mesh.h"
 #include "CubicSurfaceExtractor.h"
 #include "core/Common.h"
+#include "core/GLM.h"
 #include "core/Trace.h"
 
 namespace voxel {
 
-size_t Mesh::size() {
+template<typename INDEXTYPE>
+size_t MeshT<INDEXTYPE>::size() {
 	constexpr size_t classSize = sizeof(*this);
 	const size_t indicesSize = _vecIndices.size() * sizeof(IndexType);
 	const size_t verticesSize = _vecVertices.size() * sizeof(VoxelVertex);
@@ -17,10 +19,14 @@ size_t Mesh::size() {
 	return classSize + contentSize;
 }
 
-bool Mesh::addMesh(const Mesh& mesh) {
+template<typename INDEXTYPE>
+bool MeshT<INDEXTYPE>::addMesh(const MeshT& mesh) {
 	if (mesh.getOffset() != getOffset()) {
 		return false;
 	}
+	if (!_segments.empty() || !mesh._segments.empty()) {
+		return false;
+	}
 	const IndexType* indices = mesh.getRawIndexData();
 	const VoxelVertex* vertices = mesh.getRawVertexData();
 	const size_t nIndices = mesh.getNoOfIndices();
@@ -28,6 +34,9 @@ bool Mesh::addMesh(const Mesh& mesh) {
 
 	const size_t vSize = _vecVertices.size();
 	const size_t iSize = _vecIndices.size();
+	if (vSize + nVertices > std::numeric_limits<IndexType>::max()) {
+		return false;
+	}
 
 	_vecVertices.reserve(vSize + nVertices);
 	_vecIndices.reserve(iSize + nIndices);
@@ -43,7 +52,45 @@ bool Mesh::addMesh(const Mesh& mesh) {
 	return true;
 }
 
-void Mesh::removeUnusedVertices() {
+template<typename INDEXTYPE>
+bool MeshT<INDEXTYPE>::addSegment(const MeshT& mesh) {
+	const glm::ivec3 delta = mesh.getOffset() - getOffset();
+	const VoxelVertex* vertices = mesh.getRawVertexData();
+	const size_t nVertices = mesh.getNoOfVertices();
+	for (size_t i = 0; i < nVertices; ++i) {
+		const glm::ivec3 pos = glm::ivec3(vertices[i].position) + delta;
+		if (glm::any(glm::lessThan(pos, glm::ivec3(0))) || glm::any(glm::greaterThan(pos, glm::ivec3(255)))) {
+			return false;
+		}
+	}
+
+	if (_segments.empty() && !_vecIndices.empty()) {
+		_segments.push_back(MeshSegment{0u, 0u, (uint32_t)_vecIndices.size()});
+	}
+	const uint32_t vSize = _vecVertices.size();
+	const uint32_t iSize = _vecIndices.size();
+	if (mesh._segments.empty()) {
+		if (!mesh._vecIndices.empty()) {
+			_segments.push_back(MeshSegment{vSize, iSize, (uint32_t)mesh._vecIndices.size()});
+		}
+	} else {
+		for (const MeshSegment& segment : mesh._segments) {
+			_segments.push_back(MeshSegment{vSize + segment.firstVertex, iSize + segment.firstIndex, segment.numIndices});
+		}
+	}
+
+	_vecVertices.reserve(vSize + nVertices);
+	for (size_t i = 0; i < nVertices; ++i) {
+		VoxelVertex vertex = vertices[i];
+		vertex.position = glm::u8vec3(glm::ivec3(vertex.position) + delta);
+		_vecVertices.push_back(vertex);
+	}
+	_vecIndices.insert(_vecIndices.end(), mesh._vecIndices.begin(), mesh._vecIndices.end());
+	return true;
+}
+
+template<typename INDEXTYPE>
+void MeshT<INDEXTYPE>::removeUnusedVertices() {
 	std::vector<bool> isVertexUsed(_vecVertices.size());
 	std::fill(isVertexUsed.begin(), isVertexUsed.end(), false);
 
@@ -70,4 +117,7 @@ void Mesh::removeUnusedVertices() {
 	_vecIndices.resize(_vecIndices.size());
 }
 
+template class MeshT<IndexType>;
+template class MeshT<ChunkIndexType>;
+
 }
@@ -8,24 +8,45 @@
 #include "VoxelVertex.h"
 #include <algorithm>
 #include <cstdlib>
+#include <limits>
 #include <memory>
 #include <vector>
 
 namespace voxel {
 
-// TODO: maybe reduce to uint16_t and use glDrawElementsBaseVertex
 typedef uint32_t IndexType;
+/**
+ * @brief The index type of the world chunk meshes - the renderer draws them with a base vertex offset. If a chunk
+ * exceeds the 16 bit range, it is split into several segments.
+ * @sa MeshSegment
+ */
+typedef uint16_t ChunkIndexType;
+
+/**
+ * @brief A part of a mesh whose indices are relative to the first vertex of the segment.
+ * @sa MeshT::addSegment()
+ */
+struct MeshSegment {
+	uint32_t firstVertex;
+	uint32_t firstIndex;
+	uint32_t numIndices;
+};
 
 /**
  * @brief A simple and general-purpose mesh class to represent the data returned by the surface extraction functions.
  *
  * @note You are only able to store vertex ranges from 0 to 255 here, due to the limited data type of the position in
  * the Vertex class.
+ * @sa Mesh
+ * @sa ChunkMesh
  */
-class Mesh {
+template<typename INDEXTYPE>
+class MeshT {
 public:
-	Mesh(int vertices, int indices, bool mayGetResized = false);
-	~Mesh();
+	typedef INDEXTYPE IndexType;
+
+	MeshT(int vertices, int indices, bool mayGetResized = false);
+	~MeshT();
 
 	/**
 	 * @brief Calculate the memory amount this mesh is using
@@ -40,7 +61,26 @@ public:
 	 * due to the Vertex class position data type. Therefore we can merge meshes, but only if the offset is the same
 	 * (as we can't exceed the 0-255 range).
 	 */
-	bool addMesh(const Mesh& mesh);
+	bool addMesh(const MeshT& mesh);
+	/**
+	 * @brief Appends the given mesh as new segments without offsetting the indices. This allows a mesh to have more
+	 * vertices than the index type can address - each segment must be drawn with its first vertex as base vertex.
+	 * @return @c false if the vertex positions of the given mesh don't fit into this mesh. The offset of the given
+	 * mesh must not be smaller than the offset of this mesh.
+	 * @sa getSegments()
+	 */
+	bool addSegment(const MeshT& mesh);
+	/**
+	 * @return The segments of the mesh - if this is empty, the whole mesh is one segment.
+	 */
+	const std::vector<MeshSegment>& getSegments() const;
+
+	/**
+	 * @return @c true if more vertices were added than the index type can address. The content of the mesh
+	 * is invalid then, and the region must be extracted in smaller parts.
+	 * @sa addSegment()
+	 */
+	bool overflow() const;
 
 	size_t getNoOfVertices() const;
 	const VoxelVertex& getVertex(IndexType index) const;
@@ -68,11 +108,14 @@ public:
 private:
 	std::vector<IndexType> _vecIndices;
 	std::vector<VoxelVertex> _vecVertices;
-	glm::ivec3 _offset;
+	std::vector<MeshSegment> _segments;
+	glm::ivec3 _offset {0};
 	bool _mayGetResized;
+	bool _overflow = false;
 };
 
-inline Mesh::Mesh(int vertices, int indices, bool mayGetResized) : _mayGetResized(mayGetResized) {
+template<typename INDEXTYPE>
+inline MeshT<INDEXTYPE>::MeshT(int vertices, int indices, bool mayGetResized) : _mayGetResized(mayGetResized) {
 	if (vertices > 0) {
 		_vecVertices.reserve(vertices);
 	}
@@ -81,58 +124,82 @@ inline Mesh::Mesh(int vertices, int indices, bool mayGetResized) : _mayGetResize
 	}
 }
 
-inline Mesh::~Mesh() {
+template<typename INDEXTYPE>
+inline MeshT<INDEXTYPE>::~MeshT() {
 }
 
-inline const std::vector<IndexType>& Mesh::getIndexVector() const {
+template<typename INDEXTYPE>
+inline const std::vector<typename MeshT<INDEXTYPE>::IndexType>& MeshT<INDEXTYPE>::getIndexVector() const {
 	return _vecIndices;
 }
 
-inline const std::vector<VoxelVertex>& Mesh::getVertexVector() const {
+template<typename INDEXTYPE>
+inline const std::vector<VoxelVertex>& MeshT<INDEXTYPE>::getVertexVector() const {
 	return _vecVertices;
 }
 
-inline std::vector<IndexType>& Mesh::getIndexVector() {
+template<typename INDEXTYPE>
+inline std::vector<typename MeshT<INDEXTYPE>::IndexType>& MeshT<INDEXTYPE>::getIndexVector() {
 	return _vecIndices;
 }
 
-inline std::vector<VoxelVertex>& Mesh::getVertexVector() {
+template<typename INDEXTYPE>
+inline std::vector<VoxelVertex>& MeshT<INDEXTYPE>::getVertexVector() {
 	return _vecVertices;
 }
 
-inline size_t Mesh::getNoOfVertices() const {
+template<typename INDEXTYPE>
+inline size_t MeshT<INDEXTYPE>::getNoOfVertices() const {
 	return _vecVertices.size();
 }
 
-inline const VoxelVertex& Mesh::getVertex(IndexType index) const {
+template<typename INDEXTYPE>
+inline const VoxelVertex& MeshT<INDEXTYPE>::getVertex(IndexType index) const {
 	return _vecVertices[index];
 }
 
-inline const VoxelVertex* Mesh::getRawVertexData() const {
+template<typename INDEXTYPE>
+inline const VoxelVertex* MeshT<INDEXTYPE>::getRawVertexData() const {
 	return _vecVertices.data();
 }
 
-inline size_t Mesh::getNoOfIndices() const {
+template<typename INDEXTYPE>
+inline size_t MeshT<INDEXTYPE>::getNoOfIndices() const {
 	return _vecIndices.size();
 }
 
-inline IndexType Mesh::getIndex(IndexType index) const {
+template<typename INDEXTYPE>
+inline typename MeshT<INDEXTYPE>::IndexType MeshT<INDEXTYPE>::getIndex(IndexType index) const {
 	return _vecIndices[index];
 }
 
-inline const IndexType* Mesh::getRawIndexData() const {
+template<typename INDEXTYPE>
+inline const typename MeshT<INDEXTYPE>::IndexType* MeshT<INDEXTYPE>::getRawIndexData() const {
 	return _vecIndices.data();
 }
 
-inline const glm::ivec3& Mesh::getOffset() const {
+template<typename INDEXTYPE>
+inline const glm::ivec3& MeshT<INDEXTYPE>::getOffset() const {
 	return _offset;
 }
 
-inline void Mesh::setOffset(const glm::ivec3& offset) {
+template<typename INDEXTYPE>
+inline void MeshT<INDEXTYPE>::setOffset(const glm::ivec3& offset) {
 	_offset = offset;
 }
 
-inline void Mesh::addTriangle(IndexType index0, IndexType index1, IndexType index2) {
+template<typename INDEXTYPE>
+inline const std::vector<MeshSegment>& MeshT<INDEXTYPE>::getSegments() const {
+	return _segments;
+}
+
+template<typename INDEXTYPE>
+inline bool MeshT<INDEXTYPE>::overflow() const {
+	return _overflow;
+}
+
+template<typename INDEXTYPE>
+inline void MeshT<INDEXTYPE>::addTriangle(IndexType index0, IndexType index1, IndexType index2) {
 	//Make sure the specified indices correspond to valid vertices.
 	core_assert_msg(index0 < _vecVertices.size(), "Index points at an invalid vertex.");
 	core_assert_msg(index1 < _vecVertices.size(), "Index points at an invalid vertex.");
@@ -146,9 +213,14 @@ inline void Mesh::addTriangle(IndexType index0, IndexType index1, IndexType inde
 	_vecIndices.push_back(index2);
 }
 
-inline IndexType Mesh::addVertex(const VoxelVertex& vertex) {
-	// We should not add more vertices than our chosen index type will let us index.
-	core_assert_msg(_vecVertices.size() < std::numeric_limits<IndexType>::max(), "Mesh has more vertices that the chosen index type allows.");
+template<typename INDEXTYPE>
+inline typename MeshT<INDEXTYPE>::IndexType MeshT<INDEXTYPE>::addVertex(const VoxelVertex& vertex) {
+	// We should not add more vertices than our chosen index type will let us index - the caller has to
+	// split the region if this happens. Any valid index is returned to keep the extraction going.
+	if (_vecVertices.size() >= std::numeric_limits<IndexType>::max()) {
+		_overflow = true;
+		return 0;
+	}
 	if (!_mayGetResized) {
 		core_assert_msg(_vecVertices.size() + 1 < _vecVertices.capacity(), "addVertex() call exceeds the capacity of the vertices vector and will trigger a realloc (%i vs %i)", (int)_vecVertices.size(), (int)_vecVertices.capacity());
 	}
@@ -157,13 +229,23 @@ inline IndexType Mesh::addVertex(const VoxelVertex& vertex) {
 	return _vecVertices.size() - 1;
 }
 
-inline void Mesh::clear() {
+template<typename INDEXTYPE>
+inline void MeshT<INDEXTYPE>::clear() {
 	_vecVertices.clear();
 	_vecIndices.clear();
+	_segments.clear();
+	_overflow = false;
 }
 
-inline bool Mesh::isEmpty() const {
+template<typename INDEXTYPE>
+inline bool MeshT<INDEXTYPE>::isEmpty() const {
 	return getNoOfVertices() == 0 || getNoOfIndices() == 0;
 }
 
+extern template class MeshT<IndexType>;
+extern template class MeshT<ChunkIndexType>;
+
+typedef MeshT<IndexType> Mesh;
+typedef MeshT<ChunkIndexType> ChunkMesh;
+
 }
@@ -5,6 +5,8 @@
 #include "PagedVolume.h"
 #include "Morton.h"
 #include "Utility.h"
+#include <vector>
+#include <cstring>
 
 namespace voxel {
 
@@ -31,21 +33,21 @@ PagedVolume::PagedVolume(Pager* pPager, uint32_t uTargetMemoryUsageInBytes, uint
 	// Use to perform modulo by bit operations
 	_chunkMask = _chunkSideLength - 1;
 
-	// Calculate the number of chunks based on the memory limit and the size of each chunk.
-	uint32_t uChunkSizeInBytes = PagedVolume::Chunk::calculateSizeInBytes(_chunkSideLength);
-	_chunkCountLimit = uTargetMemoryUsageInBytes / uChunkSizeInBytes;
-
-	// Enforce sensible limits on the number of chunks.
+	// The limit is checked against the memory the chunks are really using - compact chunks are a lot smaller
+	// than the raw ones. But we must at least be able to hold a few uncompressed chunks.
+	const uint32_t uChunkSizeInBytes = PagedVolume::Chunk::calculateSizeInBytes(_chunkSideLength);
 	const uint32_t uMinPracticalNoOfChunks = 32; // Enough to make sure a chunks and it's neighbours can be loaded, with a few to spare.
-	if (_chunkCountLimit < uMinPracticalNoOfChunks) {
-		Log::warn("Requested memory usage limit of %uMb is too low and cannot be adhered to. Chunk limit is at %i, Chunk size: %uKb",
-				uTargetMemoryUsageInBytes / (1024 * 1024), _chunkCountLimit, uChunkSizeInBytes / 1024);
+	const uint64_t uMinPracticalMemoryUsage = (uint64_t)uMinPracticalNoOfChunks * uChunkSizeInBytes;
+	_targetMemoryUsageInBytes = uTargetMemoryUsageInBytes;
+	if (_targetMemoryUsageInBytes < uMinPracticalMemoryUsage) {
+		Log::warn("Requested memory usage limit of %uMb is too low and cannot be adhered to. Chunk size: %uKb",
+				uTargetMemoryUsageInBytes / (1024 * 1024), uChunkSizeInBytes / 1024);
+		_targetMemoryUsageInBytes = (uint32_t)std::min(uMinPracticalMemoryUsage, (uint64_t)UINT32_MAX);
 	}
-	_chunkCountLimit = std::max(_chunkCountLimit, uMinPracticalNoOfChunks);
 
 	// Inform the user about the chosen memory configuration.
-	Log::debug("Memory usage limit for volume now set to %uMb (%u chunks of %uKb each).",
-			(_chunkCountLimit * uChunkSizeInBytes) / (1024 * 1024), _chunkCountLimit, uChunkSizeInBytes / 1024);
+	Log::debug("Memory usage limit for volume now set to %uMb (%u uncompressed chunks of %uKb each).",
+			_targetMemoryUsageInBytes / (1024 * 1024), _targetMemoryUsageInBytes / uChunkSizeInBytes, uChunkSizeInBytes / 1024);
 }
 
 /**
@@ -64,7 +66,7 @@ PagedVolume::~PagedVolume() {
  * @param uZPos The @c z position of the voxel
  * @return The voxel value
  */
-const Voxel& PagedVolume::getVoxel(int32_t uXPos, int32_t uYPos, int32_t uZPos) const {
+Voxel PagedVolume::getVoxel(int32_t uXPos, int32_t uYPos, int32_t uZPos) const {
 	return getVoxel(glm::ivec3(uXPos, uYPos, uZPos));
 }
 
@@ -75,13 +77,24 @@ PagedVolume::ChunkPtr PagedVolume::getChunk(const glm::ivec3& pos) const {
 	return getChunk(chunkX, chunkY, chunkZ);
 }
 
+bool PagedVolume::hasChunk(const glm::ivec3& pos) const {
+	const glm::ivec3 chunkPos(pos.x >> _chunkSideLengthPower, pos.y >> _chunkSideLengthPower, pos.z >> _chunkSideLengthPower);
+	const ChunkMapShard& shard = getShard(chunkPos);
+	core::ScopedReadLock readLock(shard.lock);
+	auto i = shard.chunks.find(chunkPos);
+	if (i == shard.chunks.end()) {
+		return false;
+	}
+	return i->second->_pagedIn.load(std::memory_order_acquire);
+}
+
 /**
  * This version of the function is provided so that the wrap mode does not need
  * to be specified as a template parameter, as it may be confusing to some users.
  * @param v3dPos The 3D position of the voxel
  * @return The voxel value
  */
-const Voxel& PagedVolume::getVoxel(const glm::ivec3& v3dPos) const {
+Voxel PagedVolume::getVoxel(const glm::ivec3& v3dPos) const {
 	const uint16_t xOffset = static_cast<uint16_t>(v3dPos.x & _chunkMask);
 	const uint16_t yOffset = static_cast<uint16_t>(v3dPos.y & _chunkMask);
 	const uint16_t zOffset = static_cast<uint16_t>(v3dPos.z & _chunkMask);
@@ -149,60 +162,133 @@ void PagedVolume::setVoxels(int32_t uXPos, int32_t uYPos, int32_t uZPos, int nx,
  * Removes all voxels from memory by removing all chunks. The application has the chance to persist the data via @c Pager::pageOut
  */
 void PagedVolume::flushAll() {
-	core::RecursiveScopedWriteLock writeLock(_rwLock);
-	// Clear this pointer as all chunks are about to be removed.
-	_lastAccessedChunk = ChunkPtr();
+	std::vector<ChunkPtr> chunks;
+	chunks.reserve(_chunkCount);
+	for (ChunkMapShard& shard : _shards) {
+		shard.lock.lockWrite();
+	}
+	{
+		core::ScopedWriteLock lruLock(_lruLock);
+		_lruHead = _lruTail = nullptr;
+	}
+	for (ChunkMapShard& shard : _shards) {
+		for (auto& i : shard.chunks) {
+			i.second->_lruPrev = i.second->_lruNext = nullptr;
+			chunks.push_back(i.second);
+		}
+		shard.chunks.clear();
+	}
+	_chunkCount = 0u;
+	for (ChunkMapShard& shard : _shards) {
+		shard.lock.unlockWrite();
+	}
+	for (const ChunkPtr& chunk : chunks) {
+		chunk->detach();
+	}
+	// the chunks are paged out here - outside of the locks
+	chunks.clear();
+}
 
-	// Erase all the most recently used chunks.
-	for (ChunkMap::iterator i = _chunks.begin(); i != _chunks.end(); ++i) {
+PagedVolume::ChunkMapShard& PagedVolume::getShard(const glm::ivec3& chunkPos) const {
+	static const std::hash<glm::ivec3> hasher;
+	const size_t hash = hasher(chunkPos);
+	// mix the upper bits in - neighbouring chunks should end up in different shards
+	return _shards[(hash ^ (hash >> 7) ^ (hash >> 17)) & (ChunkMapShards - 1)];
+}
+
+/**
+ * @note Must be called with the lru lock held.
+ */
+void PagedVolume::linkChunk(Chunk* chunk) const {
+	chunk->_lruPrev = _lruTail;
+	chunk->_lruNext = nullptr;
+	if (_lruTail != nullptr) {
+		_lruTail->_lruNext = chunk;
+	} else {
+		_lruHead = chunk;
+	}
+	_lruTail = chunk;
+}
+
+/**
+ * @note Must be called with the lru lock held.
+ */
+void PagedVolume::unlinkChunk(Chunk* chunk) const {
+	if (chunk->_lruPrev != nullptr) {
+		chunk->_lruPrev->_lruNext = chunk->_lruNext;
+	} else {
+		_lruHead = chunk->_lruNext;
+	}
+	if (chunk->_lruNext != nullptr) {
+		chunk->_lruNext->_lruPrev = chunk->_lruPrev;
+	} else {
+		_lruTail = chunk->_lruPrev;
 	}
-	_chunks.clear();
+	chunk->_lruPrev = chunk->_lruNext = nullptr;
 }
 
 /**
- * Starting at the position indicated by the hash, and then search through the whole array looking for a chunk with the correct
- * position. In most cases we expect to find it in the first place we look. Note that this algorithm is slow in the case that
- * the chunk is not found because the whole array has to be searched, but in this case we are going to have to page the data in
- * from an external source which is likely to be slow anyway.
+ * Lookup the chunk in the shard the position hashes to. Only this shard is locked and the access
+ * is recorded by setting a flag in the chunk - the lru list itself is not touched here.
  */
 PagedVolume::ChunkPtr PagedVolume::getExistingChunk(int32_t chunkX, int32_t chunkY, int32_t chunkZ) const {
 	const glm::ivec3 pos(chunkX, chunkY, chunkZ);
-	auto i = _chunks.find(pos);
-	if (i == _chunks.end()) {
-		return nullptr;
+	const ChunkMapShard& shard = getShard(pos);
+	core::ScopedReadLock readLock(shard.lock);
+	auto i = shard.chunks.find(pos);
+	if (i == shard.chunks.end()) {
+		return ChunkPtr();
 	}
 	const PagedVolume::ChunkPtr& chunk = i->second;
-	chunk->_chunkLastAccessed = ++_timestamper;
+	chunk->_referenced.store(true, std::memory_order_relaxed);
 	return chunk;
 }
 
 /**
- * As we have added a chunk we may have exceeded our target chunk limit. Search through the array to
- * determine how many chunks we have, as well as finding the oldest timestamp. Note that this is potentially
- * wasteful and we may instead wish to track how many chunks we have and/or delete a chunk at random (or
- * just check e.g. 10 and delete the oldest of those) but we'll see if this is a bottleneck first. Paging
- * the data in is probably more expensive.
+ * As we have added a chunk we may have exceeded our target memory usage. The chunks are evicted from the head of the
+ * lru list - chunks that were accessed since the last time they were looked at by this function are given a second
+ * chance and are moved to the tail of the list instead (clock algorithm). This is an approximation of a real lru that
+ * doesn't need to reorder the list on every access and is amortized O(1).
+ * Chunks that are still paged in are skipped.
  */
 void PagedVolume::deleteOldestChunkIfNeeded() const {
-	const std::size_t chunkCount = _chunks.size();
-	if (chunkCount < _chunkCountLimit) {
-		return;
-	}
-	glm::ivec3 oldestChunkPos(glm::uninitialize);
-	bool foundOldestChunk = false;
-	uint32_t oldestChunkTimestamp = std::numeric_limits<uint32_t>::max();
-	for (ChunkMap::iterator i = _chunks.begin(); i != _chunks.end(); ++i) {
-		const glm::ivec3& pos = i->first;
-		const ChunkPtr& chunk = i->second;
-		if (chunk->_chunkLastAccessed < oldestChunkTimestamp) {
-			oldestChunkTimestamp = chunk->_chunkLastAccessed;
-			foundOldestChunk = true;
-			oldestChunkPos = pos;
+	while (_memoryUsage > _targetMemoryUsageInBytes) {
+		// keep a reference to page the chunk out after the shard lock was released
+		ChunkPtr victim;
+		{
+			core::ScopedWriteLock lruLock(_lruLock);
+			Chunk* chunk = _lruHead;
+			if (chunk == nullptr) {
+				return;
+			}
+			// the second chance flags are cleared on the first pass - after two passes only chunks that
+			// are currently paged in are left
+			const uint32_t maxChecks = 2u * _chunkCount;
+			uint32_t checks = 0u;
+			while (chunk->_referenced.exchange(false, std::memory_order_relaxed) || !chunk->_pagedIn.load(std::memory_order_acquire)) {
+				if (++checks > maxChecks) {
+					return;
+				}
+				unlinkChunk(chunk);
+				linkChunk(chunk);
+				chunk = _lruHead;
+			}
+			unlinkChunk(chunk);
+			// chunks in the lru list are still part of a shard - so the chunk is alive while the lru lock is held
+			victim = chunk->shared_from_this();
 		}
-	}
-	if (foundOldestChunk) {
-		ChunkMap::iterator i = _chunks.find(oldestChunkPos);
-		_chunks.erase(i);
+		ChunkMapShard& shard = getShard(victim->_chunkSpacePosition);
+		{
+			core::ScopedWriteLock writeLock(shard.lock);
+			auto i = shard.chunks.find(victim->_chunkSpacePosition);
+			if (i == shard.chunks.end() || i->second != victim) {
+				// flushAll() was faster - the position might even belong to a new chunk already
+				continue;
+			}
+			shard.chunks.erase(i);
+			--_chunkCount;
+		}
+		victim->detach();
 	}
 }
 
@@ -211,17 +297,24 @@ PagedVolume::ChunkPtr PagedVolume::createNewChunk(int32_t chunkX, int32_t chunkY
 	glm::ivec3 pos(chunkX, chunkY, chunkZ);
 	Log::debug("create new chunk at %i:%i:%i", chunkX, chunkY, chunkZ);
 	ChunkPtr chunk = std::make_shared<Chunk>(pos, _chunkSideLength, _pager);
-	chunk->_chunkLastAccessed = ++_timestamper; // Important, as we may soon delete the oldest chunk
+	// Lock the chunk before it gets visible to other threads - they have to wait until it was paged in.
+	core::RecursiveScopedWriteLock chunkWriteLock(chunk->_storageLock);
 
 	{
-		core::RecursiveScopedWriteLock volumeWriteLock(_rwLock);
-		auto i = _chunks.insert(std::make_pair(pos, chunk));
+		ChunkMapShard& shard = getShard(pos);
+		core::ScopedWriteLock writeLock(shard.lock);
+		auto i = shard.chunks.insert(std::make_pair(pos, chunk));
 		if (!i.second) {
 			return i.first->second;
 		}
-		deleteOldestChunkIfNeeded();
+		// link while the shard is still locked - only chunks that are part of a shard may be in the lru list
+		core::ScopedWriteLock lruLock(_lruLock);
+		linkChunk(chunk.get());
+		++_chunkCount;
+		chunk->_volume = this;
+		chunk->updateMemoryUsage();
 	}
-
+	deleteOldestChunkIfNeeded();
 
 	// Pass the chunk to the Pager to give it a chance to initialise it with any data
 	// From the coordinates of the chunk we deduce the coordinates of the contained voxels.
@@ -234,34 +327,29 @@ PagedVolume::ChunkPtr PagedVolume::createNewChunk(int32_t chunkX, int32_t chunkY
 
 	// Page the data in
 	// We'll use this later to decide if data needs to be paged out again.
-	core::RecursiveScopedWriteLock chunkWriteLock(chunk->_rwLock);
 	chunk->_dataModified = _pager->pageIn(pctx);
+	// The pager has written raw voxels - most chunks (e.g. air or solid rock) can be stored a lot smaller.
+	// Nobody else has access to the chunk yet, so the raw data can be freed here.
+	chunk->compact();
+	chunk->buildHeightmap();
+	chunk->updateMemoryUsage();
+	chunk->_pagedIn.store(true, std::memory_order_release);
 	Log::debug("finished creating new chunk at %i:%i:%i", chunkX, chunkY, chunkZ);
 
 	return chunk;
 }
 
 PagedVolume::ChunkPtr PagedVolume::getChunk(int32_t chunkX, int32_t chunkY, int32_t chunkZ) const {
-	ChunkPtr chunk;
-	{
-		core::RecursiveScopedReadLock readLock(_rwLock);
-		if (chunkX == _lastAccessedChunkX && chunkY == _lastAccessedChunkY && chunkZ == _lastAccessedChunkZ && _lastAccessedChunk) {
-			return _lastAccessedChunk;
-		}
-		chunk = getExistingChunk(chunkX, chunkY, chunkZ);
-	}
-
+	ChunkPtr chunk = getExistingChunk(chunkX, chunkY, chunkZ);
 	// If we still haven't found the chunk then it's time to create a new one and page it in from disk.
 	if (!chunk) {
 		chunk = createNewChunk(chunkX, chunkY, chunkZ);
 	}
-
-	core::RecursiveScopedWriteLock writeLock(_rwLock);
-	_lastAccessedChunk = chunk;
-	_lastAccessedChunkX = chunkX;
-	_lastAccessedChunkY = chunkY;
-	_lastAccessedChunkZ = chunkZ;
-
+	// The chunk might still be paged in by another thread - wait for it here once instead
+	// of locking every voxel access. The thread that is paging the chunk in can pass.
+	if (!chunk->_pagedIn.load(std::memory_order_acquire)) {
+		core::RecursiveScopedReadLock readLock(chunk->_storageLock);
+	}
 	return chunk;
 }
 
@@ -269,11 +357,7 @@ PagedVolume::ChunkPtr PagedVolume::getChunk(int32_t chunkX, int32_t chunkY, int3
  * Calculate the memory usage of the volume.
  */
 uint32_t PagedVolume::calculateSizeInBytes() {
-	core::RecursiveScopedReadLock readLock(_rwLock);
-	const std::size_t uChunkCount = _chunks.size();
-	// Note: We disregard the size of the other class members as they are likely to be very small compared to the size of the
-	// allocated voxel data. This also keeps the reported size as a power of two, which makes other memory calculations easier.
-	return PagedVolume::Chunk::calculateSizeInBytes(_chunkSideLength) * uChunkCount;
+	return _memoryUsage;
 }
 
 PagedVolume::Chunk::Chunk(glm::ivec3 v3dPosition, uint16_t uSideLength, Pager* pPager) :
@@ -285,9 +369,8 @@ PagedVolume::Chunk::Chunk(glm::ivec3 v3dPosition, uint16_t uSideLength, Pager* p
 	_sideLength = uSideLength;
 	_sideLengthPower = logBase2(uSideLength);
 
-	// Allocate the data
-	const uint32_t uNoOfVoxels = _sideLength * _sideLength * _sideLength;
-	_data = new Voxel[uNoOfVoxels];
+	// A new chunk consists of air only - nothing is allocated until a different voxel is written.
+	_palette.push_back(Voxel());
 }
 
 PagedVolume::Chunk::~Chunk() {
@@ -295,8 +378,12 @@ PagedVolume::Chunk::~Chunk() {
 		_pager->pageOut(this);
 	}
 
-	delete[] _data;
+	delete[] _data.load(std::memory_order_relaxed);
 	_data = nullptr;
+	delete[] _paletteIndices;
+	_paletteIndices = nullptr;
+	delete[] _heightmap.load(std::memory_order_relaxed);
+	_heightmap = nullptr;
 }
 
 bool PagedVolume::Chunk::isGenerated() const {
@@ -304,27 +391,115 @@ bool PagedVolume::Chunk::isGenerated() const {
 }
 
 Voxel* PagedVolume::Chunk::getData() const {
-	return _data;
+	return _data.load(std::memory_order_acquire);
 }
 
 uint32_t PagedVolume::Chunk::getDataSizeInBytes() const {
 	return _sideLength * _sideLength * _sideLength * sizeof(Voxel);
 }
 
-const Voxel& PagedVolume::Chunk::getVoxel(uint32_t uXPos, uint32_t uYPos, uint32_t uZPos) const {
+bool PagedVolume::Chunk::isCompact() const {
+	return _data.load(std::memory_order_acquire) == nullptr;
+}
+
+bool PagedVolume::Chunk::compact() {
+	Voxel* data = _data.load(std::memory_order_relaxed);
+	if (data == nullptr) {
+		return false;
+	}
+	const uint32_t voxels = _sideLength * _sideLength * _sideLength;
+	// maps material and color of a voxel to the palette index
+	std::vector<int16_t> paletteLookup(1 << 16, -1);
+	std::vector<Voxel> palette;
+	for (uint32_t i = 0u; i < voxels; ++i) {
+		const Voxel& voxel = data[i];
+		const uint16_t key = ((uint16_t)voxel.getMaterial() << 8) | voxel.getColor();
+		if (paletteLookup[key] != -1) {
+			continue;
+		}
+		if (palette.size() >= 256u) {
+			// too many different voxels - the indices wouldn't be smaller than the raw data
+			return false;
+		}
+		paletteLookup[key] = (int16_t)palette.size();
+		palette.push_back(voxel);
+	}
+
+	uint8_t bitsPerIndex = 0u;
+	while ((1u << bitsPerIndex) < palette.size()) {
+		// only power of two bit sizes - the indices must not cross byte boundaries
+		bitsPerIndex = bitsPerIndex == 0u ? 1u : bitsPerIndex * 2u;
+	}
+
+	uint8_t* paletteIndices = nullptr;
+	if (bitsPerIndex > 0u) {
+		const uint32_t indexBytes = (voxels * bitsPerIndex + 7u) / 8u;
+		paletteIndices = new uint8_t[indexBytes];
+		memset(paletteIndices, 0, indexBytes);
+		for (uint32_t i = 0u; i < voxels; ++i) {
+			const Voxel& voxel = data[i];
+			const uint16_t key = ((uint16_t)voxel.getMaterial() << 8) | voxel.getColor();
+			const uint32_t bitOffset = i * bitsPerIndex;
+			paletteIndices[bitOffset >> 3] |= (uint8_t)(paletteLookup[key] << (bitOffset & 7u));
+		}
+	}
+
+	_palette = std::move(palette);
+	_palette.shrink_to_fit();
+	delete[] _paletteIndices;
+	_paletteIndices = paletteIndices;
+	_bitsPerIndex = bitsPerIndex;
+	_data.store(nullptr, std::memory_order_relaxed);
+	delete[] data;
+	return true;
+}
+
+void PagedVolume::Chunk::decompress() {
+	core::RecursiveScopedWriteLock writeLock(_storageLock);
+	if (_data.load(std::memory_order_relaxed) != nullptr) {
+		return;
+	}
+	const uint32_t voxels = _sideLength * _sideLength * _sideLength;
+	Voxel* data = new Voxel[voxels];
+	for (uint32_t i = 0u; i < voxels; ++i) {
+		data[i] = readVoxelByIndex(i);
+	}
+	// publish the filled data - new readers don't touch the indices anymore, but readers that are in the
+	// middle of a lookup still might. That's why the indices are only freed with the chunk.
+	_data.store(data, std::memory_order_release);
+	updateMemoryUsage();
+}
+
+void PagedVolume::Chunk::updateMemoryUsage() {
+	const uint32_t size = calculateSizeInBytes();
+	if (_volume != nullptr) {
+		_volume->_memoryUsage += size;
+		_volume->_memoryUsage -= _accountedBytes;
+	}
+	_accountedBytes = size;
+}
+
+void PagedVolume::Chunk::detach() {
+	core::RecursiveScopedWriteLock writeLock(_storageLock);
+	if (_volume == nullptr) {
+		return;
+	}
+	_volume->_memoryUsage -= _accountedBytes;
+	_volume = nullptr;
+}
+
+Voxel PagedVolume::Chunk::getVoxel(uint32_t uXPos, uint32_t uYPos, uint32_t uZPos) const {
 	// This code is not usually expected to be called by the user, with the exception of when implementing paging
 	// of uncompressed data. It's a performance critical code path
 	core_assert_msg(uXPos < _sideLength, "Supplied position is outside of the chunk. asserted %u > %u", uXPos, _sideLength);
 	core_assert_msg(uYPos < _sideLength, "Supplied position is outside of the chunk. asserted %u > %u", uYPos, _sideLength);
 	core_assert_msg(uZPos < _sideLength, "Supplied position is outside of the chunk. asserted %u > %u", uZPos, _sideLength);
-	core_assert_msg(_data, "No uncompressed data - chunk must be decompressed before accessing voxels.");
 
 	const uint32_t index = morton256_x[uXPos] | morton256_y[uYPos] | morton256_z[uZPos];
-	core::RecursiveScopedReadLock readLock(_rwLock);
-	return _data[index];
+	return getVoxelByIndex(index);
 }
 
-const Voxel& PagedVolume::Chunk::getVoxel(const glm::i16vec3& v3dPos) const {
+Voxel PagedVolume::Chunk::getVoxel(const glm::i16vec3& v3dPos) const {
 	return getVoxel(v3dPos.x, v3dPos.y, v3dPos.z);
 }
 
@@ -334,13 +509,48 @@ void PagedVolume::Chunk::setVoxel(uint32_t uXPos, uint32_t uYPos, uint32_t uZPos
 	core_assert_msg(uXPos < _sideLength, "Supplied position is outside of the chunk");
 	core_assert_msg(uYPos < _sideLength, "Supplied position is outside of the chunk");
 	core_assert_msg(uZPos < _sideLength, "Supplied position is outside of the chunk");
-	core_assert_msg(_data, "No uncompressed data - chunk must be decompressed before accessing voxels.");
 
 	const uint32_t index = morton256_x[uXPos] | morton256_y[uYPos] | morton256_z[uZPos];
-	_data[index] = tValue;
+	// the writers of a chunk are serialized - the heightmap update must not interleave with another write of the column
+	core::RecursiveScopedWriteLock writeLock(_storageLock);
+	setVoxelByIndex(index, tValue);
+	updateHeightmap(uXPos, uYPos, uZPos, tValue);
+}
+
+void PagedVolume::Chunk::setVoxelByIndex(uint32_t index, const Voxel& tValue) {
+	core::RecursiveScopedWriteLock writeLock(_storageLock);
+	Voxel* data = _data.load(std::memory_order_acquire);
+	if (data == nullptr) {
+		// writing the value that is already stored doesn't need the raw data
+		if (readVoxelByIndex(index).isSame(tValue)) {
+			return;
+		}
+		decompress();
+		data = _data.load(std::memory_order_acquire);
+	}
+	const bool announced = beginWrite();
+	data[index] = tValue;
+	if (announced) {
+		endWrite();
+	}
 	_dataModified = true;
 }
 
+bool PagedVolume::Chunk::beginWrite() {
+	// the pager fills the chunk while it holds the storage lock - nobody else can read the voxels yet
+	if (!_pagedIn.load(std::memory_order_relaxed)) {
+		return false;
+	}
+	_writeSequence.store(_writeSequence.load(std::memory_order_relaxed) + 1u, std::memory_order_relaxed);
+	// the odd sequence must be visible before any of the voxels are modified
+	std::atomic_thread_fence(std::memory_order_release);
+	return true;
+}
+
+void PagedVolume::Chunk::endWrite() {
+	_writeSequence.store(_writeSequence.load(std::memory_order_relaxed) + 1u, std::memory_order_release);
+}
+
 void PagedVolume::Chunk::setVoxels(uint32_t uXPos, uint32_t uZPos, const Voxel* tValues, int amount) {
 	setVoxels(uXPos, 0, uZPos, tValues, amount);
 }
@@ -352,22 +562,152 @@ void PagedVolume::Chunk::setVoxels(uint32_t uXPos, uint32_t uYPos, uint32_t uZPo
 	core_assert_msg(uXPos < _sideLength, "Supplied x position is outside of the chunk");
 	core_assert_msg(uYPos < _sideLength, "Supplied y position is outside of the chunk");
 	core_assert_msg(uZPos < _sideLength, "Supplied z position is outside of the chunk");
-	core_assert_msg(_data, "No uncompressed data - chunk must be decompressed before accessing voxels.");
 
+	core::RecursiveScopedWriteLock writeLock(_storageLock);
+	Voxel* data = _data.load(std::memory_order_acquire);
+	if (data == nullptr) {
+		decompress();
+		data = _data.load(std::memory_order_acquire);
+	}
+	const bool announced = beginWrite();
 	for (int y = uYPos; y < amount; ++y) {
 		const uint32_t index = morton256_x[uXPos] | morton256_y[y] | morton256_z[uZPos];
-		_data[index] = tValues[y];
+		data[index] = tValues[y];
+	}
+	if (announced) {
+		endWrite();
 	}
 	_dataModified = true;
+	if (_heightmapBuilt.load(std::memory_order_acquire)) {
+		setColumnHeight(uXPos, uZPos, scanColumn(uXPos, uZPos));
+	}
 }
 
 void PagedVolume::Chunk::setVoxel(const glm::i16vec3& v3dPos, const Voxel& tValue) {
 	setVoxel(v3dPos.x, v3dPos.y, v3dPos.z, tValue);
 }
 
+uint32_t PagedVolume::Chunk::packColumnHeight(int16_t top, int16_t ground) {
+	// store y + 1 to keep the -1 of an empty column positive
+	return (uint32_t)(top + 1) | ((uint32_t)(ground + 1) << 16);
+}
+
+PagedVolume::Chunk::ColumnHeight PagedVolume::Chunk::getColumnHeight(uint32_t uXPos, uint32_t uZPos) const {
+	core_assert_msg(uXPos < _sideLength, "Supplied position is outside of the chunk");
+	core_assert_msg(uZPos < _sideLength, "Supplied position is outside of the chunk");
+	uint32_t packed;
+	const std::atomic_uint* heightmap = _heightmap.load(std::memory_order_acquire);
+	if (heightmap != nullptr) {
+		packed = heightmap[uXPos + uZPos * _sideLength].load(std::memory_order_relaxed);
+	} else if (_heightmapBuilt.load(std::memory_order_acquire)) {
+		packed = _uniformColumn;
+	} else {
+		return scanColumn(uXPos, uZPos);
+	}
+	return ColumnHeight{(int16_t)((int32_t)(packed & 0xFFFF) - 1), (int16_t)((int32_t)(packed >> 16) - 1)};
+}
+
+PagedVolume::Chunk::ColumnHeight PagedVolume::Chunk::scanColumn(uint32_t uXPos, uint32_t uZPos) const {
+	ColumnHeight column{-1, -1};
+	const uint32_t xz = morton256_x[uXPos] | morton256_z[uZPos];
+	for (int y = _sideLength - 1; y >= 0; --y) {
+		const VoxelType material = getVoxelByIndex(xz | morton256_y[y]).getMaterial();
+		if (isAir(material)) {
+			continue;
+		}
+		if (column.top == -1) {
+			column.top = (int16_t)y;
+		}
+		if (!isWater(material)) {
+			column.ground = (int16_t)y;
+			break;
+		}
+	}
+	return column;
+}
+
+void PagedVolume::Chunk::buildHeightmap() {
+	// chunks that only consist of one voxel (e.g. above or below the surface) don't need the scan
+	if (_data.load(std::memory_order_relaxed) == nullptr && _palette.size() == 1u) {
+		const VoxelType material = _palette[0].getMaterial();
+		const int16_t top = isAir(material) ? -1 : (int16_t)(_sideLength - 1);
+		const int16_t ground = isAir(material) || isWater(material) ? -1 : top;
+		_uniformColumn = packColumnHeight(top, ground);
+		_heightmapBuilt.store(true, std::memory_order_release);
+		return;
+	}
+	const uint32_t columns = _sideLength * _sideLength;
+	std::atomic_uint* heightmap = new std::atomic_uint[columns];
+	for (uint32_t z = 0u; z < _sideLength; ++z) {
+		for (uint32_t x = 0u; x < _sideLength; ++x) {
+			const ColumnHeight column = scanColumn(x, z);
+			heightmap[x + z * _sideLength].store(packColumnHeight(column.top, column.ground), std::memory_order_relaxed);
+		}
+	}
+	_heightmap.store(heightmap, std::memory_order_release);
+	_heightmapBuilt.store(true, std::memory_order_release);
+}
+
+void PagedVolume::Chunk::setColumnHeight(uint32_t uXPos, uint32_t uZPos, const ColumnHeight& column) {
+	const uint32_t packed = packColumnHeight(column.top, column.ground);
+	std::atomic_uint* heightmap = _heightmap.load(std::memory_order_acquire);
+	if (heightmap == nullptr) {
+		if (packed == _uniformColumn) {
+			return;
+		}
+		// the first column that differs - readers use the uniform value until the filled map is published
+		core::RecursiveScopedWriteLock writeLock(_storageLock);
+		heightmap = _heightmap.load(std::memory_order_acquire);
+		if (heightmap == nullptr) {
+			const uint32_t columns = _sideLength * _sideLength;
+			heightmap = new std::atomic_uint[columns];
+			for (uint32_t i = 0u; i < columns; ++i) {
+				heightmap[i].store(_uniformColumn, std::memory_order_relaxed);
+			}
+			_heightmap.store(heightmap, std::memory_order_release);
+			updateMemoryUsage();
+		}
+	}
+	heightmap[uXPos + uZPos * _sideLength].store(packed, std::memory_order_relaxed);
+}
+
+void PagedVolume::Chunk::updateHeightmap(uint32_t uXPos, uint32_t uYPos, uint32_t uZPos, const Voxel& tValue) {
+	if (!_heightmapBuilt.load(std::memory_order_acquire)) {
+		return;
+	}
+	ColumnHeight column = getColumnHeight(uXPos, uZPos);
+	const VoxelType material = tValue.getMaterial();
+	const int16_t y = (int16_t)uYPos;
+	if (isAir(material)) {
+		// only removing one of the highest voxels needs to search the next one below
+		if (y == column.top || y == column.ground) {
+			column = scanColumn(uXPos, uZPos);
+		}
+	} else if (isWater(material)) {
+		if (y == column.ground) {
+			column = scanColumn(uXPos, uZPos);
+		} else {
+			column.top = std::max(column.top, y);
+		}
+	} else {
+		column.top = std::max(column.top, y);
+		column.ground = std::max(column.ground, y);
+	}
+	setColumnHeight(uXPos, uZPos, column);
+}
+
 uint32_t PagedVolume::Chunk::calculateSizeInBytes() const {
-	// Call through to the static version
-	return calculateSizeInBytes(_sideLength);
+	uint32_t size = sizeof(Chunk) + _palette.capacity() * sizeof(Voxel);
+	if (_heightmap.load(std::memory_order_relaxed) != nullptr) {
+		size += _sideLength * _sideLength * sizeof(std::atomic_uint);
+	}
+	if (_paletteIndices != nullptr) {
+		size += (_sideLength * _sideLength * _sideLength * _bitsPerIndex + 7u) / 8u;
+	}
+	if (_data.load(std::memory_order_relaxed) != nullptr) {
+		size += calculateSizeInBytes(_sideLength);
+	}
+	return size;
 }
 
 uint32_t PagedVolume::Chunk::calculateSizeInBytes(uint32_t uSideLength) {
@@ -420,17 +760,43 @@ void PagedVolume::Sampler::setPosition(int32_t xPos, int32_t yPos, int32_t zPos)
 
 	const uint32_t voxelIndexInChunk = morton256_x[_xPosInChunk] | morton256_y[_yPosInChunk] | morton256_z[_zPosInChunk];
 
-	_currentChunk = _volume->getChunk(xChunk, yChunk, zChunk);
-	_currentVoxel = _currentChunk->_data + voxelIndexInChunk;
+	_currentChunk = getChunk(xChunk, yChunk, zChunk);
+	_currentVoxelIndex = voxelIndexInChunk;
+}
+
+PagedVolume::ChunkPtr PagedVolume::Sampler::getChunk(int32_t xChunk, int32_t yChunk, int32_t zChunk) const {
+	if (_currentChunk) {
+		const glm::ivec3& p = _currentChunk->_chunkSpacePosition;
+		if (p.x == xChunk && p.y == yChunk && p.z == zChunk) {
+			return _currentChunk;
+		}
+	}
+	if (_lastAccessedChunk) {
+		const glm::ivec3& p = _lastAccessedChunk->_chunkSpacePosition;
+		if (p.x == xChunk && p.y == yChunk && p.z == zChunk) {
+			return _lastAccessedChunk;
+		}
+	}
+	return _volume->getChunk(xChunk, yChunk, zChunk);
+}
+
+Voxel PagedVolume::Sampler::getVoxelFromVolume(int32_t xPos, int32_t yPos, int32_t zPos) const {
+	const int32_t xChunk = xPos >> _volume->_chunkSideLengthPower;
+	const int32_t yChunk = yPos >> _volume->_chunkSideLengthPower;
+	const int32_t zChunk = zPos >> _volume->_chunkSideLengthPower;
+	_lastAccessedChunk = getChunk(xChunk, yChunk, zChunk);
+	const uint16_t xOffset = static_cast<uint16_t>(xPos & _volume->_chunkMask);
+	const uint16_t yOffset = static_cast<uint16_t>(yPos & _volume->_chunkMask);
+	const uint16_t zOffset = static_cast<uint16_t>(zPos & _volume->_chunkMask);
+	return _lastAccessedChunk->getVoxel(xOffset, yOffset, zOffset);
 }
 
 bool PagedVolume::Sampler::setVoxel(const Voxel& tValue) {
-	if (_currentVoxel == nullptr) {
+	if (!_currentChunk) {
 		return false;
 	}
-	//Need to think what effect this has on any existing iterators.
-	//core_assert_msg(false, "This function cannot be used on PagedVolume samplers.");
-	*_currentVoxel = tValue;
+	// the chunk setter keeps the heightmap up to date
+	_currentChunk->setVoxel(_xPosInChunk, _yPosInChunk, _zPosInChunk, tValue);
 	return true;
 }
 
@@ -440,7 +806,7 @@ void PagedVolume::Sampler::movePositiveX() {
 	// Then we update the voxel pointer
 	if (CAN_GO_POS_X(_xPosInChunk)) {
 		//No need to compute new chunk.
-		_currentVoxel += POS_X_DELTA;
+		_currentVoxelIndex += POS_X_DELTA;
 		_xPosInChunk++;
 	} else {
 		//We've hit the chunk boundary. Just calling setPosition() is the easiest way to resolve this.
@@ -454,7 +820,7 @@ void PagedVolume::Sampler::movePositiveY() {
 	// Then we update the voxel pointer
 	if (CAN_GO_POS_Y(_yPosInChunk)) {
 		//No need to compute new chunk.
-		_currentVoxel += POS_Y_DELTA;
+		_currentVoxelIndex += POS_Y_DELTA;
 		_yPosInChunk++;
 	} else {
 		//We've hit the chunk boundary. Just calling setPosition() is the easiest way to resolve this.
@@ -468,7 +834,7 @@ void PagedVolume::Sampler::movePositiveZ() {
 	// Then we update the voxel pointer
 	if (CAN_GO_POS_Z(_zPosInChunk)) {
 		//No need to compute new chunk.
-		_currentVoxel += POS_Z_DELTA;
+		_currentVoxelIndex += POS_Z_DELTA;
 		_zPosInChunk++;
 	} else {
 		//We've hit the chunk boundary. Just calling setPosition() is the easiest way to resolve this.
@@ -482,7 +848,7 @@ void PagedVolume::Sampler::moveNegativeX() {
 	// Then we update the voxel pointer
 	if (CAN_GO_NEG_X(_xPosInChunk)) {
 		//No need to compute new chunk.
-		_currentVoxel += NEG_X_DELTA;
+		_currentVoxelIndex += NEG_X_DELTA;
 		_xPosInChunk--;
 	} else {
 		//We've hit the chunk boundary. Just calling setPosition() is the easiest way to resolve this.
@@ -496,7 +862,7 @@ void PagedVolume::Sampler::moveNegativeY() {
 	// Then we update the voxel pointer
 	if (CAN_GO_NEG_Y(_yPosInChunk)) {
 		//No need to compute new chunk.
-		_currentVoxel += NEG_Y_DELTA;
+		_currentVoxelIndex += NEG_Y_DELTA;
 		_yPosInChunk--;
 	} else {
 		//We've hit the chunk boundary. Just calling setPosition() is the easiest way to resolve this.
@@ -510,7 +876,7 @@ void PagedVolume::Sampler::moveNegativeZ() {
 	// Then we update the voxel pointer
 	if (CAN_GO_NEG_Z(_zPosInChunk)) {
 		//No need to compute new chunk.
-		_currentVoxel += NEG_Z_DELTA;
+		_currentVoxelIndex += NEG_Z_DELTA;
 		_zPosInChunk--;
 	} else {
 		//We've hit the chunk boundary. Just calling setPosition() is the easiest way to resolve this.
@@ -8,8 +8,12 @@
 #include "Region.h"
 #include "core/NonCopyable.h"
 #include "core/RecursiveReadWriteLock.h"
+#include "core/ReadWriteLock.h"
 #include <array>
 #include <memory>
+#include <atomic>
+#include <unordered_map>
+#include <vector>
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/hash.hpp>
 
@@ -45,30 +49,122 @@ public:
 		~Chunk();
 
 		bool isGenerated() const;
+		/**
+		 * @return The raw voxels in morton order or @c nullptr if the chunk is stored compact.
+		 * @sa isCompact()
+		 */
 		Voxel* getData() const;
 		uint32_t getDataSizeInBytes() const;
+		/**
+		 * @return @c true if the chunk is stored as palette (or a single value) instead of the raw voxels
+		 */
+		bool isCompact() const;
 
 		bool containsPoint(const glm::ivec3& pos) const;
 		bool containsPoint(int32_t x, int32_t y, int32_t z) const;
 		Region getRegion() const;
 
-		const Voxel& getVoxel(uint32_t uXPos, uint32_t uYPos, uint32_t uZPos) const;
-		const Voxel& getVoxel(const glm::i16vec3& v3dPos) const;
+		Voxel getVoxel(uint32_t uXPos, uint32_t uYPos, uint32_t uZPos) const;
+		Voxel getVoxel(const glm::i16vec3& v3dPos) const;
+		/**
+		 * @param index The morton index of the voxel in the chunk
+		 * @note The voxels are read without any locking - the read is repeated if a writer modified the chunk meanwhile.
+		 * That's why the voxel is returned as copy.
+		 */
+		Voxel getVoxelByIndex(uint32_t index) const;
 
 		void setVoxel(uint32_t uXPos, uint32_t uYPos, uint32_t uZPos, const Voxel& tValue);
 		void setVoxels(uint32_t uXPos, uint32_t uZPos, const Voxel* tValues, int amount);
 		void setVoxels(uint32_t uXPos, uint32_t uYPos, uint32_t uZPos, const Voxel* tValues, int amount);
 		void setVoxel(const glm::i16vec3& v3dPos, const Voxel& tValue);
 
+		/**
+		 * @brief The chunk local y coordinates of the highest voxels of a column - @c -1 if there is none.
+		 */
+		struct ColumnHeight {
+			/// the highest voxel that is not air
+			int16_t top;
+			/// the highest voxel that is neither air nor water
+			int16_t ground;
+		};
+		/**
+		 * @brief Looks up the column in the heightmap of the chunk. The heightmap is built after the chunk was
+		 * paged in and is kept up to date by the voxel writes.
+		 * @note Like the voxels, the heightmap is read without any locking.
+		 */
+		ColumnHeight getColumnHeight(uint32_t uXPos, uint32_t uZPos) const;
+
+		/**
+		 * @brief Converts the raw voxels into a palette with bit packed indices - or into a single value if
+		 * the chunk only consists of one voxel. Chunks with too many different voxels stay raw.
+		 * @note Must only be called while no other thread is accessing the chunk - the raw data is freed.
+		 * @return @c true if the chunk was compacted
+		 */
+		bool compact();
+
 	private:
-		// This is updated by the PagedVolume and used to discard the least recently used chunks.
-		uint32_t _chunkLastAccessed = 0u;
+		// Intrusive links into the PagedVolume lru list - guarded by the volume lru lock.
+		Chunk* _lruPrev = nullptr;
+		Chunk* _lruNext = nullptr;
+		// Set on every access without taking any lock - the eviction gives referenced chunks a second chance.
+		// New chunks start unreferenced - otherwise a burst of new chunks would make the eviction sweep the whole list.
+		std::atomic_bool _referenced { false };
 
 		uint32_t calculateSizeInBytes() const;
 		static uint32_t calculateSizeInBytes(uint32_t uSideLength);
 
-		Voxel* _data = nullptr;
+		/**
+		 * @brief Converts compact chunks back to raw voxels - this happens lazily on the first write that changes a voxel.
+		 */
+		void decompress();
+		/**
+		 * @note Must be called with the storage lock held.
+		 */
+		void updateMemoryUsage();
+		/**
+		 * @brief Removes the memory of this chunk from the volume memory usage - called when the chunk is evicted.
+		 */
+		void detach();
+		void setVoxelByIndex(uint32_t index, const Voxel& tValue);
+		/**
+		 * @brief The lookup in the current storage without checking the write sequence
+		 */
+		Voxel readVoxelByIndex(uint32_t index) const;
+		/**
+		 * @brief Marks the start of a voxel modification - readers that overlap with it repeat their read.
+		 * @note Must be called with the storage lock held - only one writer is allowed at a time.
+		 * @return @c false if the chunk isn't visible to other threads yet and the write doesn't have to be announced
+		 */
+		bool beginWrite();
+		void endWrite();
+
+		static uint32_t packColumnHeight(int16_t top, int16_t ground);
+		ColumnHeight scanColumn(uint32_t uXPos, uint32_t uZPos) const;
+		/**
+		 * @brief Fills the heightmap - all voxel writes from now on update the affected column.
+		 */
+		void buildHeightmap();
+		void updateHeightmap(uint32_t uXPos, uint32_t uYPos, uint32_t uZPos, const Voxel& tValue);
+		void setColumnHeight(uint32_t uXPos, uint32_t uZPos, const ColumnHeight& column);
+
+		// The raw voxels in morton order - nullptr as long as the chunk is stored compact. Only published
+		// after the voxels were filled in.
+		std::atomic<Voxel*> _data { nullptr };
+		// The palette of the compact storage. A chunk with just one entry doesn't need any indices. The
+		// palette stays alive after the chunk was decompressed - readers that didn't see the raw data yet might still use it.
+		std::vector<Voxel> _palette;
+		// Bit packed palette indices in morton order. They are not modified after the chunk was paged in and stay alive
+		// after the chunk was decompressed - readers that didn't see the raw data yet might still use them.
+		uint8_t* _paletteIndices = nullptr;
+		uint8_t _bitsPerIndex = 0u;
 		uint16_t _sideLength = 0u;
+		// The packed ColumnHeight of every column in x + z * side length order. As long as all columns are the same
+		// (e.g. for uniform chunks) only _uniformColumn is stored. The map is only published once - it is never
+		// replaced until the chunk is destroyed.
+		std::atomic<std::atomic_uint*> _heightmap { nullptr };
+		uint32_t _uniformColumn = 0u;
+		// Set after _uniformColumn or _heightmap were filled
+		std::atomic_bool _heightmapBuilt { false };
 
 		// This is so we can tell whether a uncompressed chunk has to be recompressed and whether
 		// a compressed chunk has to be paged back to disk, or whether they can just be discarded.
@@ -80,7 +176,15 @@ public:
 		// Note: Do we really need to store this position here as well as in the block maps?
 		glm::ivec3 _chunkSpacePosition;
 
-		core::RecursiveReadWriteLock _rwLock{"chunk"};
+		// Set after the pager filled the chunk. Until then, other threads have to wait for the storage lock.
+		std::atomic_bool _pagedIn { false };
+		// Odd while a writer modifies the voxels - a reader compares the value before and after it read a voxel.
+		std::atomic_uint _writeSequence { 0u };
+		// Held while the chunk is paged in and by the writers - the voxel reads are not locked, see _writeSequence.
+		core::RecursiveReadWriteLock _storageLock{"chunk"};
+		// The volume the memory of this chunk is accounted for - nullptr after the chunk was evicted.
+		const PagedVolume* _volume = nullptr;
+		uint32_t _accountedBytes = 0u;
 	};
 	typedef std::shared_ptr<Chunk> ChunkPtr;
 
@@ -117,7 +221,7 @@ public:
 		Sampler(const PagedVolume& volume);
 		~Sampler();
 
-		const Voxel& getVoxel() const;
+		Voxel getVoxel() const;
 
 		inline bool isCurrentPositionValid() const {
 			return true;
@@ -136,37 +240,47 @@ public:
 		void moveNegativeY();
 		void moveNegativeZ();
 
-		const Voxel& peekVoxel1nx1ny1nz() const;
-		const Voxel& peekVoxel1nx1ny0pz() const;
-		const Voxel& peekVoxel1nx1ny1pz() const;
-		const Voxel& peekVoxel1nx0py1nz() const;
-		const Voxel& peekVoxel1nx0py0pz() const;
-		const Voxel& peekVoxel1nx0py1pz() const;
-		const Voxel& peekVoxel1nx1py1nz() const;
-		const Voxel& peekVoxel1nx1py0pz() const;
-		const Voxel& peekVoxel1nx1py1pz() const;
-
-		const Voxel& peekVoxel0px1ny1nz() const;
-		const Voxel& peekVoxel0px1ny0pz() const;
-		const Voxel& peekVoxel0px1ny1pz() const;
-		const Voxel& peekVoxel0px0py1nz() const;
-		const Voxel& peekVoxel0px0py0pz() const;
-		const Voxel& peekVoxel0px0py1pz() const;
-		const Voxel& peekVoxel0px1py1nz() const;
-		const Voxel& peekVoxel0px1py0pz() const;
-		const Voxel& peekVoxel0px1py1pz() const;
-
-		const Voxel& peekVoxel1px1ny1nz() const;
-		const Voxel& peekVoxel1px1ny0pz() const;
-		const Voxel& peekVoxel1px1ny1pz() const;
-		const Voxel& peekVoxel1px0py1nz() const;
-		const Voxel& peekVoxel1px0py0pz() const;
-		const Voxel& peekVoxel1px0py1pz() const;
-		const Voxel& peekVoxel1px1py1nz() const;
-		const Voxel& peekVoxel1px1py0pz() const;
-		const Voxel& peekVoxel1px1py1pz() const;
+		Voxel peekVoxel1nx1ny1nz() const;
+		Voxel peekVoxel1nx1ny0pz() const;
+		Voxel peekVoxel1nx1ny1pz() const;
+		Voxel peekVoxel1nx0py1nz() const;
+		Voxel peekVoxel1nx0py0pz() const;
+		Voxel peekVoxel1nx0py1pz() const;
+		Voxel peekVoxel1nx1py1nz() const;
+		Voxel peekVoxel1nx1py0pz() const;
+		Voxel peekVoxel1nx1py1pz() const;
+
+		Voxel peekVoxel0px1ny1nz() const;
+		Voxel peekVoxel0px1ny0pz() const;
+		Voxel peekVoxel0px1ny1pz() const;
+		Voxel peekVoxel0px0py1nz() const;
+		Voxel peekVoxel0px0py0pz() const;
+		Voxel peekVoxel0px0py1pz() const;
+		Voxel peekVoxel0px1py1nz() const;
+		Voxel peekVoxel0px1py0pz() const;
+		Voxel peekVoxel0px1py1pz() const;
+
+		Voxel peekVoxel1px1ny1nz() const;
+		Voxel peekVoxel1px1ny0pz() const;
+		Voxel peekVoxel1px1ny1pz() const;
+		Voxel peekVoxel1px0py1nz() const;
+		Voxel peekVoxel1px0py0pz() const;
+		Voxel peekVoxel1px0py1pz() const;
+		Voxel peekVoxel1px1py1nz() const;
+		Voxel peekVoxel1px1py0pz() const;
+		Voxel peekVoxel1px1py1pz() const;
 
 	protected:
+		/**
+		 * @brief Lookup for voxels outside of the current chunk (e.g. the peek functions at chunk borders). This
+		 * keeps its own last accessed chunk to not hit the volume chunk map for every call.
+		 */
+		Voxel getVoxelFromVolume(int32_t xPos, int32_t yPos, int32_t zPos) const;
+		/**
+		 * @return The chunk for the given chunk space coordinates - the current chunk of the sampler is reused if possible.
+		 */
+		ChunkPtr getChunk(int32_t xChunk, int32_t yChunk, int32_t zChunk) const;
+
 		const PagedVolume* _volume;
 
 		//The current position in the volume
@@ -174,9 +288,15 @@ public:
 		int32_t _yPosInVolume;
 		int32_t _zPosInVolume;
 
+		Voxel getVoxelByIndex(uint32_t index) const;
+
 		//Other current position information
-		Voxel* _currentVoxel = nullptr;
-		ChunkPtr _currentChunk	;
+		uint32_t _currentVoxelIndex = 0u;
+		// The sampler pins the chunk it is currently in - the chunk is only looked up when a chunk border
+		// is crossed and the voxels are read without any locking.
+		ChunkPtr _currentChunk;
+		// The chunk that was used for the last lookup outside of the current chunk
+		mutable ChunkPtr _lastAccessedChunk;
 
 		uint16_t _xPosInChunk = 0u;
 		uint16_t _yPosInChunk = 0u;
@@ -195,9 +315,9 @@ public:
 	~PagedVolume();
 
 	/// Gets a voxel at the position given by <tt>x,y,z</tt> coordinates
-	const Voxel& getVoxel(int32_t uXPos, int32_t uYPos, int32_t uZPos) const;
+	Voxel getVoxel(int32_t uXPos, int32_t uYPos, int32_t uZPos) const;
 	/// Gets a voxel at the position given by a 3D vector
-	const Voxel& getVoxel(const glm::ivec3& v3dPos) const;
+	Voxel getVoxel(const glm::ivec3& v3dPos) const;
 
 	/// Sets the voxel at the position given by <tt>x,y,z</tt> coordinates
 	void setVoxel(int32_t uXPos, int32_t uYPos, int32_t uZPos, const Voxel& tValue);
@@ -213,6 +333,11 @@ public:
 	/// Calculates approximately how many bytes of memory the volume is currently using.
 	uint32_t calculateSizeInBytes();
 	ChunkPtr getChunk(const glm::ivec3& pos) const;
+	/**
+	 * @return @c true if the chunk that contains the given position is already paged in. Other than @c getChunk() this
+	 * doesn't create the chunk.
+	 */
+	bool hasChunk(const glm::ivec3& pos) const;
 
 	inline uint16_t getChunkSideLength() const {
 		return _chunkSideLength;
@@ -226,26 +351,39 @@ protected:
 	PagedVolume& operator=(const PagedVolume& rhs);
 
 private:
+	typedef std::unordered_map<glm::ivec3, ChunkPtr, std::hash<glm::ivec3> > ChunkMap;
+
+	/**
+	 * The chunks are distributed over several maps with their own locks - this way
+	 * threads that are working on different areas of the volume don't block each other.
+	 */
+	struct ChunkMapShard {
+		core::ReadWriteLock lock {"pagedvolumeshard"};
+		ChunkMap chunks;
+	};
+	static constexpr int ChunkMapShards = 16;
+	static_assert((ChunkMapShards & (ChunkMapShards - 1)) == 0, "Shard count must be a power of two");
+
+	ChunkMapShard& getShard(const glm::ivec3& chunkPos) const;
 	ChunkPtr getChunk(int32_t uChunkX, int32_t uChunkY, int32_t uChunkZ) const;
 	ChunkPtr getExistingChunk(int32_t uChunkX, int32_t uChunkY, int32_t uChunkZ) const;
 	ChunkPtr createNewChunk(int32_t uChunkX, int32_t uChunkY, int32_t uChunkZ) const;
 	void deleteOldestChunkIfNeeded() const;
 
-	// Storing these properties individually has proved to be faster than keeping
-	// them in a glm::ivec3 as it avoids constructions and comparison overheads.
-	// They are also at the start of the class in the hope that they will be pulled
-	// into cache - I've got no idea if this actually makes a difference.
-	mutable int32_t _lastAccessedChunkX = 0;
-	mutable int32_t _lastAccessedChunkY = 0;
-	mutable int32_t _lastAccessedChunkZ = 0;
-	mutable ChunkPtr _lastAccessedChunk = nullptr;
+	void linkChunk(Chunk* chunk) const;
+	void unlinkChunk(Chunk* chunk) const;
 
-	mutable std::atomic_uint _timestamper { 0u };
+	uint32_t _targetMemoryUsageInBytes = 0u;
+	// The memory that is used by the chunks - compact chunks need a lot less memory than raw ones.
+	mutable std::atomic_uint _memoryUsage { 0u };
+	mutable std::atomic_uint _chunkCount { 0u };
 
-	uint32_t _chunkCountLimit = 0u;
+	mutable std::array<ChunkMapShard, ChunkMapShards> _shards;
 
-	typedef std::unordered_map<glm::ivec3, ChunkPtr, std::hash<glm::ivec3> > ChunkMap;
-	mutable ChunkMap _chunks;
+	// The lru list of all chunks that are in the shards - the head is the oldest chunk. Lock order is shard before lru.
+	mutable core::ReadWriteLock _lruLock {"pagedvolumelru"};
+	mutable Chunk* _lruHead = nullptr;
+	mutable Chunk* _lruTail = nullptr;
 
 	// The size of the chunks
 	uint16_t _chunkSideLength;
@@ -253,12 +391,42 @@ private:
 	int32_t _chunkMask;
 
 	Pager* _pager = nullptr;
-
-	mutable core::RecursiveReadWriteLock _rwLock{"pagedvolume"};
 };
 
-inline const Voxel& PagedVolume::Sampler::getVoxel() const {
-	return *_currentVoxel;
+inline Voxel PagedVolume::Chunk::readVoxelByIndex(uint32_t index) const {
+	const Voxel* data = _data.load(std::memory_order_acquire);
+	if (data != nullptr) {
+		return data[index];
+	}
+	if (_bitsPerIndex == 0u) {
+		return _palette[0];
+	}
+	const uint32_t bitOffset = index * _bitsPerIndex;
+	const uint32_t mask = (1u << _bitsPerIndex) - 1u;
+	return _palette[(_paletteIndices[bitOffset >> 3] >> (bitOffset & 7u)) & mask];
+}
+
+/**
+ * The readers don't write to the chunk - they only load the write sequence before and after they copied the voxel.
+ * If a writer was active in between, the copy might be torn and the read is repeated.
+ */
+inline Voxel PagedVolume::Chunk::getVoxelByIndex(uint32_t index) const {
+	for (;;) {
+		const uint32_t sequence = _writeSequence.load(std::memory_order_acquire);
+		const Voxel voxel = readVoxelByIndex(index);
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if ((sequence & 1u) == 0u && _writeSequence.load(std::memory_order_relaxed) == sequence) {
+			return voxel;
+		}
+	}
+}
+
+inline Voxel PagedVolume::Sampler::getVoxelByIndex(uint32_t index) const {
+	return _currentChunk->getVoxelByIndex(index);
+}
+
+inline Voxel PagedVolume::Sampler::getVoxel() const {
+	return getVoxelByIndex(_currentVoxelIndex);
 }
 
 inline void PagedVolume::Sampler::setPosition(const glm::ivec3& v3dNewPos) {
@@ -305,190 +473,190 @@ static const std::array<int32_t, 256> deltaZ = {{ 4, 28, 4, 220, 4, 28, 4, 1756,
 #define NEG_Z_DELTA (-(deltaZ[this->_zPosInChunk-1]))
 #define POS_Z_DELTA (deltaZ[this->_zPosInChunk])
 
-inline const Voxel& PagedVolume::Sampler::peekVoxel1nx1ny1nz() const {
+inline Voxel PagedVolume::Sampler::peekVoxel1nx1ny1nz() const {
 	if (CAN_GO_NEG_X(this->_xPosInChunk) && CAN_GO_NEG_Y(this->_yPosInChunk) && CAN_GO_NEG_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + NEG_X_DELTA + NEG_Y_DELTA + NEG_Z_DELTA);
+		return getVoxelByIndex(_currentVoxelIndex + NEG_X_DELTA + NEG_Y_DELTA + NEG_Z_DELTA);
 	}
-	return this->_volume->getVoxel(this->_xPosInVolume - 1, this->_yPosInVolume - 1, this->_zPosInVolume - 1);
+	return this->getVoxelFromVolume(this->_xPosInVolume - 1, this->_yPosInVolume - 1, this->_zPosInVolume - 1);
 }
 
-inline const Voxel& PagedVolume::Sampler::peekVoxel1nx1ny0pz() const {
+inline Voxel PagedVolume::Sampler::peekVoxel1nx1ny0pz() const {
 	if (CAN_GO_NEG_X(this->_xPosInChunk) && CAN_GO_NEG_Y(this->_yPosInChunk)) {
-		return *(_currentVoxel + NEG_X_DELTA + NEG_Y_DELTA);
+		return getVoxelByIndex(_currentVoxelIndex + NEG_X_DELTA + NEG_Y_DELTA);
 	}
-	return this->_volume->getVoxel(this->_xPosInVolume - 1, this->_yPosInVolume - 1, this->_zPosInVolume);
+	return this->getVoxelFromVolume(this->_xPosInVolume - 1, this->_yPosInVolume - 1, this->_zPosInVolume);
 }
 
-inline const Voxel& PagedVolume::Sampler::peekVoxel1nx1ny1pz() const {
+inline Voxel PagedVolume::Sampler::peekVoxel1nx1ny1pz() const {
 	if (CAN_GO_NEG_X(this->_xPosInChunk) && CAN_GO_NEG_Y(this->_yPosInChunk) && CAN_GO_POS_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + NEG_X_DELTA + NEG_Y_DELTA + POS_Z_DELTA);
+		return getVoxelByIndex(_currentVoxelIndex + NEG_X_DELTA + NEG_Y_DELTA + POS_Z_DELTA);
 	}
-	return this->_volume->getVoxel(this->_xPosInVolume - 1, this->_yPosInVolume - 1, this->_zPosInVolume + 1);
+	return this->getVoxelFromVolume(this->_xPosInVolume - 1, this->_yPosInVolume - 1, this->_zPosInVolume + 1);
 }
 
-inline const Voxel& PagedVolume::Sampler::peekVoxel1nx0py1nz() const {
+inline Voxel PagedVolume::Sampler::peekVoxel1nx0py1nz() const {
 	if (CAN_GO_NEG_X(this->_xPosInChunk) && CAN_GO_NEG_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + NEG_X_DELTA + NEG_Z_DELTA);
+		return getVoxelByIndex(_currentVoxelIndex + NEG_X_DELTA + NEG_Z_DELTA);
 	}
-	return this->_volume->getVoxel(this->_xPosInVolume - 1, this->_yPosInVolume, this->_zPosInVolume - 1);
+	return this->getVoxelFromVolume(this->_xPosInVolume - 1, this->_yPosInVolume, this->_zPosInVolume - 1);
 }
 
-inline const Voxel& PagedVolume::Sampler::peekVoxel1nx0py0pz() const {
+inline Voxel PagedVolume::Sampler::peekVoxel1nx0py0pz() const {
 	if (CAN_GO_NEG_X(this->_xPosInChunk)) {
-		return *(_currentVoxel + NEG_X_DELTA);
+		return getVoxelByIndex(_currentVoxelIndex + NEG_X_DELTA);
 	}
-	return this->_volume->getVoxel(this->_xPosInVolume - 1, this->_yPosInVolume, this->_zPosInVolume);
+	return this->getVoxelFromVolume(this->_xPosInVolume - 1, this->_yPosInVolume, this->_zPosInVolume);
 }
 
-inline const Voxel& PagedVolume::Sampler::peekVoxel1nx0py1pz() const {
+inline Voxel PagedVolume::Sampler::peekVoxel1nx0py1pz() const {
 	if (CAN_GO_NEG_X(this->_xPosInChunk) && CAN_GO_POS_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + NEG_X_DELTA + POS_Z_DELTA);
+		return getVoxelByIndex(_currentVoxelIndex + NEG_X_DELTA + POS_Z_DELTA);
 	}
-	return this->_volume->getVoxel(this->_xPosInVolume - 1, this->_yPosInVolume, this->_zPosInVolume + 1);
+	return this->getVoxelFromVolume(this->_xPosInVolume - 1, this->_yPosInVolume, this->_zPosInVolume + 1);
 }
 
-inline const Voxel& PagedVolume::Sampler::peekVoxel1nx1py1nz() const {
+inline Voxel PagedVolume::Sampler::peekVoxel1nx1py1nz() const {
 	if (CAN_GO_NEG_X(this->_xPosInChunk) && CAN_GO_POS_Y(this->_yPosInChunk) && CAN_GO_NEG_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + NEG_X_DELTA + POS_Y_DELTA + NEG_Z_DELTA);
+		return getVoxelByIndex(_currentVoxelIndex + NEG_X_DELTA + POS_Y_DELTA + NEG_Z_DELTA);
 	}
-	return this->_volume->getVoxel(this->_xPosInVolume - 1, this->_yPosInVolume + 1, this->_zPosInVolume - 1);
+	return this->getVoxelFromVolume(this->_xPosInVolume - 1, this->_yPosInVolume + 1, this->_zPosInVolume - 1);
 }
 
-inline const Voxel& PagedVolume::Sampler::peekVoxel1nx1py0pz() const {
+inline Voxel PagedVolume::Sampler::peekVoxel1nx1py0pz() const {
 	if (CAN_GO_NEG_X(this->_xPosInChunk) && CAN_GO_POS_Y(this->_yPosInChunk)) {
-		return *(_currentVoxel + NEG_X_DELTA + POS_Y_DELTA);
+		return getVoxelByIndex(_currentVoxelIndex + NEG_X_DELTA + POS_Y_DELTA);
 	}
-	return this->_volume->getVoxel(this->_xPosInVolume - 1, this->_yPosInVolume + 1, this->_zPosInVolume);
+	return this->getVoxelFromVolume(this->_xPosInVolume - 1, this->_yPosInVolume + 1, this->_zPosInVolume);
 }
 
-inline const Voxel& PagedVolume::Sampler::peekVoxel1nx1py1pz() const {
+inline Voxel PagedVolume::Sampler::peekVoxel1nx1py1pz() const {
 	if (CAN_GO_NEG_X(this->_xPosInChunk) && CAN_GO_POS_Y(this->_yPosInChunk) && CAN_GO_POS_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + NEG_X_DELTA + POS_Y_DELTA + POS_Z_DELTA);
+		return getVoxelByIndex(_currentVoxelIndex + NEG_X_DELTA + POS_Y_DELTA + POS_Z_DELTA);
 	}
-	return this->_volume->getVoxel(this->_xPosInVolume - 1, this->_yPosInVolume + 1, this->_zPosInVolume + 1);
+	return this->getVoxelFromVolume(this->_xPosInVolume - 1, this->_yPosInVolume + 1, this->_zPosInVolume + 1);
 }
 
-inline const Voxel& PagedVolume::Sampler::peekVoxel0px1ny1nz() const {
+inline Voxel PagedVolume::Sampler::peekVoxel0px1ny1nz() const {
 	if (CAN_GO_NEG_Y(this->_yPosInChunk) && CAN_GO_NEG_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + NEG_Y_DELTA + NEG_Z_DELTA);
+		return getVoxelByIndex(_currentVoxelIndex + NEG_Y_DELTA + NEG_Z_DELTA);
 	}
-	return this->_volume->getVoxel(this->_xPosInVolume, this->_yPosInVolume - 1, this->_zPosInVolume - 1);
+	return this->getVoxelFromVolume(this->_xPosInVolume, this->_yPosInVolume - 1, this->_zPosInVolume - 1);
 }
 
-inline const Voxel& PagedVolume::Sampler::peekVoxel0px1ny0pz() const {
+inline Voxel PagedVolume::Sampler::peekVoxel0px1ny0pz() const {
 	if (CAN_GO_NEG_Y(this->_yPosInChunk)) {
-		return *(_currentVoxel + NEG_Y_DELTA);
+		return getVoxelByIndex(_currentVoxelIndex + NEG_Y_DELTA);
 	}
-	return this->_volume->getVoxel(this->_xPosInVolume, this->_yPosInVolume - 1, this->_zPosInVolume);
+	return this->getVoxelFromVolume(this->_xPosInVolume, this->_yPosInVolume - 1, this->_zPosInVolume);
 }
 
-inline const Voxel& PagedVolume::Sampler::peekVoxel0px1ny1pz() const {
+inline Voxel PagedVolume::Sampler::peekVoxel0px1ny1pz() const {
 	if (CAN_GO_NEG_Y(this->_yPosInChunk) && CAN_GO_POS_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + NEG_Y_DELTA + POS_Z_DELTA);
+		return getVoxelByIndex(_currentVoxelIndex + NEG_Y_DELTA + POS_Z_DELTA);
 	}
-	return this->_volume->getVoxel(this->_xPosInVolume, this->_yPosInVolume - 1, this->_zPosInVolume + 1);
+	return this->getVoxelFromVolume(this->_xPosInVolume, this->_yPosInVolume - 1, this->_zPosInVolume + 1);
 }
 
-inline const Voxel& PagedVolume::Sampler::peekVoxel0px0py1nz() const {
+inline Voxel PagedVolume::Sampler::peekVoxel0px0py1nz() const {
 	if (CAN_GO_NEG_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + NEG_Z_DELTA);
+		return getVoxelByIndex(_currentVoxelIndex + NEG_Z_DELTA);
 	}
-	return this->_volume->getVoxel(this->_xPosInVolume, this->_yPosInVolume, this->_zPosInVolume - 1);
+	return this->getVoxelFromVolume(this->_xPosInVolume, this->_yPosInVolume, this->_zPosInVolume - 1);
 }
 
-inline const Voxel& PagedVolume::Sampler::peekVoxel0px0py0pz() const {
-	return *_currentVoxel;
+inline Voxel PagedVolume::Sampler::peekVoxel0px0py0pz() const {
+	return getVoxelByIndex(_currentVoxelIndex);
 }
 
-inline const Voxel& PagedVolume::Sampler::peekVoxel0px0py1pz() const {
+inline Voxel PagedVolume::Sampler::peekVoxel0px0py1pz() const {
 	if (CAN_GO_POS_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + POS_Z_DELTA);
+		return getVoxelByIndex(_currentVoxelIndex + POS_Z_DELTA);
 	}
-	return this->_volume->getVoxel(this->_xPosInVolume, this->_yPosInVolume, this->_zPosInVolume + 1);
+	return this->getVoxelFromVolume(this->_xPosInVolume, this->_yPosInVolume, this->_zPosInVolume + 1);
 }
 
-inline const Voxel& PagedVolume::Sampler::peekVoxel0px1py1nz() const {
+inline Voxel PagedVolume::Sampler::peekVoxel0px1py1nz() const {
 	if (CAN_GO_POS_Y(this->_yPosInChunk) && CAN_GO_NEG_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + POS_Y_DELTA + NEG_Z_DELTA);
+		return getVoxelByIndex(_currentVoxelIndex + POS_Y_DELTA + NEG_Z_DELTA);
 	}
-	return this->_volume->getVoxel(this->_xPosInVolume, this->_yPosInVolume + 1, this->_zPosInVolume - 1);
+	return this->getVoxelFromVolume(this->_xPosInVolume, this->_yPosInVolume + 1, this->_zPosInVolume - 1);
 }
 
-inline const Voxel& PagedVolume::Sampler::peekVoxel0px1py0pz() const {
+inline Voxel PagedVolume::Sampler::peekVoxel0px1py0pz() const {
 	if (CAN_GO_POS_Y(this->_yPosInChunk)) {
-		return *(_currentVoxel + POS_Y_DELTA);
+		return getVoxelByIndex(_currentVoxelIndex + POS_Y_DELTA);
 	}
-	return this->_volume->getVoxel(this->_xPosInVolume, this->_yPosInVolume + 1, this->_zPosInVolume);
+	return this->getVoxelFromVolume(this->_xPosInVolume, this->_yPosInVolume + 1, this->_zPosInVolume);
 }
 
-inline const Voxel& PagedVolume::Sampler::peekVoxel0px1py1pz() const {
+inline Voxel PagedVolume::Sampler::peekVoxel0px1py1pz() const {
 	if (CAN_GO_POS_Y(this->_yPosInChunk) && CAN_GO_POS_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + POS_Y_DELTA + POS_Z_DELTA);
+		return getVoxelByIndex(_currentVoxelIndex + POS_Y_DELTA + POS_Z_DELTA);
 	}
-	return this->_volume->getVoxel(this->_xPosInVolume, this->_yPosInVolume + 1, this->_zPosInVolume + 1);
+	return this->getVoxelFromVolume(this->_xPosInVolume, this->_yPosInVolume + 1, this->_zPosInVolume + 1);
 }
 
-inline const Voxel& PagedVolume::Sampler::peekVoxel1px1ny1nz() const {
+inline Voxel PagedVolume::Sampler::peekVoxel1px1ny1nz() const {
 	if (CAN_GO_POS_X(this->_xPosInChunk) && CAN_GO_NEG_Y(this->_yPosInChunk) && CAN_GO_NEG_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + POS_X_DELTA + NEG_Y_DELTA + NEG_Z_DELTA);
+		return getVoxelByIndex(_currentVoxelIndex + POS_X_DELTA + NEG_Y_DELTA + NEG_Z_DELTA);
 	}
-	return this->_volume->getVoxel(this->_xPosInVolume + 1, this->_yPosInVolume - 1, this->_zPosInVolume - 1);
+	return this->getVoxelFromVolume(this->_xPosInVolume + 1, this->_yPosInVolume - 1, this->_zPosInVolume - 1);
 }
 
-inline const Voxel& PagedVolume::Sampler::peekVoxel1px1ny0pz() const {
+inline Voxel PagedVolume::Sampler::peekVoxel1px1ny0pz() const {
 	if (CAN_GO_POS_X(this->_xPosInChunk) && CAN_GO_NEG_Y(this->_yPosInChunk)) {
-		return *(_currentVoxel + POS_X_DELTA + NEG_Y_DELTA);
+		return getVoxelByIndex(_currentVoxelIndex + POS_X_DELTA + NEG_Y_DELTA);
 	}
-	return this->_volume->getVoxel(this->_xPosInVolume + 1, this->_yPosInVolume - 1, this->_zPosInVolume);
+	return this->getVoxelFromVolume(this->_xPosInVolume + 1, this->_yPosInVolume - 1, this->_zPosInVolume);
 }
 
-inline const Voxel& PagedVolume::Sampler::peekVoxel1px1ny1pz() const {
+inline Voxel PagedVolume::Sampler::peekVoxel1px1ny1pz() const {
 	if (CAN_GO_POS_X(this->_xPosInChunk) && CAN_GO_NEG_Y(this->_yPosInChunk) && CAN_GO_POS_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + POS_X_DELTA + NEG_Y_DELTA + POS_Z_DELTA);
+		return getVoxelByIndex(_currentVoxelIndex + POS_X_DELTA + NEG_Y_DELTA + POS_Z_DELTA);
 	}
-	return this->_volume->getVoxel(this->_xPosInVolume + 1, this->_yPosInVolume - 1, this->_zPosInVolume + 1);
+	return this->getVoxelFromVolume(this->_xPosInVolume + 1, this->_yPosInVolume - 1, this->_zPosInVolume + 1);
 }
 
-inline const Voxel& PagedVolume::Sampler::peekVoxel1px0py1nz() const {
+inline Voxel PagedVolume::Sampler::peekVoxel1px0py1nz() const {
 	if (CAN_GO_POS_X(this->_xPosInChunk) && CAN_GO_NEG_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + POS_X_DELTA + NEG_Z_DELTA);
+		return getVoxelByIndex(_currentVoxelIndex + POS_X_DELTA + NEG_Z_DELTA);
 	}
-	return this->_volume->getVoxel(this->_xPosInVolume + 1, this->_yPosInVolume, this->_zPosInVolume - 1);
+	return this->getVoxelFromVolume(this->_xPosInVolume + 1, this->_yPosInVolume, this->_zPosInVolume - 1);
 }
 
-inline const Voxel& PagedVolume::Sampler::peekVoxel1px0py0pz() const {
+inline Voxel PagedVolume::Sampler::peekVoxel1px0py0pz() const {
 	if (CAN_GO_POS_X(this->_xPosInChunk)) {
-		return *(_currentVoxel + POS_X_DELTA);
+		return getVoxelByIndex(_currentVoxelIndex + POS_X_DELTA);
 	}
-	return this->_volume->getVoxel(this->_xPosInVolume + 1, this->_yPosInVolume, this->_zPosInVolume);
+	return this->getVoxelFromVolume(this->_xPosInVolume + 1, this->_yPosInVolume, this->_zPosInVolume);
 }
 
-inline const Voxel& PagedVolume::Sampler::peekVoxel1px0py1pz() const {
+inline Voxel PagedVolume::Sampler::peekVoxel1px0py1pz() const {
 	if (CAN_GO_POS_X(this->_xPosInChunk) && CAN_GO_POS_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + POS_X_DELTA + POS_Z_DELTA);
+		return getVoxelByIndex(_currentVoxelIndex + POS_X_DELTA + POS_Z_DELTA);
 	}
-	return this->_volume->getVoxel(this->_xPosInVolume + 1, this->_yPosInVolume, this->_zPosInVolume + 1);
+	return this->getVoxelFromVolume(this->_xPosInVolume + 1, this->_yPosInVolume, this->_zPosInVolume + 1);
 }
 
-inline const Voxel& PagedVolume::Sampler::peekVoxel1px1py1nz() const {
+inline Voxel PagedVolume::Sampler::peekVoxel1px1py1nz() const {
 	if (CAN_GO_POS_X(this->_xPosInChunk) && CAN_GO_POS_Y(this->_yPosInChunk) && CAN_GO_NEG_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + POS_X_DELTA + POS_Y_DELTA + NEG_Z_DELTA);
+		return getVoxelByIndex(_currentVoxelIndex + POS_X_DELTA + POS_Y_DELTA + NEG_Z_DELTA);
 	}
-	return this->_volume->getVoxel(this->_xPosInVolume + 1, this->_yPosInVolume + 1, this->_zPosInVolume - 1);
+	return this->getVoxelFromVolume(this->_xPosInVolume + 1, this->_yPosInVolume + 1, this->_zPosInVolume - 1);
 }
 
-inline const Voxel& PagedVolume::Sampler::peekVoxel1px1py0pz() const {
+inline Voxel PagedVolume::Sampler::peekVoxel1px1py0pz() const {
 	if (CAN_GO_POS_X(this->_xPosInChunk) && CAN_GO_POS_Y(this->_yPosInChunk)) {
-		return *(_currentVoxel + POS_X_DELTA + POS_Y_DELTA);
+		return getVoxelByIndex(_currentVoxelIndex + POS_X_DELTA + POS_Y_DELTA);
 	}
-	return this->_volume->getVoxel(this->_xPosInVolume + 1, this->_yPosInVolume + 1, this->_zPosInVolume);
+	return this->getVoxelFromVolume(this->_xPosInVolume + 1, this->_yPosInVolume + 1, this->_zPosInVolume);
 }
 
-inline const Voxel& PagedVolume::Sampler::peekVoxel1px1py1pz() const {
+inline Voxel PagedVolume::Sampler::peekVoxel1px1py1pz() const {
 	if (CAN_GO_POS_X(this->_xPosInChunk) && CAN_GO_POS_Y(this->_yPosInChunk) && CAN_GO_POS_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + POS_X_DELTA + POS_Y_DELTA + POS_Z_DELTA);
+		return getVoxelByIndex(_currentVoxelIndex + POS_X_DELTA + POS_Y_DELTA + POS_Z_DELTA);
 	}
-	return this->_volume->getVoxel(this->_xPosInVolume + 1, this->_yPosInVolume + 1, this->_zPosInVolume + 1);
+	return this->getVoxelFromVolume(this->_xPosInVolume + 1, this->_yPosInVolume + 1, this->_zPosInVolume + 1);
 }
 
 #undef CAN_GO_NEG_X
@@ -35,10 +35,10 @@ void PagedVolumeWrapper::Sampler::setPosition(int32_t xPos, int32_t yPos, int32_
 	if (p.x == xChunk && p.y == yChunk && p.z == zChunk) {
 		_currentChunk = _chunk;
 	} else {
-		_currentChunk = _volume->getChunk(xChunk, yChunk, zChunk);
+		_currentChunk = getChunk(xChunk, yChunk, zChunk);
 	}
 
-	_currentVoxel = _currentChunk->_data + voxelIndexInChunk;
+	_currentVoxelIndex = voxelIndexInChunk;
 }
 
 PagedVolumeWrapper::PagedVolumeWrapper(PagedVolume* voxelStorage, PagedVolume::ChunkPtr chunk, const Region& region) :
@@ -48,7 +48,7 @@ PagedVolumeWrapper::PagedVolumeWrapper(PagedVolume* voxelStorage, PagedVolume::C
 	}
 }
 
-const Voxel& PagedVolumeWrapper::getVoxel(int x, int y, int z) const {
+Voxel PagedVolumeWrapper::getVoxel(int x, int y, int z) const {
 	if (_validRegion.containsPoint(x, y, z)) {
 		core_assert(_chunk != nullptr);
 		const int relX = x - _validRegion.getLowerX();
@@ -40,8 +40,8 @@ public:
 	PagedVolume* getVolume() const;
 	const Region& getRegion() const;
 
-	const Voxel& getVoxel(const glm::ivec3& pos) const;
-	const Voxel& getVoxel(int x, int y, int z) const;
+	Voxel getVoxel(const glm::ivec3& pos) const;
+	Voxel getVoxel(int x, int y, int z) const;
 
 	bool setVoxel(const glm::ivec3& pos, const Voxel& voxel);
 	bool setVoxel(int x, int y, int z, const Voxel& voxel);
@@ -82,7 +82,7 @@ inline bool PagedVolumeWrapper::setVoxel(const glm::ivec3& pos, const Voxel& vox
 	return setVoxel(pos.x, pos.y, pos.z, voxel);
 }
 
-inline const Voxel& PagedVolumeWrapper::getVoxel(const glm::ivec3& pos) const {
+inline Voxel PagedVolumeWrapper::getVoxel(const glm::ivec3& pos) const {
 	return getVoxel(pos.x, pos.y, pos.z);
 }
 
@@ -0,0 +1,68 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "CubicSurfaceExtractor.h"
+#include "BinaryGreedyMeshExtractor.h"
+
+namespace voxel {
+
+/**
+ * @brief The available algorithms to convert a volume region into a cubic mesh. Both produce the same
+ * faces for the same IsQuadNeeded functor.
+ */
+enum class SurfaceExtractor {
+	/** @sa extractCubicMesh() */
+	Cubic,
+	/** @sa extractBinaryGreedyMesh() */
+	BinaryGreedy
+};
+
+/**
+ * @brief Extracts the surface of the given region with the selected @c SurfaceExtractor
+ */
+template<typename VolumeType, typename MeshType, typename IsQuadNeeded>
+void extractSurface(SurfaceExtractor extractor, VolumeType* volData, const Region& region, MeshType* result, IsQuadNeeded isQuadNeeded, bool mergeQuads = true) {
+	if (extractor == SurfaceExtractor::BinaryGreedy) {
+		extractBinaryGreedyMesh(volData, region, result, isQuadNeeded, mergeQuads);
+		return;
+	}
+	extractCubicMesh(volData, region, result, isQuadNeeded, mergeQuads);
+}
+
+/**
+ * @brief Extracts the surface like extractSurface() - but if the vertices exceed the range of the index type
+ * of the mesh, the region is split along the y axis and the parts are added as segments to the mesh.
+ * @return @c false if the region couldn't be split any further
+ * @sa MeshT::addSegment()
+ */
+template<typename VolumeType, typename MeshType, typename IsQuadNeeded>
+bool extractSurfaceSegments(SurfaceExtractor extractor, VolumeType* volData, const Region& region, MeshType* result, IsQuadNeeded isQuadNeeded, bool mergeQuads = true) {
+	extractSurface(extractor, volData, region, result, isQuadNeeded, mergeQuads);
+	if (!result->overflow()) {
+		return true;
+	}
+	const glm::ivec3& mins = region.getLowerCorner();
+	const glm::ivec3& maxs = region.getUpperCorner();
+	const int vertices = result->getNoOfVertices() / 2;
+	const int indices = result->getNoOfIndices() / 2;
+	result->clear();
+	result->setOffset(mins);
+	if (mins.y == maxs.y) {
+		return false;
+	}
+	const int splitY = mins.y + (maxs.y - mins.y) / 2;
+	MeshType lower(vertices, indices, true);
+	MeshType upper(vertices, indices, true);
+	if (!extractSurfaceSegments(extractor, volData, Region(mins, glm::ivec3(maxs.x, splitY, maxs.z)), &lower, isQuadNeeded, mergeQuads)) {
+		return false;
+	}
+	if (!extractSurfaceSegments(extractor, volData, Region(glm::ivec3(mins.x, splitY + 1, mins.z), maxs), &upper, isQuadNeeded, mergeQuads)) {
+		return false;
+	}
+	return result->addSegment(lower) && result->addSegment(upper);
+}
+
+}
@@ -7,22 +7,27 @@
 #include "core/Common.h"
 #include "Voxel.h"
 #include <glm/vec3.hpp>
+#include <glm/gtc/type_precision.hpp>
 
 namespace voxel {
 
 /**
  * @brief Represents a vertex in a mesh and includes position and ambient occlusion
  * as well as color and material information.
+ *
+ * @note The position is relative to the offset of the mesh the vertex belongs to - and
+ * the renderers have to apply the offset. This keeps the vertex at 8 bytes.
+ * @sa Mesh::getOffset()
  */
 struct VoxelVertex {
-	glm::ivec3 position;
+	glm::u8vec3 position;
 	/** 0 is the darkest, 3 is no occlusion at all */
 	uint8_t ambientOcclusion;
 	uint8_t colorIndex;
 	/* currently we only need to know whether it's water, or not. */
 	VoxelType material;
-	uint8_t padding[1];
+	uint8_t padding[2];
 };
-static_assert(sizeof(VoxelVertex) == 16, "Unexpected size of the vertex struct");
+static_assert(sizeof(VoxelVertex) == 8, "Unexpected size of the vertex struct");
 
 }
@@ -0,0 +1,91 @@
+/**
+ * @file
+ */
+
+#include "core/tests/AbstractTest.h"
+#include "voxel/polyvox/RawVolume.h"
+#include "voxel/polyvox/AStarPathfinder.h"
+#include "core/GLM.h"
+
+namespace voxel {
+
+class AStarPathfinderTest: public core::AbstractTest {
+protected:
+	static bool isWalkable(const RawVolume* volume, const glm::ivec3& pos) {
+		if (!volume->getRegion().containsPoint(pos)) {
+			return false;
+		}
+		return !isBlocked(volume->getVoxel(pos).getMaterial());
+	}
+
+	bool findPath(RawVolume& volume, const glm::ivec3& start, const glm::ivec3& end, std::vector<glm::ivec3>& result,
+			Connectivity connectivity = SixConnected, const std::atomic_bool* cancelled = nullptr) {
+		AStarPathfinderParams<RawVolume> params(&volume, start, end, &result, 1.0f, 10000, connectivity, &isWalkable);
+		params.cancelled = cancelled;
+		AStarPathfinder<RawVolume> pathfinder(params);
+		return pathfinder.execute();
+	}
+
+	void verifyPath(const RawVolume& volume, const std::vector<glm::ivec3>& path, const glm::ivec3& start, const glm::ivec3& end) {
+		ASSERT_FALSE(path.empty());
+		EXPECT_EQ(start, path.front());
+		EXPECT_EQ(end, path.back());
+		for (size_t i = 1; i < path.size(); ++i) {
+			const glm::ivec3 delta = glm::abs(path[i] - path[i - 1]);
+			EXPECT_LE(std::max(delta.x, std::max(delta.y, delta.z)), 1) << "Gap in the path at " << i;
+			EXPECT_TRUE(isWalkable(&volume, path[i])) << "Blocked voxel in the path at " << i;
+		}
+	}
+};
+
+TEST_F(AStarPathfinderTest, testStraightPath) {
+	RawVolume volume(Region(glm::ivec3(0), glm::ivec3(15)));
+	std::vector<glm::ivec3> path;
+	const glm::ivec3 start(0, 0, 0);
+	const glm::ivec3 end(10, 0, 0);
+	ASSERT_TRUE(findPath(volume, start, end, path));
+	verifyPath(volume, path, start, end);
+	EXPECT_EQ(11u, path.size());
+}
+
+TEST_F(AStarPathfinderTest, testPathAroundWall) {
+	RawVolume volume(Region(glm::ivec3(0), glm::ivec3(15, 0, 15)));
+	// a wall along the z axis with one hole at the end
+	for (int z = 0; z < 15; ++z) {
+		volume.setVoxel(glm::ivec3(7, 0, z), createVoxel(VoxelType::Rock, 0));
+	}
+	std::vector<glm::ivec3> path;
+	const glm::ivec3 start(0, 0, 0);
+	const glm::ivec3 end(14, 0, 0);
+	ASSERT_TRUE(findPath(volume, start, end, path));
+	verifyPath(volume, path, start, end);
+	EXPECT_NE(path.end(), std::find(path.begin(), path.end(), glm::ivec3(7, 0, 15)));
+	// manhattan distance through the hole
+	EXPECT_EQ(7u + 15u + 7u + 15u + 1u, path.size());
+
+	// the arena is reused for the next search - the result must not depend on the previous search
+	std::vector<glm::ivec3> diagonal;
+	ASSERT_TRUE(findPath(volume, start, end, diagonal, TwentySixConnected));
+	verifyPath(volume, diagonal, start, end);
+	EXPECT_LT(diagonal.size(), path.size());
+}
+
+TEST_F(AStarPathfinderTest, testNoPath) {
+	RawVolume volume(Region(glm::ivec3(0), glm::ivec3(15, 0, 15)));
+	for (int z = 0; z <= 15; ++z) {
+		volume.setVoxel(glm::ivec3(7, 0, z), createVoxel(VoxelType::Rock, 0));
+	}
+	std::vector<glm::ivec3> path;
+	EXPECT_FALSE(findPath(volume, glm::ivec3(0), glm::ivec3(14, 0, 0), path, TwentySixConnected));
+	EXPECT_TRUE(path.empty());
+}
+
+TEST_F(AStarPathfinderTest, testCancelled) {
+	RawVolume volume(Region(glm::ivec3(0), glm::ivec3(15)));
+	const std::atomic_bool cancelled { true };
+	std::vector<glm::ivec3> path;
+	EXPECT_FALSE(findPath(volume, glm::ivec3(0), glm::ivec3(10), path, SixConnected, &cancelled));
+	EXPECT_TRUE(path.empty());
+}
+
+}
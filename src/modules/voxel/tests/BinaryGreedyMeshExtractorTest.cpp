@@ -0,0 +1,233 @@
+/**
+ * @file
+ */
+
+#include "AbstractVoxelTest.h"
+#include "voxel/polyvox/CubicSurfaceExtractor.h"
+#include "voxel/polyvox/BinaryGreedyMeshExtractor.h"
+#include "voxel/polyvox/SurfaceExtractor.h"
+#include "voxel/polyvox/RawVolume.h"
+#include "voxel/IsQuadNeeded.h"
+#include <map>
+#include <tuple>
+#include <array>
+#include <vector>
+#include <algorithm>
+
+namespace voxel {
+
+class BinaryGreedyMeshExtractorTest: public AbstractVoxelTest {
+protected:
+	/**
+	 * @brief A quad of a mesh - the ambient occlusion values are stored in the order of the sorted vertex positions
+	 */
+	struct Face {
+		glm::ivec3 mins;
+		glm::ivec3 maxs;
+		glm::ivec3 normal;
+		int material;
+		int color;
+		int ambientOcclusion[4];
+
+		inline std::array<int, 15> key() const {
+			return std::array<int, 15> {{ mins.x, mins.y, mins.z, maxs.x, maxs.y, maxs.z, normal.x, normal.y, normal.z,
+				material, color, ambientOcclusion[0], ambientOcclusion[1], ambientOcclusion[2], ambientOcclusion[3] }};
+		}
+
+		inline bool operator<(const Face& other) const {
+			return key() < other.key();
+		}
+
+		inline bool operator==(const Face& other) const {
+			return key() == other.key();
+		}
+	};
+
+	static bool lessPosition(const glm::ivec3& a, const glm::ivec3& b) {
+		return std::tie(a.x, a.y, a.z) < std::tie(b.x, b.y, b.z);
+	}
+
+	/**
+	 * @brief Converts every quad (two consecutive triangles) of the mesh into a face.
+	 */
+	std::vector<Face> faces(const Mesh& mesh) const {
+		const std::vector<IndexType>& indices = mesh.getIndexVector();
+		const std::vector<VoxelVertex>& vertices = mesh.getVertexVector();
+		EXPECT_EQ(0u, indices.size() % 6);
+		std::vector<Face> result;
+		for (size_t i = 0; i + 6 <= indices.size(); i += 6) {
+			std::vector<IndexType> quad(indices.begin() + i, indices.begin() + i + 6);
+			std::sort(quad.begin(), quad.end());
+			quad.erase(std::unique(quad.begin(), quad.end()), quad.end());
+			EXPECT_EQ(4u, quad.size());
+			std::sort(quad.begin(), quad.end(), [&] (IndexType a, IndexType b) {
+				return lessPosition(vertices[a].position, vertices[b].position);
+			});
+			const glm::ivec3 p0 = vertices[indices[i]].position;
+			const glm::ivec3 p1 = vertices[indices[i + 1]].position;
+			const glm::ivec3 p2 = vertices[indices[i + 2]].position;
+			Face face;
+			face.mins = vertices[quad.front()].position;
+			face.maxs = vertices[quad.back()].position;
+			face.normal = glm::ivec3(glm::sign(glm::cross(glm::vec3(p1 - p0), glm::vec3(p2 - p0))));
+			face.material = (int)vertices[quad.front()].material;
+			face.color = vertices[quad.front()].colorIndex;
+			for (int n = 0; n < 4; ++n) {
+				face.ambientOcclusion[n] = vertices[quad[n]].ambientOcclusion;
+			}
+			result.push_back(face);
+		}
+		std::sort(result.begin(), result.end());
+		return result;
+	}
+
+	/**
+	 * @brief Maps every unit cell that is covered by a quad to the voxel of the quad.
+	 */
+	std::map<std::tuple<int, int, int, int, int, int>, std::pair<int, int>> coverage(const Mesh& mesh) const {
+		std::map<std::tuple<int, int, int, int, int, int>, std::pair<int, int>> cells;
+		for (const Face& face : faces(mesh)) {
+			const glm::ivec3 extent = glm::max(face.maxs - face.mins, glm::ivec3(1));
+			for (int z = 0; z < extent.z; ++z) {
+				for (int y = 0; y < extent.y; ++y) {
+					for (int x = 0; x < extent.x; ++x) {
+						const glm::ivec3 pos = face.mins + glm::ivec3(x, y, z);
+						const auto key = std::make_tuple(pos.x, pos.y, pos.z, face.normal.x, face.normal.y, face.normal.z);
+						EXPECT_EQ(0u, cells.count(key)) << "Overlapping quads at " << glm::to_string(pos);
+						cells[key] = std::make_pair(face.material, face.color);
+					}
+				}
+			}
+		}
+		return cells;
+	}
+
+	template<typename VolumeType, typename IsQuadNeeded>
+	void compare(VolumeType* volume, const Region& region, IsQuadNeeded isQuadNeeded) {
+		Mesh cubic(128, 128, true);
+		Mesh greedy(128, 128, true);
+		extractCubicMesh(volume, region, &cubic, isQuadNeeded, false);
+		extractBinaryGreedyMesh(volume, region, &greedy, isQuadNeeded, false);
+		EXPECT_EQ(cubic.getOffset(), greedy.getOffset());
+		const std::vector<Face>& expected = faces(cubic);
+		const std::vector<Face>& actual = faces(greedy);
+		ASSERT_EQ(expected.size(), actual.size()) << "Different amount of faces for " << region;
+		for (size_t i = 0; i < expected.size(); ++i) {
+			ASSERT_TRUE(expected[i] == actual[i]) << "Face " << i << " differs at " << glm::to_string(expected[i].mins)
+					<< " vs " << glm::to_string(actual[i].mins) << " for " << region;
+		}
+
+		Mesh merged(128, 128, true);
+		extractBinaryGreedyMesh(volume, region, &merged, isQuadNeeded, true);
+		EXPECT_LE(merged.getNoOfIndices(), greedy.getNoOfIndices());
+		EXPECT_TRUE(coverage(greedy) == coverage(merged)) << "Merged quads don't cover the same faces for " << region;
+	}
+};
+
+TEST_F(BinaryGreedyMeshExtractorTest, testSphere) {
+	// spans several chunks and more than one block of the binary mesher
+	const Region region(glm::ivec3(-10), glm::ivec3(80));
+	compare(&_volData, region, IsQuadNeeded());
+}
+
+TEST_F(BinaryGreedyMeshExtractorTest, testSphereMerged) {
+	const Region region(glm::ivec3(0), glm::ivec3(63));
+	Mesh cubic(128, 128, true);
+	Mesh greedy(128, 128, true);
+	extractCubicMesh(&_volData, region, &cubic, IsQuadNeeded());
+	extractBinaryGreedyMesh(&_volData, region, &greedy, IsQuadNeeded());
+	EXPECT_GT(greedy.getNoOfIndices(), 0u);
+	EXPECT_TRUE(coverage(cubic) == coverage(greedy));
+}
+
+TEST_F(BinaryGreedyMeshExtractorTest, testChunkMesh) {
+	const Region region(glm::ivec3(0), glm::ivec3(15, 63, 15));
+	for (bool greedy : { false, true }) {
+		Mesh mesh(128, 128, true);
+		ChunkMesh chunkMesh(128, 128, true);
+		if (greedy) {
+			extractBinaryGreedyMesh(&_volData, region, &mesh, IsQuadNeeded());
+			extractBinaryGreedyMesh(&_volData, region, &chunkMesh, IsQuadNeeded());
+		} else {
+			extractCubicMesh(&_volData, region, &mesh, IsQuadNeeded());
+			extractCubicMesh(&_volData, region, &chunkMesh, IsQuadNeeded());
+		}
+		ASSERT_GT(chunkMesh.getNoOfIndices(), 0u);
+		ASSERT_EQ(mesh.getNoOfVertices(), chunkMesh.getNoOfVertices());
+		ASSERT_EQ(mesh.getNoOfIndices(), chunkMesh.getNoOfIndices());
+		EXPECT_EQ(mesh.getOffset(), chunkMesh.getOffset());
+		for (size_t i = 0; i < mesh.getNoOfIndices(); ++i) {
+			ASSERT_EQ(mesh.getIndex(i), (IndexType)chunkMesh.getIndex(i)) << "Index " << i << " differs";
+		}
+	}
+}
+
+TEST_F(BinaryGreedyMeshExtractorTest, testChunkMeshSegments) {
+	// a checkerboard has more vertices than the 16 bit indices of a chunk mesh can address
+	const Region region(glm::ivec3(0), glm::ivec3(63, 15, 63));
+	RawVolume volume(region);
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				if ((x + y + z) % 2 == 0) {
+					volume.setVoxel(x, y, z, createVoxel(VoxelType::Grass, 0));
+				}
+			}
+		}
+	}
+	for (SurfaceExtractor extractor : { SurfaceExtractor::Cubic, SurfaceExtractor::BinaryGreedy }) {
+		Mesh mesh(128, 128, true);
+		extractSurface(extractor, &volume, region, &mesh, IsQuadNeeded());
+		ASSERT_GT(mesh.getNoOfVertices(), (size_t)std::numeric_limits<ChunkIndexType>::max());
+		ChunkMesh chunkMesh(128, 128, true);
+		extractSurface(extractor, &volume, region, &chunkMesh, IsQuadNeeded());
+		EXPECT_TRUE(chunkMesh.overflow());
+		ASSERT_TRUE(extractSurfaceSegments(extractor, &volume, region, &chunkMesh, IsQuadNeeded()));
+		EXPECT_FALSE(chunkMesh.overflow());
+		ASSERT_GE(chunkMesh.getSegments().size(), 2u);
+		EXPECT_EQ(mesh.getOffset(), chunkMesh.getOffset());
+
+		// convert the segments back into one mesh with 32 bit indices
+		Mesh merged(chunkMesh.getNoOfVertices(), chunkMesh.getNoOfIndices(), true);
+		merged.getVertexVector() = chunkMesh.getVertexVector();
+		const std::vector<ChunkIndexType>& indices = chunkMesh.getIndexVector();
+		for (const MeshSegment& segment : chunkMesh.getSegments()) {
+			for (uint32_t i = 0; i < segment.numIndices; ++i) {
+				merged.getIndexVector().push_back(segment.firstVertex + indices[segment.firstIndex + i]);
+			}
+		}
+		ASSERT_EQ(mesh.getNoOfIndices(), merged.getNoOfIndices());
+		EXPECT_TRUE(faces(mesh) == faces(merged)) << "The segments don't contain the same faces";
+	}
+}
+
+TEST_F(BinaryGreedyMeshExtractorTest, testRandomVolume) {
+	const Region region(glm::ivec3(-3, -2, -1), glm::ivec3(36, 69, 28));
+	RawVolume volume(region);
+	const VoxelType types[] = { VoxelType::Air, VoxelType::Air, VoxelType::Water, VoxelType::Grass, VoxelType::Rock };
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				const VoxelType type = types[_random.random(0, (int)SDL_arraysize(types) - 1)];
+				volume.setVoxel(x, y, z, createVoxel(type, _random.random(0, 1)));
+			}
+		}
+	}
+
+	struct BlockedIsQuadNeeded {
+		inline bool operator()(const VoxelType& back, const VoxelType& front, FaceNames face) const {
+			return isBlocked(back) && !isBlocked(front);
+		}
+	};
+
+	Region extended = region;
+	extended.shiftUpperCorner(1, 1, 1);
+	const Region inner(glm::ivec3(2, 3, 4), glm::ivec3(20, 65, 25));
+	for (const Region& r : { region, extended, inner }) {
+		compare(&volume, r, IsQuadNeeded());
+		compare(&volume, r, IsWaterQuadNeeded());
+		compare(&volume, r, BlockedIsQuadNeeded());
+	}
+}
+
+}
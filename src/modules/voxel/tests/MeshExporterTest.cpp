@@ -24,4 +24,19 @@ TEST_F(MeshExporterTest, testExport) {
 	ASSERT_TRUE(core::App::getInstance()->filesystem()->exists(filename));
 }
 
+TEST_F(MeshExporterTest, testExportMultipleMeshes) {
+	const Region& region = _ctx.getRegion();
+	const glm::ivec3& mins = region.getLowerCorner();
+	const glm::ivec3& maxs = region.getUpperCorner();
+	const glm::ivec3 center = region.getCentre();
+	Mesh lower(100, 100, true);
+	Mesh upper(100, 100, true);
+	extractCubicMesh(&_volData, Region(mins, glm::ivec3(maxs.x, center.y, maxs.z)), &lower, IsQuadNeeded());
+	extractCubicMesh(&_volData, Region(glm::ivec3(mins.x, center.y + 1, mins.z), maxs), &upper, IsQuadNeeded());
+	ASSERT_NE(lower.getOffset(), upper.getOffset());
+	const char *filename = "meshexportertest-multiple.obj";
+	ASSERT_TRUE(exportMesh(std::vector<Mesh*>{&lower, &upper}, filename)) << "Could not export meshes to " << filename;
+	ASSERT_TRUE(core::App::getInstance()->filesystem()->exists(filename));
+}
+
 }
@@ -0,0 +1,205 @@
+/**
+ * @file
+ */
+
+#include "core/tests/AbstractTest.h"
+#include "voxel/NavigationGraph.h"
+#include "voxel/polyvox/RawVolume.h"
+#include <atomic>
+#include <thread>
+
+namespace voxel {
+
+class NavigationGraphTest: public core::AbstractTest {
+protected:
+	static constexpr int ClusterSize = 16;
+	static constexpr int Size = 128;
+	static constexpr int Height = 16;
+
+	RawVolume _volume { Region(glm::ivec3(0), glm::ivec3(Size - 1, Height - 1, Size - 1)) };
+	NavigationGraph _graph { [this] (const glm::ivec3& pos) {
+		const Region& region = _volume.getRegion();
+		if (!region.containsPoint(pos) || !region.containsPoint(pos.x, pos.y - 1, pos.z)) {
+			return false;
+		}
+		return isWalkable(&_volume, pos);
+	}, ClusterSize, 1, Height - 1 };
+
+	void SetUp() override {
+		core::AbstractTest::SetUp();
+		// a flat rock floor - the walkable positions are at y = 1
+		fill(glm::ivec3(0), glm::ivec3(Size - 1, 0, Size - 1), VoxelType::Rock);
+	}
+
+	void fill(const glm::ivec3& mins, const glm::ivec3& maxs, VoxelType type) {
+		for (int z = mins.z; z <= maxs.z; ++z) {
+			for (int y = mins.y; y <= maxs.y; ++y) {
+				for (int x = mins.x; x <= maxs.x; ++x) {
+					_volume.setVoxel(x, y, z, createVoxel(type, 0));
+				}
+			}
+		}
+	}
+
+	void verifyPath(const std::vector<glm::ivec3>& path, const glm::ivec3& start, const glm::ivec3& end) {
+		ASSERT_FALSE(path.empty());
+		EXPECT_EQ(start, path.front());
+		EXPECT_EQ(end, path.back());
+		for (size_t i = 1; i < path.size(); ++i) {
+			const glm::ivec3 delta = glm::abs(path[i] - path[i - 1]);
+			ASSERT_LE(std::max(delta.x, std::max(delta.y, delta.z)), 1) << "Gap in the path at " << i << ": "
+					<< glm::to_string(path[i - 1]) << " - " << glm::to_string(path[i]);
+			ASSERT_TRUE(isWalkable(&_volume, path[i])) << "Not walkable position in the path at " << glm::to_string(path[i]);
+		}
+	}
+
+	static bool contains(const std::vector<glm::ivec3>& path, const std::function<bool(const glm::ivec3&)>& func) {
+		return std::find_if(path.begin(), path.end(), func) != path.end();
+	}
+};
+
+TEST_F(NavigationGraphTest, testFlat) {
+	std::vector<glm::ivec3> path;
+	const glm::ivec3 start(2, 1, 2);
+	const glm::ivec3 end(Size - 3, 1, Size - 3);
+	ASSERT_TRUE(_graph.findPath(start, end, path));
+	verifyPath(path, start, end);
+	EXPECT_GT(_graph.nodes(), 0);
+	// the diagonal - the refined path is close to the shortest path
+	EXPECT_LE((int)path.size(), (Size - 5) * 5 / 4);
+}
+
+TEST_F(NavigationGraphTest, testSnapToFloor) {
+	std::vector<glm::ivec3> path;
+	// the positions of the floor voxels are moved up to the walkable positions
+	ASSERT_TRUE(_graph.findPath(glm::ivec3(2, 0, 2), glm::ivec3(Size - 3, 0, 2), path));
+	verifyPath(path, glm::ivec3(2, 1, 2), glm::ivec3(Size - 3, 1, 2));
+}
+
+TEST_F(NavigationGraphTest, testWall) {
+	// a wall that is too high to step on with a gap at the far end
+	fill(glm::ivec3(Size / 2, 1, 0), glm::ivec3(Size / 2, 4, Size - 9), VoxelType::Rock);
+	std::vector<glm::ivec3> path;
+	const glm::ivec3 start(8, 1, 8);
+	const glm::ivec3 end(Size - 9, 1, 8);
+	ASSERT_TRUE(_graph.findPath(start, end, path));
+	verifyPath(path, start, end);
+	EXPECT_TRUE(contains(path, [] (const glm::ivec3& p) { return p.x == Size / 2 && p.z > Size - 9; }))
+			<< "The path doesn't use the gap in the wall";
+
+	// close the gap
+	fill(glm::ivec3(Size / 2, 1, Size - 8), glm::ivec3(Size / 2, 4, Size - 1), VoxelType::Rock);
+	_graph.invalidate(glm::ivec3(Size / 2, 1, Size - 8), glm::ivec3(Size / 2, 4, Size - 1));
+	EXPECT_FALSE(_graph.findPath(start, end, path));
+}
+
+TEST_F(NavigationGraphTest, testStairs) {
+	// a plateau in the second half of the volume that can only be reached by the stairs at z = 0 - 3
+	const int plateauHeight = 6;
+	fill(glm::ivec3(Size / 2, 1, 0), glm::ivec3(Size - 1, plateauHeight, Size - 1), VoxelType::Rock);
+	fill(glm::ivec3(Size / 2, 1, 0), glm::ivec3(Size / 2 + plateauHeight - 1, plateauHeight, 3), VoxelType::Air);
+	for (int step = 0; step < plateauHeight; ++step) {
+		fill(glm::ivec3(Size / 2 + step, 1, 0), glm::ivec3(Size / 2 + step, step + 1, 3), VoxelType::Rock);
+	}
+	std::vector<glm::ivec3> path;
+	const glm::ivec3 start(8, 1, Size - 8);
+	const glm::ivec3 end(Size - 8, plateauHeight + 1, Size - 8);
+	ASSERT_TRUE(_graph.findPath(start, end, path));
+	verifyPath(path, start, end);
+	EXPECT_TRUE(contains(path, [] (const glm::ivec3& p) { return p.x == Size / 2 + 2 && p.z <= 3; }))
+			<< "The path doesn't use the stairs";
+}
+
+TEST_F(NavigationGraphTest, testWater) {
+	// a river along the z axis with a bridge
+	fill(glm::ivec3(Size / 2 - 2, 0, 0), glm::ivec3(Size / 2 + 2, 0, Size - 1), VoxelType::Water);
+	fill(glm::ivec3(Size / 2 - 2, 0, Size - 20), glm::ivec3(Size / 2 + 2, 0, Size - 18), VoxelType::Dirt);
+	std::vector<glm::ivec3> path;
+	const glm::ivec3 start(8, 1, 8);
+	const glm::ivec3 end(Size - 9, 1, 8);
+	ASSERT_TRUE(_graph.findPath(start, end, path));
+	verifyPath(path, start, end);
+	EXPECT_TRUE(contains(path, [] (const glm::ivec3& p) { return p.x == Size / 2 && p.z >= Size - 20 && p.z <= Size - 18; }))
+			<< "The path doesn't use the bridge";
+	EXPECT_FALSE(contains(path, [this] (const glm::ivec3& p) { return isWater(_volume.getVoxel(p.x, p.y - 1, p.z).getMaterial()); }));
+}
+
+TEST_F(NavigationGraphTest, testInvalidate) {
+	std::vector<glm::ivec3> path;
+	const glm::ivec3 start(8, 1, 8);
+	const glm::ivec3 end(Size - 9, 1, 8);
+	ASSERT_TRUE(_graph.findPath(start, end, path));
+	const int builtClusters = _graph.builtClusters();
+
+	// the graph is reused for the next search
+	ASSERT_TRUE(_graph.findPath(end, start, path));
+	EXPECT_EQ(builtClusters, _graph.builtClusters());
+
+	// a wall with a gap - only the clusters of the wall are rebuilt
+	fill(glm::ivec3(Size / 2, 1, 0), glm::ivec3(Size / 2, 4, Size - 9), VoxelType::Rock);
+	_graph.invalidate(glm::ivec3(Size / 2, 1, 0), glm::ivec3(Size / 2, 4, Size - 9));
+	ASSERT_TRUE(_graph.findPath(start, end, path));
+	verifyPath(path, start, end);
+	EXPECT_TRUE(contains(path, [] (const glm::ivec3& p) { return p.x == Size / 2 && p.z > Size - 9; }));
+	EXPECT_GT(_graph.builtClusters(), builtClusters);
+}
+
+TEST_F(NavigationGraphTest, testInvalidateArea) {
+	// a small plane with a row of four clusters - the first rebuilt clusters connect their dirty neighbours
+	RawVolume volume(Region(glm::ivec3(0), glm::ivec3(15, 7, 3)));
+	NavigationGraph graph([&volume] (const glm::ivec3& pos) {
+		const Region& region = volume.getRegion();
+		if (!region.containsPoint(pos) || !region.containsPoint(pos.x, pos.y - 1, pos.z)) {
+			return false;
+		}
+		return isWalkable(&volume, pos);
+	}, 4, 1, 7);
+	auto fillPlane = [&volume] (const glm::ivec3& mins, const glm::ivec3& maxs, VoxelType type) {
+		for (int z = mins.z; z <= maxs.z; ++z) {
+			for (int y = mins.y; y <= maxs.y; ++y) {
+				for (int x = mins.x; x <= maxs.x; ++x) {
+					volume.setVoxel(x, y, z, createVoxel(type, 0));
+				}
+			}
+		}
+	};
+	fillPlane(glm::ivec3(0), glm::ivec3(15, 0, 3), VoxelType::Rock);
+	fillPlane(glm::ivec3(5, 1, 0), glm::ivec3(5, 4, 3), VoxelType::Rock);
+	std::vector<glm::ivec3> path;
+	const glm::ivec3 start(0, 1, 1);
+	const glm::ivec3 end(15, 1, 1);
+	EXPECT_FALSE(graph.findPath(start, end, path));
+
+	// all the clusters are dirty
+	graph.invalidate(glm::ivec3(0), glm::ivec3(15, 7, 3));
+	EXPECT_FALSE(graph.findPath(start, end, path));
+
+	// the clusters that were rebuilt accept new invalidations
+	fillPlane(glm::ivec3(5, 1, 0), glm::ivec3(5, 4, 3), VoxelType::Air);
+	graph.invalidate(glm::ivec3(5, 1, 0), glm::ivec3(5, 4, 3));
+	ASSERT_TRUE(graph.findPath(start, end, path));
+	ASSERT_FALSE(path.empty());
+	EXPECT_EQ(end, path.back());
+}
+
+TEST_F(NavigationGraphTest, testInvalidateWhileSearching) {
+	const glm::ivec3 start(8, 1, 8);
+	const glm::ivec3 end(Size - 9, 1, Size - 9);
+	std::atomic_bool done { false };
+	// the invalidations must not wait for the builds of the searches
+	std::thread invalidator([&] () {
+		while (!done) {
+			_graph.invalidate(glm::ivec3(0), glm::ivec3(Size - 1, Height - 1, Size - 1));
+			std::this_thread::yield();
+		}
+	});
+	std::vector<glm::ivec3> path;
+	for (int i = 0; i < 10; ++i) {
+		ASSERT_TRUE(_graph.findPath(i % 2 == 0 ? start : end, i % 2 == 0 ? end : start, path));
+	}
+	done = true;
+	invalidator.join();
+	verifyPath(path, end, start);
+}
+
+}
@@ -0,0 +1,355 @@
+/**
+ * @file
+ */
+
+#include "AbstractVoxelTest.h"
+#include <thread>
+#include <vector>
+#include <atomic>
+
+namespace voxel {
+
+class PagedVolumeTest: public AbstractVoxelTest {
+protected:
+	std::atomic_int _pageIns { 0 };
+	std::atomic_int _originPageIns { 0 };
+	// if not zero, the chunks are filled with a pattern of this many different voxels
+	int _patternVoxels = 0;
+
+	static Voxel patternVoxel(int x, int y, int z, int patternVoxels) {
+		const int value = (x + y * 3 + z * 7) % patternVoxels;
+		return createVoxel((VoxelType)((int)VoxelType::Water + value / 256), value % 256);
+	}
+
+	bool pageIn(const Region& region, const PagedVolume::ChunkPtr& chunk) override {
+		++_pageIns;
+		if (region.getLowerCorner() == glm::ivec3(0)) {
+			++_originPageIns;
+		}
+		if (_patternVoxels > 0) {
+			for (int z = 0; z < region.getDepthInVoxels(); ++z) {
+				for (int y = 0; y < region.getHeightInVoxels(); ++y) {
+					for (int x = 0; x < region.getWidthInVoxels(); ++x) {
+						chunk->setVoxel(x, y, z, patternVoxel(x, y, z, _patternVoxels));
+					}
+				}
+			}
+			return true;
+		}
+		// mark every chunk with a voxel that depends on its position
+		const VoxelType type = (region.getLowerX() / region.getWidthInVoxels()) % 2 == 0 ? VoxelType::Grass : VoxelType::Rock;
+		chunk->setVoxel(0, 0, 0, createVoxel(type, 0));
+		return true;
+	}
+
+	void SetUp() override {
+		AbstractVoxelTest::SetUp();
+		_volData.flushAll();
+		_pageIns = 0;
+		_originPageIns = 0;
+	}
+
+	glm::ivec3 chunkPos(int i) const {
+		return glm::ivec3(i * _volData.getChunkSideLength(), 0, 0);
+	}
+
+	void testPattern(int patternVoxels, bool expectCompact) {
+		_patternVoxels = patternVoxels;
+		const PagedVolume::ChunkPtr chunk = _volData.getChunk(glm::ivec3(0));
+		EXPECT_EQ(expectCompact, chunk->isCompact());
+		const int size = _volData.getChunkSideLength();
+		PagedVolume::Sampler sampler(&_volData);
+		for (int z = 0; z < size; ++z) {
+			for (int y = 0; y < size; ++y) {
+				sampler.setPosition(0, y, z);
+				for (int x = 0; x < size; ++x) {
+					const Voxel& expected = patternVoxel(x, y, z, patternVoxels);
+					ASSERT_TRUE(expected.isSame(chunk->getVoxel(x, y, z))) << "Unexpected voxel at " << x << ":" << y << ":" << z;
+					ASSERT_TRUE(expected.isSame(sampler.getVoxel())) << "Unexpected sampler voxel at " << x << ":" << y << ":" << z;
+					if (x < size - 1) {
+						// don't page in the next chunk
+						sampler.movePositiveX();
+					}
+				}
+			}
+		}
+	}
+};
+
+TEST_F(PagedVolumeTest, testEvictionKeepsMemoryLimit) {
+	const uint32_t limit = _volData.calculateSizeInBytes();
+	ASSERT_EQ(0u, limit) << "Expected an empty volume after flushing";
+	const int chunks = 1024;
+	for (int i = 0; i < chunks; ++i) {
+		_volData.getVoxel(chunkPos(i));
+	}
+	EXPECT_EQ(chunks, _pageIns);
+	EXPECT_LE(_volData.calculateSizeInBytes(), 128u * 1024u * 1024u);
+	EXPECT_GT(_volData.calculateSizeInBytes(), 0u);
+}
+
+TEST_F(PagedVolumeTest, testRecentlyUsedChunkIsNotEvicted) {
+	_volData.getVoxel(chunkPos(0));
+	for (int i = 1; i < 2048; ++i) {
+		_volData.getVoxel(chunkPos(i));
+		_volData.getVoxel(chunkPos(0));
+	}
+	EXPECT_EQ(1, _originPageIns) << "The chunk at the origin was accessed all the time and should not get evicted";
+}
+
+TEST_F(PagedVolumeTest, testFlushAll) {
+	for (int i = 0; i < 16; ++i) {
+		_volData.getVoxel(chunkPos(i));
+	}
+	_volData.flushAll();
+	EXPECT_EQ(0u, _volData.calculateSizeInBytes());
+	_volData.getVoxel(chunkPos(0));
+	EXPECT_EQ(2, _originPageIns);
+}
+
+TEST_F(PagedVolumeTest, testUniformChunk) {
+	testPattern(1, true);
+	const uint32_t rawSize = _volData.getChunkSideLength() * _volData.getChunkSideLength() * _volData.getChunkSideLength() * sizeof(Voxel);
+	EXPECT_LT(_volData.calculateSizeInBytes(), rawSize / 100u);
+}
+
+TEST_F(PagedVolumeTest, testPaletteChunk) {
+	testPattern(2, true);
+	_volData.flushAll();
+	testPattern(3, true);
+	_volData.flushAll();
+	testPattern(16, true);
+	_volData.flushAll();
+	testPattern(200, true);
+	const uint32_t rawSize = _volData.getChunkSideLength() * _volData.getChunkSideLength() * _volData.getChunkSideLength() * sizeof(Voxel);
+	EXPECT_LT(_volData.calculateSizeInBytes(), rawSize);
+}
+
+TEST_F(PagedVolumeTest, testTooManyVoxelsForPalette) {
+	testPattern(300, false);
+}
+
+TEST_F(PagedVolumeTest, testDecompressOnWrite) {
+	_patternVoxels = 4;
+	const PagedVolume::ChunkPtr chunk = _volData.getChunk(glm::ivec3(0));
+	ASSERT_TRUE(chunk->isCompact());
+	const uint32_t compactSize = _volData.calculateSizeInBytes();
+	// writing the same value doesn't need the raw data
+	_volData.setVoxel(1, 2, 3, patternVoxel(1, 2, 3, _patternVoxels));
+	EXPECT_TRUE(chunk->isCompact());
+	const Voxel voxel = createVoxel(VoxelType::Rock, 0);
+	_volData.setVoxel(1, 2, 3, voxel);
+	EXPECT_FALSE(chunk->isCompact());
+	// the palette indices are kept until the chunk is evicted - the raw data is added
+	const uint32_t side = _volData.getChunkSideLength();
+	const uint32_t rawSize = side * side * side * sizeof(Voxel);
+	EXPECT_EQ(compactSize + rawSize, _volData.calculateSizeInBytes());
+	EXPECT_TRUE(voxel.isSame(_volData.getVoxel(1, 2, 3)));
+	EXPECT_TRUE(patternVoxel(2, 2, 3, _patternVoxels).isSame(_volData.getVoxel(2, 2, 3)));
+	_volData.flushAll();
+	EXPECT_EQ(0u, _volData.calculateSizeInBytes());
+}
+
+TEST_F(PagedVolumeTest, testDecompressWhileReading) {
+	_patternVoxels = 4;
+	const PagedVolume::ChunkPtr chunk = _volData.getChunk(glm::ivec3(0));
+	ASSERT_TRUE(chunk->isCompact());
+	const int size = _volData.getChunkSideLength();
+	std::atomic_bool written { false };
+	std::atomic_int errors { 0 };
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; ++t) {
+		threads.emplace_back([&] () {
+			// read the whole chunk at least once after the raw data was published
+			for (int n = 0; n < 2; n += written ? 1 : 0) {
+				for (int z = 0; z < size; ++z) {
+					for (int y = 1; y < size; ++y) {
+						for (int x = 0; x < size; ++x) {
+							if (!patternVoxel(x, y, z, _patternVoxels).isSame(chunk->getVoxel(x, y, z))) {
+								++errors;
+							}
+						}
+					}
+				}
+			}
+		});
+	}
+	// only the voxels at y = 0 are modified - the readers don't look at them
+	for (int x = 0; x < size; ++x) {
+		chunk->setVoxel(x, 0, 0, createVoxel(VoxelType::Rock, 0));
+	}
+	written = true;
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	EXPECT_FALSE(chunk->isCompact());
+	EXPECT_EQ(0, errors);
+}
+
+TEST_F(PagedVolumeTest, testWriteWhileSampling) {
+	const PagedVolume::ChunkPtr chunk = _volData.getChunk(glm::ivec3(0));
+	const int size = _volData.getChunkSideLength();
+	// the writer switches whole columns between these two voxels - the samplers must never see a mix of both
+	const Voxel first = createVoxel(VoxelType::Rock, 1);
+	const Voxel second = createVoxel(VoxelType::Grass, 2);
+	std::vector<Voxel> firstColumn(size, first);
+	std::vector<Voxel> secondColumn(size, second);
+	for (int x = 0; x < size; ++x) {
+		chunk->setVoxels(x, 0, firstColumn.data(), size);
+	}
+	std::atomic_bool done { false };
+	std::atomic_int errors { 0 };
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; ++t) {
+		threads.emplace_back([&] () {
+			PagedVolume::Sampler sampler(&_volData);
+			while (!done) {
+				for (int x = 0; x < size; ++x) {
+					sampler.setPosition(x, 0, 0);
+					for (int y = 0; y < size - 1; ++y) {
+						const Voxel voxel = sampler.getVoxel();
+						if (!voxel.isSame(first) && !voxel.isSame(second)) {
+							++errors;
+						}
+						const Voxel above = sampler.peekVoxel0px1py0pz();
+						if (!above.isSame(first) && !above.isSame(second)) {
+							++errors;
+						}
+						sampler.movePositiveY();
+					}
+				}
+			}
+		});
+	}
+	for (int n = 0; n < 200; ++n) {
+		for (int x = 0; x < size; ++x) {
+			chunk->setVoxels(x, 0, n % 2 == 0 ? secondColumn.data() : firstColumn.data(), size);
+			_volData.setVoxel(x, n % size, 0, n % 2 == 0 ? first : second);
+		}
+	}
+	done = true;
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	EXPECT_EQ(0, errors);
+	EXPECT_FALSE(chunk->isCompact());
+}
+
+TEST_F(PagedVolumeTest, testColumnHeight) {
+	const PagedVolume::ChunkPtr chunk = _volData.getChunk(glm::ivec3(0));
+	PagedVolume::Chunk::ColumnHeight column = chunk->getColumnHeight(0, 0);
+	EXPECT_EQ(0, column.top);
+	EXPECT_EQ(0, column.ground);
+	column = chunk->getColumnHeight(1, 0);
+	EXPECT_EQ(-1, column.top);
+	EXPECT_EQ(-1, column.ground);
+
+	_volData.setVoxel(0, 5, 0, createVoxel(VoxelType::Water, 0));
+	_volData.setVoxel(0, 3, 0, createVoxel(VoxelType::Rock, 0));
+	column = chunk->getColumnHeight(0, 0);
+	EXPECT_EQ(5, column.top);
+	EXPECT_EQ(3, column.ground);
+
+	_volData.setVoxel(0, 5, 0, createVoxel(VoxelType::Air, 0));
+	column = chunk->getColumnHeight(0, 0);
+	EXPECT_EQ(3, column.top);
+	EXPECT_EQ(3, column.ground);
+
+	_volData.setVoxel(0, 3, 0, createVoxel(VoxelType::Water, 0));
+	column = chunk->getColumnHeight(0, 0);
+	EXPECT_EQ(3, column.top);
+	EXPECT_EQ(0, column.ground);
+
+	_volData.setVoxels(1, 0, 2, 1, 1, std::vector<Voxel>(4, createVoxel(VoxelType::Dirt, 0)).data(), 4);
+	column = chunk->getColumnHeight(1, 2);
+	EXPECT_EQ(3, column.top);
+	EXPECT_EQ(3, column.ground);
+}
+
+TEST_F(PagedVolumeTest, testColumnHeightSampler) {
+	const PagedVolume::ChunkPtr chunk = _volData.getChunk(glm::ivec3(0));
+	PagedVolume::Sampler sampler(&_volData);
+	sampler.setPosition(2, 6, 2);
+	ASSERT_TRUE(sampler.setVoxel(createVoxel(VoxelType::Rock, 0)));
+	PagedVolume::Chunk::ColumnHeight column = chunk->getColumnHeight(2, 2);
+	EXPECT_EQ(6, column.top);
+	EXPECT_EQ(6, column.ground);
+
+	sampler.movePositiveY();
+	ASSERT_TRUE(sampler.setVoxel(createVoxel(VoxelType::Water, 0)));
+	column = chunk->getColumnHeight(2, 2);
+	EXPECT_EQ(7, column.top);
+	EXPECT_EQ(6, column.ground);
+
+	sampler.moveNegativeY();
+	ASSERT_TRUE(sampler.setVoxel(createVoxel(VoxelType::Air, 0)));
+	column = chunk->getColumnHeight(2, 2);
+	EXPECT_EQ(7, column.top);
+	EXPECT_EQ(-1, column.ground);
+}
+
+TEST_F(PagedVolumeTest, testColumnHeightUniformChunk) {
+	testPattern(1, true);
+	const PagedVolume::ChunkPtr chunk = _volData.getChunk(glm::ivec3(0));
+	const int size = _volData.getChunkSideLength();
+	const PagedVolume::Chunk::ColumnHeight column = chunk->getColumnHeight(size - 1, size - 1);
+	EXPECT_EQ(size - 1, column.top) << "The chunk is filled with water";
+	EXPECT_EQ(-1, column.ground) << "The chunk is filled with water";
+	_volData.setVoxel(2, 4, 2, createVoxel(VoxelType::Rock, 0));
+	EXPECT_EQ(4, chunk->getColumnHeight(2, 2).ground);
+	EXPECT_EQ(-1, chunk->getColumnHeight(3, 2).ground);
+}
+
+TEST_F(PagedVolumeTest, testColumnHeightMixedChunk) {
+	// water and generic voxels
+	_patternVoxels = 300;
+	const PagedVolume::ChunkPtr chunk = _volData.getChunk(glm::ivec3(0));
+	const int size = _volData.getChunkSideLength();
+	for (int z = 0; z < size; ++z) {
+		for (int x = 0; x < size; ++x) {
+			int top = -1;
+			int ground = -1;
+			for (int y = size - 1; y >= 0; --y) {
+				const VoxelType material = chunk->getVoxel(x, y, z).getMaterial();
+				if (top == -1 && !isAir(material)) {
+					top = y;
+				}
+				if (!isAir(material) && !isWater(material)) {
+					ground = y;
+					break;
+				}
+			}
+			const PagedVolume::Chunk::ColumnHeight column = chunk->getColumnHeight(x, z);
+			ASSERT_EQ(top, column.top) << "Unexpected top at " << x << ":" << z;
+			ASSERT_EQ(ground, column.ground) << "Unexpected ground at " << x << ":" << z;
+		}
+	}
+}
+
+TEST_F(PagedVolumeTest, testConcurrentAccess) {
+	const int threadCount = 4;
+	const int chunks = 512;
+	std::atomic_int errors { 0 };
+	std::vector<std::thread> threads;
+	for (int t = 0; t < threadCount; ++t) {
+		threads.emplace_back([&, t] () {
+			for (int n = 0; n < 4; ++n) {
+				for (int i = t; i < chunks; i += 1 + t) {
+					const VoxelType expected = i % 2 == 0 ? VoxelType::Grass : VoxelType::Rock;
+					// keep a reference - the chunk might get evicted by another thread
+					const PagedVolume::ChunkPtr chunk = _volData.getChunk(chunkPos(i));
+					if (chunk->getVoxel(0, 0, 0).getMaterial() != expected) {
+						++errors;
+					}
+				}
+			}
+		});
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	EXPECT_EQ(0, errors);
+	EXPECT_LE(_volData.calculateSizeInBytes(), 128u * 1024u * 1024u);
+}
+
+}
@@ -85,6 +85,83 @@ TEST_F(WorldTest, testExtractionSingle) {
 	extract(1);
 }
 
+TEST_F(WorldTest, testPrefetchChunks) {
+	World world;
+	core::Var::get(cfg::VoxelMeshSize, "16", core::CV_READONLY);
+	const io::FilesystemPtr& filesystem = _testApp->filesystem();
+	ASSERT_TRUE(world.init(filesystem->load("world.lua"), filesystem->load("biomes.lua"), 128, 64));
+	world.setSeed(0);
+	world.setPersist(false);
+	const glm::ivec3 pos(0);
+	ASSERT_FALSE(world.isChunkReady(pos));
+	world.prefetchChunks(pos, 1);
+	// returns the future of the already queued chunk
+	const std::shared_future<void> future = world.prefetchChunk(pos);
+	ASSERT_EQ(std::future_status::ready, future.wait_for(std::chrono::seconds(120))) << "Took too long to generate the chunk";
+	EXPECT_TRUE(world.isChunkReady(pos));
+	EXPECT_EQ(std::future_status::ready, world.prefetchChunk(pos).wait_for(std::chrono::seconds(0)))
+		<< "The future of an available chunk should be ready";
+
+	WorldStats stats;
+	world.stats(stats);
+	EXPECT_GT(stats.generatedChunks, 0);
+	EXPECT_GT(stats.terrainMillis, 0.0);
+	world.shutdown();
+}
+
+TEST_F(WorldTest, testPrefetchChunksRemoveViewer) {
+	World world;
+	core::Var::get(cfg::VoxelMeshSize, "16", core::CV_READONLY);
+	const io::FilesystemPtr& filesystem = _testApp->filesystem();
+	ASSERT_TRUE(world.init(filesystem->load("world.lua"), filesystem->load("biomes.lua"), 128, 64));
+	world.setSeed(0);
+	world.setPersist(false);
+	const int64_t viewer = 1;
+	world.prefetchChunks(glm::ivec3(10000, 0, 10000), 8, viewer);
+	WorldStats stats;
+	world.stats(stats);
+	EXPECT_GT(stats.pendingChunks, 0);
+	world.removeViewer(viewer);
+	world.stats(stats);
+	EXPECT_EQ(0, stats.pendingChunks) << "The chunks that no viewer needs anymore should be dropped";
+	world.shutdown();
+}
+
+TEST_F(WorldTest, testFindFloorAfterModification) {
+	World world;
+	core::Var::get(cfg::VoxelMeshSize, "16", core::CV_READONLY);
+	const io::FilesystemPtr& filesystem = _testApp->filesystem();
+	ASSERT_TRUE(world.init(filesystem->load("world.lua"), filesystem->load("biomes.lua"), 128, 64));
+	world.setSeed(0);
+	world.setPersist(false);
+	const int x = 10;
+	const int z = 10;
+	const int floor = world.findFloor(x, z, isFloor);
+	ASSERT_NE(NO_FLOOR_FOUND, floor);
+	ASSERT_LT(floor + 10, MAX_HEIGHT);
+
+	// the world setter
+	world.setVoxel(glm::ivec3(x, floor + 5, z), createVoxel(VoxelType::Rock, 0));
+	EXPECT_EQ(floor + 5, world.findFloor(x, z, isFloor));
+
+	// the sampler setter
+	auto setVoxel = [&] (int y, const Voxel& voxel) {
+		world.raycast(glm::vec3(x + 0.5f, y + 0.5f, z + 0.5f), glm::vec3(0.0f, -1.0f, 0.0f), 1.0f, [&] (const PagedVolume::Sampler& sampler) {
+			PagedVolume::Sampler writer(sampler);
+			EXPECT_TRUE(writer.setVoxel(voxel));
+			return false;
+		});
+	};
+	setVoxel(floor + 10, createVoxel(VoxelType::Rock, 0));
+	EXPECT_EQ(floor + 10, world.findFloor(x, z, isFloor));
+	setVoxel(floor + 10, createVoxel(VoxelType::Air, 0));
+	EXPECT_EQ(floor + 5, world.findFloor(x, z, isFloor));
+
+	world.setVoxel(glm::ivec3(x, floor + 5, z), createVoxel(VoxelType::Air, 0));
+	EXPECT_EQ(floor, world.findFloor(x, z, isFloor));
+	world.shutdown();
+}
+
 // e.g. chunksize = 64 and meshsize = 64
 // 0 - 63 => chunk 0
 // -64 - -1 => chunk -1
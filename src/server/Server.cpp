@@ -33,6 +33,7 @@ core::AppState Server::onConstruct() {
 	core::Var::get(cfg::DatabaseUser, "engine");
 	core::Var::get(cfg::DatabasePassword, "engine", core::CV_SECRET);
 	core::Var::get(cfg::ServerUserTimeout, "60000");
+	core::Var::get(cfg::ServerEntityUpdateBudget, "1200");
 	core::Var::get(cfg::ServerPort, "11337");
 	core::Var::get(cfg::ServerHost, "");
 	core::Var::get(cfg::ServerMaxClients, "1024");
@@ -41,6 +42,9 @@ core::AppState Server::onConstruct() {
 	core::Var::get(cfg::VoxelMeshSize, "16", core::CV_READONLY);
 	core::Var::get(cfg::DatabaseMinConnections, "2");
 	core::Var::get(cfg::DatabaseMaxConnections, "10");
+	core::Var::get(cfg::DatabaseAcquireTimeout, "1000");
+	core::Var::get(cfg::DatabaseIdleCheck, "30000");
+	core::Var::get(cfg::DatabaseWorkers, "2");
 
 	return state;
 }
@@ -105,7 +109,7 @@ int main(int argc, char *argv[]) {
 	const backend::EntityStoragePtr& entityStorage = std::make_shared<backend::EntityStorage>(messageSender, world, timeProvider, containerProvider, poiProvider, cooldownProvider);
 	const backend::SpawnMgrPtr& spawnMgr = std::make_shared<backend::SpawnMgr>(world, entityStorage, messageSender, timeProvider, loader, containerProvider, poiProvider, cooldownProvider);
 
-	const backend::ServerLoopPtr& serverLoop = std::make_shared<backend::ServerLoop>(network, spawnMgr, world, entityStorage, eventBus, registry, containerProvider, poiProvider, cooldownProvider);
+	const backend::ServerLoopPtr& serverLoop = std::make_shared<backend::ServerLoop>(network, messageSender, spawnMgr, world, entityStorage, eventBus, registry, containerProvider, poiProvider, cooldownProvider);
 
 	Server app(network, serverLoop, timeProvider, filesystem, eventBus);
 	return app.startMainLoop(argc, argv);
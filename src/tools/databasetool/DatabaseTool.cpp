@@ -317,6 +317,34 @@ bool DatabaseTool::generateClassForTable(const Table& table, std::stringstream&
 	src << "\t\treturn __p_.exec().result;\n";
 	src << "\t}\n\n";
 
+	src << "\t/**\n";
+	src << "\t * @brief Inserts the given rows with multi row INSERT statements\n";
+	src << "\t * @see ::persistence::Model::row()\n";
+	src << "\t */\n";
+	src << "\tstatic bool insertMany(const std::vector<Row>& rows) {\n";
+	src << "\t\treturn " << classname << "().insertRows(rows);\n";
+	src << "\t}\n\n";
+
+	src << "\t/**\n";
+	src << "\t * @brief Bulk load of new rows with COPY FROM STDIN\n";
+	src << "\t * @see ::persistence::Model::row()\n";
+	src << "\t */\n";
+	src << "\tstatic bool copyMany(const std::vector<Row>& rows) {\n";
+	src << "\t\treturn " << classname << "().copyRows(rows);\n";
+	src << "\t}\n\n";
+
+	if (table.primaryKeys > 0) {
+		src << "\t/**\n";
+		src << "\t * @brief Inserts the given rows or updates them if the primary key already exists\n";
+		src << "\t * @see ::persistence::Model::row()\n";
+		src << "\t */\n";
+		src << "\tstatic bool upsertMany(const std::vector<Row>& rows) {\n";
+		src << "\t\treturn " << classname << "().upsertRows(rows);\n";
+		src << "\t}\n\n";
+
+		src << "\ttypedef ::persistence::WriteBehindQueue<" << classname << "> WriteBehind;\n\n";
+	}
+
 	src << "\tstatic bool truncate() {\n";
 	src << "\t\treturn " << classname << "().exec(\"TRUNCATE TABLE " << table.name << ";\");\n";
 	src << "\t}\n\n";
@@ -383,6 +411,7 @@ bool DatabaseTool::generateSrc() const {
 	src << "#pragma once\n";
 	src << "\n";
 	src << "#include \"persistence/Model.h\"\n";
+	src << "#include \"persistence/WriteBehindQueue.h\"\n";
 	src << "#include \"core/String.h\"\n\n";
 	src << "#include \"core/Common.h\"\n\n";
 
@@ -28,7 +28,7 @@ void VolumeNode::update() {
 		return;
 	}
 	nge->deleteNode(ret.noise);
-	_rawVolumeRenderer.update(0, ret.mesh);
+	_rawVolumeRenderer.update(0, ret.meshes);
 
 	delete _rawVolumeRenderer.setVolume(0, ret.volume);
 	voxelCnt = ret.voxelCnt;
@@ -56,7 +56,6 @@ void VolumeNode::volumeCallback() {
 		ret.volume = new voxel::RawVolume(cmd.region);
 		ret.voxelCnt = 0;
 		ret.noise = cmd.noise;
-		ret.mesh = new voxel::Mesh(128, 128, true);
 		for (int x = 0; x < cmd.volumeWidth; ++x) {
 			for (int y = 0; y < cmd.volumeHeight; ++y) {
 				for (int z = 0; z < cmd.volumeDepth; ++z) {
@@ -68,7 +67,7 @@ void VolumeNode::volumeCallback() {
 				}
 			}
 		}
-		_rawVolumeRenderer.extract(ret.volume, ret.mesh);
+		_rawVolumeRenderer.extract(ret.volume, ret.meshes);
 		_return.push(ret);
 	}
 }
@@ -109,9 +108,10 @@ bool VolumeNode::render(float nodeWidth) {
 		_rawVolumeRenderer.render(_camera);
 		_frameBuffer.unbind();
 
-		const voxel::Mesh* mesh = _rawVolumeRenderer.mesh(0);
-		vertices = mesh->getNoOfVertices();
-		indices = mesh->getNoOfIndices();
+		for (const voxel::Mesh* mesh : _rawVolumeRenderer.meshes(0)) {
+			vertices += mesh->getNoOfVertices();
+			indices += mesh->getNoOfIndices();
+		}
 	}
 
 	const glm::ivec2& dim = _frameBuffer.dimension();
@@ -20,7 +20,7 @@ private:
 		int voxelCnt = 0;
 		voxel::RawVolume* volume = nullptr;
 		NNode* noise = nullptr;
-		voxel::Mesh* mesh = nullptr;
+		frontend::RawVolumeRenderer::Meshes meshes;
 		inline bool operator< (const VolumeCommandReturn& cmd) const { return noise > cmd.noise; }
 	};
 	struct VolumeCommand {
@@ -68,6 +68,33 @@ public:
 	}
 };
 
+class StateDeltaHandler: public ProtocolHandler<AIStateDeltaMessage> {
+private:
+	AIDebugger& _aiDebugger;
+public:
+	StateDeltaHandler (AIDebugger& aiDebugger) :
+			_aiDebugger(aiDebugger) {
+	}
+
+	void execute(const ClientId&, const AIStateDeltaMessage* msg) override {
+		_aiDebugger.applyStateDelta(*msg);
+		emit _aiDebugger.onEntitiesUpdated();
+	}
+};
+
+class StreamModeHandler: public ProtocolHandler<AIStreamModeMessage> {
+private:
+	AIDebugger& _aiDebugger;
+public:
+	StreamModeHandler (AIDebugger& aiDebugger) :
+			_aiDebugger(aiDebugger) {
+	}
+
+	void execute(const ClientId&, const AIStreamModeMessage* msg) override {
+		_aiDebugger.setStreamModeAcknowledged(msg->getMode());
+	}
+};
+
 class PauseHandler: public ProtocolHandler<AIPauseMessage> {
 private:
 	AIDebugger& _aiDebugger;
@@ -85,8 +112,9 @@ public:
 
 AIDebugger::AIDebugger(AINodeStaticResolver& resolver) :
 		QObject(), _stateHandler(new StateHandler(*this)), _characterHandler(new CharacterHandler(*this)), _characterStaticHandler(
-				new CharacterStaticHandler(*this)), _pauseHandler(new PauseHandler(*this)), _namesHandler(new NamesHandler(*this)), _nopHandler(
-				new NopHandler()), _selectedId(AI_NOTHING_SELECTED), _socket(this), _pause(false), _resolver(resolver) {
+				new CharacterStaticHandler(*this)), _pauseHandler(new PauseHandler(*this)), _namesHandler(new NamesHandler(*this)), _stateDeltaHandler(
+				new StateDeltaHandler(*this)), _streamModeHandler(new StreamModeHandler(*this)), _nopHandler(new NopHandler()), _selectedId(
+				AI_NOTHING_SELECTED), _socket(this), _pause(false), _streamMode(true, 100), _deltaMode(false), _resolver(resolver) {
 	connect(&_socket, SIGNAL(readyRead()), SLOT(readTcpData()));
 	connect(&_socket, SIGNAL(disconnected()), SLOT(onDisconnect()));
 
@@ -96,6 +124,8 @@ AIDebugger::AIDebugger(AINodeStaticResolver& resolver) :
 	r.registerHandler(ai::PROTO_CHARACTER_STATIC, _characterStaticHandler);
 	r.registerHandler(ai::PROTO_PAUSE, _pauseHandler);
 	r.registerHandler(ai::PROTO_NAMES, _namesHandler);
+	r.registerHandler(ai::PROTO_STATEDELTA, _stateDeltaHandler);
+	r.registerHandler(ai::PROTO_STREAMMODE, _streamModeHandler);
 	r.registerHandler(ai::PROTO_PING, _nopHandler);
 }
 
@@ -106,6 +136,8 @@ AIDebugger::~AIDebugger() {
 	delete _characterStaticHandler;
 	delete _pauseHandler;
 	delete _namesHandler;
+	delete _stateDeltaHandler;
+	delete _streamModeHandler;
 }
 
 bool AIDebugger::isSelected(const ai::AIStateWorld& ai) const {
@@ -155,24 +187,12 @@ bool AIDebugger::writeMessage(const IProtocolMessage& msg) {
 	// serialize into streamcontainer to get the final size
 	streamContainer out;
 	msg.serialize(out);
-	// now put the serialized message into the byte array
-	QByteArray temp;
-	QDataStream data(&temp, QIODevice::ReadWrite);
 	// add the framing size int
-	const uint32_t size = out.size();
-	streamContainer sizeC;
-	IProtocolMessage::addInt(sizeC, size);
-	for (streamContainer::iterator i = sizeC.begin(); i != sizeC.end(); ++i) {
-		const uint8_t byte = *i;
-		data << byte;
-	}
-	// add the real message
-	for (streamContainer::iterator i = out.begin(); i != out.end(); ++i) {
-		const uint8_t byte = *i;
-		data << byte;
-	}
+	streamContainer framed;
+	IProtocolMessage::addInt(framed, static_cast<int32_t>(out.size()));
+	framed.append(out);
 	// now write everything to the socket
-	_socket.write(temp);
+	_socket.write(reinterpret_cast<const char*>(framed.data()), framed.size());
 	_socket.flush();
 	return true;
 }
@@ -217,6 +237,7 @@ bool AIDebugger::connectToAIServer(const QString& hostname, short port) {
 	_socket.connectToHost(hostname, port, QAbstractSocket::ReadWrite, QAbstractSocket::AnyIPProtocol);
 	if (_socket.waitForConnected()) {
 		qDebug() << "Connection established " << _socket.state();
+		writeMessage(AIStreamModeMessage(_streamMode));
 		return true;
 	}
 	const QAbstractSocket::SocketError socketError = _socket.error();
@@ -247,6 +268,7 @@ bool AIDebugger::disconnectFromAIServer() {
 
 void AIDebugger::onDisconnect() {
 	qDebug() << "disconnect from server: " << _socket.state();
+	_deltaMode = false;
 	{
 		_pause = false;
 		emit onPause(_pause);
@@ -273,10 +295,7 @@ void AIDebugger::readTcpData() {
 		const QByteArray& data = _socket.readAll();
 		// read everything that is currently available from the socket
 		// and store it in our buffer
-		const int n = data.count();
-		for (int i = 0; i < n; ++i) {
-			_stream.push_back(data[i]);
-		}
+		_stream.append(reinterpret_cast<const uint8_t*>(data.constData()), data.size());
 		ai::ProtocolMessageFactory& mf = ai::ProtocolMessageFactory::get();
 		for (;;) {
 			if (!mf.isNewMessageAvailable(_stream))
@@ -301,6 +320,37 @@ void AIDebugger::readTcpData() {
 	}
 }
 
+void AIDebugger::setStreamMode(const AIStreamMode& mode) {
+	_streamMode = mode;
+	writeMessage(AIStreamModeMessage(_streamMode));
+}
+
+void AIDebugger::setViewRect(float minX, float minZ, float maxX, float maxZ) {
+	AIStreamMode mode = _streamMode;
+	mode.minX = minX;
+	mode.minZ = minZ;
+	mode.maxX = maxX;
+	mode.maxZ = maxZ;
+	setStreamMode(mode);
+}
+
+void AIDebugger::setStreamModeAcknowledged(const AIStreamMode& mode) {
+	if (mode.delta && !_deltaMode) {
+		// the server starts with an empty baseline - every entity is sent again
+		_entities.clear();
+	}
+	_deltaMode = mode.delta;
+}
+
+void AIDebugger::applyStateDelta(const AIStateDeltaMessage& msg) {
+	for (CharacterId id : msg.getRemoved()) {
+		_entities.remove(id);
+	}
+	for (const AIStateDelta& delta : msg.getDeltas()) {
+		delta.apply(_entities[delta.id]);
+	}
+}
+
 MapView* AIDebugger::createMapWidget() {
 	return new MapView(*this);
 }
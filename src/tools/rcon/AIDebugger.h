@@ -45,6 +45,8 @@ protected:
 	ai::IProtocolHandler *_characterStaticHandler;
 	ai::IProtocolHandler *_pauseHandler;
 	ai::IProtocolHandler *_namesHandler;
+	ai::IProtocolHandler *_stateDeltaHandler;
+	ai::IProtocolHandler *_streamModeHandler;
 	ai::IProtocolHandler *_nopHandler;
 
 	// The buffer where we store our network data until we can read one complete protocol message.
@@ -61,6 +63,10 @@ protected:
 	// the socket of the ai debug server
 	QTcpSocket _socket;
 	bool _pause;
+	// the stream mode that is negotiated with the server after connecting
+	AIStreamMode _streamMode;
+	// true if the server acknowledged the delta streaming
+	bool _deltaMode;
 	QStringList _names;
 	AINodeStaticResolver& _resolver;
 
@@ -78,6 +84,11 @@ public:
 	 */
 	const Entities& getEntities() const;
 	void setEntities(const std::vector<AIStateWorld>& entities);
+	void applyStateDelta(const AIStateDeltaMessage& msg);
+	/**
+	 * @brief Called when the server acknowledged a new stream mode
+	 */
+	void setStreamModeAcknowledged(const AIStreamMode& mode);
 	void setCharacterDetails(const CharacterId& id, const AIStateAggro& aggro, const AIStateNode& node);
 	void addCharacterStaticData(const AICharacterStaticMessage& msg);
 	void setNames(const std::vector<std::string>& names);
@@ -112,6 +123,19 @@ public:
 	void deleteNode(int32_t nodeId);
 	void addNode(int32_t parentNodeId, const QVariant& name, const QVariant& type, const QVariant& condition);
 
+	/**
+	 * @brief Changes the way the server streams the entities. By default the debugger receives deltas
+	 * for all entities with at most 10 updates per second.
+	 * @see @ai{AIStreamModeMessage}
+	 */
+	void setStreamMode(const AIStreamMode& mode);
+	/**
+	 * @brief Only receive the entities in the given rectangle on the x/z plane. This is meant for
+	 * @c MapView implementations that know the extents of their map. An empty rectangle (min > max)
+	 * disables the filter again.
+	 */
+	void setViewRect(float minX, float minZ, float maxX, float maxZ);
+
 	/**
 	 * @brief override this if you would like to create your own @c MapView implementation that renders
 	 * for example more details of your map.
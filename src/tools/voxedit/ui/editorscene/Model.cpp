@@ -432,8 +432,7 @@ void Model::cut() {
 }
 
 void Model::render(const video::Camera& camera) {
-	const voxel::Mesh* mesh = _rawVolumeRenderer.mesh(ModelVolumeIndex);
-	_empty = mesh != nullptr ? mesh->getNoOfIndices() == 0 : true;
+	_empty = _rawVolumeRenderer.empty(ModelVolumeIndex);
 	_gridRenderer.render(camera, modelVolume()->getRegion());
 	_rawVolumeRenderer.render(camera);
 	// TODO: render error if rendered last - but be before grid renderer to get transparency.
@@ -452,8 +451,7 @@ void Model::render(const video::Camera& camera) {
 }
 
 void Model::renderSelection(const video::Camera& camera) {
-	const voxel::Mesh* mesh = _rawVolumeSelectionRenderer.mesh(SelectionVolumeIndex);
-	if (mesh == nullptr || mesh->getNoOfIndices() == 0) {
+	if (_rawVolumeSelectionRenderer.empty(SelectionVolumeIndex)) {
 		return;
 	}
 	video::ScopedPolygonMode polygonMode(video::PolygonMode::WireFrame, glm::vec2(-2.0f));